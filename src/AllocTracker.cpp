@@ -0,0 +1,127 @@
+#include "AllocTracker.h"
+
+#ifdef TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h> // _aligned_malloc: MSVC has no std::aligned_alloc
+#endif
+
+namespace {
+    const int PHASE_COUNT = static_cast<int>(AllocPhase::Count);
+
+    std::atomic<std::uint64_t> frameCounters[PHASE_COUNT];
+    std::atomic<std::uint64_t> totalCounter(0);
+    thread_local AllocPhase threadPhase = AllocPhase::Other;
+
+    inline void record() {
+        frameCounters[static_cast<int>(threadPhase)].fetch_add(1, std::memory_order_relaxed);
+        totalCounter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void* allocate(std::size_t size) {
+        record();
+        if (size == 0) size = 1;
+        for (;;) {
+            if (void* p = std::malloc(size)) return p;
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    void* allocateAligned(std::size_t size, std::size_t alignment) {
+        record();
+        if (size == 0) size = 1;
+        size = (size + alignment - 1) / alignment * alignment; // aligned_alloc wants a multiple
+        for (;;) {
+#ifdef _MSC_VER
+            if (void* p = _aligned_malloc(size, alignment)) return p;
+#else
+            if (void* p = std::aligned_alloc(alignment, size)) return p;
+#endif
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    // Must match allocateAligned: on MSVC those blocks cannot go to free()
+    void freeAligned(void* p) {
+#ifdef _MSC_VER
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+namespace AllocTracker {
+    void setPhase(AllocPhase phase) { threadPhase = phase; }
+    AllocPhase currentPhase() { return threadPhase; }
+
+    void beginFrame() {
+        for (int i = 0; i < PHASE_COUNT; ++i) frameCounters[i].store(0, std::memory_order_relaxed);
+    }
+
+    std::uint64_t frameCount(AllocPhase phase) {
+        return frameCounters[static_cast<int>(phase)].load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t frameTotal() {
+        std::uint64_t total = 0;
+        for (int i = 0; i < PHASE_COUNT; ++i) total += frameCounters[i].load(std::memory_order_relaxed);
+        return total;
+    }
+
+    std::uint64_t totalCount() { return totalCounter.load(std::memory_order_relaxed); }
+
+    const char* phaseName(AllocPhase phase) {
+        switch (phase) {
+            case AllocPhase::Other:     return "other";
+            case AllocPhase::Input:     return "input";
+            case AllocPhase::Update:    return "update";
+            case AllocPhase::Collision: return "collision";
+            case AllocPhase::Cleanup:   return "cleanup";
+            case AllocPhase::Hud:       return "hud";
+            case AllocPhase::Render:    return "render";
+            case AllocPhase::Count:     break;
+        }
+        return "?";
+    }
+}
+
+// Global replacements: count, then forward to malloc/free
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return allocateAligned(size, static_cast<std::size_t>(alignment)); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return allocateAligned(size, static_cast<std::size_t>(alignment)); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(p); }
+
+#endif // TRACK_ALLOCATIONS
@@ -0,0 +1,50 @@
+#ifndef ALLOCTRACKER_H
+#define ALLOCTRACKER_H
+
+#include <cstdint>
+
+// Heap allocation counters, bucketed by the frame phase that was active when the allocation happened.
+// Only compiled in when the build defines TRACK_ALLOCATIONS (CMake option of the same name);
+// otherwise every call below is an empty inline and global operator new is untouched.
+
+enum class AllocPhase { Other, Input, Update, Collision, Cleanup, Hud, Render, Count };
+
+namespace AllocTracker {
+
+#ifdef TRACK_ALLOCATIONS
+    const bool enabled = true;
+
+    void setPhase(AllocPhase phase);        // Phase of the calling thread
+    AllocPhase currentPhase();
+
+    void beginFrame();                      // Resets the per-frame counters
+    std::uint64_t frameCount(AllocPhase phase);
+    std::uint64_t frameTotal();
+    std::uint64_t totalCount();             // Since program start
+    const char* phaseName(AllocPhase phase);
+#else
+    const bool enabled = false;
+
+    inline void setPhase(AllocPhase) {}
+    inline AllocPhase currentPhase() { return AllocPhase::Other; }
+
+    inline void beginFrame() {}
+    inline std::uint64_t frameCount(AllocPhase) { return 0; }
+    inline std::uint64_t frameTotal() { return 0; }
+    inline std::uint64_t totalCount() { return 0; }
+    inline const char* phaseName(AllocPhase) { return ""; }
+#endif
+
+    // Marks a scope as belonging to a phase, restoring the previous phase on exit
+    class PhaseScope {
+    public:
+        explicit PhaseScope(AllocPhase phase) : previous(currentPhase()) { setPhase(phase); }
+        ~PhaseScope() { setPhase(previous); }
+        PhaseScope(const PhaseScope&) = delete;
+        PhaseScope& operator=(const PhaseScope&) = delete;
+    private:
+        AllocPhase previous;
+    };
+}
+
+#endif // ALLOCTRACKER_H
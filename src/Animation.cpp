@@ -1,60 +1,42 @@
 #include "Animation.h"
+#include <cmath>
 
-Animation::Animation() : frame(0.f), speed(0.f), isPlaying(true), loop(true) {}
+Animation::Animation() : speed(0.f), frameCount(0), loop(true) {}
 
 Animation::Animation(sf::Texture &t, int x, int y, int w, int h, int count, float Speed, bool loopAnimation)
-    : frame(0.f), speed(Speed), isPlaying(true), loop(loopAnimation)
+    : speed(Speed), firstFrame(x, y, w, h), frameCount(count > 0 ? count : 0), loop(loopAnimation)
 {
-    frames.reserve(count);
-    for (int i = 0; i < count; i++) {
-        frames.emplace_back(x + i * w, y, w, h);
-    }
-
     sprite.setTexture(t);
     sprite.setOrigin(static_cast<float>(w) / 2.f, static_cast<float>(h) / 2.f);
-    if (!frames.empty()) {
-        sprite.setTextureRect(frames[0]);
+    if (frameCount > 0) {
+        sprite.setTextureRect(frameRect(0));
     } else {
         // Handle error or set a default rect if needed
     }
 }
 
-void Animation::update(float dt) {
-    if (!isPlaying || speed == 0.f) return; // Don't update if paused or speed is zero
-
-    frame += speed * dt * 60.f; // Multiply by 60 to keep speed consistent with original logic if dt is ~1/60
-
-    int n = static_cast<int>(frames.size());
-    if (n == 0) return; // No frames to animate
+int Animation::frameAt(std::uint64_t elapsedTicks) const {
+    if (frameCount <= 1 || speed <= 0.f) return 0;
 
+    double frame = static_cast<double>(elapsedTicks) * speed;
     if (loop) {
-        while (frame >= n) frame -= n; // Loop around
-    } else {
-        if (frame >= n) {
-            frame = static_cast<float>(n - 1); // Clamp to last frame
-            isPlaying = false;           // Stop playing if not looping
-        }
+        return static_cast<int>(std::fmod(frame, static_cast<double>(frameCount)));
     }
-
-    sprite.setTextureRect(frames[static_cast<int>(frame)]);
+    return frame >= frameCount ? frameCount - 1 : static_cast<int>(frame); // Hold the last frame
 }
 
-bool Animation::isFinished() const {
-    return !loop && !isPlaying && !frames.empty() && static_cast<int>(frame) == frames.size() - 1;
+void Animation::apply(std::uint64_t elapsedTicks, int frameStep) {
+    if (frameCount <= 0) return;
+    int frame = frameAt(elapsedTicks);
+    if (frameStep > 1) frame -= frame % frameStep;
+    sprite.setTextureRect(frameRect(frame));
 }
 
-void Animation::play() {
-    isPlaying = true;
+std::uint64_t Animation::durationTicks() const {
+    if (loop || frameCount == 0 || speed <= 0.f) return 0;
+    return static_cast<std::uint64_t>(std::ceil(frameCount / speed));
 }
 
-void Animation::pause() {
-    isPlaying = false;
+sf::IntRect Animation::frameRect(int index) const {
+    return sf::IntRect(firstFrame.left + index * firstFrame.width, firstFrame.top, firstFrame.width, firstFrame.height);
 }
-
-void Animation::reset() {
-    frame = 0.f;
-    isPlaying = true; // Or false depending on desired behavior
-    if (!frames.empty()) {
-        sprite.setTextureRect(frames[0]);
-    }
-}
\ No newline at end of file
@@ -2,24 +2,29 @@
 #define ANIMATION_H
 
 #include <SFML/Graphics.hpp>
-#include <vector>
+#include <cstdint>
 
+// Flipbook clip. Playback is stateless: the frame shown is a pure function of the ticks elapsed
+// since the owner spawned, so nothing has to be advanced per tick and off-screen entities cost nothing.
 class Animation {
 public:
-    float frame, speed;
+    float speed;      // Frames per simulation tick (1/60 s)
     sf::Sprite sprite;
-    std::vector<sf::IntRect> frames;
-    bool isPlaying; // Added to control playback
-    bool loop;      // Added for looping control
+    // Frames are a horizontal strip starting at firstFrame; stored as geometry (not a vector)
+    // so copying an Animation never touches the heap
+    sf::IntRect firstFrame;
+    int frameCount;
+    bool loop;
 
     Animation();
     Animation(sf::Texture &t, int x, int y, int w, int h, int count, float speed, bool loopAnimation = true);
 
-    void update(float dt); // Update based on delta time
-    bool isFinished() const; // Check if non-looping animation finished
-    void play();
-    void pause();
-    void reset();
+    int frameAt(std::uint64_t elapsedTicks) const;   // Frame index after 'elapsedTicks' of playback
+    void apply(std::uint64_t elapsedTicks, int frameStep = 1); // Points the sprite at that frame (call at draw time);
+                                                               // frameStep > 1 only shows every Nth frame
+    std::uint64_t durationTicks() const;             // Ticks until a non-looping clip ends (0 = never)
+
+    sf::IntRect frameRect(int index) const;
 };
 
-#endif // ANIMATION_H
\ No newline at end of file
+#endif // ANIMATION_H
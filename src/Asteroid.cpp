@@ -1,8 +1,9 @@
 #include "Asteroid.h"
+#include "Logger.h"
 #include "ResourceManager.h"
+#include "Random.h"
 #include <cstdlib>
 #include <cmath>
-#include <iostream>
 
 Asteroid::Asteroid(Size sz) : asteroidSize(sz) {
     type = Type::Asteroid;
@@ -14,8 +15,8 @@ Asteroid::Asteroid(Size sz) : asteroidSize(sz) {
         case Size::Small: scoreValue = 100; R = 8.f; break;  // Adjusted default R
     }
 
-    float angleRad = (rand() % 360) * 0.017453f;
-    float speed = static_cast<float>(rand() % 3 + 2);
+    float angleRad = Random::range(360) * 0.017453f;
+    float speed = static_cast<float>(Random::range(3) + 2);
     velocity.x = std::cos(angleRad) * speed;
     velocity.y = std::sin(angleRad) * speed;
 }
@@ -46,7 +47,7 @@ void Asteroid::settings(Animation &a, sf::Vector2f startPos, float startAngle, f
                  break;
         }
      } catch(const std::runtime_error& e) {
-         std::cerr << "Error setting asteroid animation: " << e.what() << std::endl;
+         LOG_ERROR(LogCategory::Entity, "Error setting asteroid animation: %s", e.what());
          actualAnim = a;
          actualRadius = radius; // Keep fallback
      }
@@ -65,9 +66,23 @@ void Asteroid::update(float dt, const sf::Vector2u& windowSize) {
     else if (pos.x > windowSize.x + R) pos.x = -R;
     if (pos.y < -R) pos.y = windowSize.y + R;
     else if (pos.y > windowSize.y + R) pos.y = -R;
-    anim.update(dt);
 }
 
 Asteroid::Size Asteroid::getSize() const {
     return asteroidSize;
-}
\ No newline at end of file
+}
+
+float Asteroid::getMass() const {
+    switch (asteroidSize) {
+        case Size::Large: return 9.f;
+        case Size::Medium: return 3.5f;
+        case Size::Small: return 1.f;
+    }
+    return 1.f;
+}
+
+void Asteroid::hashState(WorldChecksum& sum) const {
+    Entity::hashState(sum);
+    sum.add(static_cast<std::int32_t>(asteroidSize));
+    sum.add(scoreValue);
+}
@@ -16,6 +16,8 @@ public:
     void update(float dt, const sf::Vector2u& windowSize) override;
 
     Size getSize() const;
+    float getMass() const; // By size, in proportion to the rock's area (a small rock is 1)
+    void hashState(WorldChecksum& sum) const override;
 };
 
 #endif // ASTEROID_H
\ No newline at end of file
@@ -0,0 +1,100 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LSB-first bit packing into a byte vector. Fixed-width fields use write(value, bits); small
+// integers of unknown size use the length-prefixed writeVar/writeSigned forms.
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<std::uint8_t>& output) : out(output), acc(0), used(0) {}
+
+    void write(std::uint64_t value, int bits) {
+        while (bits > 0) {
+            int take = bits < 32 ? bits : 32;
+            std::uint64_t part = value & ((std::uint64_t(1) << take) - 1);
+            acc |= part << used;
+            used += take;
+            value >>= take;
+            bits -= take;
+            while (used >= 8) {
+                out.push_back(static_cast<std::uint8_t>(acc));
+                acc >>= 8;
+                used -= 8;
+            }
+        }
+    }
+    void writeBool(bool value) { write(value ? 1 : 0, 1); }
+
+    // 6-bit bit count, then the significant bits (0 costs 6 bits, 1000 costs 16)
+    void writeVar(std::uint64_t value) {
+        int bits = 0;
+        while (bits < 64 && (value >> bits) != 0) ++bits;
+        if (bits >= 63) { // Count 63 means "all 64 bits follow"
+            write(63, 6);
+            write(value, 64);
+            return;
+        }
+        write(static_cast<std::uint64_t>(bits), 6);
+        write(value, bits);
+    }
+    void writeSigned(std::int64_t value) { writeVar((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63)); } // Zigzag
+
+    void flush() { // Pads the last partial byte
+        if (used > 0) out.push_back(static_cast<std::uint8_t>(acc));
+        acc = 0;
+        used = 0;
+    }
+
+private:
+    std::vector<std::uint8_t>& out;
+    std::uint64_t acc;
+    int used;
+};
+
+class BitReader {
+public:
+    BitReader(const std::uint8_t* bytes, std::size_t size) : data(bytes), end(bytes + size), acc(0), avail(0), overrun(false) {}
+
+    std::uint64_t read(int bits) {
+        std::uint64_t value = 0;
+        int shift = 0;
+        while (bits > 0) {
+            int take = bits < 32 ? bits : 32;
+            while (avail < take) {
+                if (data == end) { overrun = true; return 0; }
+                acc |= static_cast<std::uint64_t>(*data++) << avail;
+                avail += 8;
+            }
+            value |= (acc & ((std::uint64_t(1) << take) - 1)) << shift;
+            acc >>= take;
+            avail -= take;
+            shift += take;
+            bits -= take;
+        }
+        return value;
+    }
+    bool readBool() { return read(1) != 0; }
+
+    std::uint64_t readVar() {
+        int bits = static_cast<int>(read(6));
+        return read(bits == 63 ? 64 : bits);
+    }
+    std::int64_t readSigned() {
+        std::uint64_t z = readVar();
+        return static_cast<std::int64_t>(z >> 1) ^ -static_cast<std::int64_t>(z & 1);
+    }
+
+    bool ok() const { return !overrun; } // False once a read ran past the end
+
+private:
+    const std::uint8_t* data;
+    const std::uint8_t* end;
+    std::uint64_t acc;
+    int avail;
+    bool overrun;
+};
+
+#endif // BITSTREAM_H
@@ -1,16 +1,23 @@
 #include "Boss.h"
+#include "Logger.h"
 #include "ResourceManager.h"
+#include <algorithm>
 #include <cmath>
-#include <iostream> // For debug
 
 const float BOSS_DEGTORAD = 0.017453f;
 
+// Bullet pattern per gun (firePoint1-3) in each phase. Gun N opens in phase N (see Game::onTimer),
+// so the first row's third entry never plays.
+const BulletPatterns::PatternId BOSS_PATTERNS[2][3] = {
+    { BulletPatterns::AimedFan, BulletPatterns::RingBurst, BulletPatterns::AimedFan },
+    { BulletPatterns::Spiral,   BulletPatterns::DenseRing, BulletPatterns::Curtain },
+};
+
 Boss::Boss() :
     maxHealth(100), // Example health
     health(100),
     phaseTimer(0.f),
     currentPhase(1),
-    shootTimer1(0.f), shootTimer2(0.f), shootTimer3(0.f),
     shootCooldown(1.5f) // Base cooldown
 {
     type = Type::Boss;
@@ -33,7 +40,7 @@ void Boss::settings(Animation &a, sf::Vector2f startPos, float startAngle, float
         actualAnim = Animation(ResourceManager::getInstance().getTexture("boss1.png"), 0, 0, 230, 336, 1, 0, false); // Static image
         actualRadius = 100.f; // Adjust collision radius if needed
     } catch (const std::runtime_error& e) {
-        std::cerr << "Error setting Boss animation: " << e.what() << std::endl;
+        LOG_ERROR(LogCategory::Boss, "Error setting Boss animation: %s", e.what());
         actualAnim = a;
         actualRadius = radius;
     }
@@ -42,9 +49,6 @@ void Boss::settings(Animation &a, sf::Vector2f startPos, float startAngle, float
     health = maxHealth; // Reset health on setting
     currentPhase = 1;
     phaseTimer = 0.f;
-    shootTimer1 = shootCooldown; // Initial delay before firing
-    shootTimer2 = shootCooldown * 1.2f;
-    shootTimer3 = shootCooldown * 1.4f;
     name = "boss1";
     type = Type::Boss;
 }
@@ -53,10 +57,7 @@ void Boss::update(float dt, const sf::Vector2u& windowSize) {
     if (!life) return;
 
     updatePhase(dt);
-    updateMovement(dt, windowSize);
-    updateShooting(dt); // Game class will actually spawn bullets based on boss state
-
-    anim.update(dt); // Update animation (might be static)
+    updateMovement(dt, windowSize); // Guns are timers in Game, firing patternFor() each time
 }
 
 void Boss::updatePhase(float dt) {
@@ -66,7 +67,7 @@ void Boss::updatePhase(float dt) {
         currentPhase = 2;
         phaseTimer = 0.f;
         shootCooldown = 1.0f; // Faster shooting in phase 2
-        std::cout << "Boss entering Phase 2!" << std::endl;
+        LOG_INFO(LogCategory::Boss, "Boss entering Phase 2!");
     }
      // Add more phase logic
 }
@@ -95,39 +96,19 @@ void Boss::updateMovement(float dt, const sf::Vector2u& windowSize) {
     // angle = 5.f * std::sin(phaseTimer * 1.5f);
 }
 
-void Boss::updateShooting(float dt) {
-     // Decrement timers (Game class checks these timers to spawn bullets)
-     if (shootTimer1 > 0) shootTimer1 -= dt;
-     if (shootTimer2 > 0) shootTimer2 -= dt;
-     if (shootTimer3 > 0) shootTimer3 -= dt;
-
-     // Logic based on phase
-     if (currentPhase == 1) {
-         phase1Logic(dt);
-     } else if (currentPhase == 2) {
-          phase2Logic(dt);
-     }
-}
-
-void Boss::phase1Logic(float dt) {
-    // Example: Fire from middle gun periodically
-     // Timers decremented in updateShooting. Game::spawnBossBullet handles spawning.
+BulletPatterns::PatternId Boss::patternFor(int firePointIndex) const {
+    int phase = std::max(1, std::min(2, currentPhase)) - 1;
+    return BOSS_PATTERNS[phase][std::max(0, std::min(2, firePointIndex))];
 }
 
-void Boss::phase2Logic(float dt) {
-     // Example: Fire from all guns more frequently
-     // Timers decremented in updateShooting. Game::spawnBossBullet handles spawning.
-}
-
-
 void Boss::takeDamage(int amount) {
     if (!life) return;
     health -= amount;
-    std::cout << "Boss health: " << health << "/" << maxHealth << std::endl;
+    LOG_DEBUG(LogCategory::Boss, "Boss health: %d/%d", health, maxHealth);
     if (health <= 0) {
         health = 0;
-        life = false; // Boss defeated
-        std::cout << "Boss defeated!" << std::endl;
+        kill(); // Boss defeated
+        LOG_INFO(LogCategory::Boss, "Boss defeated!");
         // TODO: Trigger boss explosion sequence in Game class
     }
     // TODO: Add hit flash effect?
@@ -150,4 +131,27 @@ sf::Vector2f Boss::getAbsoluteFirePos(const sf::Vector2f& relativePos) {
     // Rotate the relative point and add to boss's position
     return pos + sf::Vector2f(relativePos.x * cosA - relativePos.y * sinA,
                               relativePos.x * sinA + relativePos.y * cosA);
-}
\ No newline at end of file
+}
+
+sf::Vector2f Boss::getGunPos(int firePointIndex) {
+    switch (firePointIndex) {
+        case 0: return getAbsoluteFirePos(firePoint1);
+        case 1: return getAbsoluteFirePos(firePoint2);
+        default: return getAbsoluteFirePos(firePoint3);
+    }
+}
+
+float Boss::firstShotDelay(int firePointIndex) const {
+    switch (firePointIndex) {
+        case 0: return shootCooldown;
+        case 1: return shootCooldown * 1.2f;
+        default: return shootCooldown * 1.4f;
+    }
+}
+
+void Boss::hashState(WorldChecksum& sum) const {
+    Entity::hashState(sum);
+    sum.add(health);
+    sum.add(currentPhase);
+    sum.add(phaseTimer);
+}
@@ -2,6 +2,7 @@
 #define BOSS_H
 
 #include "Entity.h"
+#include "BulletPatterns.h"
 #include <vector> // For fire points
 
 class Boss : public Entity {
@@ -10,8 +11,7 @@ public:
     int maxHealth;
     float phaseTimer;
     int currentPhase;
-    float shootTimer1, shootTimer2, shootTimer3; // Timers for different guns
-    float shootCooldown;
+    float shootCooldown; // Gun timers live in Game's timer wheel
 
     // Relative positions for firing points
     sf::Vector2f firePoint1, firePoint2, firePoint3;
@@ -20,18 +20,20 @@ public:
 
     void settings(Animation &a, sf::Vector2f startPos, float startAngle = 0.f, float radius = 100.f) override;
     void update(float dt, const sf::Vector2u& windowSize) override;
+    sf::Vector2f step(float dt) const override { return velocity * dt; } // Boss velocity is px per second
     void takeDamage(int amount);
     void onCollision(Entity* other) override;
+    void hashState(WorldChecksum& sum) const override;
 
     // Function to get absolute fire point positions
     sf::Vector2f getAbsoluteFirePos(const sf::Vector2f& relativePos);
+    sf::Vector2f getGunPos(int firePointIndex); // World position of fire point 0-2
+    BulletPatterns::PatternId patternFor(int firePointIndex) const; // What that gun plays in the current phase
+    float firstShotDelay(int firePointIndex) const; // Delay before a gun's first shot after spawning
 
 private:
     void updatePhase(float dt);
     void updateMovement(float dt, const sf::Vector2u& windowSize);
-    void updateShooting(float dt);
-    void phase1Logic(float dt);
-    void phase2Logic(float dt); // Add more phases if needed
 };
 
 #endif // BOSS_H
\ No newline at end of file
@@ -1,37 +1,39 @@
 #include "Bullet.h"
+#include "Logger.h"
 #include "ResourceManager.h"
 #include <cmath>
-#include <iostream>
 
 const float BULLET_DEGTORAD = 0.017453f;
 
 Bullet::Bullet(BulletType type) :
     speed(10.0f),
     lifetime(1.5f),
-    lifeTimer(0.f),
     bulletType(type),
-    damage(1) // Default damage
+    damage(1), // Default damage
+    targetPoint(-1)
 {
     this->type = Type::Bullet;
-    name = "bullet_"; // Base name
-
     switch (bulletType) {
         case BulletType::Standard:
-            name += "standard";
+            name = "bullet_standard";
             speed = 10.0f; damage = 1;
             break;
         case BulletType::Laser:
-            name += "laser";
-            speed = 18.0f; lifetime = 0.8f; damage = 1; // Laser: fast, short life?
+            name = "bullet_laser";
+            speed = 18.0f; lifetime = 0.8f; damage = 1; // The player's laser is a beam (Game::fireBeam); this is for old snapshots
             break;
         case BulletType::Spread:
-             name += "spread";
+             name = "bullet_spread";
              speed = 8.0f; lifetime = 1.0f; damage = 1;
              break;
         case BulletType::Red: // Added Red bullet type
-             name += "red";
+             name = "bullet_red";
              speed = 12.0f; damage = 2; // Faster and more damage?
              break;
+        case BulletType::Homing:
+             name = "bullet_homing";
+             speed = 7.0f; lifetime = 3.0f; damage = 2; // Slow, but it gets there
+             break;
     }
 }
 
@@ -41,7 +43,7 @@ void Bullet::settings(Animation &a, sf::Vector2f startPos, float startAngle, flo
     float animSpeed = 0.8f; // Default speed
 
      try {
-         std::string textureFile;
+         const char* textureFile = "fire_blue.png";
          int frameW = 32, frameH = 64, frameCount = 16; // Defaults for blue/red
          switch(bulletType) {
             case BulletType::Standard:
@@ -61,11 +63,15 @@ void Bullet::settings(Animation &a, sf::Vector2f startPos, float startAngle, flo
                   textureFile = "fire_red.png"; // Use the red texture
                   actualRadius = 5.f; animSpeed = 0.9f; // Slightly faster anim?
                   break;
+             case BulletType::Homing:
+                  textureFile = "fire_blue.png";
+                  actualRadius = 5.f; animSpeed = 0.6f;
+                  break;
          }
          actualAnim = Animation(ResourceManager::getInstance().getTexture(textureFile), 0, 0, frameW, frameH, frameCount, animSpeed, false); // Non-looping
 
      } catch (const std::runtime_error& e) {
-        std::cerr << "Error setting bullet animation (" << name << "): " << e.what() << std::endl;
+        LOG_ERROR(LogCategory::Entity, "Error setting bullet animation (%s): %s", name, e.what());
         actualAnim = a; // Fallback
         actualRadius = radius;
      }
@@ -76,24 +82,27 @@ void Bullet::settings(Animation &a, sf::Vector2f startPos, float startAngle, flo
     velocity.x = std::sin(angleRad) * speed;      // Thành phần X theo sin
     velocity.y = -std::cos(angleRad) * speed;     // Thành phần Y theo -cos (vì Y hướng xuống)
 
-    lifeTimer = 0;
-    life = true;
+    lastPos = pos;
+    revive();
     // Name and type already set in constructor
 }
 
 void Bullet::update(float dt, const sf::Vector2u& windowSize) {
     if (!life) return;
 
+    lastPos = pos;
     pos += velocity * dt * 60.f;
-    lifeTimer += dt;
-
-    if (lifeTimer >= lifetime) {
-        life = false;
-        return;
-    }
      if (pos.x < -R || pos.x > windowSize.x + R || pos.y < -R || pos.y > windowSize.y + R) {
-        life = false;
-        return;
+        kill();
      }
-    anim.update(dt);
-}
\ No newline at end of file
+}
+
+void Bullet::hashState(WorldChecksum& sum) const {
+    Entity::hashState(sum);
+    sum.add(static_cast<std::int32_t>(bulletType));
+    sum.add(damage);
+    if (bulletType == BulletType::Homing) {
+        sum.add(target.index);
+        sum.add(static_cast<std::int32_t>(targetPoint));
+    }
+}
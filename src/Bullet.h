@@ -5,18 +5,24 @@
 
 class Bullet : public Entity {
 public:
-    enum class BulletType { Standard, Laser, Spread, Red }; // Added Red type
+    enum class BulletType { Standard, Laser, Spread, Red, Homing }; // Added Red type
 
     float speed;
-    float lifetime;
-    float lifeTimer;
+    float lifetime; // Seconds; expiry is a timer registered at spawn
     BulletType bulletType;
     int damage; // How much damage this bullet does
+    sf::Vector2f lastPos; // Where the last update started: hits are swept from here to pos
+
+    // Homing: what the missile is steering for, re-picked every tick by Game::guideMissiles
+    EntityHandle target;
+    int targetPoint; // -1 = the target's centre, 0-2 = a boss fire point
 
     Bullet(BulletType type = BulletType::Standard);
 
     void settings(Animation &a, sf::Vector2f startPos, float startAngle = 0.f, float radius = 5.f) override;
     void update(float dt, const sf::Vector2u& windowSize) override;
+    std::uint64_t lifetimeTicks() const override { return secondsToTicks(lifetime); }
+    void hashState(WorldChecksum& sum) const override;
 };
 
 #endif // BULLET_H
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "BulletPatterns.h"
+#include <cmath>
+
+namespace {
+    const float DEG_TO_RAD = 0.017453293f;
+    const float RAD_TO_DEG = 57.29578f;
+
+    typedef BulletPatterns::Shape Shape;
+    const BulletPatterns::Pattern PATTERNS[BulletPatterns::PATTERN_COUNT] = {
+        // shape,            shots, volleys, interval, spread, turn,  speed
+        { Shape::AimedFan,   7,     6,       8,        50.f,   0.f,   4.0f }, // AimedFan
+        { Shape::Ring,       24,    4,       12,       0.f,    7.5f,  3.0f }, // RingBurst
+        { Shape::Ring,       72,    12,      8,        0.f,    2.5f,  2.0f }, // DenseRing
+        { Shape::Spiral,     10,    150,     2,        0.f,    7.f,   2.2f }, // Spiral
+        { Shape::Curtain,    60,    24,      6,        1150.f, 0.f,   1.8f }, // Curtain
+    };
+}
+
+const float BulletPatterns::SHOT_RADIUS = 4.f;
+
+const BulletPatterns::Pattern& BulletPatterns::pattern(PatternId id) {
+    return PATTERNS[id < PATTERN_COUNT ? id : 0];
+}
+
+std::uint32_t BulletPatterns::durationTicks(PatternId id) {
+    const Pattern& p = pattern(id);
+    return static_cast<std::uint32_t>(p.volleys - 1) * p.interval;
+}
+
+BulletPatterns::BulletPatterns() :
+    minX(0.f), minY(0.f), maxX(0.f), maxY(0.f), capacity(0), emitterCapacity(0), dropped(0) {}
+
+void BulletPatterns::configure(float width, float height, float margin) {
+    minX = -margin;
+    minY = -margin;
+    maxX = width + margin;
+    maxY = height + margin;
+}
+
+void BulletPatterns::reserve(std::size_t shots, std::size_t emitterCount) {
+    capacity = shots;
+    emitterCapacity = emitterCount;
+    for (std::vector<float>* column : { &originX, &originY, &velX, &velY, &headings, &posX, &posY }) column->reserve(shots);
+    born.reserve(shots);
+    emitters.reserve(emitterCount);
+}
+
+void BulletPatterns::clear() {
+    for (std::vector<float>* column : { &originX, &originY, &velX, &velY, &headings, &posX, &posY }) column->clear();
+    born.clear();
+    emitters.clear();
+}
+
+void BulletPatterns::start(PatternId id, SlotHandle source, int gun, float aimDegrees) {
+    if (emitters.size() >= emitterCapacity) return;
+    Emitter e;
+    e.pattern = id < PATTERN_COUNT ? id : AimedFan;
+    e.source = source;
+    e.gun = static_cast<std::uint8_t>(gun);
+    e.volleysLeft = pattern(e.pattern).volleys;
+    e.wait = 0; // First volley on the next update
+    e.aim = aimDegrees;
+    emitters.push_back(e);
+}
+
+void BulletPatterns::restoreEmitter(const Emitter& emitter) {
+    if (emitters.size() < emitterCapacity && emitter.volleysLeft > 0) emitters.push_back(emitter);
+}
+
+void BulletPatterns::fireVolley(Emitter& e, sf::Vector2f from, sf::Vector2f target, std::uint64_t tick) {
+    const Pattern& p = pattern(e.pattern);
+    int volley = p.volleys - e.volleysLeft;
+    float toTarget = std::atan2(target.y - from.y, target.x - from.x) * RAD_TO_DEG;
+
+    switch (p.shape) {
+        case Shape::Ring:
+        case Shape::Spiral: {
+            float first = p.shape == Shape::Ring ? toTarget + (volley % 2 ? p.turn : 0.f) : e.aim;
+            float step = 360.f / p.shots;
+            for (int k = 0; k < p.shots; ++k) fire(from, first + k * step, p.speed, tick);
+            if (p.shape == Shape::Spiral) e.aim = std::fmod(e.aim + p.turn, 360.f);
+            break;
+        }
+        case Shape::AimedFan: {
+            float step = p.shots > 1 ? p.spread / (p.shots - 1) : 0.f;
+            float first = toTarget - (p.shots > 1 ? p.spread / 2.f : 0.f);
+            for (int k = 0; k < p.shots; ++k) fire(from, first + k * step, p.speed, tick);
+            break;
+        }
+        case Shape::Curtain: {
+            float gap = p.spread / p.shots;
+            float left = from.x - p.spread / 2.f + (volley % 2 ? gap : gap / 2.f);
+            for (int k = 0; k < p.shots; ++k) fire(sf::Vector2f(left + k * gap, from.y), 90.f, p.speed, tick);
+            break;
+        }
+    }
+}
+
+void BulletPatterns::fire(sf::Vector2f from, float degrees, float speed, std::uint64_t tick) {
+    spawn(from, sf::Vector2f(std::cos(degrees * DEG_TO_RAD) * speed, std::sin(degrees * DEG_TO_RAD) * speed), tick, tick);
+}
+
+void BulletPatterns::spawn(sf::Vector2f from, sf::Vector2f velocity, std::uint64_t bornTick, std::uint64_t tick) {
+    if (originX.size() >= capacity) {
+        ++dropped;
+        return;
+    }
+    float age = static_cast<float>(tick - bornTick);
+    originX.push_back(from.x);
+    originY.push_back(from.y);
+    velX.push_back(velocity.x);
+    velY.push_back(velocity.y);
+    headings.push_back(std::atan2(velocity.y, velocity.x) * RAD_TO_DEG + 90.f);
+    born.push_back(bornTick);
+    posX.push_back(from.x + velocity.x * age);
+    posY.push_back(from.y + velocity.y * age);
+}
+
+// Positions from scratch and the out-of-bounds sweep in one pass, compacting as it goes
+void BulletPatterns::advance(std::uint64_t tick) {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < originX.size(); ++i) {
+        float age = static_cast<float>(tick - born[i]);
+        float x = originX[i] + velX[i] * age;
+        float y = originY[i] + velY[i] * age;
+        if (x < minX || x > maxX || y < minY || y > maxY) continue;
+        if (kept != i) {
+            originX[kept] = originX[i];
+            originY[kept] = originY[i];
+            velX[kept] = velX[i];
+            velY[kept] = velY[i];
+            headings[kept] = headings[i];
+            born[kept] = born[i];
+        }
+        posX[kept] = x;
+        posY[kept] = y;
+        ++kept;
+    }
+    for (std::vector<float>* column : { &originX, &originY, &velX, &velY, &headings, &posX, &posY }) column->resize(kept);
+    born.resize(kept);
+}
+
+std::size_t BulletPatterns::removeTouching(sf::Vector2f center, float radius) {
+    float reach = radius + SHOT_RADIUS;
+    float reachSq = reach * reach;
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < originX.size(); ++i) {
+        float dx = posX[i] - center.x, dy = posY[i] - center.y;
+        if (dx * dx + dy * dy < reachSq) continue;
+        if (kept != i) {
+            originX[kept] = originX[i];
+            originY[kept] = originY[i];
+            velX[kept] = velX[i];
+            velY[kept] = velY[i];
+            headings[kept] = headings[i];
+            born[kept] = born[i];
+            posX[kept] = posX[i];
+            posY[kept] = posY[i];
+        }
+        ++kept;
+    }
+    std::size_t removed = originX.size() - kept;
+    for (std::vector<float>* column : { &originX, &originY, &velX, &velY, &headings, &posX, &posY }) column->resize(kept);
+    born.resize(kept);
+    return removed;
+}
+
+// Positions and headings are derived, so only the inputs are hashed
+void BulletPatterns::hashState(WorldChecksum& sum) const {
+    sum.add(static_cast<std::uint64_t>(originX.size()));
+    for (std::size_t i = 0; i < originX.size(); ++i) {
+        sum.add(originX[i]);
+        sum.add(originY[i]);
+        sum.add(velX[i]);
+        sum.add(velY[i]);
+        sum.add(born[i]);
+    }
+    sum.add(static_cast<std::uint64_t>(emitters.size()));
+    for (const Emitter& e : emitters) {
+        sum.add(static_cast<std::uint32_t>(e.pattern));
+        sum.add(e.source.index);
+        sum.add(static_cast<std::uint32_t>(e.gun));
+        sum.add(static_cast<std::uint32_t>(e.volleysLeft));
+        sum.add(static_cast<std::uint32_t>(e.wait));
+        sum.add(e.aim);
+    }
+}
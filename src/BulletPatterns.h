@@ -0,0 +1,125 @@
+#ifndef BULLETPATTERNS_H
+#define BULLETPATTERNS_H
+
+#include "SlotMap.h"
+#include "WorldChecksum.h"
+#include <SFML/System.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Enemy bullet-hell shots. Boss guns start emitters, each playing one pattern from a small data
+// table (rings, spirals, aimed fans, curtains) volley by volley. Shots are not entities: they live
+// in flat arrays and fly in straight lines, so a shot is just its origin, velocity and spawn tick
+// and every position is recomputed from those in one pass per tick. Removal compacts the arrays
+// in place, keeping the survivors in order (snapshots delta code against that order).
+//
+// Directions are degrees with 0 along +x and 90 straight down the screen.
+class BulletPatterns {
+public:
+    enum class Shape : std::uint8_t {
+        Ring,     // 'shots' evenly around the circle, first one at the target; odd volleys turned by 'turn'
+        Spiral,   // Like Ring, but every volley turns 'turn' further than the last
+        AimedFan, // 'shots' across 'spread' degrees, centred on the target each volley
+        Curtain   // 'shots' in a row 'spread' px wide, falling straight down; odd volleys shifted half a gap
+    };
+
+    enum PatternId : std::uint8_t { AimedFan, RingBurst, DenseRing, Spiral, Curtain, PATTERN_COUNT };
+
+    struct Pattern {
+        Shape shape;
+        std::uint8_t shots;    // Per volley
+        std::uint8_t volleys;
+        std::uint8_t interval; // Ticks between volleys
+        float spread;          // Degrees (AimedFan) or px (Curtain)
+        float turn;            // Degrees (Ring, Spiral)
+        float speed;           // px per tick
+    };
+
+    struct Emitter {
+        PatternId pattern;
+        SlotHandle source;     // The entity whose gun fires; the emitter stops once it is gone
+        std::uint8_t gun;
+        std::uint8_t volleysLeft;
+        std::uint8_t wait;     // Ticks until the next volley
+        float aim;             // Degrees; Spiral turns it each volley
+    };
+
+    static const float SHOT_RADIUS;
+
+    static const Pattern& pattern(PatternId id);
+    static std::uint32_t durationTicks(PatternId id); // First volley to last
+
+    BulletPatterns();
+
+    void configure(float width, float height, float margin); // Shots this far outside the area are dropped
+    void reserve(std::size_t shots, std::size_t emitters);   // Hard caps: shots past capacity are not fired
+    void clear();
+
+    void start(PatternId id, SlotHandle source, int gun, float aimDegrees);
+
+    // One tick: due volleys fire, then every shot moves. muzzle(source, gun, pos) stores where a
+    // gun is and returns false once its source is gone. 'target' is what aimed patterns aim at.
+    template <typename MuzzleFn>
+    void update(std::uint64_t tick, sf::Vector2f target, MuzzleFn&& muzzle) {
+        for (std::size_t i = 0; i < emitters.size();) {
+            Emitter& e = emitters[i];
+            sf::Vector2f from;
+            if (!muzzle(e.source, e.gun, from)) {
+                emitters.erase(emitters.begin() + static_cast<std::ptrdiff_t>(i));
+                continue;
+            }
+            if (e.wait > 0) {
+                --e.wait;
+                ++i;
+                continue;
+            }
+            fireVolley(e, from, target, tick);
+            if (--e.volleysLeft == 0) {
+                emitters.erase(emitters.begin() + static_cast<std::ptrdiff_t>(i));
+                continue;
+            }
+            e.wait = static_cast<std::uint8_t>(pattern(e.pattern).interval - 1);
+            ++i;
+        }
+        advance(tick);
+    }
+
+    // Removes every shot touching the circle; returns how many there were
+    std::size_t removeTouching(sf::Vector2f center, float radius);
+
+    void hashState(WorldChecksum& sum) const;
+
+    // Shots, for drawing and snapshots
+    std::size_t size() const { return originX.size(); }
+    sf::Vector2f position(std::size_t i) const { return sf::Vector2f(posX[i], posY[i]); }
+    sf::Vector2f origin(std::size_t i) const { return sf::Vector2f(originX[i], originY[i]); }
+    sf::Vector2f velocity(std::size_t i) const { return sf::Vector2f(velX[i], velY[i]); }
+    float heading(std::size_t i) const { return headings[i]; } // Sprite rotation (the art points up)
+    std::uint64_t bornAt(std::size_t i) const { return born[i]; }
+    std::uint64_t droppedCount() const { return dropped; }
+
+    // Restoring a snapshot: shots and emitters as they were saved
+    void spawn(sf::Vector2f from, sf::Vector2f velocity, std::uint64_t bornTick, std::uint64_t tick);
+    void restoreEmitter(const Emitter& emitter);
+    const std::vector<Emitter>& activeEmitters() const { return emitters; }
+
+private:
+    void fireVolley(Emitter& e, sf::Vector2f from, sf::Vector2f target, std::uint64_t tick);
+    void fire(sf::Vector2f from, float degrees, float speed, std::uint64_t tick);
+    void advance(std::uint64_t tick);
+
+    float minX, minY, maxX, maxY;
+    std::size_t capacity;
+    std::size_t emitterCapacity;
+    std::uint64_t dropped; // Shots not fired because the arrays were full
+
+    // One entry per shot in each array
+    std::vector<float> originX, originY, velX, velY, headings;
+    std::vector<std::uint64_t> born;
+    std::vector<float> posX, posY; // Derived each tick from the above
+
+    std::vector<Emitter> emitters;
+};
+
+#endif // BULLETPATTERNS_H
@@ -0,0 +1,150 @@
+#include "CollisionMask.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const float DEG_TO_RAD = 0.017453293f;
+
+    // 64 pixels of a packed row starting at pixel 'start' (may be negative); pixels off the row are clear
+    std::uint64_t slice(const std::uint64_t* row, int words, int start) {
+        if (start <= -64 || start >= words * 64) return 0;
+        if (start < 0) return row[0] << -start;
+        int word = start / 64, shift = start % 64;
+        std::uint64_t bits = row[word] >> shift;
+        if (shift && word + 1 < words) bits |= row[word + 1] << (64 - shift);
+        return bits;
+    }
+
+    // Packs a byte-per-pixel coverage grid, trimmed to the rectangle around its set pixels
+    CollisionMask pack(const std::vector<std::uint8_t>& coverage, int width, int height, int originX, int originY) {
+        int minX = width, minY = height, maxX = -1, maxY = -1;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                if (!coverage[static_cast<std::size_t>(y) * width + x]) continue;
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+            }
+        }
+        CollisionMask mask;
+        if (maxX < 0) return mask; // Fully transparent: never touches anything
+
+        mask.width = maxX - minX + 1;
+        mask.height = maxY - minY + 1;
+        mask.words = (mask.width + 63) / 64;
+        mask.originX = originX - minX;
+        mask.originY = originY - minY;
+        mask.bits.assign(static_cast<std::size_t>(mask.words) * mask.height, 0);
+        for (int y = 0; y < mask.height; ++y) {
+            std::uint64_t* row = &mask.bits[static_cast<std::size_t>(y) * mask.words];
+            for (int x = 0; x < mask.width; ++x) {
+                if (coverage[static_cast<std::size_t>(y + minY) * width + x + minX]) row[x / 64] |= std::uint64_t(1) << (x % 64);
+            }
+        }
+        return mask;
+    }
+}
+
+CollisionMask::CollisionMask() : width(0), height(0), words(0), originX(0), originY(0) {}
+
+CollisionMask CollisionMask::disc(float radius) {
+    int half = static_cast<int>(std::ceil(radius));
+    int size = 2 * half;
+    std::vector<std::uint8_t> coverage(static_cast<std::size_t>(size) * size, 0);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            float dx = x + 0.5f - half, dy = y + 0.5f - half;
+            coverage[static_cast<std::size_t>(y) * size + x] = dx * dx + dy * dy <= radius * radius;
+        }
+    }
+    return pack(coverage, size, size, half, half);
+}
+
+bool CollisionMask::overlaps(const CollisionMask& other, int dx, int dy) const {
+    // Where the other mask's top-left pixel lands in ours
+    int left = originX + dx - other.originX;
+    int top = originY + dy - other.originY;
+    int y0 = std::max(0, top), y1 = std::min(height, top + other.height);
+    int x0 = std::max(0, left), x1 = std::min(width, left + other.width);
+    if (y0 >= y1 || x0 >= x1) return false;
+
+    int firstWord = x0 / 64, lastWord = (x1 - 1) / 64;
+    for (int y = y0; y < y1; ++y) {
+        const std::uint64_t* mine = &bits[static_cast<std::size_t>(y) * words];
+        const std::uint64_t* theirs = &other.bits[static_cast<std::size_t>(y - top) * other.words];
+        for (int w = firstWord; w <= lastWord; ++w) {
+            if (mine[w] & slice(theirs, other.words, w * 64 - left)) return true;
+        }
+    }
+    return false;
+}
+
+CollisionMaskSet::CollisionMaskSet() : source(nullptr), reach(0.f) {}
+
+void CollisionMaskSet::add(const sf::Image& image, const Animation& clip, int rotations) {
+    source = clip.sprite.getTexture();
+    rotations = std::max(1, rotations);
+    sf::Vector2f scale = clip.sprite.getScale();
+    for (int i = 0; i < clip.frameCount; ++i) {
+        Frame frame;
+        frame.rect = clip.frameRect(i);
+        frame.first = masks.size();
+        frame.rotations = rotations;
+        frames.push_back(frame);
+        for (int r = 0; r < rotations; ++r) {
+            masks.push_back(rasterize(image, frame.rect, scale, 360.f * r / rotations));
+            const CollisionMask& mask = masks.back();
+            // Corners of the set rectangle bound every set pixel
+            float farX = static_cast<float>(std::max(mask.originX, mask.width - mask.originX));
+            float farY = static_cast<float>(std::max(mask.originY, mask.height - mask.originY));
+            if (mask.width > 0) reach = std::max(reach, std::sqrt(farX * farX + farY * farY));
+        }
+    }
+}
+
+std::size_t CollisionMaskSet::byteSize() const {
+    std::size_t bytes = 0;
+    for (const CollisionMask& mask : masks) bytes += mask.bits.size() * sizeof(std::uint64_t);
+    return bytes;
+}
+
+const CollisionMask* CollisionMaskSet::find(const sf::IntRect& rect, float angle) const {
+    for (const Frame& frame : frames) {
+        if (frame.rect != rect) continue;
+        float step = 360.f / frame.rotations;
+        int r = static_cast<int>(std::floor(angle / step + 0.5f)) % frame.rotations;
+        if (r < 0) r += frame.rotations;
+        return &masks[frame.first + static_cast<std::size_t>(r)];
+    }
+    return nullptr;
+}
+
+// Each screen pixel around the origin is mapped back through the sprite's rotation and scale and
+// takes the alpha of the texel under its centre (what the sprite draws there, unsmoothed).
+CollisionMask CollisionMaskSet::rasterize(const sf::Image& image, const sf::IntRect& rect, sf::Vector2f scale, float angle) {
+    float c = std::cos(angle * DEG_TO_RAD), s = std::sin(angle * DEG_TO_RAD);
+    float halfW = rect.width * std::fabs(scale.x) / 2.f, halfH = rect.height * std::fabs(scale.y) / 2.f;
+    int originX = static_cast<int>(std::ceil(std::fabs(c) * halfW + std::fabs(s) * halfH));
+    int originY = static_cast<int>(std::ceil(std::fabs(s) * halfW + std::fabs(c) * halfH));
+    int width = 2 * originX, height = 2 * originY;
+
+    sf::Vector2u imageSize = image.getSize();
+    const sf::Uint8* pixels = image.getPixelsPtr();
+    std::vector<std::uint8_t> coverage(static_cast<std::size_t>(width) * height, 0);
+    if (!pixels || scale.x == 0.f || scale.y == 0.f) return pack(coverage, width, height, originX, originY);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float wx = x + 0.5f - originX, wy = y + 0.5f - originY;
+            float u = (c * wx + s * wy) / scale.x + rect.width / 2.f;   // Undo the rotation, then the scale
+            float v = (-s * wx + c * wy) / scale.y + rect.height / 2.f;
+            if (u < 0.f || v < 0.f || u >= rect.width || v >= rect.height) continue;
+            int tx = rect.left + static_cast<int>(u), ty = rect.top + static_cast<int>(v);
+            if (tx < 0 || ty < 0 || tx >= static_cast<int>(imageSize.x) || ty >= static_cast<int>(imageSize.y)) continue;
+            std::uint8_t alpha = pixels[(static_cast<std::size_t>(ty) * imageSize.x + tx) * 4 + 3];
+            coverage[static_cast<std::size_t>(y) * width + x] = alpha >= ALPHA_THRESHOLD;
+        }
+    }
+    return pack(coverage, width, height, originX, originY);
+}
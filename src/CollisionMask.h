@@ -0,0 +1,62 @@
+#ifndef COLLISIONMASK_H
+#define COLLISIONMASK_H
+
+#include "Animation.h"
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Pixel-accurate hit shape: one sprite frame as it is drawn (scaled, rotated about the frame
+// centre), one bit per screen pixel, set where the texture is opaque. Rows are packed into 64-bit
+// words, so two masks are compared 64 pixels at a time with a shift and an AND.
+struct CollisionMask {
+    int width, height;
+    int words;            // 64-bit words per row
+    int originX, originY; // The pixel the entity's position falls in
+    std::vector<std::uint64_t> bits; // Row after row; pixel x of a row is bit x % 64 of word x / 64
+
+    CollisionMask();
+
+    static CollisionMask disc(float radius);
+
+    // True if a set pixel of 'other', with its origin (dx, dy) px from ours, lands on one of ours
+    bool overlaps(const CollisionMask& other, int dx, int dy) const;
+};
+
+// Every frame of one texture's clips, pre-rotated to a fixed number of evenly spaced angles. All
+// masks are built at load time (texture read back once); lookups only index into the set.
+class CollisionMaskSet {
+public:
+    static const std::uint8_t ALPHA_THRESHOLD = 128;
+
+    CollisionMaskSet();
+
+    // Adds every frame of 'clip' at its sprite's scale. 'image' is the clip's texture read back;
+    // rotations = 1 for sprites that never turn. Clips added to one set share its texture.
+    void add(const sf::Image& image, const Animation& clip, int rotations);
+
+    const sf::Texture* texture() const { return source; }
+    float radius() const { return reach; } // Farthest set pixel from the origin (circle early-out)
+    std::size_t maskCount() const { return masks.size(); }
+    std::size_t byteSize() const;
+
+    // The mask for a frame at an angle (degrees, nearest step), or nullptr if the frame is not in the set
+    const CollisionMask* find(const sf::IntRect& frame, float angle) const;
+
+private:
+    struct Frame {
+        sf::IntRect rect;
+        std::size_t first; // Index of its first rotation in 'masks'
+        int rotations;
+    };
+
+    static CollisionMask rasterize(const sf::Image& image, const sf::IntRect& rect, sf::Vector2f scale, float angle);
+
+    const sf::Texture* source;
+    std::vector<Frame> frames;
+    std::vector<CollisionMask> masks;
+    float reach;
+};
+
+#endif // COLLISIONMASK_H
@@ -0,0 +1,252 @@
+#include "DroneSwarm.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const float RAD_TO_DEG = 57.29578f;
+    const float NEIGHBOR_RADIUS = 48.f;   // Flockmates seen (also the grid cell)
+    const float SEPARATION_RADIUS = 22.f; // Closer than this pushes apart
+    const float SEPARATION_WEIGHT = 1.5f; // On the sum of offset / distance^2
+    const float ALIGNMENT_WEIGHT = 0.08f; // On the difference to the neighbours' mean velocity
+    const float COHESION_WEIGHT = 0.004f; // On the offset to the neighbours' centre
+    const float PURSUIT_WEIGHT = 0.06f;   // On the difference to full speed towards the target
+    const float MAX_FORCE = 0.15f;        // px per tick per tick
+    const float WRAP_MARGIN = 16.f;       // Drones leave this far past an edge before wrapping
+}
+
+const float DroneSwarm::RADIUS = 9.f;
+const float DroneSwarm::MAX_SPEED = 3.5f;
+
+DroneSwarm::DroneSwarm() : width(0.f), height(0.f), capacity(0), lastStats(), gridStale(true) {}
+
+void DroneSwarm::configure(float areaWidth, float areaHeight) {
+    width = areaWidth;
+    height = areaHeight;
+    grid.configure(areaWidth, areaHeight, NEIGHBOR_RADIUS);
+    gridStale = true;
+}
+
+void DroneSwarm::reserve(std::size_t drones) {
+    capacity = drones;
+    for (std::vector<float>* column : { &posX, &posY, &velX, &velY, &sepX, &sepY, &alignX, &alignY, &cohX, &cohY }) column->reserve(drones);
+    born.reserve(drones);
+    dead.reserve(drones);
+    neighbors.reserve(drones);
+    grid.reserve(drones);
+}
+
+void DroneSwarm::clear() {
+    for (std::vector<float>* column : { &posX, &posY, &velX, &velY }) column->clear();
+    born.clear();
+    dead.clear();
+    gridStale = true;
+}
+
+void DroneSwarm::spawn(sf::Vector2f pos, sf::Vector2f velocity, std::uint64_t bornTick) {
+    if (posX.size() >= capacity) {
+        ++lastStats.dropped;
+        return;
+    }
+    posX.push_back(pos.x);
+    posY.push_back(pos.y);
+    velX.push_back(velocity.x);
+    velY.push_back(velocity.y);
+    born.push_back(bornTick);
+    dead.push_back(0);
+    gridStale = true;
+}
+
+void DroneSwarm::update(sf::Vector2f target, bool hasTarget) {
+    compact();
+    if (posX.empty()) return;
+    if (gridStale) buildGrid();
+    gather();
+    steer(target, hasTarget);
+    buildGrid();
+}
+
+void DroneSwarm::buildGrid() {
+    grid.clear();
+    for (std::size_t i = 0; i < posX.size(); ++i) grid.add(static_cast<std::uint32_t>(i), sf::Vector2f(posX[i], posY[i]), RADIUS);
+    grid.build();
+    gridStale = false;
+}
+
+// Neighbour sums, from positions and velocities as they were at the start of the tick
+void DroneSwarm::gather() {
+    std::size_t count = posX.size();
+    for (std::vector<float>* column : { &sepX, &sepY, &alignX, &alignY, &cohX, &cohY }) column->assign(count, 0.f);
+    neighbors.assign(count, 0);
+    const float reachSq = NEIGHBOR_RADIUS * NEIGHBOR_RADIUS;
+    const float separationSq = SEPARATION_RADIUS * SEPARATION_RADIUS;
+    std::uint64_t tests = 0;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        float px = posX[i], py = posY[i];
+        float sx = 0.f, sy = 0.f, ax = 0.f, ay = 0.f, cx = 0.f, cy = 0.f;
+        int seen = 0;
+        grid.queryWhile(sf::Vector2f(px, py), NEIGHBOR_RADIUS, [&](std::uint32_t j) {
+            if (j == i) return true;
+            ++tests;
+            float dx = posX[j] - px, dy = posY[j] - py;
+            float distanceSq = dx * dx + dy * dy;
+            if (distanceSq >= reachSq) return true;
+            ax += velX[j];
+            ay += velY[j];
+            cx += dx;
+            cy += dy;
+            if (distanceSq < separationSq && distanceSq > 1e-4f) {
+                sx -= dx / distanceSq;
+                sy -= dy / distanceSq;
+            }
+            return ++seen < MAX_NEIGHBORS;
+        });
+        if (seen == 0) continue;
+        float inverse = 1.f / seen;
+        sepX[i] = sx;
+        sepY[i] = sy;
+        alignX[i] = ax * inverse;
+        alignY[i] = ay * inverse;
+        cohX[i] = cx * inverse;
+        cohY[i] = cy * inverse;
+        neighbors[i] = static_cast<std::uint8_t>(seen);
+    }
+    lastStats.neighborTests = tests;
+}
+
+// The steering kernel: straight loops over the arrays, no lookups
+void DroneSwarm::steer(sf::Vector2f target, bool hasTarget) {
+    std::size_t count = posX.size();
+    float pursuit = hasTarget ? PURSUIT_WEIGHT : 0.f;
+    for (std::size_t i = 0; i < count; ++i) {
+        float vx = velX[i], vy = velY[i];
+        float has = neighbors[i] ? 1.f : 0.f;
+        float fx = SEPARATION_WEIGHT * sepX[i] + has * (ALIGNMENT_WEIGHT * (alignX[i] - vx) + COHESION_WEIGHT * cohX[i]);
+        float fy = SEPARATION_WEIGHT * sepY[i] + has * (ALIGNMENT_WEIGHT * (alignY[i] - vy) + COHESION_WEIGHT * cohY[i]);
+
+        float tx = target.x - posX[i], ty = target.y - posY[i];
+        float toTarget = std::sqrt(tx * tx + ty * ty);
+        float scale = toTarget > 1e-3f ? MAX_SPEED / toTarget : 0.f;
+        fx += pursuit * (tx * scale - vx);
+        fy += pursuit * (ty * scale - vy);
+
+        float force = std::sqrt(fx * fx + fy * fy);
+        if (force > MAX_FORCE) {
+            fx *= MAX_FORCE / force;
+            fy *= MAX_FORCE / force;
+        }
+        vx += fx;
+        vy += fy;
+        float speed = std::sqrt(vx * vx + vy * vy);
+        if (speed > MAX_SPEED) {
+            vx *= MAX_SPEED / speed;
+            vy *= MAX_SPEED / speed;
+        }
+        velX[i] = vx;
+        velY[i] = vy;
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        float x = posX[i] + velX[i], y = posY[i] + velY[i];
+        if (x < -WRAP_MARGIN) x = width + WRAP_MARGIN;
+        else if (x > width + WRAP_MARGIN) x = -WRAP_MARGIN;
+        if (y < -WRAP_MARGIN) y = height + WRAP_MARGIN;
+        else if (y > height + WRAP_MARGIN) y = -WRAP_MARGIN;
+        posX[i] = x;
+        posY[i] = y;
+    }
+}
+
+std::size_t DroneSwarm::removeTouching(sf::Vector2f center, float radius) {
+    if (gridStale) buildGrid();
+    float reach = radius + RADIUS;
+    std::size_t removed = 0;
+    grid.query(center, radius, [&](std::uint32_t i) {
+        if (dead[i]) return;
+        float dx = posX[i] - center.x, dy = posY[i] - center.y;
+        if (dx * dx + dy * dy >= reach * reach) return;
+        dead[i] = 1;
+        ++removed;
+    });
+    return removed;
+}
+
+float DroneSwarm::segmentHit(std::size_t i, sf::Vector2f from, sf::Vector2f d, float lengthSq, float reachSq) const {
+    float ox = posX[i] - from.x, oy = posY[i] - from.y;
+    float t = lengthSq > 0.f ? std::max(0.f, std::min(1.f, (ox * d.x + oy * d.y) / lengthSq)) : 0.f;
+    float ex = ox - d.x * t, ey = oy - d.y * t;
+    return ex * ex + ey * ey < reachSq ? t : -1.f;
+}
+
+std::size_t DroneSwarm::removeAlongSegment(sf::Vector2f from, sf::Vector2f to, float radius) {
+    if (gridStale) buildGrid();
+    sf::Vector2f d = to - from;
+    float lengthSq = d.x * d.x + d.y * d.y;
+    float reach = radius + RADIUS;
+    std::size_t removed = 0;
+    grid.querySegment(from, to, radius, [&](std::uint32_t i) {
+        if (dead[i] || segmentHit(i, from, d, lengthSq, reach * reach) < 0.f) return;
+        dead[i] = 1;
+        ++removed;
+    });
+    return removed;
+}
+
+bool DroneSwarm::removeFirstAlong(sf::Vector2f from, sf::Vector2f to, float radius, sf::Vector2f& at) {
+    if (gridStale) buildGrid();
+    sf::Vector2f d = to - from;
+    float lengthSq = d.x * d.x + d.y * d.y;
+    float reach = radius + RADIUS;
+    float firstT = 2.f;
+    std::uint32_t first = 0;
+    grid.querySegment(from, to, radius, [&](std::uint32_t i) {
+        if (dead[i]) return;
+        float t = segmentHit(i, from, d, lengthSq, reach * reach);
+        if (t < 0.f) return;
+        if (t < firstT || (t == firstT && i < first)) {
+            firstT = t;
+            first = i;
+        }
+    });
+    if (firstT > 1.f) return false;
+    dead[first] = 1;
+    at = sf::Vector2f(posX[first], posY[first]);
+    return true;
+}
+
+void DroneSwarm::compact() {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < posX.size(); ++i) {
+        if (dead[i]) continue;
+        if (kept != i) {
+            posX[kept] = posX[i];
+            posY[kept] = posY[i];
+            velX[kept] = velX[i];
+            velY[kept] = velY[i];
+            born[kept] = born[i];
+            dead[kept] = 0;
+        }
+        ++kept;
+    }
+    if (kept == posX.size()) return;
+    for (std::vector<float>* column : { &posX, &posY, &velX, &velY }) column->resize(kept);
+    born.resize(kept);
+    dead.resize(kept);
+    gridStale = true;
+}
+
+float DroneSwarm::heading(std::size_t i) const {
+    return std::atan2(velY[i], velX[i]) * RAD_TO_DEG + 90.f;
+}
+
+void DroneSwarm::hashState(WorldChecksum& sum) const {
+    sum.add(static_cast<std::uint64_t>(posX.size()));
+    for (std::size_t i = 0; i < posX.size(); ++i) {
+        sum.add(posX[i]);
+        sum.add(posY[i]);
+        sum.add(velX[i]);
+        sum.add(velY[i]);
+        sum.add(born[i]);
+        sum.add(dead[i] != 0);
+    }
+}
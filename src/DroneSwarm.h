@@ -0,0 +1,87 @@
+#ifndef DRONESWARM_H
+#define DRONESWARM_H
+
+#include "SpatialGrid.h"
+#include "WorldChecksum.h"
+#include <SFML/System.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hunter drones: small ships that flock (separation, alignment, cohesion) while chasing the
+// player. Like enemy shots they are not entities but flat arrays, one per field, so hundreds to
+// thousands of them cost a few linear passes per tick:
+//   1. gather - each drone sums what it needs from its neighbours, found on a uniform grid
+//      (cell = neighbour radius, so 3x3 cells) and capped at MAX_NEIGHBORS in grid order;
+//   2. steer  - one branch-light loop over the arrays turns the sums and the pursuit into a
+//      clamped acceleration, then moves and wraps every drone;
+//   3. the grid is rebuilt on the new positions for this tick's hit tests.
+// Every drone reads only the previous positions in step 1, so the result does not depend on the
+// order drones are visited in. Removal only marks drones; compact() drops them, keeping the
+// survivors in order.
+//
+// Velocities are in px per tick. Nothing is allocated once reserve() has sized the arrays;
+// drones past the capacity are not spawned (and counted).
+class DroneSwarm {
+public:
+    static const float RADIUS;          // Hit circle
+    static const float MAX_SPEED;       // px per tick
+    static const int MAX_NEIGHBORS = 12;
+
+    struct Stats {
+        std::uint64_t neighborTests; // Neighbour candidates looked at in the last update
+        std::uint64_t dropped;       // Drones not spawned because the arrays were full (all time)
+    };
+
+    DroneSwarm();
+
+    void configure(float width, float height); // The area drones fly and wrap around in
+    void reserve(std::size_t drones);          // Hard cap
+    void clear();
+
+    void spawn(sf::Vector2f pos, sf::Vector2f velocity, std::uint64_t bornTick);
+
+    // One tick of steering and movement. Drones hunt 'target' when hasTarget, otherwise they only flock.
+    void update(sf::Vector2f target, bool hasTarget);
+
+    // Hit tests against the positions after the last update. Hit drones are marked, not removed,
+    // until compact(); marked drones are never hit twice.
+    std::size_t removeTouching(sf::Vector2f center, float radius); // Every drone touching the circle
+    std::size_t removeAlongSegment(sf::Vector2f from, sf::Vector2f to, float radius); // ... the capsule
+    // The drone the capsule from-to meets first (nearest to 'from', ties by index); false if none
+    bool removeFirstAlong(sf::Vector2f from, sf::Vector2f to, float radius, sf::Vector2f& at);
+    void compact();
+
+    void hashState(WorldChecksum& sum) const;
+
+    // Drones, for drawing and snapshots (marked ones included until compact())
+    std::size_t size() const { return posX.size(); }
+    bool isDead(std::size_t i) const { return dead[i] != 0; }
+    sf::Vector2f position(std::size_t i) const { return sf::Vector2f(posX[i], posY[i]); }
+    sf::Vector2f velocity(std::size_t i) const { return sf::Vector2f(velX[i], velY[i]); }
+    float heading(std::size_t i) const; // Sprite rotation (the art points up)
+    std::uint64_t bornAt(std::size_t i) const { return born[i]; }
+    const Stats& stats() const { return lastStats; }
+
+private:
+    void buildGrid();
+    void gather();
+    void steer(sf::Vector2f target, bool hasTarget);
+    float segmentHit(std::size_t i, sf::Vector2f from, sf::Vector2f d, float lengthSq, float reachSq) const; // Param along from-to, or -1
+
+    float width, height;
+    std::size_t capacity;
+    Stats lastStats;
+    SpatialGrid grid;
+    bool gridStale; // Indices changed since the grid was built (spawns, compaction)
+
+    // One entry per drone in each array
+    std::vector<float> posX, posY, velX, velY;
+    std::vector<std::uint64_t> born;
+    std::vector<std::uint8_t> dead;
+    // Neighbour sums from the gather pass (scratch, same indexing)
+    std::vector<float> sepX, sepY, alignX, alignY, cohX, cohY;
+    std::vector<std::uint8_t> neighbors;
+};
+
+#endif // DRONESWARM_H
@@ -1,8 +1,10 @@
 #include "Entity.h"
+#include "EntityRegistry.h"
+#include "QualityController.h"
 
 const float DEGTORAD = 0.017453f;
 
-Entity::Entity() : R(1.f), angle(0.f), life(true), type(Type::Generic) {
+Entity::Entity() : R(1.f), angle(0.f), life(true), name("entity"), type(Type::Generic), spawnTick(0), registry(nullptr), masks(nullptr) {
     // Default velocity and position are (0,0)
 }
 
@@ -12,14 +14,25 @@ void Entity::settings(Animation &a, sf::Vector2f startPos, float startAngle, flo
     pos = startPos;
     angle = startAngle;
     R = radius;
-    life = true; // Ensure entity starts alive
-    anim.reset(); // Reset animation state
-    anim.play();
+    revive(); // Ensure entity starts alive
 }
 
-void Entity::draw(sf::RenderTarget &target) {
+void Entity::kill() {
+    if (!life) return;
+    life = false;
+    if (registry) registry->died(type);
+}
+
+void Entity::revive() {
+    if (life) return;
+    life = true;
+    if (registry) registry->revived(type);
+}
+
+void Entity::draw(sf::RenderTarget &target, std::uint64_t tick) {
     if (!life) return; // Don't draw dead entities
 
+    anim.apply(tick - spawnTick, QualityController::getInstance().settings().animationStep);
     anim.sprite.setPosition(pos);
     anim.sprite.setRotation(angle); // Offset often needed depending on sprite orientation
     target.draw(anim.sprite);
@@ -34,5 +47,14 @@ void Entity::draw(sf::RenderTarget &target) {
     */
 }
 
+void Entity::hashState(WorldChecksum& sum) const {
+    sum.add(static_cast<std::int32_t>(type));
+    sum.add(life);
+    sum.add(pos.x); sum.add(pos.y);
+    sum.add(velocity.x); sum.add(velocity.y);
+    sum.add(R);
+    sum.add(angle);
+}
+
 // update method is pure virtual, no implementation here.
 // Subclasses MUST implement it.
\ No newline at end of file
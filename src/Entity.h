@@ -2,14 +2,29 @@
 #define ENTITY_H
 
 #include "Animation.h"
+#include "CollisionMask.h"
+#include "EntityPool.h"
+#include "SlotMap.h"
+#include "WorldChecksum.h"
 #include <SFML/Graphics.hpp>
-#include <string>
 
 class Game;
+class EntityRegistry;
+
+typedef SlotHandle EntityHandle; // Stable reference to an entity owned by Game's slot map
+
+const int TICK_RATE = 60; // Simulation ticks per second (Game runs a fixed 1/60 s step)
+
+// Whole ticks for a duration in seconds (at least one tick for any positive duration)
+inline std::uint64_t secondsToTicks(float seconds) {
+    if (seconds <= 0.f) return 0;
+    std::uint64_t ticks = static_cast<std::uint64_t>(seconds * TICK_RATE + 0.5f);
+    return ticks > 0 ? ticks : 1;
+}
 
 class Entity {
 public:
-    // Expanded types
+    // Expanded types. Effect is retired (explosions are particles now) but keeps its slot: the values are in snapshots
     enum class Type { Generic, Player, Asteroid, Bullet, PowerUp, PowerDown, Effect, Boss, HazardMeteor };
 
     sf::Vector2f pos;
@@ -17,17 +32,34 @@ public:
     float R;
     float angle;
     bool life;
-    std::string name;
+    const char* name; // Static string, never owned (no allocation per entity)
     Animation anim;
     Type type;
+    EntityHandle handle;      // This entity's own handle (set when added to the world)
+    std::uint64_t spawnTick;  // Simulation tick the entity entered the world (animation time base)
+    EntityRegistry* registry; // Live counts to keep current (set while the entity is in the world)
+    const CollisionMaskSet* masks; // Pixel hit shapes for its texture (set by Game; nullptr = the circle R)
 
     Entity();
     virtual ~Entity() = default;
 
+    // All entities live in EntityPool blocks (the virtual destructor passes the real size)
+    static void* operator new(std::size_t size) { return EntityPool::allocate(size); }
+    static void operator delete(void* p, std::size_t size) { EntityPool::deallocate(p, size); }
+
+    // Life changes go through these once an entity is in the world, so the registry's live counts
+    // stay exact. Both are no-ops if the entity is already in that state.
+    void kill();
+    void revive();
+
     virtual void settings(Animation &a, sf::Vector2f startPos, float startAngle = 0.f, float radius = 1.f);
     virtual void update(float dt, const sf::Vector2u& windowSize) = 0;
-    virtual void draw(sf::RenderTarget &target);
+    virtual void draw(sf::RenderTarget &target, std::uint64_t tick); // Samples the animation at 'tick'
+    virtual std::uint64_t lifetimeTicks() const { return 0; } // Fixed lifetime from spawn, 0 = none (expired by a timer)
+    float hitRadius() const { return masks ? masks->radius() : R; } // Circle around everything it can touch
+    virtual sf::Vector2f step(float dt) const { return velocity * dt * 60.f; } // How far update(dt) moves it (for swept tests)
     virtual void onCollision(Entity* other) {};
+    virtual void hashState(WorldChecksum& sum) const; // Gameplay fields for the per-tick checksum (subclasses add theirs)
 };
 
 #endif // ENTITY_H
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "EntityPool.h"
+#include <algorithm>
+#include <new>
+
+thread_local EntityPool::FreeBlock* EntityPool::freeLists[EntityPool::CLASS_COUNT] = {};
+thread_local EntityPool::Arena* EntityPool::bound = nullptr;
+
+EntityPool::Arena::~Arena() {
+    for (void* chunk : chunks) ::operator delete(chunk, std::align_val_t(BLOCK_ALIGN));
+}
+
+void EntityPool::grow(std::size_t cls, std::size_t blocks) {
+    std::size_t blockSize = (cls + 1) * BLOCK_ALIGN;
+    char* chunk = static_cast<char*>(::operator new(blockSize * blocks, std::align_val_t(BLOCK_ALIGN)));
+    if (bound) bound->chunks.push_back(chunk);
+    FreeBlock** heads = lists();
+    for (std::size_t i = 0; i < blocks; ++i) {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+        block->next = heads[cls];
+        heads[cls] = block;
+    }
+}
+
+void* EntityPool::allocate(std::size_t size) {
+    if (size == 0 || size > MAX_POOLED_SIZE) return ::operator new(size);
+    std::size_t cls = sizeClass(size);
+    FreeBlock** heads = lists();
+    if (!heads[cls]) grow(cls, std::max<std::size_t>(1, CHUNK_BYTES / ((cls + 1) * BLOCK_ALIGN)));
+    FreeBlock* block = heads[cls];
+    heads[cls] = block->next;
+    return block;
+}
+
+void EntityPool::deallocate(void* p, std::size_t size) {
+    if (!p) return;
+    if (size == 0 || size > MAX_POOLED_SIZE) { ::operator delete(p); return; }
+    std::size_t cls = sizeClass(size);
+    FreeBlock** heads = lists();
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    block->next = heads[cls];
+    heads[cls] = block;
+}
+
+void EntityPool::reserve(std::size_t size, std::size_t count) {
+    if (size == 0 || size > MAX_POOLED_SIZE) return;
+    std::size_t cls = sizeClass(size);
+    std::size_t available = 0;
+    for (FreeBlock* b = lists()[cls]; b && available < count; b = b->next) ++available;
+    if (available < count) grow(cls, count - available);
+}
@@ -0,0 +1,61 @@
+#ifndef ENTITYPOOL_H
+#define ENTITYPOOL_H
+
+#include <cstddef>
+#include <vector>
+
+// Block pool backing Entity::operator new/delete.
+// Blocks are carved from large chunks and recycled through per-size-class free lists,
+// so spawning/destroying entities during play does not touch the global heap once warm.
+// Free lists are per thread; chunks are never returned, so the footprint is the peak entity count.
+// A world stepped by different threads in turn (the session server's) would scatter its blocks
+// over their lists instead, so it keeps its own Arena and binds it while it creates or destroys
+// entities; the arena's footprint is that world's peak, and it is freed with the world.
+class EntityPool {
+    static const std::size_t BLOCK_ALIGN = 64;
+    static const std::size_t MAX_POOLED_SIZE = 4096;
+    static const std::size_t CLASS_COUNT = MAX_POOLED_SIZE / BLOCK_ALIGN;
+    static const std::size_t CHUNK_BYTES = 16384; // Per grow (at least one block): one player is not 128 players
+
+    struct FreeBlock { FreeBlock* next; };
+
+public:
+    class Arena {
+    public:
+        Arena() {}
+        ~Arena(); // Every block must be back by now
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+    private:
+        friend class EntityPool;
+        FreeBlock* freeLists[CLASS_COUNT] = {};
+        std::vector<void*> chunks;
+    };
+
+    // Routes this thread's allocations to 'arena' for its lifetime (nullptr: leaves them as they are)
+    class Binding {
+    public:
+        explicit Binding(Arena* arena) : previous(bound) { if (arena) bound = arena; }
+        ~Binding() { bound = previous; }
+        Binding(const Binding&) = delete;
+        Binding& operator=(const Binding&) = delete;
+    private:
+        Arena* previous;
+    };
+
+    static void* allocate(std::size_t size);
+    static void deallocate(void* p, std::size_t size);
+
+    // Pre-allocates 'count' blocks able to hold objects of 'size' bytes
+    static void reserve(std::size_t size, std::size_t count);
+
+private:
+    static std::size_t sizeClass(std::size_t size) { return (size + BLOCK_ALIGN - 1) / BLOCK_ALIGN - 1; }
+    static FreeBlock** lists() { return bound ? bound->freeLists : freeLists; }
+    static void grow(std::size_t cls, std::size_t blocks);
+
+    static thread_local FreeBlock* freeLists[CLASS_COUNT];
+    static thread_local Arena* bound;
+};
+
+#endif // ENTITYPOOL_H
@@ -0,0 +1,56 @@
+#include "EntityRegistry.h"
+
+EntityRegistry::EntityRegistry() : live() {}
+
+void EntityRegistry::reserve(std::size_t entities) {
+    for (std::vector<EntityHandle>& list : lists) list.reserve(entities);
+    listPosition.reserve(entities);
+}
+
+void EntityRegistry::add(Entity& entity) {
+    std::vector<EntityHandle>& list = lists[index(entity.type)];
+    if (entity.handle.index >= listPosition.size()) listPosition.resize(entity.handle.index + 1);
+    listPosition[entity.handle.index] = static_cast<std::uint32_t>(list.size());
+    list.push_back(entity.handle);
+    if (entity.life) ++live[index(entity.type)];
+    entity.registry = this;
+}
+
+void EntityRegistry::remove(Entity& entity) {
+    std::vector<EntityHandle>& list = lists[index(entity.type)];
+    std::uint32_t position = listPosition[entity.handle.index];
+    EntityHandle moved = list.back();
+    list[position] = moved;
+    listPosition[moved.index] = position;
+    list.pop_back();
+    if (entity.life) --live[index(entity.type)];
+    entity.registry = nullptr;
+}
+
+void EntityRegistry::clear() {
+    for (int t = 0; t < TYPE_COUNT; ++t) {
+        lists[t].clear();
+        live[t] = 0;
+    }
+}
+
+int EntityRegistry::liveTotal() const {
+    int total = 0;
+    for (int count : live) total += count;
+    return total;
+}
+
+const char* EntityRegistry::typeName(Entity::Type type) {
+    switch (type) {
+        case Entity::Type::Generic:      return "generic";
+        case Entity::Type::Player:       return "player";
+        case Entity::Type::Asteroid:     return "asteroid";
+        case Entity::Type::Bullet:       return "bullet";
+        case Entity::Type::PowerUp:      return "power-up";
+        case Entity::Type::PowerDown:    return "power-down";
+        case Entity::Type::Effect:       return "effect";
+        case Entity::Type::Boss:         return "boss";
+        case Entity::Type::HazardMeteor: return "meteor";
+    }
+    return "?";
+}
@@ -0,0 +1,42 @@
+#ifndef ENTITYREGISTRY_H
+#define ENTITYREGISTRY_H
+
+#include "Entity.h"
+#include <cstdint>
+#include <vector>
+
+// Per-type bookkeeping for the entities in Game's slot map, kept up to date as they come and go
+// instead of rediscovered by scanning: live counts change on add, kill, revive and removal, and
+// each type keeps a list of its handles (swap-removed, so order is not stable). The lists hold
+// every stored entity of the type, including dead ones still waiting for cleanup.
+class EntityRegistry {
+public:
+    static const int TYPE_COUNT = static_cast<int>(Entity::Type::HazardMeteor) + 1;
+
+    EntityRegistry();
+
+    void reserve(std::size_t entities); // Handle slots; each type list gets room for all of them
+
+    void add(Entity& entity);    // After insertion (the entity's handle is set); links it back here
+    void remove(Entity& entity); // Before removal
+    void clear();                // The slot map was cleared
+
+    void died(Entity::Type type) { --live[index(type)]; }    // Entity::kill
+    void revived(Entity::Type type) { ++live[index(type)]; } // Entity::revive
+
+    int liveCount(Entity::Type type) const { return live[index(type)]; }
+    int liveTotal() const;
+    std::size_t storedCount(Entity::Type type) const { return lists[index(type)].size(); }
+    const std::vector<EntityHandle>& handles(Entity::Type type) const { return lists[index(type)]; }
+
+    static const char* typeName(Entity::Type type);
+
+private:
+    static int index(Entity::Type type) { return static_cast<int>(type); }
+
+    int live[TYPE_COUNT];
+    std::vector<EntityHandle> lists[TYPE_COUNT];
+    std::vector<std::uint32_t> listPosition; // Slot index -> position in its type's list
+};
+
+#endif // ENTITYREGISTRY_H
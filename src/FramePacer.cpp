@@ -0,0 +1,109 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+    const double MAX_DISPLAY_HZ = 360.0;
+}
+
+FramePacer::FramePacer() :
+    currentMode(Mode::VSync),
+    hz(60),
+    interval(std::chrono::microseconds(16667)),
+    started(false),
+    spinWindow(std::chrono::milliseconds(2)),
+    calibrationCount(0),
+    dropMs(1500.0 / 60)
+{
+    resetStats();
+}
+
+void FramePacer::setMode(Mode mode, int targetHz) {
+    currentMode = mode;
+    hz = targetHz > 0 ? targetHz : 60;
+    interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+    started = false;
+    calibrationCount = 0;
+    dropMs = 1500.0 / hz;
+}
+
+const char* FramePacer::modeName(Mode mode) {
+    switch (mode) {
+        case Mode::VSync: return "vsync";
+        case Mode::Limiter: return "limiter";
+        case Mode::Uncapped: return "uncapped";
+    }
+    return "?";
+}
+
+void FramePacer::waitUntil(Clock::time_point target) {
+    // Coarse sleeps while the deadline is far, then spin; the window widens when a sleep overshoots
+    while (true) {
+        Clock::time_point now = Clock::now();
+        if (now >= target) return;
+        if (target - now <= spinWindow) break;
+        Clock::time_point wake = target - spinWindow;
+        std::this_thread::sleep_until(wake);
+        Clock::duration overshoot = Clock::now() - wake;
+        if (overshoot > spinWindow / 2) spinWindow = std::min<Clock::duration>(spinWindow * 2, std::chrono::milliseconds(8));
+        else if (overshoot < spinWindow / 8) spinWindow = std::max<Clock::duration>(spinWindow - std::chrono::microseconds(50), std::chrono::microseconds(500));
+    }
+    while (Clock::now() < target) std::this_thread::yield();
+}
+
+void FramePacer::endFrame() {
+    if (currentMode == Mode::Limiter) {
+        if (!started) deadline = Clock::now() + interval;
+        waitUntil(deadline);
+        // Fixed deadlines keep the average rate exact; after a long stall, start over instead of bursting
+        deadline += interval;
+        Clock::time_point now = Clock::now();
+        if (now > deadline) deadline = now + interval;
+    }
+
+    Clock::time_point now = Clock::now();
+    if (!started) {
+        started = true;
+        lastFrame = now;
+        return;
+    }
+    double ms = std::chrono::duration<double, std::milli>(now - lastFrame).count();
+    lastFrame = now;
+
+    frameTimes.add(ms);
+    if (currentMode != Mode::VSync || calibrationCount == CALIBRATION_FRAMES) {
+        if (ms > dropMs) ++dropped;
+        return;
+    }
+
+    // Until the refresh interval is known, keep the frame; then judge the kept ones against it too
+    calibration[calibrationCount++] = ms;
+    if (calibrationCount < CALIBRATION_FRAMES) return;
+    double sorted[CALIBRATION_FRAMES];
+    std::copy(calibration, calibration + CALIBRATION_FRAMES, sorted);
+    std::nth_element(sorted, sorted + CALIBRATION_FRAMES / 2, sorted + CALIBRATION_FRAMES);
+    // A driver that ignores vsync presents far faster than any display: keep a floor (360 Hz)
+    double refreshMs = std::max(sorted[CALIBRATION_FRAMES / 2], 1000.0 / MAX_DISPLAY_HZ);
+    dropMs = 1.5 * refreshMs;
+    for (double frame : calibration) {
+        if (frame > dropMs) ++dropped;
+    }
+}
+
+void FramePacer::resetStats() {
+    frameTimes.reset();
+    dropped = 0;
+}
+
+FramePacer::Report FramePacer::report() const {
+    Report r;
+    r.frames = frameTimes.count();
+    r.p50 = frameTimes.percentile(0.50);
+    r.p95 = frameTimes.percentile(0.95);
+    r.p99 = frameTimes.percentile(0.99);
+    r.max = frameTimes.max();
+    r.mean = frameTimes.mean();
+    r.dropped = dropped;
+    r.displayHz = 1500.0 / dropMs;
+    return r;
+}
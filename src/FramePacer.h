@@ -0,0 +1,65 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include "Histogram.h"
+#include <chrono>
+#include <cstdint>
+
+// Decides when a frame may start and keeps statistics of the frame-to-frame times.
+//   VSync:    display() blocks on the monitor refresh; nothing is added here. The refresh interval
+//             is measured (median of the first frames), since the display may run at 120 or 144 Hz
+//   Limiter:  waits for a fixed deadline per frame, sleeping while far from it and spinning the
+//             last stretch (OS sleeps overshoot by up to a scheduler quantum)
+//   Uncapped: no waiting at all, for benchmarks
+// Statistics go into a fixed histogram (no allocation), so they can run in every build.
+class FramePacer {
+public:
+    enum class Mode { VSync, Limiter, Uncapped };
+
+    struct Report {
+        std::uint64_t frames;
+        double p50, p95, p99, max; // Milliseconds
+        double mean;
+        std::uint64_t dropped;     // Frames longer than 1.5 display intervals
+        double displayHz;          // Rate those are judged against: measured (vsync), else targetHz
+    };
+
+    FramePacer();
+
+    // targetHz is the limiter rate, and the rate dropped frames are judged against until vsync has
+    // measured the display's
+    void setMode(Mode mode, int targetHz);
+    Mode mode() const { return currentMode; }
+    int targetHz() const { return hz; }
+    static const char* modeName(Mode mode);
+
+    // Call once per frame after presenting it: waits (Limiter) and records the frame time
+    void endFrame();
+
+    Report report() const;
+    void resetStats();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void waitUntil(Clock::time_point deadline);
+
+    Mode currentMode;
+    int hz;
+    Clock::duration interval;
+    Clock::time_point deadline;
+    Clock::time_point lastFrame;
+    bool started;
+    Clock::duration spinWindow;             // Sleep no closer to the deadline than this (adapts to oversleep)
+
+    Histogram frameTimes;
+    std::uint64_t dropped;
+
+    // VSync: present intervals kept until there are enough to take the refresh interval from
+    static const int CALIBRATION_FRAMES = 120;
+    double calibration[CALIBRATION_FRAMES];
+    int calibrationCount;
+    double dropMs;                          // Frames longer than this count as dropped
+};
+
+#endif // FRAMEPACER_H
@@ -1,82 +1,295 @@
 #include "Game.h"
 #include "ResourceManager.h"
+#include "Random.h"
 #include "Animation.h"
 #include "Asteroid.h"
 #include "Bullet.h"
 #include "PowerUp.h"
 #include "HazardMeteor.h"
-#include "Effect.h"
 #include "Boss.h"
+#include "Logger.h"
+#include "AllocTracker.h"
+#include "EntityPool.h"
+#include "QualityController.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
-#include <iostream>
+#include <ctime>
 #include <string>
 #include <fstream> // Required for file I/O
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
 #include <limits>  // Required for numeric_limits (though not used directly now)
 
 // --- Constants ---
 const int WINDOW_WIDTH = 1200;
 const int WINDOW_HEIGHT = 800;
+const sf::Vector2u FIELD_SIZE(WINDOW_WIDTH, WINDOW_HEIGHT); // The simulated play field, whatever the window does
 const float ASTEROID_SPAWN_RATE_BASE = 3.5f;
 const float POWERUP_SPAWN_RATE_BASE = 12.0f;
 const float HAZARD_METEOR_SPAWN_RATE = 15.0f;
 const float PLAYER_RESPAWN_DELAY = 3.0f;
 const float STORY_DISPLAY_DURATION = 4.0f;
+const float LEVEL_TRANSITION_DURATION = 2.0f;
 const int BOSS_LEVEL_INTERVAL = 3;
 const std::string HIGHSCORE_FILE = "highscore.dat";
+const std::string SNAPSHOT_FILE = "suspend.snap"; // F5 saves, F9 loads
+const int REWIND_SECONDS = 10;               // History kept for rewinding (if the memory budget allows)
+const int REWIND_KEYFRAME_INTERVAL = 30;     // Ticks per full frame; the rest are deltas (bounds seek cost)
+const double REWIND_CAPTURE_BUDGET = 0.05;   // Capture may take at most this fraction of a tick
+const int INPUT_SAMPLE_RATE = 1000;          // Keyboard polls per second on the input thread
+const float TICK_DT = 1.f / 60.f;      // Fixed simulation step
+const float MAX_FRAME_TIME = 0.1f;     // Frame time clamp (at most 6 ticks of catch-up per frame)
+const double TICK_WORK_BUDGET = 4096.0;      // Entity visits per tick before housekeeping is deferred
+const int CLEANUP_MAX_DELAY = 8;             // Ticks dead entities may linger before removal is forced
+const int LEVEL_CHECK_MAX_DELAY = 15;        // Ticks a level-complete check may wait
+const double FRAME_HOUSEKEEPING_SHARE = 0.5; // HUD rebuilds only while the frame's work is under this share
+const int HUD_MAX_DELAY = 4;                 // Frames the HUD may lag behind the game
+const int MAX_LIVE_ASTEROIDS = 256;          // Timed spawns pause at these live counts (splits still happen)
+const int MAX_LIVE_METEORS = 32;
+const int MAX_LIVE_POWERUPS = 4;
+const float COLLISION_CELL_SIZE = 32.f;      // Broadphase grid cell edge
+const int ROCK_MASK_ROTATIONS = 32;          // Pre-rotated collision masks per rock/meteor frame
+const int SHIP_MASK_ROTATIONS = 64;          // The ship turns smoothly, so finer steps
+const int DISC_MASK_MAX_RADIUS = 32;         // Unmasked entities up to this radius get a pixel disc
+const float ROCK_CELL_SIZE = 50.f;           // Rock solver grid: the largest rock's diameter
+const std::size_t ROCK_CONTACTS_PER_BODY = 4; // Contact capacity per reserved body
+const float METEOR_MASS = 3.5f;              // Like a medium rock
+const float ROCK_MAX_COVER = 1.f;            // Rock area per screen area past which contacts are skipped
+const int SWARM_MIN_TARGET = 1000;            // --swarm is clamped to this range
+const int SWARM_MAX_TARGET = 50000;
+const float SWARM_WAVE_INTERVAL = 0.25f;      // Seconds between Swarm top-ups
+const int SWARM_RAMP_SECONDS = 20;            // Time to reach the target from an empty field
+const int SWARM_METEOR_SHARE = 20;            // One hazard meteor per this many asteroids
+const int SWARM_OVERLAY_INTERVAL = 15;        // Frames between overlay text rebuilds
+const std::size_t ENTITY_RESERVE = 1024;     // Entity vector capacity, grown only past this
+const std::size_t ENEMY_SHOT_CAPACITY = 8192; // Boss shots in flight; volleys past this are cut short
+const std::size_t SHOT_EMITTER_CAPACITY = 16; // Boss patterns playing at once
+const float ENEMY_SHOT_MARGIN = 32.f;         // Shots are dropped this far off screen
+const float PLAYER_SHOT_HITBOX = 0.4f;        // Share of the player's radius enemy shots must reach
+const float SHOT_HIT_CLEAR_RADIUS = 150.f;    // Shots around the player vanish when one hits
+const float BEAM_LENGTH = 1500.f;             // Laser reach (past the far corner of the screen)
+const float BEAM_RADIUS = 4.f;                // Half the beam's width
+const int BEAM_PIERCE = 3;                    // Rocks a beam goes through before it stops
+const int BEAM_DAMAGE = 1;                    // Against the boss, which stops the beam
+const int BEAM_TRACE_TICKS = 6;               // How long a beam stays on screen
+const std::size_t BEAM_RESERVE = 16;          // Beams per tick / traces on screen
+const float MISSILE_RANGE = 700.f;            // How far a homing missile looks for targets
+const float MISSILE_CONE_COS = 0.5f;          // Targets within 60 degrees of its heading
+const float MISSILE_TURN = 5.f;               // Degrees a missile can turn per tick
+const float BOMB_RADIUS = 260.f;              // Smart bomb blast
+const int BOMB_WORK_PER_TICK = 256;           // Targets a blast destroys per tick; the rest wait a tick
+const int BOMB_BOSS_DAMAGE = 5;
+const std::size_t DRONE_CAPACITY = 4096;      // Drones alive at once (Swarm reserves more for big targets)
+const float DRONE_SPAWN_RATE = 10.f;          // Seconds between Survival drone packs
+const int DRONE_PACK = 12;
+const int MAX_LIVE_DRONES = 96;               // Survival packs pause at this many
+const float DRONE_PACK_SPREAD = 60.f;         // Along the edge a pack enters from
+const float DRONE_PACK_DEPTH = 12.f;          // Outside it (less than DroneSwarm's wrap margin)
+const float DRONE_SIZE = 26.f;                // On-screen length of a drone
+const int DRONE_SCORE = 15;
+const int SWARM_DRONE_SHARE = 10;             // One hunter drone per this many asteroids in Swarm
+const int GRAVITY_LEVEL_INTERVAL = 3;         // Campaign levels 2, 5, 8... (each one before a boss) have black holes
+const int MAX_WELLS = 3;
+const float WELL_STRENGTH = 600.f;            // G * mass of a black hole, px^3 per tick^2 (2 px/tick orbits 150 px out)
+const float WELL_HORIZON = 18.f;              // What gets this close is swallowed
+const float WELL_PLAYER_REACH = 0.5f;         // Share of the player's radius that must cross the horizon
+const float ROCK_GRAVITY = 3.f;               // G per unit of asteroid mass (Rocks mode: large rocks pull too)
+const float GRAVITY_SOFTENING = 10.f;         // Pulls never grow as if closer than about this (px)
+const float MAX_PULL = 0.6f;                  // px per tick^2, so a near miss cannot fling anything off screen
+const float MAX_GRAVITY_THETA = 1.5f;         // --gravity-theta is clamped to 0..this
+// Black hole spots as shares of the screen, clear of the centre where the player respawns; odd
+// levels mirror them left to right
+const sf::Vector2f WELL_SPOTS[MAX_WELLS] = { {0.28f, 0.3f}, {0.72f, 0.7f}, {0.7f, 0.24f} };
+const std::size_t TIMER_RESERVE = 1024;      // Timer wheel node capacity (about one per live entity)
+const unsigned int ALLOC_WARMUP_FRAMES = 300; // Playing frames ignored by the allocation check after a state change
 
 // --- Constructor ---
-Game::Game() :
-    window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Asteroids Game"),
+Game::Game(const GameOptions& gameOptions) :
     currentState(State::MainMenu), // State được khởi tạo ở đây
     currentMode(PlayMode::Campaign),
     resourceManager(ResourceManager::getInstance()),
-    player(nullptr),
-    currentBoss(nullptr),
     selectedShipType(Player::ShipType::Standard),
     currentLevel(0),
-    asteroidSpawnTimer(ASTEROID_SPAWN_RATE_BASE),
-    powerUpSpawnTimer(POWERUP_SPAWN_RATE_BASE),
-    hazardMeteorSpawnTimer(HAZARD_METEOR_SPAWN_RATE),
-    playerRespawnTimer(0.f),
+    playTick(0),
+    respawnTick(0),
     bossDefeatScoreBonus(1000),
     storyDisplayTimer(0.f),
-    highScore(0)
+    transitionTimer(0.f),
+    highScore(0),
+    simTick(0),
+    tickAccumulator(0.f),
+    options(gameOptions),
+    runSeed(0),
+    fireRequested(false),
+    fireStampNs(0),
+    runTicks(0),
+    replaying(false),
+    replayExpected(0),
+    replayMismatchTick(0),
+    exitCode(0),
+    headlessRng(0),
+    headlessScore(0),
+    inputHeld(),
+    frameStampCount(0),
+    latencyFrames(0),
+    rewindCursor(0),
+    rewound(false),
+    rewindCaptureSeconds(0.0),
+    rewindCaptures(0),
+    tickJobs(JobScheduler::Cost::WorkUnits),
+    frameJobs(JobScheduler::Cost::WallMicros),
+    levelComplete(false),
+    pairTests(0),
+    rockSolveSeconds(0.0),
+    rockSolveMax(0.0),
+    rockSolves(0),
+    rockSkipped(0),
+    rockContactsMax(0),
+    gravitySeconds(0.0),
+    gravityMax(0.0),
+    gravitySolves(0),
+    gravitySourcesMax(0),
+    gravityProbesMax(0),
+    bombHead(0),
+    bombDestroyed(0),
+    bombDepth(0),
+    bombStartTick(0),
+    droneSeconds(0.0),
+    droneMax(0.0),
+    droneUpdates(0),
+    swarmOverlayFrames(0),
+    tickMs(0.0),
+    hudScore(INT_MIN),
+    hudLives(INT_MIN),
+    hudLevel(INT_MIN),
+    hudMode(PlayMode::Campaign),
+    steadyFrames(0),
+    allocFramesChecked(0),
+    allocFramesFailed(0)
 {
-    std::cout << "Game Constructor: Initializing window..." << std::endl; // DEBUG
-    window.setFramerateLimit(60);
-    window.setVerticalSyncEnabled(true);
-    std::cout << "Game Constructor: Calling initialize()..." << std::endl; // DEBUG
+    if (!options.headless) {
+        LOG_DEBUG(LogCategory::Game, "Game Constructor: Initializing window...");
+        window.create(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Asteroids Game");
+        // One pacing mechanism at a time: SFML's own limiter and vsync together fight each other
+        window.setFramerateLimit(0);
+        window.setVerticalSyncEnabled(options.pacing == FramePacer::Mode::VSync);
+        audio = std::make_unique<Audio>();
+    } else {
+        entityArena = std::make_unique<EntityPool::Arena>();
+    }
+    EntityPool::Binding pool(entityArena.get()); // Anything initialize() creates goes to the world's arena
+    pacer.setMode(options.pacing, options.targetHz);
+    options.swarmTarget = std::max(SWARM_MIN_TARGET, std::min(SWARM_MAX_TARGET, options.swarmTarget));
+    // Sessions store theta in thousandths: keep exactly what a replay will read back
+    options.gravityTheta = std::lround(std::max(0.f, std::min(MAX_GRAVITY_THETA, options.gravityTheta)) * 1000.f) / 1000.f;
+    // The quality level is process-wide and follows the frame budget: headless worlds have neither
+    if (!options.headless) QualityController::getInstance().configure(options.qualityLevel, 1.0 / pacer.targetHz());
+    // A headless replay or world never pauses, so it keeps no history
+    bool pauses = options.replayPath.empty() && !options.headless;
+    rewind.configure(pauses ? options.rewindBudget : 0, TICK_RATE * REWIND_SECONDS, REWIND_KEYFRAME_INTERVAL);
+    if (rewind.enabled()) rewind.reserve(ENTITY_RESERVE, TIMER_RESERVE, ENEMY_SHOT_CAPACITY, DRONE_CAPACITY);
+    cleanupJob = tickJobs.add("cleanup", CLEANUP_MAX_DELAY, [this]() { return cleanupEntities(); });
+    levelCheckJob = tickJobs.add("level-check", LEVEL_CHECK_MAX_DELAY, [this]() {
+        levelComplete = checkLevelComplete();
+        return 1u; // Registry lookups
+    });
+    hudJob = frameJobs.add("hud", HUD_MAX_DELAY, [this]() { updateHud(); return 0u; });
+    LOG_DEBUG(LogCategory::Game, "Game Constructor: Calling initialize()...");
     initialize();
-    std::cout << "Game Constructor: initialize() finished." << std::endl; // DEBUG
+    LOG_DEBUG(LogCategory::Game, "Game Constructor: initialize() finished.");
+
+    if (options.replayPath.empty() && !options.headless) {
+        if (options.inputThread) inputSampler.start(INPUT_SAMPLE_RATE);
+        if (!options.latencyPath.empty()) {
+            latencyLog.open(options.latencyPath);
+            if (!latencyLog) throw std::runtime_error("Could not open latency log " + options.latencyPath);
+            latencyLog << "frame,inputs,min_ms,max_ms\n";
+        }
+    }
 }
 
 // --- Destructor ---
 Game::~Game() {
-    backgroundMusic.stop();
-    bossMusic.stop();
+    stopMusic();
+    EntityPool::Binding pool(entityArena.get());
+    entities.clear(); // While the arena is bound: it goes right after
 }
 
 // --- Initialization ---
 void Game::initialize() {
-    std::cout << "initialize() called." << std::endl; // DEBUG
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-    std::cout << " - Loading resources..." << std::endl; // DEBUG
+    LOG_DEBUG(LogCategory::Game, "initialize() called.");
+    Random::seed(static_cast<std::uint64_t>(std::time(nullptr)));
+    // Pre-size entity storage so spawning during play never reallocates
+    entities.reserve(ENTITY_RESERVE);
+    registry.reserve(ENTITY_RESERVE);
+    collisionGrid.configure(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT), COLLISION_CELL_SIZE);
+    collisionGrid.reserve(ENTITY_RESERVE);
+    rockSolver.configure(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT), ROCK_CELL_SIZE);
+    rockSolver.reserve(ENTITY_RESERVE, ENTITY_RESERVE * ROCK_CONTACTS_PER_BODY);
+    rockSolver.setWorkers(options.rockThreads >= 0 ? options.rockThreads
+                          : static_cast<int>(std::min(3u, std::max(1u, std::thread::hardware_concurrency()) - 1)));
+    rockBodies.reserve(ENTITY_RESERVE);
+    gravity.setAccuracy(options.gravityTheta);
+    gravity.setSoftening(GRAVITY_SOFTENING);
+    gravity.reserve(ENTITY_RESERVE, ENTITY_RESERVE);
+    gravity.setWorkers(options.gravityThreads >= 0 ? options.gravityThreads : rockSolver.workerCount());
+    gravityBodies.reserve(ENTITY_RESERVE);
+    wells.reserve(MAX_WELLS);
+    collisionPairs.reserve(ENTITY_RESERVE);
+    if (!options.headless) rockBatch.reserve(ENTITY_RESERVE);
+    pendingBeams.reserve(BEAM_RESERVE);
+    beamHits.reserve(ENTITY_RESERVE);
+    beamTraces.reserve(BEAM_RESERVE);
+    missileCandidates.reserve(1);
+    bombQueue.reserve(ENTITY_RESERVE);
+    bombSeeds.reserve(ENTITY_RESERVE);
+    enemyShots.configure(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT), ENEMY_SHOT_MARGIN);
+    enemyShots.reserve(ENEMY_SHOT_CAPACITY, SHOT_EMITTER_CAPACITY);
+    if (!options.headless) shotBatch.reserve(ENEMY_SHOT_CAPACITY);
+    drones.configure(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT));
+    drones.reserve(DRONE_CAPACITY);
+    if (!options.headless) droneBatch.reserve(DRONE_CAPACITY);
+    timers.reserve(TIMER_RESERVE);
+    if (!options.tracePath.empty()) sessionTrace.open(options.tracePath);
+    // A headless world's arena grows to its own peak instead: hundreds of them share the process
+    if (!options.headless) {
+        EntityPool::reserve(sizeof(Asteroid), 256);
+        EntityPool::reserve(sizeof(Bullet), 256);
+        EntityPool::reserve(sizeof(HazardMeteor), 32);
+        EntityPool::reserve(sizeof(PowerUp), 32);
+    }
+    LOG_DEBUG(LogCategory::Game, " - Loading resources...");
     loadResources();
-    std::cout << " - Loading high score..." << std::endl; // DEBUG
+    // A batch layer per rock texture now, so the first rock of each kind does not allocate mid-game
+    for (const char* texture : { "rock.png", "rock_medium.png", "rock_small.png", "slow_powerdown.png" }) {
+        try {
+            rockBatch.addLayer(resourceManager.getTexture(texture));
+        } catch (const std::runtime_error&) {
+            // Missing art was reported by loadResources; those rocks fall back to their own layer
+        }
+    }
+    if (animBulletRed.sprite.getTexture()) shotBatch.addLayer(*animBulletRed.sprite.getTexture());
+    if (animDrone.sprite.getTexture()) droneBatch.addLayer(*animDrone.sprite.getTexture());
+    LOG_DEBUG(LogCategory::Game, " - Loading high score...");
     loadHighScore();
-    std::cout << " - Setting up UI..." << std::endl; // DEBUG
-    setupUI();
-    std::cout << " - Setting initial state to MainMenu..." << std::endl; // DEBUG
+    LOG_DEBUG(LogCategory::Game, " - Setting up UI...");
+    if (!options.headless) setupUI();
+    LOG_DEBUG(LogCategory::Game, " - Setting initial state to MainMenu...");
     // Gọi setState một cách tường minh thay vì dựa vào giá trị khởi tạo ban đầu
     // currentState = State::MainMenu; // Gán trực tiếp có thể bỏ qua logic trong setState
     setState(State::MainMenu); // Gọi hàm setState để thực thi logic thiết lập
-    std::cout << "initialize() finished." << std::endl; // DEBUG
+    LOG_DEBUG(LogCategory::Game, "initialize() finished.");
 }
 
 // --- Resource Loading ---
 void Game::loadResources() {
-    std::cout << "Loading resources and animations..." << std::endl;
+    LOG_INFO(LogCategory::Resource, "Loading resources and animations...");
     try {
         // Textures
         resourceManager.getTexture("spaceship.png");
@@ -106,11 +319,25 @@ void Game::loadResources() {
         animBulletRed = Animation(resourceManager.getTexture("fire_red.png"), 0, 0, 32, 64, 16, 0.9f, false);
         animBulletLaser = Animation(resourceManager.getTexture("fire_laser.png"), 0, 0, 64, 64, 18, 1.2f, false);
         animHazardMeteor = Animation(resourceManager.getTexture("slow_powerdown.png"), 0, 0, 64, 64, 24, 0.3f, true);
-        animExplosionSmall = Animation(resourceManager.getTexture("explosions/type_A.png"), 0, 0, 51, 50, 20, 0.6f, false);
-        animExplosionPlayer = Animation(resourceManager.getTexture("explosions/type_B.png"), 0, 0, 192, 192, 64, 0.7f, false);
-        animExplosionAsteroid = Animation(resourceManager.getTexture("explosions/type_C.png"), 0, 0, 256, 256, 48, 0.6f, false);
-        animExplosionBoss = Animation(resourceManager.getTexture("explosions/boss_explosion.png"), 0, 0, 64, 64, 8, 0.5f, false);
         animBoss1 = Animation(resourceManager.getTexture("boss1.png"), 0, 0, 230, 336, 1, 0, false);
+        Animation shipIdle;
+        Player::makeShipClips(shipIdle, animDrone);
+        float droneScale = DRONE_SIZE / static_cast<float>(animDrone.firstFrame.height);
+        animDrone.sprite.setScale(droneScale, droneScale);
+        animDrone.sprite.setColor(sf::Color(255, 90, 90));
+        buildCollisionMasks();
+
+        // Particle clips (explosions)
+        clipExplosionSmall = particles.addClip(resourceManager.getTexture("explosions/type_A.png"), 0, 0, 51, 50, 20, 0.6f);
+        clipExplosionPlayer = particles.addClip(resourceManager.getTexture("explosions/type_B.png"), 0, 0, 192, 192, 64, 0.7f);
+        clipExplosionAsteroid = particles.addClip(resourceManager.getTexture("explosions/type_C.png"), 0, 0, 256, 256, 48, 0.6f);
+        clipExplosionBoss = particles.addClip(resourceManager.getTexture("explosions/boss_explosion.png"), 0, 0, 64, 64, 8, 0.5f);
+
+        // Nothing below is needed without a window
+        if (!audio) {
+            LOG_INFO(LogCategory::Resource, "Resources loaded successfully (headless).");
+            return;
+        }
 
         // Fonts (Adjust path as needed - place font near executable or provide full path)
         if (!uiFont.loadFromFile("arial.ttf")) { // Example: Assuming arial.ttf is in the same folder
@@ -121,27 +348,28 @@ void Game::loadResources() {
         }
 
         // Sounds
-        shootSound.setBuffer(resourceManager.getSoundBuffer("shoot.wav"));
-        explosionSoundAsteroid.setBuffer(resourceManager.getSoundBuffer("explosion_asteroid.wav"));
-        explosionSoundPlayer.setBuffer(resourceManager.getSoundBuffer("explosion_player.wav"));
-        powerupSound.setBuffer(resourceManager.getSoundBuffer("powerup_collect.wav"));
-        powerdownSound.setBuffer(resourceManager.getSoundBuffer("powerdown.ogg"));
-        // bossHitSound.setBuffer(resourceManager.getSoundBuffer("boss_hit.wav"));
-        // bossExplodeSound.setBuffer(resourceManager.getSoundBuffer("boss_explode.wav"));
+        audio->shootSound.setBuffer(resourceManager.getSoundBuffer("shoot.wav"));
+        audio->explosionSoundAsteroid.setBuffer(resourceManager.getSoundBuffer("explosion_asteroid.wav"));
+        audio->explosionSoundPlayer.setBuffer(resourceManager.getSoundBuffer("explosion_player.wav"));
+        audio->powerupSound.setBuffer(resourceManager.getSoundBuffer("powerup_collect.wav"));
+        audio->powerdownSound.setBuffer(resourceManager.getSoundBuffer("powerdown.ogg"));
+        // audio->bossHitSound.setBuffer(resourceManager.getSoundBuffer("boss_hit.wav"));
+        // audio->bossExplodeSound.setBuffer(resourceManager.getSoundBuffer("boss_explode.wav"));
 
         // Music
-        if (!backgroundMusic.openFromFile("sounds/background_music.ogg")) throw std::runtime_error("Failed to load background music");
-        backgroundMusic.setLoop(true); backgroundMusic.setVolume(30);
-        if (!bossMusic.openFromFile("sounds/boss_theme.ogg")) throw std::runtime_error("Failed to load boss music");
-        bossMusic.setLoop(true); bossMusic.setVolume(45);
+        if (!audio->backgroundMusic.openFromFile("sounds/background_music.ogg")) throw std::runtime_error("Failed to load background music");
+        audio->backgroundMusic.setLoop(true); audio->backgroundMusic.setVolume(30);
+        if (!audio->bossMusic.openFromFile("sounds/boss_theme.ogg")) throw std::runtime_error("Failed to load boss music");
+        audio->bossMusic.setLoop(true); audio->bossMusic.setVolume(45);
 
     } catch (const std::exception& e) {
-        std::cerr << "Error loading resources: " << e.what() << std::endl;
+        LOG_ERROR(LogCategory::Resource, "Error loading resources: %s", e.what());
+        Logger::getInstance().flush(); // Make sure the reason is visible before exiting
         // Consider closing the window or handling the error more gracefully
          window.close();
          exit(EXIT_FAILURE); // Exit if critical resources fail
     }
-    std::cout << "Resources loaded successfully." << std::endl;
+    LOG_INFO(LogCategory::Resource, "Resources loaded successfully.");
 }
 
 // --- UI Setup ---
@@ -149,48 +377,88 @@ void Game::setupUI() {
     scoreText.setFont(uiFont); scoreText.setCharacterSize(24); scoreText.setFillColor(sf::Color::White); scoreText.setPosition(10, 10);
     livesText.setFont(uiFont); livesText.setCharacterSize(24); livesText.setFillColor(sf::Color::White); livesText.setPosition(10, 40);
     levelText.setFont(uiFont); levelText.setCharacterSize(24); levelText.setFillColor(sf::Color::White); levelText.setPosition(window.getSize().x - 150.f, 10);
+    swarmText.setFont(uiFont); swarmText.setCharacterSize(16); swarmText.setFillColor(sf::Color::Green); swarmText.setPosition(10, window.getSize().y - 50.f);
     messageText.setFont(uiFont); messageText.setCharacterSize(40); messageText.setFillColor(sf::Color::White);
 
     highScoreText.setFont(uiFont); highScoreText.setCharacterSize(20); highScoreText.setFillColor(sf::Color::Yellow);
     shipSelectionText.setFont(uiFont); shipSelectionText.setCharacterSize(20); shipSelectionText.setFillColor(sf::Color::Cyan);
 
+    // Warm the glyph cache and vertex arrays with every character the HUD can show
+    const char* hudGlyphs = "Score: Lives: Level: Wave: 0123456789-";
+    setHudText(scoreText, hudGlyphs); scoreText.getLocalBounds();
+    setHudText(livesText, hudGlyphs); livesText.getLocalBounds();
+    setHudText(levelText, hudGlyphs); levelText.getLocalBounds();
+    setHudText(swarmText, "Entities: Asteroids: Meteors: Drones: Tick ms Pair tests: 0123456789.|\n"); swarmText.getLocalBounds();
+
+    // Boss health bar and pause overlay (resized in place while playing)
+    const float bossBarWidth = 300.f;
+    bossBarBackground.setSize(sf::Vector2f(bossBarWidth, 15.f));
+    bossBarBackground.setFillColor(sf::Color(100, 100, 100, 200));
+    bossBarBackground.setPosition(window.getSize().x / 2.f - bossBarWidth / 2.f, 20.f);
+    bossBarFill.setSize(sf::Vector2f(bossBarWidth, 15.f));
+    bossBarFill.setFillColor(sf::Color(200, 0, 0, 200));
+    bossBarFill.setPosition(window.getSize().x / 2.f - bossBarWidth / 2.f, 20.f);
+    pauseOverlay.setSize(sf::Vector2f(window.getSize()));
+    pauseOverlay.setFillColor(sf::Color(0, 0, 0, 150)); // Black with alpha
+    // Black holes: the horizon, inside a faint glowing ring
+    wellCore.setRadius(WELL_HORIZON);
+    wellCore.setOrigin(WELL_HORIZON, WELL_HORIZON);
+    wellCore.setFillColor(sf::Color::Black);
+    wellCore.setOutlineThickness(3.f);
+    wellCore.setOutlineColor(sf::Color(255, 150, 60, 220));
+    wellHalo.setRadius(3.f * WELL_HORIZON);
+    wellHalo.setOrigin(3.f * WELL_HORIZON, 3.f * WELL_HORIZON);
+    wellHalo.setFillColor(sf::Color(120, 60, 200, 40));
+
+    // Background
+    try {
+        backgroundSprite.setTexture(resourceManager.getTexture("background.jpg"));
+        backgroundSprite.setScale(
+            static_cast<float>(window.getSize().x) / backgroundSprite.getLocalBounds().width,
+            static_cast<float>(window.getSize().y) / backgroundSprite.getLocalBounds().height);
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR(LogCategory::Resource, "Error loading background: %s", e.what());
+    }
+
     // Game Over Sprite
     try {
         gameOverSprite.setTexture(resourceManager.getTexture("gameover.png"));
         gameOverSprite.setOrigin(gameOverSprite.getLocalBounds().width / 2.f, gameOverSprite.getLocalBounds().height / 2.f);
         gameOverSprite.setPosition(window.getSize().x / 2.f, window.getSize().y / 2.f - 50);
     } catch (const std::runtime_error& e) {
-        std::cerr << "Warning: Failed to load gameover.png texture. Game over screen will use text only." << std::endl;
+        LOG_WARN(LogCategory::Resource, "Failed to load gameover.png texture. Game over screen will use text only.");
     }
 }
 
 // --- State Management ---
 void Game::setState(State newState) {
     State oldState = currentState;
-     std::cout << "setState() called: old=" << static_cast<int>(oldState) << ", new=" << static_cast<int>(newState) << std::endl; // DEBUG
+    LOG_DEBUG(LogCategory::Game, "setState() called: old=%d, new=%d", oldState, newState);
 
     currentState = newState;
     messageText.setString("");
 
     // State Exit Actions
     if (oldState == State::Playing || oldState == State::Paused) {
-         std::cout << " - Pausing music due to exiting Playing/Paused." << std::endl; // DEBUG
-        backgroundMusic.pause();
-        bossMusic.pause();
+        LOG_DEBUG(LogCategory::Game, " - Pausing music due to exiting Playing/Paused.");
+        if (audio) {
+            audio->backgroundMusic.pause();
+            audio->bossMusic.pause();
+        }
     }
 
     // State Entry Actions
-    std::cout << " - Entering setup for state " << static_cast<int>(currentState) << std::endl; // DEBUG
+    LOG_DEBUG(LogCategory::Game, " - Entering setup for state %d", currentState);
     switch (currentState) {
         case State::MainMenu:
-             std::cout << "   - Setting up MainMenu..." << std::endl; // DEBUG
+            LOG_DEBUG(LogCategory::Game, "   - Setting up MainMenu...");
             resetGame(true); // Reset game state, spawns player
-             std::cout << "   - Game reset complete (player spawned)." << std::endl; // DEBUG
-            messageText.setString("ASTEROIDS DELUXE\n\n[P] Play Campaign\n[S] Play Survival\n[I] Instructions\n[N] Next Ship\n[Esc] Exit");
+            LOG_DEBUG(LogCategory::Game, "   - Game reset complete (player spawned).");
+            messageText.setString("ASTEROIDS DELUXE\n\n[P] Play Campaign\n[S] Play Survival\n[W] Swarm Survival\n[I] Instructions\n[N] Next Ship\n[Esc] Exit");
             messageText.setCharacterSize(40);
             // Origin/Positioning (Quan trọng: đảm bảo font đã load và string đã set)
-            if (uiFont.getInfo().family.empty()) {
-                 std::cerr << "   - WARNING: uiFont seems invalid in setState(MainMenu)!" << std::endl;
+            if (!options.headless && uiFont.getInfo().family.empty()) {
+                LOG_WARN(LogCategory::Game, "uiFont seems invalid in setState(MainMenu)!");
             }
             messageText.setOrigin(messageText.getLocalBounds().left + messageText.getLocalBounds().width / 2.f, messageText.getLocalBounds().top + messageText.getLocalBounds().height / 2.f);
             messageText.setPosition(window.getSize().x / 2.f, window.getSize().y / 2.f);
@@ -203,14 +471,14 @@ void Game::setState(State newState) {
             highScoreText.setOrigin(highScoreText.getLocalBounds().left + highScoreText.getLocalBounds().width, 0);
             highScoreText.setPosition(window.getSize().x - 10.f, 10.f);
 
-             std::cout << "   - UI text set. Playing music..." << std::endl; // DEBUG
-            if (backgroundMusic.getStatus() != sf::Music::Playing) {
-                 backgroundMusic.play();
-                 std::cout << "   - Background music started." << std::endl; // DEBUG
-            } else {
-                 std::cout << "   - Background music already playing." << std::endl; // DEBUG
+            LOG_DEBUG(LogCategory::Game, "   - UI text set. Playing music...");
+            if (audio && audio->backgroundMusic.getStatus() != sf::Music::Playing) {
+                 audio->backgroundMusic.play();
+                LOG_DEBUG(LogCategory::Game, "   - Background music started.");
+            } else if (audio) {
+                LOG_DEBUG(LogCategory::Game, "   - Background music already playing.");
             }
-             std::cout << "   - MainMenu setup complete." << std::endl; // DEBUG
+            LOG_DEBUG(LogCategory::Game, "   - MainMenu setup complete.");
             break;
 
         case State::Instructions:
@@ -228,16 +496,21 @@ void Game::setState(State newState) {
 
         case State::Playing:
              if (oldState == State::Paused) { // Resuming game
-                 if (currentBoss) bossMusic.play(); else backgroundMusic.play();
+                 if (rewound) { // Play on from the frame shown: the history after it is abandoned
+                     rewind.truncateAfter(rewindCursor);
+                     rewound = false;
+                 }
+                 resumeMusic();
              } else if (oldState == State::MainMenu || oldState == State::GameOver) { // Starting new game
                  // resetGame(true) was called in MainMenu or is handled by Retry/R key logic
                  // Need to initiate the chosen mode
+                 beginRun();
                  if (currentMode == PlayMode::Campaign) {
                      currentLevel = 1; // Set level before showing story
                      showStory(currentLevel); // Will set state to Story or Playing
-                 } else { // Survival
+                 } else { // Survival or Swarm
                      currentLevel = 1;
-                     startSurvival();
+                     if (currentMode == PlayMode::Swarm) startSwarm(); else startSurvival();
                      // If startSurvival doesn't set state, set it here
                      if (currentState != State::Playing) setState(State::Playing);
                  }
@@ -245,12 +518,10 @@ void Game::setState(State newState) {
              } else if (oldState == State::Story || oldState == State::LevelTransition) { // Coming from story/transition
                  // Level was loaded by updateStory or updateLevelTransition calling loadLevel
                  // Ensure music is correct
-                 if (currentBoss) { if(bossMusic.getStatus() != sf::Music::Playing) bossMusic.play(); }
-                 else { if(backgroundMusic.getStatus() != sf::Music::Playing) backgroundMusic.play(); }
-             } else if (player && !player->life && player->lives > 0) { // Respawning state triggered by updatePlaying
-                 playerRespawnTimer = PLAYER_RESPAWN_DELAY;
-                 if (currentBoss) { if(bossMusic.getStatus() != sf::Music::Playing) bossMusic.play(); }
-                 else { if(backgroundMusic.getStatus() != sf::Music::Playing) backgroundMusic.play(); }
+                 resumeMusic();
+             } else if (getPlayer() && !getPlayer()->life && getPlayer()->lives > 0) { // Respawning state triggered by updatePlaying
+                 startRespawnDelay();
+                 resumeMusic();
              }
             break;
 
@@ -259,11 +530,12 @@ void Game::setState(State newState) {
             messageText.setCharacterSize(40);
             messageText.setOrigin(messageText.getLocalBounds().left + messageText.getLocalBounds().width / 2.f, messageText.getLocalBounds().top + messageText.getLocalBounds().height / 2.f);
             messageText.setPosition(window.getSize().x / 2.f, window.getSize().y / 2.f);
-            clock.restart(); // Start timer for transition delay
+            transitionTimer = LEVEL_TRANSITION_DURATION; // In ticks of game time, so replays and headless worlds wait the same
             break;
 
-        case State::GameOver:
-            if (player && player->score > highScore) {
+        case State::GameOver: {
+            Player* player = getPlayer();
+            if (!replaying && !options.headless && player && player->score > highScore) { // Replays and server worlds must not touch the saved score
                 highScore = player->score;
                 saveHighScore();
             }
@@ -273,43 +545,823 @@ void Game::setState(State newState) {
                                   "\n\n[R] Retry\n[M] Main Menu");
             messageText.setOrigin(messageText.getLocalBounds().left + messageText.getLocalBounds().width / 2.f, messageText.getLocalBounds().top + messageText.getLocalBounds().height / 2.f);
             messageText.setPosition(gameOverSprite.getPosition().x, gameOverSprite.getPosition().y + gameOverSprite.getGlobalBounds().height / 2.f + 50.f);
-            backgroundMusic.stop(); // Ensure music stops
-            bossMusic.stop();
+            stopMusic(); // Ensure music stops
             break;
+        }
 
         case State::Paused:
-            messageText.setString("PAUSED\n\n[Esc] Resume\n[M] Main Menu");
-            messageText.setCharacterSize(40);
-            messageText.setOrigin(messageText.getLocalBounds().left + messageText.getLocalBounds().width / 2.f, messageText.getLocalBounds().top + messageText.getLocalBounds().height / 2.f);
-            messageText.setPosition(window.getSize().x / 2.f, window.getSize().y / 2.f);
+            rewound = false;
+            if (rewind.enabled() && rewindCaptures > 0) {
+                double average = rewindCaptureSeconds / rewindCaptures;
+                LOG_INFO(LogCategory::Game, "Rewind: %d frames, %d KB of %d KB, capture %d us per tick (%d%% of a tick)",
+                         rewind.frameCount(), rewind.bytesUsed() / 1024, rewind.budget() / 1024,
+                         static_cast<int>(average * 1e6), static_cast<int>(average / TICK_DT * 100.0));
+            }
+            updatePauseText();
             // Music pause handled by exit actions of Playing state
             break;
     }
-    std::cout << "setState() finished for state " << static_cast<int>(currentState) << std::endl; // DEBUG
+    LOG_DEBUG(LogCategory::Game, "setState() finished for state %d", currentState);
+}
+
+void Game::playSound(sf::Sound Audio::*sound) {
+    if (audio) ((*audio).*sound).play();
+}
+
+void Game::resumeMusic() {
+    if (!audio) return;
+    sf::Music& music = getBoss() ? audio->bossMusic : audio->backgroundMusic;
+    if (music.getStatus() != sf::Music::Playing) music.play();
+}
+
+void Game::stopMusic() {
+    if (!audio) return;
+    audio->backgroundMusic.stop();
+    audio->bossMusic.stop();
 }
 
 // --- Main Loop ---
 void Game::run() {
-    std::cout << "Starting main game loop..." << std::endl; // DEBUG
+    if (!options.replayPath.empty()) {
+        runReplay();
+        return;
+    }
+    LOG_DEBUG(LogCategory::Game, "Starting main game loop...");
     while (window.isOpen()) {
-        // 1. Calculate Delta Time
-        float dt = clock.restart().asSeconds();
-        // Clamp delta time to prevent issues after pauses or lag spikes
-        if (dt > 0.1f) dt = 0.1f;
+        AllocTracker::beginFrame();
+        State frameStartState = currentState;
+        frameWorkStart = std::chrono::steady_clock::now();
+
+        // 1. Calculate frame time and bank it for fixed-size ticks
+        float frameTime = clock.restart().asSeconds();
+        // Clamp to prevent a catch-up spiral after pauses or lag spikes
+        if (frameTime > MAX_FRAME_TIME) frameTime = MAX_FRAME_TIME;
+        tickAccumulator += frameTime;
+
+        // 2. Handle Input (MUST BE CALLED EVERY FRAME). Gameplay keys are read later, per tick.
+        {
+            AllocTracker::PhaseScope phase(AllocPhase::Input);
+            handleInput();
+            if (currentState != State::Playing) discardInput();
+        }
+
+        // 3. Update Game State in fixed ticks (zero or more per frame)
+        {
+            AllocTracker::PhaseScope phase(AllocPhase::Update);
+            while (tickAccumulator >= TICK_DT) {
+                update(TICK_DT);
+                tickAccumulator -= TICK_DT;
+            }
+        }
+
+        // 4. Housekeeping the ticks deferred to the frame, in what is left of its budget
+        {
+            AllocTracker::PhaseScope phase(AllocPhase::Hud);
+            double workedMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - frameWorkStart).count();
+            frameJobs.runSlice(1e6 / pacer.targetHz() * FRAME_HOUSEKEEPING_SHARE - workedMicros);
+        }
+
+        // 5. Render Graphics (MUST BE CALLED EVERY FRAME)
+        {
+            AllocTracker::PhaseScope phase(AllocPhase::Render);
+            render(); // render() calls window.display() internally
+        }
+        if (latencyLog.is_open()) recordFrameLatency();
+
+        checkFrameAllocations(frameStartState);
+
+        // 6. Wait for the next frame (limiter mode) and record the frame time
+        pacer.endFrame();
+    }
+    LOG_DEBUG(LogCategory::Game, "Exited main game loop.");
+    logFramePacing("exit");
+    if (AllocTracker::enabled) {
+        LOG_INFO(LogCategory::Game, "Allocation tracking: %d steady frames checked, %d allocated, %d allocations in total",
+                 allocFramesChecked, allocFramesFailed, AllocTracker::totalCount());
+        if (allocFramesFailed > 0) exitCode = 1;
+    }
+}
+
+void Game::logFramePacing(const char* when) {
+    FramePacer::Report r = pacer.report();
+    LOG_INFO(LogCategory::Game, "Frame pacing (%s, %s %d Hz): %d frames, %d dropped (against %.1f Hz)",
+             when, FramePacer::modeName(pacer.mode()), pacer.targetHz(), r.frames, r.dropped, r.displayHz);
+    LOG_INFO(LogCategory::Game, "Frame times: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms, mean %.2f ms",
+             r.p50, r.p95, r.p99, r.max, r.mean);
+    if (latencyLog.is_open()) {
+        LOG_INFO(LogCategory::Game, "Input to present: %d inputs, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms",
+                 inputLatency.count(), inputLatency.percentile(0.50), inputLatency.percentile(0.95),
+                 inputLatency.percentile(0.99), inputLatency.max());
+    }
+    LOG_INFO(LogCategory::Game, "Live entities: %d (%d asteroids, %d meteors, %d bullets, %d power-ups)",
+             registry.liveTotal(), registry.liveCount(Entity::Type::Asteroid), registry.liveCount(Entity::Type::HazardMeteor),
+             registry.liveCount(Entity::Type::Bullet), registry.liveCount(Entity::Type::PowerUp));
+    if (rockSolves > 0) {
+        LOG_INFO(LogCategory::Game, "Rock contacts: %d ticks solved on %d workers, mean %.2f ms, max %.2f ms, peak %d contacts, %d dropped",
+                 rockSolves, rockSolver.workerCount(), rockSolveSeconds * 1000.0 / rockSolves, rockSolveMax * 1000.0,
+                 rockContactsMax, rockSolver.stats().dropped);
+    }
+    if (gravitySolves > 0) {
+        LOG_INFO(LogCategory::Game, "Gravity: %d ticks solved on %d workers (theta %.3f), mean %.3f ms, max %.3f ms",
+                 gravitySolves, gravity.workerCount(), gravity.accuracy(), gravitySeconds * 1000.0 / gravitySolves, gravityMax * 1000.0);
+        LOG_INFO(LogCategory::Game, "Gravity: peak %d sources / %d probes, %d dropped",
+                 gravitySourcesMax, gravityProbesMax, gravity.stats().dropped);
+    }
+    if (rockSkipped > 0) LOG_INFO(LogCategory::Game, "Rock contacts skipped on %d ticks (field denser than the screen)", rockSkipped);
+    if (droneUpdates > 0) {
+        LOG_INFO(LogCategory::Game, "Drones: %d alive, %d updates, mean %.3f ms, max %.3f ms, %d neighbour tests last tick, %d not spawned",
+                 drones.size(), droneUpdates, droneSeconds * 1000.0 / droneUpdates, droneMax * 1000.0,
+                 drones.stats().neighborTests, drones.stats().dropped);
+    }
+    LOG_INFO(LogCategory::Game, "Enemy shots: %d in flight, %d patterns playing, %d not fired (over capacity)",
+             enemyShots.size(), enemyShots.activeEmitters().size(), enemyShots.droppedCount());
+    tickJobs.logReport("Tick");
+    frameJobs.logReport("Frame");
+    QualityController& quality = QualityController::getInstance();
+    LOG_INFO(LogCategory::Game, "Quality level %d (%s), %d cosmetic effects shed",
+             quality.level(), quality.automatic() ? "auto" : "fixed", quality.shedCount());
+    if (inputSampler.droppedCount() > 0) {
+        LOG_WARN(LogCategory::Game, "Input thread found its queue full %d times (those key changes were sent late)", inputSampler.droppedCount());
+    }
+}
+
+// --- Allocation Tracking ---
+// A steady-state frame is a Playing frame that started and ended in Playing, after the warm-up
+// that follows any state change (level load, respawn pools, first glyphs). Such frames must not
+// touch the heap from the game thread; allocations made by other threads (audio, logger) are
+// recorded under AllocPhase::Other and ignored here.
+void Game::checkFrameAllocations(State frameStartState) {
+    if (!AllocTracker::enabled) return;
+
+    if (frameStartState != State::Playing || currentState != State::Playing) {
+        steadyFrames = 0;
+        return;
+    }
+    if (++steadyFrames <= ALLOC_WARMUP_FRAMES) return;
+
+    std::uint64_t frameAllocs = AllocTracker::frameTotal() - AllocTracker::frameCount(AllocPhase::Other);
+    ++allocFramesChecked;
+    if (frameAllocs == 0) return;
+
+    ++allocFramesFailed;
+    LOG_ERROR(LogCategory::Game, "Steady-state frame allocated: input %d, update %d, collision %d, cleanup %d, hud %d, render %d",
+              AllocTracker::frameCount(AllocPhase::Input),
+              AllocTracker::frameCount(AllocPhase::Update),
+              AllocTracker::frameCount(AllocPhase::Collision),
+              AllocTracker::frameCount(AllocPhase::Cleanup),
+              AllocTracker::frameCount(AllocPhase::Hud),
+              AllocTracker::frameCount(AllocPhase::Render));
+    Logger::getInstance().flush();
+}
+
+// --- Allocation check (tools/alloc_check) ---
+// The steady-state rule above, on a headless Survival run: one tick per frame, a bot that turns,
+// thrusts in bursts and keeps firing, and a new run after each game over (which restarts the
+// warm-up). It covers the simulation phases (update, collision, cleanup) only: there is no window,
+// so input polling, the HUD and render are NOT exercised. Those are checked only by running a
+// windowed TRACK_ALLOCATIONS build by hand (its exit status reports a frame that allocated).
+int Game::runAllocationCheck(std::uint64_t ticks, std::uint32_t seed) {
+    if (!AllocTracker::enabled || !options.headless) {
+        LOG_ERROR(LogCategory::Game, "The allocation check needs a TRACK_ALLOCATIONS build and a headless world");
+        return 2;
+    }
+    startHeadless(PlayMode::Survival, seed);
+    std::uint64_t runs = 1;
+    for (std::uint64_t t = 0; t < ticks; ++t) {
+        PlayerInput input;
+        input.left = (t / 90) % 2 == 0;
+        input.right = !input.left;
+        input.thrust = t % 120 < 10;
+        input.fire = t % 6 == 0;
+
+        AllocTracker::beginFrame();
+        State frameStartState = currentState;
+        bool running;
+        {
+            AllocTracker::PhaseScope phase(AllocPhase::Update);
+            running = stepHeadless(input);
+        }
+        checkFrameAllocations(frameStartState);
+        if (!running) {
+            startHeadless(PlayMode::Survival, seed + static_cast<std::uint32_t>(runs));
+            ++runs;
+        }
+    }
+    LOG_INFO(LogCategory::Game, "Allocation check (simulation only, no input/HUD/render): %d ticks over %d runs, %d steady ticks checked, %d allocated",
+             ticks, runs, allocFramesChecked, allocFramesFailed);
+    Logger::getInstance().flush();
+    return (allocFramesChecked > 0 && allocFramesFailed == 0) ? 0 : 1;
+}
+
+// --- Sessions ---
+// Every run starts from a known Random seed, and the simulation only sees input through tickInput,
+// so a run is fully described by its seed, start settings and per-tick inputs.
+void Game::beginRun() {
+    runSeed = options.fixedSeed ? options.seed : static_cast<std::uint32_t>(std::time(nullptr));
+    Random::seed(runSeed);
+    runTicks = 0;
+    fireRequested = false;
+    tickInput = PlayerInput();
+    rewind.clear();
+    tickJobs.reset(); // The schedule is part of the replayed state: every run starts from the same one
+
+    if (!options.recordPath.empty() && !replaying) {
+        SessionHeader header;
+        header.seed = runSeed;
+        header.mode = static_cast<std::uint8_t>(currentMode);
+        header.ship = static_cast<std::uint8_t>(selectedShipType);
+        header.swarmTarget = currentMode == PlayMode::Swarm ? static_cast<std::uint32_t>(options.swarmTarget) : 0;
+        header.gravity = static_cast<std::uint8_t>(options.gravity);
+        header.gravityTheta = static_cast<std::uint16_t>(std::lround(options.gravityTheta * 1000.f));
+        sessionWriter.open(options.recordPath, header); // Each new run replaces the previous recording
+        LOG_INFO(LogCategory::Game, "Recording session to %s (seed %d)", options.recordPath, runSeed);
+    }
+}
+
+// Called right before each Playing tick. With the input thread, everything it saw up to now is
+// applied in order; a key pressed and released since the last tick still counts for this one.
+PlayerInput Game::sampleInput() {
+    PlayerInput in;
+    if (inputSampler.running()) {
+        bool tapped[InputSampler::KEY_COUNT] = {};
+        InputSampler::Event event;
+        while (inputSampler.poll(event)) {
+            inputHeld[event.key] = event.pressed;
+            if (event.pressed) {
+                tapped[event.key] = true;
+                noteInputStamp(event.stampNs);
+            }
+        }
+        in.left = inputHeld[InputSampler::Left] || tapped[InputSampler::Left];
+        in.right = inputHeld[InputSampler::Right] || tapped[InputSampler::Right];
+        in.thrust = inputHeld[InputSampler::Thrust] || tapped[InputSampler::Thrust];
+        in.fire = fireRequested || tapped[InputSampler::Fire];
+    } else {
+        in.left = sf::Keyboard::isKeyPressed(sf::Keyboard::Left);
+        in.right = sf::Keyboard::isKeyPressed(sf::Keyboard::Right);
+        in.thrust = sf::Keyboard::isKeyPressed(sf::Keyboard::Up);
+        in.fire = fireRequested;
+    }
+    if (fireRequested) noteInputStamp(fireStampNs);
+    fireRequested = false;
+    return in;
+}
+
+void Game::discardInput() {
+    InputSampler::Event event;
+    while (inputSampler.poll(event)) inputHeld[event.key] = event.pressed;
+    fireRequested = false;
+}
+
+void Game::noteInputStamp(std::uint64_t stampNs) {
+    if (latencyLog.is_open() && frameStampCount < MAX_FRAME_STAMPS) frameStamps[frameStampCount++] = stampNs;
+}
+
+// display() has returned (with vsync: the swap happened), so this is input-to-present time
+void Game::recordFrameLatency() {
+    ++latencyFrames;
+    if (frameStampCount == 0) return;
+    std::uint64_t now = InputSampler::nowNs();
+    double minMs = 1e9, maxMs = 0.0;
+    for (int i = 0; i < frameStampCount; ++i) {
+        double ms = static_cast<double>(now - frameStamps[i]) / 1e6;
+        inputLatency.add(ms);
+        if (ms < minMs) minMs = ms;
+        if (ms > maxMs) maxMs = ms;
+    }
+    latencyLog << latencyFrames << ',' << frameStampCount << ',' << minMs << ',' << maxMs << '\n';
+    frameStampCount = 0;
+}
+
+// Hash of everything that decides future gameplay: the tick counters, pending timers and every
+// entity in dense order. Each entity is hashed on its own and folded in, so a trace can show which
+// entity changed the world hash.
+std::uint64_t Game::worldChecksum() {
+    WorldChecksum world;
+    world.add(simTick);
+    world.add(playTick);
+    world.add(respawnTick);
+    world.add(currentLevel);
+    world.add(static_cast<std::uint64_t>(timers.pending()));
+    world.add(static_cast<std::uint64_t>(entities.size()));
+
+    bool tracing = sessionTrace.isOpen();
+    if (tracing) {
+        sessionTrace.beginTick(runTicks);
+        sessionTrace.globals(simTick, playTick, respawnTick, currentLevel, timers.pending());
+    }
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        const Entity& e = *entities[i];
+        WorldChecksum one;
+        e.hashState(one);
+        world.add(one.value());
+        if (tracing) sessionTrace.entity(i, entities.handleAt(i), e, one.value());
+    }
+    enemyShots.hashState(world);
+    drones.hashState(world);
+    world.add(static_cast<std::uint64_t>(wells.size()));
+    for (const sf::Vector2f& well : wells) {
+        world.add(well.x);
+        world.add(well.y);
+    }
+    if (tracing) sessionTrace.endTick(world.value());
+    return world.value();
+}
+
+void Game::finishTick() {
+    std::uint64_t checksum = worldChecksum();
+    if (sessionWriter.isOpen()) {
+        SessionTick record;
+        record.input = tickInput.toBits();
+        record.checksum = checksum;
+        sessionWriter.write(record);
+    }
+    if (replaying && replayMismatchTick == 0 && checksum != replayExpected) {
+        replayMismatchTick = runTicks;
+        LOG_ERROR(LogCategory::Game, "Replay diverged at tick %d: checksum %016x, session has %016x",
+                  runTicks, checksum, replayExpected);
+    }
+}
+
+// --replay: re-simulates a recorded session without rendering. The recorded inputs are fed tick by
+// tick and every checksum is compared; story and transition screens in between are stepped through.
+void Game::runReplay() {
+    SessionReader reader(options.replayPath);
+    const SessionHeader& header = reader.header();
+    LOG_INFO(LogCategory::Game, "Replaying %s (seed %d)", options.replayPath, header.seed);
+
+    replaying = true;
+    options.fixedSeed = true;
+    options.seed = header.seed;
+    currentMode = static_cast<PlayMode>(header.mode);
+    selectedShipType = static_cast<Player::ShipType>(header.ship);
+    if (header.swarmTarget) options.swarmTarget = static_cast<int>(header.swarmTarget);
+    options.gravity = static_cast<GameOptions::GravityMode>(header.gravity); // Off for sessions older than gravity
+    options.gravityTheta = header.gravityTheta / 1000.f;
+    gravity.setAccuracy(options.gravityTheta);
+    setState(State::Playing); // Same path as starting a run from the menu (calls beginRun)
+
+    std::uint64_t recorded = 0;
+    SessionTick record;
+    while (reader.next(record)) {
+        ++recorded;
+        while (currentState == State::Story || currentState == State::LevelTransition) {
+            update(TICK_DT);
+        }
+        if (currentState != State::Playing) break; // This build stopped playing before the session did
+        tickInput = PlayerInput::fromBits(record.input);
+        replayExpected = record.checksum;
+        update(TICK_DT);
+    }
+
+    bool complete = recorded == runTicks && !reader.next(record);
+    if (replayMismatchTick == 0 && complete) {
+        LOG_INFO(LogCategory::Game, "Replay matched: %d ticks, final checksum %016x", runTicks, replayExpected);
+    } else if (replayMismatchTick == 0) {
+        LOG_ERROR(LogCategory::Game, "Replay ended early: the session has more ticks than the %d played", runTicks);
+    }
+    exitCode = (replayMismatchTick == 0 && complete) ? 0 : 1;
+    Logger::getInstance().flush();
+}
+
+// --- Headless worlds ---
+// The server's counterpart of runReplay: the same run start as the menu, then one update per tick
+// with the owner's input instead of the keyboard's. Every tick of story and transition screens is
+// stepped too, so a world runs in real time like a windowed game would.
+void Game::startHeadless(PlayMode mode, std::uint32_t seed) {
+    EntityPool::Binding pool(entityArena.get());
+    options.fixedSeed = true;
+    options.seed = seed;
+    currentMode = mode;
+    if (currentState != State::MainMenu) setState(State::MainMenu); // Fresh world
+    setState(State::Playing); // Calls beginRun, which seeds Random on this thread
+    headlessRng = Random::state();
+    headlessScore = 0;
+}
+
+bool Game::stepHeadless(const PlayerInput& input) {
+    EntityPool::Binding pool(entityArena.get());
+    Random::setState(headlessRng);
+    tickInput = input;
+    update(TICK_DT);
+    headlessRng = Random::state();
+    if (Player* player = getPlayer()) headlessScore = player->score;
+    return currentState != State::GameOver;
+}
+
+void Game::captureWorld(WorldSnapshot& world) {
+    captureSnapshot(world);
+    world.rngState = headlessRng; // Not this thread's state
+}
+
+// --- Snapshots ---
+// Type-specific fields go in EntityRecord::extra (timers in ms):
+//   Player:   score, lives, shootTimer, shootCooldown, weapon, thrust   (variant = ship type)
+//   Boss:     health, maxHealth, currentPhase, phaseTimer, shootCooldown
+//   Asteroid: scoreValue (variant = size)    Bullet: damage, target entity (-1 = none), target point (variant = bullet type)
+//   PowerUp:  age (variant = power-up type)  HazardMeteor: none
+// Enemy shots and the boss pattern emitters have their own records.
+void Game::captureSnapshot(WorldSnapshot& world) {
+    world.mode = static_cast<std::uint8_t>(currentMode);
+    world.level = currentLevel;
+    world.simTick = simTick;
+    world.playTick = playTick;
+    world.respawnTick = respawnTick;
+    world.rngState = Random::state();
+    world.player = -1;
+    world.boss = -1;
+
+    world.entities.resize(entities.size());
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        const Entity& e = *entities[i];
+        EntityRecord& r = world.entities[i];
+        r = EntityRecord();
+        r.id = e.handle.index;
+        r.generation = e.handle.generation;
+        r.type = static_cast<std::uint8_t>(e.type);
+        r.life = e.life;
+        r.x = SnapshotCodec::quantize(e.pos.x, SnapshotCodec::POS_SCALE);
+        r.y = SnapshotCodec::quantize(e.pos.y, SnapshotCodec::POS_SCALE);
+        r.vx = SnapshotCodec::quantize(e.velocity.x, SnapshotCodec::VEL_SCALE);
+        r.vy = SnapshotCodec::quantize(e.velocity.y, SnapshotCodec::VEL_SCALE);
+        r.angle = SnapshotCodec::quantizeAngle(e.angle);
+        r.radius = static_cast<std::uint16_t>(SnapshotCodec::quantize(e.R, SnapshotCodec::RADIUS_SCALE));
+        r.age = static_cast<std::uint32_t>(simTick - e.spawnTick);
+
+        switch (e.type) {
+            case Entity::Type::Player: {
+                const Player& p = static_cast<const Player&>(e);
+                r.variant = static_cast<std::uint8_t>(p.currentShipType);
+                r.extraCount = 6;
+                r.extra[0] = p.score;
+                r.extra[1] = p.lives;
+                r.extra[2] = SnapshotCodec::quantize(p.shootTimer, 1000);
+                r.extra[3] = SnapshotCodec::quantize(p.shootCooldown, 1000);
+                r.extra[4] = static_cast<std::int32_t>(p.currentWeaponType);
+                r.extra[5] = p.thrust ? 1 : 0;
+                if (e.handle == playerHandle) world.player = static_cast<std::int32_t>(i);
+                break;
+            }
+            case Entity::Type::Boss: {
+                const Boss& b = static_cast<const Boss&>(e);
+                r.extraCount = 5;
+                r.extra[0] = b.health;
+                r.extra[1] = b.maxHealth;
+                r.extra[2] = b.currentPhase;
+                r.extra[3] = SnapshotCodec::quantize(b.phaseTimer, 1000);
+                r.extra[4] = SnapshotCodec::quantize(b.shootCooldown, 1000);
+                if (e.handle == bossHandle) world.boss = static_cast<std::int32_t>(i);
+                break;
+            }
+            case Entity::Type::Asteroid: {
+                const Asteroid& a = static_cast<const Asteroid&>(e);
+                r.variant = static_cast<std::uint8_t>(a.getSize());
+                r.extraCount = 1;
+                r.extra[0] = a.scoreValue;
+                break;
+            }
+            case Entity::Type::Bullet: {
+                const Bullet& b = static_cast<const Bullet&>(e);
+                r.variant = static_cast<std::uint8_t>(b.bulletType);
+                r.extraCount = 3;
+                r.extra[0] = b.damage;
+                r.extra[1] = entities.contains(b.target) ? static_cast<std::int32_t>(entities.indexOf(b.target)) : -1;
+                r.extra[2] = b.targetPoint;
+                break;
+            }
+            case Entity::Type::PowerUp: {
+                const PowerUp& p = static_cast<const PowerUp&>(e);
+                r.variant = static_cast<std::uint8_t>(p.itemType.upType);
+                r.extraCount = 1;
+                r.extra[0] = SnapshotCodec::quantize(p.age, 1000);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Timer targets become entity indices (handles mean nothing to a restored world). Timers of
+    // removed entities would fire as no-ops and are dropped; the rest are sorted by due time so the
+    // same world always gives the same bytes, whatever order the wheel's pool holds them in.
+    world.timers.clear();
+    timers.forEachPending([&](const TimerEvent& event, std::uint64_t remaining) {
+        TimerRecord t;
+        t.kind = event.kind;
+        t.arg = event.arg;
+        t.remaining = static_cast<std::uint32_t>(remaining);
+        if (!event.target.isNull()) {
+            if (!entities.contains(event.target)) return;
+            t.target = static_cast<std::int32_t>(entities.indexOf(event.target));
+        }
+        world.timers.push_back(t);
+    });
+    std::sort(world.timers.begin(), world.timers.end(), [](const TimerRecord& a, const TimerRecord& b) {
+        if (a.remaining != b.remaining) return a.remaining < b.remaining;
+        if (a.kind != b.kind) return a.kind < b.kind;
+        if (a.target != b.target) return a.target < b.target;
+        return a.arg < b.arg;
+    });
+
+    // Enemy shots in their array order (the delta coding relies on it); emitter sources become
+    // entity indices like timer targets
+    world.shots.resize(enemyShots.size());
+    for (std::size_t i = 0; i < enemyShots.size(); ++i) {
+        ShotRecord& r = world.shots[i];
+        r.x = SnapshotCodec::quantize(enemyShots.origin(i).x, SnapshotCodec::POS_SCALE);
+        r.y = SnapshotCodec::quantize(enemyShots.origin(i).y, SnapshotCodec::POS_SCALE);
+        r.vx = SnapshotCodec::quantize(enemyShots.velocity(i).x, SnapshotCodec::VEL_SCALE);
+        r.vy = SnapshotCodec::quantize(enemyShots.velocity(i).y, SnapshotCodec::VEL_SCALE);
+        r.age = static_cast<std::uint32_t>(simTick - enemyShots.bornAt(i));
+    }
+    world.emitters.clear();
+    for (const BulletPatterns::Emitter& e : enemyShots.activeEmitters()) {
+        if (!entities.contains(e.source)) continue;
+        EmitterRecord r;
+        r.pattern = static_cast<std::uint8_t>(e.pattern);
+        r.source = static_cast<std::int32_t>(entities.indexOf(e.source));
+        r.gun = e.gun;
+        r.volleysLeft = e.volleysLeft;
+        r.wait = e.wait;
+        r.aim = SnapshotCodec::quantizeAngle(e.aim);
+        world.emitters.push_back(r);
+    }
+
+    world.drones.resize(drones.size());
+    for (std::size_t i = 0; i < drones.size(); ++i) {
+        DroneRecord& r = world.drones[i];
+        r.x = SnapshotCodec::quantize(drones.position(i).x, SnapshotCodec::POS_SCALE);
+        r.y = SnapshotCodec::quantize(drones.position(i).y, SnapshotCodec::POS_SCALE);
+        r.vx = SnapshotCodec::quantize(drones.velocity(i).x, SnapshotCodec::VEL_SCALE);
+        r.vy = SnapshotCodec::quantize(drones.velocity(i).y, SnapshotCodec::VEL_SCALE);
+        r.age = static_cast<std::uint32_t>(simTick - drones.bornAt(i));
+    }
+}
+
+// Rebuilds the world from a snapshot. Entities are created through their constructors and
+// settings (for animations and constants), then the saved fields overwrite the rest.
+void Game::restoreSnapshot(const WorldSnapshot& world) {
+    entities.clear();
+    registry.clear();
+    timers.clear(world.simTick);
+    particles.clear();
+    enemyShots.clear();
+    drones.clear();
+    pendingBeams.clear();
+    beamTraces.clear();
+    clearBombQueue(); // A blast in progress is not saved: restoring ends it
+    tickJobs.reset(); // Pending housekeeping belonged to the replaced world
+    levelComplete = false;
+    playerHandle = EntityHandle();
+    bossHandle = EntityHandle();
+
+    currentMode = static_cast<PlayMode>(world.mode);
+    currentLevel = world.level;
+    placeWells();
+    simTick = world.simTick;
+    playTick = world.playTick;
+    respawnTick = world.respawnTick;
+
+    std::vector<EntityHandle> handles(world.entities.size());
+    Animation dummyAnim; // Player/PowerUp settings load their own animations
+    for (std::size_t i = 0; i < world.entities.size(); ++i) {
+        const EntityRecord& r = world.entities[i];
+        sf::Vector2f pos(SnapshotCodec::dequantize(r.x, SnapshotCodec::POS_SCALE), SnapshotCodec::dequantize(r.y, SnapshotCodec::POS_SCALE));
+        float angle = SnapshotCodec::dequantizeAngle(r.angle);
+        float radius = SnapshotCodec::dequantize(r.radius, SnapshotCodec::RADIUS_SCALE);
+
+        std::unique_ptr<Entity> entity;
+        switch (static_cast<Entity::Type>(r.type)) {
+            case Entity::Type::Player: {
+                auto player = std::make_unique<Player>();
+                player->settings(dummyAnim, pos);
+                player->setShipType(static_cast<Player::ShipType>(r.variant));
+                player->score = r.extra[0];
+                player->lives = r.extra[1];
+                player->shootTimer = SnapshotCodec::dequantize(r.extra[2], 1000);
+                player->shootCooldown = SnapshotCodec::dequantize(r.extra[3], 1000);
+                player->currentWeaponType = static_cast<Bullet::BulletType>(r.extra[4]);
+                player->thrust = r.extra[5] != 0;
+                entity = std::move(player);
+                break;
+            }
+            case Entity::Type::Boss: {
+                auto boss = std::make_unique<Boss>();
+                boss->settings(animBoss1, pos);
+                boss->health = r.extra[0];
+                boss->maxHealth = r.extra[1];
+                boss->currentPhase = r.extra[2];
+                boss->phaseTimer = SnapshotCodec::dequantize(r.extra[3], 1000);
+                boss->shootCooldown = SnapshotCodec::dequantize(r.extra[4], 1000);
+                entity = std::move(boss);
+                break;
+            }
+            case Entity::Type::Asteroid: {
+                auto asteroid = std::make_unique<Asteroid>(static_cast<Asteroid::Size>(r.variant));
+                Animation* animPtr = r.variant == 0 ? &animRockLarge : (r.variant == 1 ? &animRockMedium : &animRockSmall);
+                asteroid->settings(*animPtr, pos, angle, radius);
+                asteroid->scoreValue = r.extra[0];
+                entity = std::move(asteroid);
+                break;
+            }
+            case Entity::Type::Bullet: {
+                Bullet::BulletType bulletType = static_cast<Bullet::BulletType>(r.variant);
+                Animation* animPtr = bulletType == Bullet::BulletType::Laser ? &animBulletLaser
+                                   : (bulletType == Bullet::BulletType::Red ? &animBulletRed : &animBulletBlue);
+                auto bullet = std::make_unique<Bullet>(bulletType);
+                bullet->settings(*animPtr, pos, angle);
+                bullet->damage = r.extra[0];
+                entity = std::move(bullet);
+                break;
+            }
+            case Entity::Type::PowerUp: {
+                auto powerUp = std::make_unique<PowerUp>(static_cast<PowerUp::PowerUpType>(r.variant));
+                powerUp->settings(dummyAnim, pos, 0, radius);
+                powerUp->age = SnapshotCodec::dequantize(r.extra[0], 1000);
+                entity = std::move(powerUp);
+                break;
+            }
+            case Entity::Type::HazardMeteor: {
+                auto meteor = std::make_unique<HazardMeteor>();
+                meteor->settings(animHazardMeteor, pos, angle, radius);
+                entity = std::move(meteor);
+                break;
+            }
+            default:
+                LOG_WARN(LogCategory::Game, "Snapshot entity %d has unknown type %d, skipped", static_cast<int>(i), r.type);
+                continue;
+        }
+
+        entity->pos = pos;
+        entity->velocity = sf::Vector2f(SnapshotCodec::dequantize(r.vx, SnapshotCodec::VEL_SCALE), SnapshotCodec::dequantize(r.vy, SnapshotCodec::VEL_SCALE));
+        entity->angle = angle;
+        entity->R = radius;
+        entity->life = r.life;
+        entity->spawnTick = simTick - r.age;
+        // Inserted directly rather than through addEntity: lifetimes come back with the saved timers
+        Entity* raw = entity.get();
+        handles[i] = entities.insert(std::move(entity));
+        raw->handle = handles[i];
+        registry.add(*raw);
+    }
+
+    auto handleOf = [&](std::int32_t index) {
+        return index >= 0 && static_cast<std::size_t>(index) < handles.size() ? handles[index] : EntityHandle();
+    };
+    playerHandle = handleOf(world.player);
+    bossHandle = handleOf(world.boss);
+    for (std::size_t i = 0; i < world.entities.size(); ++i) {
+        const EntityRecord& r = world.entities[i];
+        if (static_cast<Entity::Type>(r.type) != Entity::Type::Bullet || r.extraCount < 3 || !entities.contains(handles[i])) continue;
+        Bullet* bullet = static_cast<Bullet*>(entities.get(handles[i])->get());
+        bullet->target = handleOf(r.extra[1]);
+        bullet->targetPoint = r.extra[2];
+    }
+    Player* player = getPlayer();
+    if (player) player->attachTimers(&timers, static_cast<std::uint16_t>(GameTimer::PlayerStatusEnd));
+
+    for (const TimerRecord& t : world.timers) {
+        std::uint64_t remaining = t.remaining > 0 ? t.remaining : 1;
+        EntityHandle target = handleOf(t.target);
+        if (static_cast<GameTimer>(t.kind) == GameTimer::PlayerStatusEnd && player && target == playerHandle) {
+            player->startStatusTicks(static_cast<Player::Status>(t.arg), remaining); // Re-arms the status as well
+            continue;
+        }
+        TimerEvent event;
+        event.kind = t.kind;
+        event.arg = t.arg;
+        event.target = target;
+        timers.schedule(remaining, event);
+    }
+
+    for (const ShotRecord& r : world.shots) {
+        sf::Vector2f origin(SnapshotCodec::dequantize(r.x, SnapshotCodec::POS_SCALE), SnapshotCodec::dequantize(r.y, SnapshotCodec::POS_SCALE));
+        sf::Vector2f velocity(SnapshotCodec::dequantize(r.vx, SnapshotCodec::VEL_SCALE), SnapshotCodec::dequantize(r.vy, SnapshotCodec::VEL_SCALE));
+        enemyShots.spawn(origin, velocity, simTick - r.age, simTick);
+    }
+    for (const EmitterRecord& r : world.emitters) {
+        BulletPatterns::Emitter e;
+        e.pattern = static_cast<BulletPatterns::PatternId>(r.pattern < BulletPatterns::PATTERN_COUNT ? r.pattern : 0);
+        e.source = handleOf(r.source);
+        e.gun = r.gun;
+        e.volleysLeft = r.volleysLeft;
+        e.wait = r.wait;
+        e.aim = SnapshotCodec::dequantizeAngle(r.aim);
+        if (!e.source.isNull()) enemyShots.restoreEmitter(e);
+    }
+    for (const DroneRecord& r : world.drones) {
+        sf::Vector2f pos(SnapshotCodec::dequantize(r.x, SnapshotCodec::POS_SCALE), SnapshotCodec::dequantize(r.y, SnapshotCodec::POS_SCALE));
+        sf::Vector2f velocity(SnapshotCodec::dequantize(r.vx, SnapshotCodec::VEL_SCALE), SnapshotCodec::dequantize(r.vy, SnapshotCodec::VEL_SCALE));
+        drones.spawn(pos, velocity, simTick - r.age);
+    }
+
+    Random::setState(world.rngState); // Last: the constructors above drew random numbers
+    fireRequested = false;
+    tickInput = PlayerInput();
+}
+
+void Game::saveSnapshot(const std::string& path) {
+    captureSnapshot(snapshotWorld);
+    std::vector<std::uint8_t> bytes;
+    snapshotCodec.encode(snapshotWorld, nullptr, bytes);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_ERROR(LogCategory::Game, "Could not open %s to save the snapshot", path);
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    LOG_INFO(LogCategory::Game, "Saved snapshot %s: tick %d, %d entities, %d bytes",
+             path, simTick, snapshotWorld.entities.size(), bytes.size());
+}
 
-        // 2. Handle Input (MUST BE CALLED EVERY FRAME)
-        // std::cout << "Calling handleInput()..." << std::endl; // DEBUG (Optional, can be noisy)
-        handleInput();
+void Game::loadSnapshot(const std::string& path) {
+    if (replaying) return; // A replay must follow its session
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_WARN(LogCategory::Game, "No snapshot at %s", path);
+        return;
+    }
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    try {
+        snapshotCodec.decode(bytes.data(), bytes.size(), nullptr, snapshotWorld);
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR(LogCategory::Game, "Could not load snapshot %s: %s", path, e.what());
+        return;
+    }
+
+    if (sessionWriter.isOpen()) {
+        sessionWriter.close(); // The recording can no longer be replayed from its seed
+        LOG_WARN(LogCategory::Game, "Session recording stopped: a snapshot was loaded");
+    }
+    restoreSnapshot(snapshotWorld);
+    rewind.clear(); // The history belongs to the world that was replaced
+    rewound = false;
+    updateHud();
+    if (currentState == State::Paused) updatePauseText();
+    LOG_INFO(LogCategory::Game, "Loaded snapshot %s: tick %d, %d entities", path, simTick, entities.size());
+
+    stopMusic();
+    if (currentState == State::Playing) resumeMusic();
+    steadyFrames = 0; // Loading allocates; restart the allocation check warm-up
+}
+
+// --- Rewind ---
+void Game::recordRewindFrame() {
+    auto start = std::chrono::steady_clock::now();
+    captureSnapshot(rewind.beginFrame());
+    rewind.commitFrame();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    rewindCaptureSeconds += seconds;
+    if (++rewindCaptures == TICK_RATE * REWIND_SECONDS && rewindCaptureSeconds / rewindCaptures > REWIND_CAPTURE_BUDGET * TICK_DT) {
+        LOG_WARN(LogCategory::Game, "Rewind capture takes %d us per tick, over its budget of %d us",
+                 static_cast<int>(rewindCaptureSeconds / rewindCaptures * 1e6), static_cast<int>(REWIND_CAPTURE_BUDGET * TICK_DT * 1e6));
+    }
+}
 
-        // 3. Update Game State (MUST BE CALLED EVERY FRAME)
-        // std::cout << "Calling update(" << dt << ")..." << std::endl; // DEBUG (Optional, can be noisy)
-        update(dt);
+// The newest frame is the paused world itself. Going back restores older frames; going forward
+// replays them, and past the newest frame simulates new ticks with the keys currently held.
+void Game::stepRewind(int ticks) {
+    if (!rewind.enabled() || rewind.frameCount() == 0 || replaying) return;
+    std::size_t newest = rewind.frameCount() - 1;
+    if (!rewound) rewindCursor = newest;
+
+    if (ticks > 0 && rewindCursor == newest) {
+        rewind.truncateAfter(rewindCursor);
+        for (int i = 0; i < ticks && currentState == State::Paused; ++i) updatePlaying(TICK_DT);
+        if (currentState != State::Paused) return; // The step ended the level or the game
+        rewindCursor = rewind.frameCount() - 1;
+    } else {
+        long target = static_cast<long>(rewindCursor) + ticks;
+        if (target < 0) target = 0;
+        if (target > static_cast<long>(newest)) target = static_cast<long>(newest);
+        try {
+            restoreSnapshot(rewind.frame(static_cast<std::size_t>(target)));
+        } catch (const std::runtime_error& e) {
+            LOG_ERROR(LogCategory::Game, "Rewind failed: %s", e.what());
+            return;
+        }
+        rewindCursor = static_cast<std::size_t>(target);
+        if (sessionWriter.isOpen()) {
+            sessionWriter.close(); // The recording can no longer be replayed from its seed
+            LOG_WARN(LogCategory::Game, "Session recording stopped: the world was rewound");
+        }
+    }
+    rewound = true;
+    updateHud();
+    updatePauseText();
+}
 
-        // 4. Render Graphics (MUST BE CALLED EVERY FRAME)
-        // std::cout << "Calling render()..." << std::endl; // DEBUG (Optional, can be noisy)
-        render(); // render() calls window.display() internally
+void Game::updatePauseText() {
+    std::string text = "PAUSED\n\n[Esc] Resume\n[M] Main Menu";
+    if (rewind.enabled()) {
+        text += "\n[Left/Right] Step  [Down/Up] 1 s";
+        if (rewound) text += "\nRewind: -" + std::to_string(rewind.frameCount() - 1 - rewindCursor) + " ticks";
     }
-     std::cout << "Exited main game loop." << std::endl; // DEBUG
+    messageText.setString(text);
+    messageText.setCharacterSize(40);
+    messageText.setOrigin(messageText.getLocalBounds().left + messageText.getLocalBounds().width / 2.f, messageText.getLocalBounds().top + messageText.getLocalBounds().height / 2.f);
+    messageText.setPosition(window.getSize().x / 2.f, window.getSize().y / 2.f);
 }
 
 // --- Input Handling ---
@@ -330,6 +1382,19 @@ void Game::handleInput() {
                 else if (currentState == State::Story) { /* Allow skipping story? setState(State::Playing); loadLevel(currentLevel); */ }
                 else if (currentState == State::MainMenu) window.close();
             }
+            if (event.key.code == sf::Keyboard::F5 || event.key.code == sf::Keyboard::F9) {
+                if (currentState == State::Playing || currentState == State::Paused) {
+                    if (event.key.code == sf::Keyboard::F5) saveSnapshot(SNAPSHOT_FILE);
+                    else loadSnapshot(SNAPSHOT_FILE);
+                }
+            }
+            if (event.key.code == sf::Keyboard::F3) logFramePacing("F3");
+            if (currentState == State::Paused) {
+                if (event.key.code == sf::Keyboard::Left) stepRewind(-1);
+                else if (event.key.code == sf::Keyboard::Right) stepRewind(1);
+                else if (event.key.code == sf::Keyboard::Down) stepRewind(-TICK_RATE);
+                else if (event.key.code == sf::Keyboard::Up) stepRewind(TICK_RATE);
+            }
             if (event.key.code == sf::Keyboard::M) {
                 if (currentState == State::Paused || currentState == State::GameOver) {
                     setState(State::MainMenu);
@@ -343,6 +1408,7 @@ void Game::handleInput() {
                 if (event.type == sf::Event::KeyPressed) {
                     if (event.key.code == sf::Keyboard::P) { currentMode = PlayMode::Campaign; setState(State::Playing); }
                     else if (event.key.code == sf::Keyboard::S) { currentMode = PlayMode::Survival; setState(State::Playing); }
+                    else if (event.key.code == sf::Keyboard::W) { currentMode = PlayMode::Swarm; setState(State::Playing); }
                     else if (event.key.code == sf::Keyboard::I) { setState(State::Instructions); }
                     else if (event.key.code == sf::Keyboard::N) {
                         cycleShipSelection();
@@ -356,14 +1422,12 @@ void Game::handleInput() {
 
             case State::Playing:
                 if (event.type == sf::Event::KeyPressed) {
-                    if (event.key.code == sf::Keyboard::Space && player && player->life) {
-                        player->shoot(); // Signal intent
-                        if (player->shootTimer <= 0) { // Check cooldown *before* spawning
-                            spawnBullet();
-                        }
+                    if (event.key.code == sf::Keyboard::Space) {
+                        if (!fireRequested) fireStampNs = InputSampler::nowNs(); // Events carry no time: stamp the poll
+                        fireRequested = true; // Consumed by the next Playing tick
                     }
                 }
-                // Player movement input is handled directly in Player::handleInput using isKeyPressed
+                // Movement keys are sampled once per tick in sampleInput
                 break;
 
             case State::GameOver:
@@ -410,29 +1474,44 @@ void Game::updateStory(float dt) {
 }
 
 void Game::updateLevelTransition(float dt) {
-    if (clock.getElapsedTime().asSeconds() > 2.0f) {
+    transitionTimer -= dt;
+    if (transitionTimer <= 0) {
         // Transition finished, show story for the *next* level
         showStory(currentLevel); // showStory handles the next state (Story or Playing)
     }
 }
 
+// One Playing tick: fix this tick's controls, simulate, then checksum if a session/replay/trace wants it
 void Game::updatePlaying(float dt) {
-    // 1. Handle Player Respawn Timer
-    if (playerRespawnTimer > 0) {
-        playerRespawnTimer -= dt;
-        if (playerRespawnTimer <= 0) {
+    if (!replaying && !options.headless) tickInput = sampleInput();
+    auto start = std::chrono::steady_clock::now();
+    stepPlaying(dt);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    tickMs += (ms - tickMs) * 0.1;
+    ++runTicks;
+    if (replaying || sessionWriter.isOpen() || sessionTrace.isOpen()) finishTick();
+    // A Swarm world is far too large to capture every tick: no rewind there
+    if (rewind.enabled() && currentMode != PlayMode::Swarm && (currentState == State::Playing || currentState == State::Paused)) recordRewindFrame();
+}
+
+void Game::stepPlaying(float dt) {
+    Player* player = getPlayer();
+    Boss* currentBoss = getBoss();
+
+    // 1. Handle Player Respawn (a play-tick deadline: the timer wheel runs on simTick, which is frozen while waiting)
+    ++playTick;
+    if (respawnPending()) {
+        if (playTick >= respawnTick) {
+            respawnTick = 0;
             if (player && player->lives > 0) { // Player was dead but has lives left
                 player->reset(); // Reset stats (pos, velocity, effects etc.)
-                player->pos = sf::Vector2f(window.getSize().x / 2.f, window.getSize().y / 2.f);
-                player->life = true; // Revive
-                player->shieldActive = true; // Respawn shield
-                player->shieldTimer = 2.0f;
+                player->pos = sf::Vector2f(FIELD_SIZE.x / 2.f, FIELD_SIZE.y / 2.f);
+                player->revive(); // Revive
+                player->startStatus(Player::Status::Shield, 2.0f); // Respawn shield
             } else if (!player) {
-                 // This case shouldn't ideally happen if logic is correct,
-                 // means player unique_ptr got deleted before respawn timer finished.
-                 // Maybe game over was triggered prematurely?
-                 // For safety, just transition to game over if player is gone.
-                 std::cerr << "Error: Respawn timer ended but player pointer is null." << std::endl;
+                 // The player handle went stale before the respawn timer finished
+                 // (entity removed). Treat it as game over rather than touching freed memory.
+                 LOG_WARN(LogCategory::Game, "Respawn timer ended but the player handle is stale.");
                  setState(State::GameOver);
                  return;
             }
@@ -443,95 +1522,216 @@ void Game::updatePlaying(float dt) {
     }
 
     // Check if player is null and not respawning -> Game Over
-    if (!player && playerRespawnTimer <= 0) {
+    if (!player && !respawnPending()) {
         if (currentState != State::GameOver) { // Prevent multiple calls
-             std::cout << "Player is null and not respawning. Triggering Game Over." << std::endl;
+             LOG_INFO(LogCategory::Game, "Player is null and not respawning. Triggering Game Over.");
              setState(State::GameOver);
         }
         return; // Stop updatePlaying if game over
     }
 
-    // 2. Handle Spawning
-    // Asteroids (only if no boss)
-    if (!currentBoss || !currentBoss->life) {
-        asteroidSpawnTimer -= dt;
-        if (asteroidSpawnTimer <= 0) {
-            int sizeRoll = rand() % 3;
-            Asteroid::Size spawnSize = (sizeRoll == 0) ? Asteroid::Size::Large : ((sizeRoll == 1) ? Asteroid::Size::Medium : Asteroid::Size::Small);
-            spawnAsteroid(spawnSize);
-            asteroidSpawnTimer = ASTEROID_SPAWN_RATE_BASE / (1.0f + currentLevel * 0.05f); // Increase rate slightly with level
-            if (asteroidSpawnTimer < 0.5f) asteroidSpawnTimer = 0.5f; // Cap spawn rate
-        }
-    }
-
-    // Hazard Meteors
-    hazardMeteorSpawnTimer -= dt;
-    if (hazardMeteorSpawnTimer <= 0) {
-        spawnHazardMeteor();
-        hazardMeteorSpawnTimer = HAZARD_METEOR_SPAWN_RATE * (0.8f + static_cast<float>(rand() % 40) / 100.f); // Randomize slightly
-    }
-
-    // Power-ups
-    powerUpSpawnTimer -= dt;
-    if (powerUpSpawnTimer <= 0) {
-        spawnPowerUp();
-        powerUpSpawnTimer = POWERUP_SPAWN_RATE_BASE * (0.9f + static_cast<float>(rand() % 20) / 100.f); // Randomize slightly
-    }
-
-    // 3. Update Entities
-    // Use explicit iterator loop to handle potential removals during update (though cleanup is separate)
-    for (auto it = entities.begin(); it != entities.end(); ++it) {
-        Entity* e = it->get();
-        if (e->life) {
-            e->update(dt, window.getSize());
-
-            // Trigger Boss shooting based on its internal timers
-            if (e->type == Entity::Type::Boss) {
-                Boss* boss = static_cast<Boss*>(e);
-                // Boss timers are decremented in Boss::updateShooting
-                // Game::spawnBossBullet checks if timer <= 0
-                if (boss->shootTimer1 <= 0) { spawnBossBullet(boss, 0); /* Boss resets its own timer */ }
-                if (boss->currentPhase > 0 && boss->shootTimer2 <= 0) { spawnBossBullet(boss, 1); }
-                if (boss->currentPhase > 1 && boss->shootTimer3 <= 0) { spawnBossBullet(boss, 2); }
+    // 2. Apply this tick's controls, then fire due timers: spawns, boss guns, lifetimes and player status expiry
+    if (player && player->life) {
+        player->setInput(tickInput);
+        if (tickInput.fire) {
+            player->shoot(); // Signal intent
+            if (player->shootTimer <= 0) { // Check cooldown *before* spawning
+                spawnBullet();
             }
         }
     }
+    ++simTick; // Entity time only advances here, so animations and timers freeze while respawning/paused
+    timers.advance(simTick, [this](const TimerEvent& event) { onTimer(event); });
+
+    // 3. Update Entities (gravity first: it only changes velocities, the updates move)
+    particles.update(dt);
+    applyGravity(dt);
+    // Index loop: spawns append while iterating (removal happens in cleanupEntities)
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        Entity* e = entities[i].get();
+        if (e->life) e->update(dt, FIELD_SIZE);
+    }
+    updateEnemyShots();
+    updateDrones();
 
     // 4. Check Collisions
-    checkCollisions();
+    {
+        AllocTracker::PhaseScope phase(AllocPhase::Collision);
+        checkCollisions();
+    }
 
-    // 5. Cleanup Entities marked as not alive
-    cleanupEntities();
+    // 5. Housekeeping: cleanup and the level check run when this tick's load leaves room, or
+    // once they reach their deadline. Dead entities may linger a few ticks; every pass skips them.
+    {
+        AllocTracker::PhaseScope phase(AllocPhase::Cleanup);
+        tickJobs.request(cleanupJob);
+        if (currentMode == PlayMode::Campaign) tickJobs.request(levelCheckJob);
+        // Update and collision passes visit each entity, and each enemy shot once
+        tickJobs.runSlice(TICK_WORK_BUDGET - 2.0 * entities.size() - static_cast<double>(enemyShots.size()));
+    }
+    frameJobs.request(hudJob);
+
+    // 6. Level Completion (Campaign Mode Only)
+    // Cleanup may have removed the player or boss: resolve the handles again
+    player = getPlayer();
+    currentBoss = getBoss();
+    if (currentMode == PlayMode::Campaign && levelComplete) {
+        // Can proceed if player is alive or if they are dead but have finished respawning (timer <= 0)
+        bool canProceed = (player && player->life) || !respawnPending();
+        if (!currentBoss && canProceed) { // Ensure no boss AND player ready
+            levelComplete = false;
+            nextLevel(); // Increment level counter
+            setState(State::LevelTransition);
+            return; // Exit updatePlaying early as state has changed
+        }
+    }
+     // --- Make sure no other logic runs if state changed during update ---
+     if (currentState != State::Playing) return;
+}
 
-    // 6. Update UI Text
-    if (player) { // Check if player still exists after cleanup
-        scoreText.setString("Score: " + std::to_string(player->score));
-        livesText.setString("Lives: " + std::to_string(player->lives));
-    } else {
-        // If player is gone and we are not yet in GameOver state (and not respawning), something's wrong.
-        // This case is now handled earlier by checking !player && playerRespawnTimer <= 0.
-        // If we reach here and player is null, it means cleanup just removed them.
-        // UI will update correctly on the next frame when state is GameOver.
-        scoreText.setString("Score: ---");
-        livesText.setString("Lives: 0");
+// --- Entity Handles ---
+// Every spawn goes through here: stamps the animation time base, attaches the pixel masks for its
+// texture and schedules any fixed lifetime
+EntityHandle Game::addEntity(std::unique_ptr<Entity> entity) {
+    entity->spawnTick = simTick;
+    std::uint64_t lifetime = entity->lifetimeTicks();
+    Entity* raw = entity.get();
+    EntityHandle handle = entities.insert(std::move(entity));
+    raw->handle = handle;
+    raw->masks = masksFor(raw->anim.sprite.getTexture());
+    registry.add(*raw);
+    if (lifetime) {
+        TimerEvent event;
+        event.kind = static_cast<std::uint16_t>(GameTimer::EntityExpire);
+        event.target = handle;
+        timers.schedule(lifetime, event);
     }
-    levelText.setString(((currentMode == PlayMode::Campaign) ? "Level: " : "Wave: ") + std::to_string(currentLevel));
+    return handle;
+}
 
-    // 7. Check Level Completion (Campaign Mode Only)
-    if (currentMode == PlayMode::Campaign) {
-        bool levelDone = checkLevelComplete();
-        if (levelDone) {
-            // Can proceed if player is alive or if they are dead but have finished respawning (timer <= 0)
-            bool canProceed = (player && player->life) || playerRespawnTimer <= 0;
-            if (!currentBoss && canProceed) { // Ensure no boss AND player ready
-                nextLevel(); // Increment level counter
-                setState(State::LevelTransition);
-                return; // Exit updatePlaying early as state has changed
+// --- Gameplay Timers ---
+TimerId Game::scheduleTimer(GameTimer kind, float seconds, int arg, EntityHandle target) {
+    TimerEvent event;
+    event.kind = static_cast<std::uint16_t>(kind);
+    event.arg = arg;
+    event.target = target;
+    return timers.schedule(secondsToTicks(seconds), event);
+}
+
+void Game::scheduleSpawnTimers() {
+    scheduleTimer(GameTimer::SpawnAsteroid, ASTEROID_SPAWN_RATE_BASE);
+    scheduleTimer(GameTimer::SpawnPowerUp, POWERUP_SPAWN_RATE_BASE);
+    scheduleTimer(GameTimer::SpawnHazardMeteor, HAZARD_METEOR_SPAWN_RATE);
+}
+
+void Game::startRespawnDelay() {
+    respawnTick = playTick + secondsToTicks(PLAYER_RESPAWN_DELAY);
+}
+
+// Entity-targeted events check their handle: the entity may be gone by the time they fire
+void Game::onTimer(const TimerEvent& event) {
+    switch (static_cast<GameTimer>(event.kind)) {
+        case GameTimer::SpawnAsteroid: {
+            // No asteroids while a boss is up; the timer keeps running so they resume afterwards
+            Boss* boss = getBoss();
+            if ((!boss || !boss->life) && registry.liveCount(Entity::Type::Asteroid) < MAX_LIVE_ASTEROIDS) {
+                int sizeRoll = Random::range(3);
+                Asteroid::Size spawnSize = (sizeRoll == 0) ? Asteroid::Size::Large : ((sizeRoll == 1) ? Asteroid::Size::Medium : Asteroid::Size::Small);
+                spawnAsteroid(spawnSize);
+            }
+            float next = ASTEROID_SPAWN_RATE_BASE / (1.0f + currentLevel * 0.05f); // Increase rate slightly with level
+            if (next < 0.5f) next = 0.5f; // Cap spawn rate
+            scheduleTimer(GameTimer::SpawnAsteroid, next);
+            break;
+        }
+        case GameTimer::SpawnHazardMeteor:
+            if (registry.liveCount(Entity::Type::HazardMeteor) < MAX_LIVE_METEORS) spawnHazardMeteor();
+            scheduleTimer(GameTimer::SpawnHazardMeteor, HAZARD_METEOR_SPAWN_RATE * (0.8f + static_cast<float>(Random::range(40)) / 100.f)); // Randomize slightly
+            break;
+        case GameTimer::SpawnPowerUp:
+            if (registry.liveCount(Entity::Type::PowerUp) < MAX_LIVE_POWERUPS) spawnPowerUp();
+            scheduleTimer(GameTimer::SpawnPowerUp, POWERUP_SPAWN_RATE_BASE * (0.9f + static_cast<float>(Random::range(20)) / 100.f)); // Randomize slightly
+            break;
+        case GameTimer::EntityExpire:
+            if (std::unique_ptr<Entity>* slot = entities.get(event.target)) (*slot)->kill(); // Fixed lifetime ran out
+            break;
+        case GameTimer::PlayerStatusEnd:
+            if (event.target == playerHandle) {
+                if (Player* player = getPlayer()) player->endStatus(static_cast<Player::Status>(event.arg));
             }
+            break;
+        case GameTimer::SwarmWave:
+            spawnSwarmWave();
+            scheduleTimer(GameTimer::SwarmWave, SWARM_WAVE_INTERVAL);
+            break;
+        case GameTimer::SpawnDrones:
+            if (static_cast<int>(drones.size()) + DRONE_PACK <= MAX_LIVE_DRONES) spawnDronePack(DRONE_PACK);
+            scheduleTimer(GameTimer::SpawnDrones, DRONE_SPAWN_RATE);
+            break;
+        case GameTimer::BossShoot: {
+            std::unique_ptr<Entity>* slot = entities.get(event.target);
+            if (!slot || !(*slot)->life) break; // Boss gone: the gun stops
+            Boss* boss = static_cast<Boss*>(slot->get());
+            if (boss->currentPhase >= event.arg) fireBossPattern(boss, event.arg); // Reschedules itself
+            else scheduleTimer(GameTimer::BossShoot, boss->shootCooldown, event.arg, event.target); // Gun N opens in phase N
+            break;
         }
     }
-     // --- Make sure no other logic runs if state changed during update ---
-     if (currentState != State::Playing) return;
+}
+
+// Resolve the player/boss handles; nullptr once the entity has been removed
+Player* Game::getPlayer() {
+    std::unique_ptr<Entity>* slot = entities.get(playerHandle);
+    return slot ? static_cast<Player*>(slot->get()) : nullptr;
+}
+
+Boss* Game::getBoss() {
+    std::unique_ptr<Entity>* slot = entities.get(bossHandle);
+    return slot ? static_cast<Boss*>(slot->get()) : nullptr;
+}
+
+// --- HUD ---
+void Game::updateHud() {
+    Player* player = getPlayer();
+    // If player is null here, cleanup just removed them; the state switches to GameOver next frame
+    int score = player ? player->score : INT_MIN + 1; // "---", distinct from the never-shown INT_MIN
+    int lives = player ? player->lives : 0;
+    char line[32];
+
+    if (score != hudScore) {
+        hudScore = score;
+        if (player) std::snprintf(line, sizeof(line), "Score: %d", score);
+        else std::snprintf(line, sizeof(line), "Score: ---");
+        setHudText(scoreText, line);
+    }
+    if (lives != hudLives) {
+        hudLives = lives;
+        std::snprintf(line, sizeof(line), "Lives: %d", lives);
+        setHudText(livesText, line);
+    }
+    if (currentLevel != hudLevel || currentMode != hudMode) {
+        hudLevel = currentLevel;
+        hudMode = currentMode;
+        std::snprintf(line, sizeof(line), "%s%d", (currentMode == PlayMode::Campaign) ? "Level: " : "Wave: ", currentLevel);
+        setHudText(levelText, line);
+    }
+}
+
+void Game::updateSwarmOverlay() {
+    swarmOverlayFrames = SWARM_OVERLAY_INTERVAL;
+    char line[160];
+    std::snprintf(line, sizeof(line), "Entities: %d | Asteroids: %d | Meteors: %d | Drones: %zu\nTick %.2f ms | Pair tests: %llu",
+                  registry.liveTotal(), registry.liveCount(Entity::Type::Asteroid), registry.liveCount(Entity::Type::HazardMeteor),
+                  drones.size(), tickMs, pairTests);
+    setHudText(swarmText, line);
+}
+
+// Rebuilds the shared buffer in place (keeping its capacity) and copies it into the text,
+// which reuses its own string capacity as well
+void Game::setHudText(sf::Text& text, const char* value) {
+    hudBuffer.clear();
+    for (const char* c = value; *c; ++c) hudBuffer += sf::String(static_cast<sf::Uint32>(static_cast<unsigned char>(*c)));
+    text.setString(hudBuffer);
 }
 
 // --- Rendering Dispatcher ---
@@ -540,32 +1740,59 @@ void Game::render() {
     window.clear(sf::Color::Black);
 
     // Draw Background
-    try {
-        sf::Sprite backgroundSprite(resourceManager.getTexture("background.jpg"));
-        backgroundSprite.setScale(
-            static_cast<float>(window.getSize().x) / backgroundSprite.getLocalBounds().width,
-            static_cast<float>(window.getSize().y) / backgroundSprite.getLocalBounds().height);
-        window.draw(backgroundSprite);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error rendering background: " << e.what() << std::endl;
+    if (backgroundSprite.getTexture()) window.draw(backgroundSprite);
+    for (const sf::Vector2f& well : wells) {
+        wellHalo.setPosition(well);
+        wellCore.setPosition(well);
+        window.draw(wellHalo);
+        window.draw(wellCore);
     }
 
-    // Draw Entities (Effects first for layering)
-    for (const auto& entity : entities) {
-        if (entity->type == Entity::Type::Effect) entity->draw(window);
+    // Draw particles first (layered under entities)
+    Player* player = getPlayer();
+    particles.draw(window);
+    // Rocks are the bulk of the world: batched into one draw call per texture
+    int frameStep = QualityController::getInstance().settings().animationStep;
+    for (Entity::Type type : { Entity::Type::Asteroid, Entity::Type::HazardMeteor }) {
+        for (EntityHandle handle : registry.handles(type)) {
+            Entity* rock = entities.get(handle)->get();
+            if (!rock->life) continue;
+            rock->anim.apply(simTick - rock->spawnTick, frameStep);
+            rockBatch.add(rock->anim.sprite, rock->pos, rock->angle);
+        }
+    }
+    rockBatch.draw(window);
+    // Boss shots: thousands at a time, all the same art
+    for (std::size_t i = 0; i < enemyShots.size(); ++i) {
+        animBulletRed.apply(simTick - enemyShots.bornAt(i), frameStep);
+        shotBatch.add(animBulletRed.sprite, enemyShots.position(i), enemyShots.heading(i));
     }
-    for (const auto& entity : entities) {
-        // Draw all non-effects, excluding player (drawn last)
-        if (entity->type != Entity::Type::Effect && entity.get() != player) entity->draw(window);
+    shotBatch.draw(window);
+    // Hunter drones: one batch, each pointing along its velocity
+    for (std::size_t i = 0; i < drones.size(); ++i) droneBatch.add(animDrone.sprite, drones.position(i), drones.heading(i));
+    droneBatch.draw(window);
+    // Laser beams: the laser art stretched along the beam, fading out
+    for (const BeamTrace& trace : beamTraces) {
+        std::uint64_t age = simTick - trace.tick;
+        if (age >= static_cast<std::uint64_t>(BEAM_TRACE_TICKS)) continue;
+        animBulletLaser.apply(age, frameStep);
+        sf::Sprite beam(animBulletLaser.sprite);
+        sf::FloatRect frame = beam.getLocalBounds();
+        beam.setOrigin(frame.width / 2.f, frame.height);
+        beam.setScale(1.f, trace.length / frame.height);
+        beam.setRotation(trace.angle);
+        beam.setPosition(trace.from);
+        beam.setColor(sf::Color(255, 255, 255, static_cast<sf::Uint8>(255 - 255 * age / BEAM_TRACE_TICKS)));
+        window.draw(beam);
+    }
+    // Everything else one by one (player drawn last)
+    for (Entity::Type type : { Entity::Type::Generic, Entity::Type::PowerUp, Entity::Type::PowerDown, Entity::Type::Boss, Entity::Type::Bullet }) {
+        for (EntityHandle handle : registry.handles(type)) (*entities.get(handle))->draw(window, simTick);
     }
     // Draw player last if alive (handles overlays internally)
-    if (player) {
-        // std::cout << "Attempting to draw player. Life: " << player->life << std::endl; // DEBUG
-        if (player->life) {
-            player->draw(window);
-        }
-    } else {
-        std::cout << "Player pointer is null, cannot draw." << std::endl; // DEBUG
+    // (player is legitimately null after Game Over cleanup, so no per-frame log here)
+    if (player && player->life) {
+        player->draw(window, simTick);
     }
 
 
@@ -580,6 +1807,9 @@ void Game::render() {
         case State::Paused:         renderPaused(); break;
     }
 
+    // Everything up to here is this frame's work; presenting (and any vsync wait) is not
+    QualityController::getInstance().frameWorked(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - frameWorkStart).count());
     window.display();
 }
 
@@ -589,7 +1819,7 @@ void Game::renderMainMenu() {
     // std::cout << "renderMainMenu() called." << std::endl; // DEBUG
     // Kiểm tra xem font có hợp lệ không trước khi vẽ
     if (uiFont.getInfo().family.empty()) {
-         std::cerr << "WARNING: Attempting to render MainMenu with invalid font!" << std::endl;
+         LOG_WARN(LogCategory::Game, "Attempting to render MainMenu with invalid font!");
          // Vẽ hình chữ nhật thay thế để biết hàm có chạy không
          sf::RectangleShape rect(sf::Vector2f(200, 100));
          rect.setFillColor(sf::Color::Red);
@@ -617,24 +1847,22 @@ void Game::renderPlaying() {
     window.draw(scoreText);
     window.draw(livesText);
     window.draw(levelText);
+    if (currentMode == PlayMode::Swarm) {
+        if (--swarmOverlayFrames <= 0) updateSwarmOverlay();
+        window.draw(swarmText);
+    }
 
     // Draw boss health bar if boss exists and is alive
+    Boss* currentBoss = getBoss();
     if (currentBoss && currentBoss->life) {
-        float barWidth = 300.f;
-        float barHeight = 15.f;
         float healthPercent = static_cast<float>(currentBoss->health) / currentBoss->maxHealth;
         if (healthPercent < 0) healthPercent = 0; // Clamp health display
 
-        sf::RectangleShape backgroundBar(sf::Vector2f(barWidth, barHeight));
-        backgroundBar.setFillColor(sf::Color(100, 100, 100, 200));
-        backgroundBar.setPosition(window.getSize().x / 2.f - barWidth / 2.f, 20.f);
-
-        sf::RectangleShape healthBar(sf::Vector2f(barWidth * healthPercent, barHeight));
-        healthBar.setFillColor(sf::Color(200, 0, 0, 200));
-        healthBar.setPosition(window.getSize().x / 2.f - barWidth / 2.f, 20.f);
+        const sf::Vector2f& fullSize = bossBarBackground.getSize();
+        bossBarFill.setSize(sf::Vector2f(fullSize.x * healthPercent, fullSize.y));
 
-        window.draw(backgroundBar);
-        window.draw(healthBar);
+        window.draw(bossBarBackground);
+        window.draw(bossBarFill);
     }
 }
 
@@ -654,9 +1882,7 @@ void Game::renderPaused() {
     renderPlaying(); // Draw the paused game state underneath
 
     // Draw semi-transparent overlay
-    sf::RectangleShape overlay(sf::Vector2f(window.getSize()));
-    overlay.setFillColor(sf::Color(0, 0, 0, 150)); // Black with alpha
-    window.draw(overlay);
+    window.draw(pauseOverlay);
 
     // Draw Pause message text on top
     window.draw(messageText);
@@ -666,8 +1892,9 @@ void Game::renderPaused() {
 // --- Game Logic Helpers ---
 
 void Game::loadLevel(int levelNum) {
-    std::cout << "--- Loading Level: " << levelNum << " ---" << std::endl;
+    LOG_INFO(LogCategory::Game, "--- Loading Level: %d ---", levelNum);
     resetGame(false); // Partial reset (keeps score, lives, selected ship)
+    placeWells();
 
     // Player is guaranteed to exist after resetGame(false) calls spawnPlayer
 
@@ -684,27 +1911,29 @@ void Game::loadLevel(int levelNum) {
     // Spawn Boss?
     if (currentMode == PlayMode::Campaign && levelNum > 0 && levelNum % BOSS_LEVEL_INTERVAL == 0) {
         spawnBoss(levelNum);
-        backgroundMusic.stop();
-        bossMusic.play();
-    } else {
+        if (audio) {
+            audio->backgroundMusic.stop();
+            audio->bossMusic.play();
+        }
+    } else if (audio) {
         // Ensure boss music is stopped and background music plays if no boss
-        if (bossMusic.getStatus() == sf::Music::Playing) bossMusic.stop();
-        if (backgroundMusic.getStatus() != sf::Music::Playing) backgroundMusic.play();
+        if (audio->bossMusic.getStatus() == sf::Music::Playing) audio->bossMusic.stop();
+        if (audio->backgroundMusic.getStatus() != sf::Music::Playing) audio->backgroundMusic.play();
     }
 
-    // Reset spawn timers for the new level
-    asteroidSpawnTimer = ASTEROID_SPAWN_RATE_BASE;
-    powerUpSpawnTimer = POWERUP_SPAWN_RATE_BASE;
-    hazardMeteorSpawnTimer = HAZARD_METEOR_SPAWN_RATE;
-    playerRespawnTimer = 0.f; // Ensure player starts active
+    // Fresh spawn timers for the new level (resetGame cleared the wheel)
+    scheduleSpawnTimers();
+    respawnTick = 0; // Ensure player starts active
 
-    std::cout << "--- Level " << levelNum << " loading complete. Entity count: " << entities.size() << " ---" << std::endl;
+    LOG_INFO(LogCategory::Game, "--- Level %d loading complete. Entity count: %d (%d asteroids) ---",
+             levelNum, entities.size(), registry.liveCount(Entity::Type::Asteroid));
 }
 
 void Game::startSurvival() {
-    std::cout << "Starting Survival Mode" << std::endl;
+    LOG_INFO(LogCategory::Game, "Starting Survival Mode");
     resetGame(true); // Full reset for survival mode
     currentLevel = 1; // Survival starts at wave 1
+    placeWells();
 
     // Player should exist after resetGame(true)
 
@@ -712,22 +1941,78 @@ void Game::startSurvival() {
         spawnAsteroid(Asteroid::Size::Large);
     }
 
-    asteroidSpawnTimer = ASTEROID_SPAWN_RATE_BASE;
-    powerUpSpawnTimer = POWERUP_SPAWN_RATE_BASE;
-    hazardMeteorSpawnTimer = HAZARD_METEOR_SPAWN_RATE;
-    playerRespawnTimer = 0.f;
+    scheduleSpawnTimers();
+    scheduleTimer(GameTimer::SpawnDrones, DRONE_SPAWN_RATE);
+    respawnTick = 0;
 
-    bossMusic.stop(); // Ensure no boss music
-    backgroundMusic.play();
+    stopMusic(); // Ensure no boss music
+    resumeMusic();
     // Set state to Playing *after* setup is complete
     setState(State::Playing);
 }
 
+// Survival at load-test scale: the field is topped up towards options.swarmTarget asteroids (and
+// a share of hazard meteors and hunter drones) every wave, and the player cannot be hurt
+void Game::startSwarm() {
+    int target = options.swarmTarget;
+    LOG_INFO(LogCategory::Game, "Starting Swarm Survival: ramping to %d asteroids", target);
+    resetGame(true);
+    currentLevel = 1;
+    placeWells();
+
+    // Room for the whole swarm up front, so the ramp never reallocates mid-run
+    std::size_t capacity = static_cast<std::size_t>(target + target / SWARM_METEOR_SHARE) + ENTITY_RESERVE;
+    entities.reserve(capacity);
+    registry.reserve(capacity);
+    collisionGrid.reserve(capacity);
+    rockSolver.reserve(capacity, capacity * ROCK_CONTACTS_PER_BODY);
+    rockBodies.reserve(capacity);
+    gravity.reserve(capacity, capacity);
+    gravityBodies.reserve(capacity);
+    collisionPairs.reserve(capacity);
+    bombQueue.reserve(capacity);
+    bombSeeds.reserve(capacity);
+    rockBatch.reserve(capacity);
+    EntityPool::reserve(sizeof(Asteroid), capacity);
+    EntityPool::reserve(sizeof(HazardMeteor), static_cast<std::size_t>(target / SWARM_METEOR_SHARE) + 256); // Plus the dead awaiting cleanup
+    std::size_t droneCapacity = std::max(DRONE_CAPACITY, static_cast<std::size_t>(target / SWARM_DRONE_SHARE));
+    drones.reserve(droneCapacity);
+    droneBatch.reserve(droneCapacity);
+
+    scheduleSpawnTimers();
+    scheduleTimer(GameTimer::SwarmWave, SWARM_WAVE_INTERVAL);
+    respawnTick = 0;
+    swarmOverlayFrames = 0;
+
+    stopMusic();
+    resumeMusic();
+    setState(State::Playing);
+}
+
+void Game::spawnSwarmWave() {
+    int target = options.swarmTarget;
+    int waves = static_cast<int>(SWARM_RAMP_SECONDS / SWARM_WAVE_INTERVAL);
+    int perWave = std::max(1, target / waves);
+
+    int asteroids = std::min(perWave, target - registry.liveCount(Entity::Type::Asteroid));
+    for (int i = 0; i < asteroids; ++i) {
+        int sizeRoll = Random::range(3);
+        spawnAsteroid(sizeRoll == 0 ? Asteroid::Size::Large : (sizeRoll == 1 ? Asteroid::Size::Medium : Asteroid::Size::Small));
+    }
+    int meteorTarget = target / SWARM_METEOR_SHARE;
+    int meteors = std::min(std::max(1, perWave / SWARM_METEOR_SHARE), meteorTarget - registry.liveCount(Entity::Type::HazardMeteor));
+    for (int i = 0; i < meteors; ++i) spawnHazardMeteor();
+    int droneTarget = target / SWARM_DRONE_SHARE;
+    int newDrones = std::min(std::max(1, perWave / SWARM_DRONE_SHARE), droneTarget - static_cast<int>(drones.size()));
+    if (newDrones > 0) spawnDronePack(newDrones);
+}
+
 void Game::resetGame(bool fullReset) {
     // Store player stats if not a full reset and player exists
     int previousScore = 0;
     int previousLives = 3; // Default starting lives
     Player::ShipType shipToUse = selectedShipType; // Default to selection
+    Player* player = getPlayer();
 
     if (!fullReset && player) {
         previousScore = player->score;
@@ -735,13 +2020,22 @@ void Game::resetGame(bool fullReset) {
         shipToUse = player->currentShipType; // Keep the ship they were using
     }
 
-    // Clear all entities
+    // Clear all entities (invalidates the player and boss handles) and every pending timer with them
     entities.clear();
-    player = nullptr;
-    currentBoss = nullptr;
+    registry.clear();
+    timers.clear(simTick);
+    particles.clear();
+    enemyShots.clear();
+    drones.clear();
+    wells.clear();
+    pendingBeams.clear();
+    beamTraces.clear();
+    clearBombQueue();
+    levelComplete = false;
 
     // Always respawn player object after clearing
-    spawnPlayer(); // Creates the player object and sets the raw pointer
+    spawnPlayer(); // Creates the player object and sets playerHandle
+    player = getPlayer();
 
     if (fullReset) {
         currentLevel = 1; // Reset level for full reset
@@ -759,24 +2053,24 @@ void Game::resetGame(bool fullReset) {
             player->lives = previousLives;
             player->setShipType(shipToUse); // Restore the correct ship type
             player->reset(); // Reset position, velocity, effects etc.
-            player->pos = sf::Vector2f(window.getSize().x / 2.f, window.getSize().y / 2.f);
-            player->life = true; // Ensure player is alive
+            player->pos = sf::Vector2f(FIELD_SIZE.x / 2.f, FIELD_SIZE.y / 2.f);
+            player->revive(); // Ensure player is alive
         }
     }
 }
 
 void Game::spawnPlayer() {
-    // if (player) return; // Should be null after entities.clear() in resetGame
+    // Any previous player handle is stale after entities.clear() in resetGame
 
     auto newPlayer = std::make_unique<Player>();
-    player = newPlayer.get(); // Get raw pointer BEFORE moving ownership
 
     Animation dummyAnim; // Player::settings loads its own textures/anims
-    player->settings(dummyAnim, sf::Vector2f(window.getSize().x / 2.f, window.getSize().y / 2.f));
+    newPlayer->settings(dummyAnim, sf::Vector2f(FIELD_SIZE.x / 2.f, FIELD_SIZE.y / 2.f));
     // Score/lives/ship type are handled by resetGame logic calling this
 
-    entities.push_back(std::move(newPlayer)); // Add to entity list
-    std::cout << "Player spawned/re-added." << std::endl;
+    playerHandle = addEntity(std::move(newPlayer)); // Add to entity map
+    getPlayer()->attachTimers(&timers, static_cast<std::uint16_t>(GameTimer::PlayerStatusEnd));
+    LOG_DEBUG(LogCategory::Player, "Player spawned/re-added.");
 }
 
 void Game::spawnAsteroid(Asteroid::Size size, sf::Vector2f pos) {
@@ -788,39 +2082,39 @@ void Game::spawnAsteroid(Asteroid::Size size, sf::Vector2f pos) {
         case Asteroid::Size::Large:  animPtr = &animRockLarge; radius = 25.f; break;
         case Asteroid::Size::Medium: animPtr = &animRockMedium; radius = 15.f; break;
         case Asteroid::Size::Small:  animPtr = &animRockSmall; radius = 8.f; break;
-        default: std::cerr << "Error: Invalid asteroid size requested!" << std::endl; return;
+        default: LOG_ERROR(LogCategory::Entity, "Invalid asteroid size requested!"); return;
     }
 
     // Calculate random edge position if not provided
     if (pos.x == -100 && pos.y == -100) { // Use the default value as a flag
-        int edge = rand() % 4;
+        int edge = Random::range(4);
         float spawnX = 0, spawnY = 0;
         switch(edge) {
             case 0: // Top
-                spawnX = static_cast<float>(rand() % WINDOW_WIDTH);
+                spawnX = static_cast<float>(Random::range(WINDOW_WIDTH));
                 spawnY = -radius;
                 break;
             case 1: // Right
                 spawnX = static_cast<float>(WINDOW_WIDTH + radius);
-                spawnY = static_cast<float>(rand() % WINDOW_HEIGHT);
+                spawnY = static_cast<float>(Random::range(WINDOW_HEIGHT));
                 break;
             case 2: // Bottom
-                spawnX = static_cast<float>(rand() % WINDOW_WIDTH);
+                spawnX = static_cast<float>(Random::range(WINDOW_WIDTH));
                 spawnY = static_cast<float>(WINDOW_HEIGHT + radius);
                 break;
             case 3: // Left
                 spawnX = -radius;
-                spawnY = static_cast<float>(rand() % WINDOW_HEIGHT);
+                spawnY = static_cast<float>(Random::range(WINDOW_HEIGHT));
                 break;
         }
         pos = sf::Vector2f(spawnX, spawnY);
     }
 
-    asteroid->settings(*animPtr, pos, static_cast<float>(rand() % 360), radius);
+    asteroid->settings(*animPtr, pos, static_cast<float>(Random::range(360)), radius);
     if (asteroid->type != Entity::Type::Asteroid) { // Sanity check after settings
-        std::cerr << "Warning: Spawned asteroid does not have Asteroid type!" << std::endl;
+        LOG_WARN(LogCategory::Entity, "Spawned asteroid does not have Asteroid type!");
     }
-    entities.push_back(std::move(asteroid));
+    addEntity(std::move(asteroid));
 }
 
 void Game::spawnHazardMeteor() {
@@ -828,33 +2122,34 @@ void Game::spawnHazardMeteor() {
      float radius = 20.f;
      sf::Vector2f pos;
 
-     int edge = rand() % 4;
+     int edge = Random::range(4);
      float spawnX = 0, spawnY = 0;
      switch(edge) {
-         case 0: spawnX = static_cast<float>(rand() % WINDOW_WIDTH); spawnY = -radius; break;
-         case 1: spawnX = static_cast<float>(WINDOW_WIDTH + radius); spawnY = static_cast<float>(rand() % WINDOW_HEIGHT); break;
-         case 2: spawnX = static_cast<float>(rand() % WINDOW_WIDTH); spawnY = static_cast<float>(WINDOW_HEIGHT + radius); break;
-         case 3: spawnX = -radius; spawnY = static_cast<float>(rand() % WINDOW_HEIGHT); break;
+         case 0: spawnX = static_cast<float>(Random::range(WINDOW_WIDTH)); spawnY = -radius; break;
+         case 1: spawnX = static_cast<float>(WINDOW_WIDTH + radius); spawnY = static_cast<float>(Random::range(WINDOW_HEIGHT)); break;
+         case 2: spawnX = static_cast<float>(Random::range(WINDOW_WIDTH)); spawnY = static_cast<float>(WINDOW_HEIGHT + radius); break;
+         case 3: spawnX = -radius; spawnY = static_cast<float>(Random::range(WINDOW_HEIGHT)); break;
      }
      pos = sf::Vector2f(spawnX, spawnY);
 
-     meteor->settings(animHazardMeteor, pos, static_cast<float>(rand() % 360), radius);
+     meteor->settings(animHazardMeteor, pos, static_cast<float>(Random::range(360)), radius);
       if (meteor->type != Entity::Type::HazardMeteor) { // Sanity check
-        std::cerr << "Warning: Spawned hazard meteor does not have HazardMeteor type!" << std::endl;
+        LOG_WARN(LogCategory::Entity, "Spawned hazard meteor does not have HazardMeteor type!");
       }
-     entities.push_back(std::move(meteor));
+     addEntity(std::move(meteor));
 }
 
 void Game::spawnBullet() {
     // Cooldown check is done in handleInput before calling this
+    Player* player = getPlayer();
     if (!player || !player->life) {
-        std::cerr << "SpawnBullet called but player is null or dead." << std::endl;
+        LOG_WARN(LogCategory::Game, "SpawnBullet called but player is null or dead.");
         return;
     }
 
     // Reset cooldown and play sound *now* that we know we are spawning
     player->shootTimer = player->shootCooldown;
-    shootSound.play();
+    playSound(&Audio::shootSound);
 
     Bullet::BulletType typeToSpawn = player->currentWeaponType;
     Animation* animPtr = nullptr;
@@ -866,11 +2161,12 @@ void Game::spawnBullet() {
         case Bullet::BulletType::Laser:    animPtr = &animBulletLaser; bulletsToSpawn = 1; break;
         case Bullet::BulletType::Spread:   animPtr = &animBulletBlue; bulletsToSpawn = 3; break;
         case Bullet::BulletType::Red:      animPtr = &animBulletRed; bulletsToSpawn = 1; break; // Ensure Red is intended for player
-        default: std::cerr << "Error: Unknown bullet type requested!" << std::endl; return;
+        case Bullet::BulletType::Homing:   animPtr = &animBulletBlue; bulletsToSpawn = 1; break;
+        default: LOG_ERROR(LogCategory::Entity, "Unknown bullet type requested!"); return;
     }
 
     if (!animPtr) { // Should not happen if switch is exhaustive
-         std::cerr << "Error: Could not find animation pointer for bullet type " << static_cast<int>(typeToSpawn) << std::endl;
+         LOG_ERROR(LogCategory::Entity, "Could not find animation pointer for bullet type %d", typeToSpawn);
          player->shootTimer = 0; // Allow immediate retry if anim failed
          return;
     }
@@ -881,6 +2177,12 @@ void Game::spawnBullet() {
     sf::Vector2f offsetVecBase = sf::Vector2f(std::cos(angleRadBase) * offsetDist, std::sin(angleRadBase) * offsetDist);
     sf::Vector2f spawnPosBase = player->pos + offsetVecBase;
 
+    // The laser is a beam, not a projectile: it resolves this tick in checkCollisions
+    if (typeToSpawn == Bullet::BulletType::Laser) {
+        if (pendingBeams.size() < BEAM_RESERVE) pendingBeams.push_back(BeamShot{spawnPosBase, baseAngle});
+        return;
+    }
+
     for (int i = 0; i < bulletsToSpawn; ++i) {
         auto bullet = std::make_unique<Bullet>(typeToSpawn);
         float shotAngle = baseAngle;
@@ -893,62 +2195,92 @@ void Game::spawnBullet() {
         // Could adjust spawnPos slightly based on shotAngle if desired.
         bullet->settings(*animPtr, spawnPosBase, shotAngle);
         if (bullet->type != Entity::Type::Bullet) { // Sanity check
-             std::cerr << "Warning: Spawned bullet does not have Bullet type!" << std::endl;
+             LOG_WARN(LogCategory::Entity, "Spawned bullet does not have Bullet type!");
         }
-        entities.push_back(std::move(bullet));
+        addEntity(std::move(bullet));
     }
     // std::cout << "Bullet spawned. Type: " << static_cast<int>(typeToSpawn) << std::endl; // Optional debug
 }
 
-void Game::spawnBossBullet(Boss* boss, int firePointIndex) {
+void Game::fireBossPattern(Boss* boss, int firePointIndex) {
     if (!boss || !boss->life) return;
-
-    sf::Vector2f relativePos;
-    switch(firePointIndex) {
-        case 0: relativePos = boss->firePoint1; break;
-        case 1: relativePos = boss->firePoint2; break;
-        case 2: relativePos = boss->firePoint3; break;
-        default: std::cerr << "Invalid boss fire point index: " << firePointIndex << std::endl; return;
+    if (firePointIndex < 0 || firePointIndex > 2) {
+        LOG_ERROR(LogCategory::Boss, "Invalid boss fire point index: %d", firePointIndex);
+        return;
     }
 
-    sf::Vector2f startPos = boss->getAbsoluteFirePos(relativePos);
-
-    Bullet::BulletType bossBulletType = Bullet::BulletType::Red; // Boss uses red bullets
-    Animation* animPtr = &animBulletRed;
-    float bulletAngle = 0;
-
-    // Simple aim-at-player logic
+    // Patterns that turn on their own start aimed at the player (straight down if there is none)
+    sf::Vector2f startPos = boss->getGunPos(firePointIndex);
+    float aim = 90.f;
+    Player* player = getPlayer();
     if (player && player->life) {
         sf::Vector2f direction = player->pos - startPos;
-        bulletAngle = std::atan2(direction.y, direction.x) * 180.f / 3.14159f + 90.f; // atan2 gives angle in radians, convert and adjust
-    } else {
-         bulletAngle = boss->angle + 180.f; // Fire straight 'down' relative to boss if player is dead/null
+        aim = std::atan2(direction.y, direction.x) * 180.f / 3.14159f;
     }
+    BulletPatterns::PatternId pattern = boss->patternFor(firePointIndex);
+    enemyShots.start(pattern, boss->handle, firePointIndex, aim);
 
-    auto bullet = std::make_unique<Bullet>(bossBulletType);
-    bullet->settings(*animPtr, startPos, bulletAngle);
-    // TODO: Add bullet->isEnemy = true; flag and check in Player-Bullet collision
-     if (bullet->type != Entity::Type::Bullet) { // Sanity check
-          std::cerr << "Warning: Spawned boss bullet does not have Bullet type!" << std::endl;
-     }
-    entities.push_back(std::move(bullet));
+    // This gun's next pattern: once this one has played out, plus the phase's cooldown
+    float playing = static_cast<float>(BulletPatterns::durationTicks(pattern)) / TICK_RATE;
+    float cooldown = boss->shootCooldown * (1.0f + 0.1f * firePointIndex + Random::range(20) / 100.f);
+    scheduleTimer(GameTimer::BossShoot, playing + cooldown, firePointIndex, boss->handle);
+}
+
+// Boss guns move with the boss, so each volley asks where the gun is now
+void Game::updateEnemyShots() {
+    Player* player = getPlayer();
+    sf::Vector2f target = player && player->life ? player->pos : sf::Vector2f(WINDOW_WIDTH / 2.f, static_cast<float>(WINDOW_HEIGHT));
+    enemyShots.update(simTick, target, [this](EntityHandle source, int gun, sf::Vector2f& at) {
+        std::unique_ptr<Entity>* slot = entities.get(source);
+        if (!slot || !(*slot)->life || (*slot)->type != Entity::Type::Boss) return false;
+        at = static_cast<Boss*>(slot->get())->getGunPos(gun);
+        return true;
+    });
+}
 
-    // Boss resets its own shoot timer after deciding to fire
-    switch(firePointIndex) {
-        case 0: boss->shootTimer1 = boss->shootCooldown * (1.0f + (rand()%20)/100.f); break;
-        case 1: boss->shootTimer2 = boss->shootCooldown * (1.1f + (rand()%20)/100.f); break;
-        case 2: boss->shootTimer3 = boss->shootCooldown * (1.2f + (rand()%20)/100.f); break;
+// A pack of drones just outside a random edge, drifting in
+void Game::spawnDronePack(int count) {
+    int edge = Random::range(4);
+    float alongX = static_cast<float>(Random::range(WINDOW_WIDTH));
+    float alongY = static_cast<float>(Random::range(WINDOW_HEIGHT));
+    sf::Vector2f center(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f);
+    for (int i = 0; i < count; ++i) {
+        float along = (Random::unit() * 2.f - 1.f) * DRONE_PACK_SPREAD;
+        float depth = Random::unit() * DRONE_PACK_DEPTH;
+        sf::Vector2f pos;
+        switch (edge) {
+            case 0: pos = sf::Vector2f(alongX + along, -depth); break;
+            case 1: pos = sf::Vector2f(WINDOW_WIDTH + depth, alongY + along); break;
+            case 2: pos = sf::Vector2f(alongX + along, WINDOW_HEIGHT + depth); break;
+            default: pos = sf::Vector2f(-depth, alongY + along); break;
+        }
+        sf::Vector2f in = center - pos;
+        float length = std::sqrt(in.x * in.x + in.y * in.y);
+        drones.spawn(pos, in * (0.5f * DroneSwarm::MAX_SPEED / std::max(length, 1.f)), simTick);
     }
 }
 
+void Game::updateDrones() {
+    if (drones.size() == 0) return;
+    Player* player = getPlayer();
+    bool hunting = player && player->life;
+    auto start = std::chrono::steady_clock::now();
+    drones.update(hunting ? player->pos : sf::Vector2f(), hunting);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    droneSeconds += seconds;
+    droneMax = std::max(droneMax, seconds);
+    ++droneUpdates;
+}
+
 void Game::spawnPowerUp() {
     // Determine type
-    int typeRoll = rand() % 3; // 0: Shield, 1: Weapon, 2: Speed (ExtraLife handled differently?)
+    int typeRoll = Random::range(4); // 0: Shield, 1: Weapon, 2: Speed, 3: Smart bomb (ExtraLife handled differently?)
     PowerUp::PowerUpType chosenType;
     switch(typeRoll) {
         case 0: chosenType = PowerUp::PowerUpType::Shield; break;
         case 1: chosenType = PowerUp::PowerUpType::Weapon; break;
         case 2: chosenType = PowerUp::PowerUpType::Speed; break;
+        case 3: chosenType = PowerUp::PowerUpType::SmartBomb; break;
         default: return; // Should not happen
     }
 
@@ -957,51 +2289,48 @@ void Game::spawnPowerUp() {
 
     // Calculate random position within bounds
     float margin = 50.f;
-    sf::Vector2f pos(static_cast<float>(rand() % (WINDOW_WIDTH - (int)(2*margin)) + margin),
-                      static_cast<float>(rand() % (WINDOW_HEIGHT - (int)(2*margin)) + margin));
+    sf::Vector2f pos(static_cast<float>(Random::range(WINDOW_WIDTH - (int)(2*margin)) + margin),
+                      static_cast<float>(Random::range(WINDOW_HEIGHT - (int)(2*margin)) + margin));
     float radius = 15.f; // Default collision radius
 
     Animation dummyAnim; // PowerUp::settings loads its own texture/anim
     powerUp->settings(dummyAnim, pos, 0, radius);
 
     if (powerUp->life && (powerUp->type == Entity::Type::PowerUp)) { // Check if setup was successful and type is correct
-        entities.push_back(std::unique_ptr<Entity>(powerUp)); // Transfer ownership to list
+        addEntity(std::unique_ptr<Entity>(powerUp)); // Transfer ownership to list
     } else {
-        std::cerr << "Failed to spawn or configure PowerUp correctly. Deleting." << std::endl;
+        LOG_WARN(LogCategory::Entity, "Failed to spawn or configure PowerUp correctly. Deleting.");
         delete powerUp; // Cleanup if settings failed or type is wrong
     }
 }
 
-void Game::spawnEffect(Animation& anim, sf::Vector2f pos) {
-    auto effect = std::make_unique<Effect>();
-    Animation animCopy = anim; // Effects need their own copy to manage state
-    animCopy.reset();          // Ensure animation starts from frame 0
-    animCopy.play();
-    effect->settings(animCopy, pos); // Settings applies the animation and position
-     if (effect->type != Entity::Type::Effect) { // Sanity check
-        std::cerr << "Warning: Spawned effect does not have Effect type!" << std::endl;
-     }
-    entities.push_back(std::move(effect));
+void Game::spawnEffect(ParticleSystem::ClipId clip, sf::Vector2f pos) {
+    // Explosions/sparks are pure cosmetics: no entity, no collision slot (and nothing to show headless)
+    if (options.headless) return;
+    particles.spawn(clip, pos);
 }
 
 void Game::spawnBoss(int level) {
-    if (currentBoss) {
-        std::cerr << "Warning: Trying to spawn boss when one already exists." << std::endl;
+    if (getBoss()) {
+        LOG_WARN(LogCategory::Boss, "Trying to spawn boss when one already exists.");
         return;
     }
 
-    std::cout << "Spawning Boss for Level " << level << std::endl;
+    LOG_INFO(LogCategory::Boss, "Spawning Boss for Level %d", level);
     auto boss = std::make_unique<Boss>();
-    currentBoss = boss.get(); // Assign raw pointer
 
     // TODO: Potentially choose boss type/animation based on level
     Animation* bossAnim = &animBoss1;
 
-    boss->settings(*bossAnim, sf::Vector2f(window.getSize().x / 2.f, window.getSize().y * 0.15f));
+    boss->settings(*bossAnim, sf::Vector2f(FIELD_SIZE.x / 2.f, FIELD_SIZE.y * 0.15f));
      if (boss->type != Entity::Type::Boss) { // Sanity check
-        std::cerr << "Warning: Spawned boss does not have Boss type!" << std::endl;
+        LOG_WARN(LogCategory::Boss, "Spawned boss does not have Boss type!");
      }
-    entities.push_back(std::move(boss));
+    bossHandle = addEntity(std::move(boss));
+    Boss* spawned = getBoss();
+    for (int gun = 0; gun < 3; ++gun) {
+        scheduleTimer(GameTimer::BossShoot, spawned->firstShotDelay(gun), gun, bossHandle);
+    }
 
     // Music handled in loadLevel
 }
@@ -1011,233 +2340,678 @@ void Game::triggerBossExplosion(sf::Vector2f bossPos) {
     int numExplosions = 10;
     float radius = 60.f; // Spread radius for small explosions
     for (int i = 0; i < numExplosions; ++i) {
-         float angle = (static_cast<float>(rand()) / RAND_MAX) * 2.f * 3.14159f;
-         float dist = (static_cast<float>(rand()) / RAND_MAX) * radius;
+         float angle = Random::unit() * 2.f * 3.14159f;
+         float dist = Random::unit() * radius;
          sf::Vector2f offset(std::cos(angle) * dist, std::sin(angle) * dist);
-         spawnEffect(animExplosionBoss, bossPos + offset); // Specific small boss explosions
+         spawnEffect(clipExplosionBoss, bossPos + offset); // Specific small boss explosions
     }
     // Add one larger one in the center
-    spawnEffect(animExplosionAsteroid, bossPos); // Use large asteroid/general explosion
+    spawnEffect(clipExplosionAsteroid, bossPos); // Use large asteroid/general explosion
+}
+
+// --- Gravity ---
+// Black holes for the level or mode being started, from the gravity option (none when it is off)
+void Game::placeWells() {
+    wells.clear();
+    int count = 0;
+    bool everywhere = options.gravity == GameOptions::GravityMode::Wells || options.gravity == GameOptions::GravityMode::Rocks;
+    if (currentMode == PlayMode::Campaign) {
+        bool gravityLevel = currentLevel % GRAVITY_LEVEL_INTERVAL == GRAVITY_LEVEL_INTERVAL - 1;
+        if (everywhere || (options.gravity == GameOptions::GravityMode::Levels && gravityLevel)) {
+            count = std::min(MAX_WELLS, 1 + currentLevel / (2 * GRAVITY_LEVEL_INTERVAL));
+        }
+    } else if (everywhere) {
+        count = currentMode == PlayMode::Swarm ? 2 : 1;
+    }
+    bool mirrored = currentLevel % 2 != 0;
+    for (int i = 0; i < count; ++i) {
+        float x = mirrored ? 1.f - WELL_SPOTS[i].x : WELL_SPOTS[i].x;
+        wells.push_back(sf::Vector2f(x * WINDOW_WIDTH, WELL_SPOTS[i].y * WINDOW_HEIGHT));
+    }
+}
+
+// The pull of every source on everything that moves freely: rocks, meteors, bullets and the
+// player. Bodies are gathered from the registry lists; the field only hands back accelerations,
+// which are capped and added to velocities here (the entities' own updates then move them).
+void Game::applyGravity(float dt) {
+    bool rocksPull = options.gravity == GameOptions::GravityMode::Rocks;
+    if (wells.empty() && !rocksPull) return;
+
+    gravity.clear();
+    for (const sf::Vector2f& well : wells) gravity.addSource(well, WELL_STRENGTH);
+    if (rocksPull) {
+        for (EntityHandle handle : registry.handles(Entity::Type::Asteroid)) {
+            const Asteroid* rock = static_cast<const Asteroid*>(entities.get(handle)->get());
+            if (rock->life && rock->getSize() == Asteroid::Size::Large) gravity.addSource(rock->pos, ROCK_GRAVITY * rock->getMass());
+        }
+    }
+    if (gravity.sourceCount() == 0) return;
+
+    gravityBodies.clear();
+    for (Entity::Type type : { Entity::Type::Player, Entity::Type::Asteroid, Entity::Type::HazardMeteor, Entity::Type::Bullet }) {
+        for (EntityHandle handle : registry.handles(type)) {
+            const Entity* e = entities.get(handle)->get();
+            if (!e->life || !gravity.addProbe(e->pos)) continue;
+            gravityBodies.push_back(handle);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    gravity.solve();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    gravitySeconds += seconds;
+    gravityMax = std::max(gravityMax, seconds);
+    ++gravitySolves;
+    gravitySourcesMax = std::max(gravitySourcesMax, gravity.sourceCount());
+    gravityProbesMax = std::max(gravityProbesMax, gravity.probeCount());
+
+    float steps = dt * 60.f; // Pulls are per tick^2, velocities per tick
+    for (std::uint32_t i = 0; i < gravityBodies.size(); ++i) {
+        Entity* e = entities.get(gravityBodies[i])->get();
+        sf::Vector2f pull = gravity.pull(i);
+        float strength = std::sqrt(pull.x * pull.x + pull.y * pull.y);
+        if (strength > MAX_PULL) pull *= MAX_PULL / strength;
+        e->velocity += pull * steps;
+    }
+}
+
+// Black holes swallow rocks, meteors and bullets whose centre crosses the horizon (no score, no
+// fragments); the player takes a hit like any other
+void Game::checkWellHits(Player* player) {
+    if (wells.empty()) return;
+    const float horizonSq = WELL_HORIZON * WELL_HORIZON;
+    for (const sf::Vector2f& well : wells) {
+        for (Entity::Type type : { Entity::Type::Asteroid, Entity::Type::HazardMeteor, Entity::Type::Bullet }) {
+            for (EntityHandle handle : registry.handles(type)) {
+                Entity* e = entities.get(handle)->get();
+                if (!e->life) continue;
+                sf::Vector2f d = e->pos - well;
+                if (d.x * d.x + d.y * d.y >= horizonSq) continue;
+                e->kill();
+                if (type != Entity::Type::Bullet) spawnEffect(clipExplosionSmall, e->pos);
+            }
+        }
+        if (!player || !player->life) continue;
+        sf::Vector2f d = player->pos - well;
+        float reach = WELL_HORIZON + WELL_PLAYER_REACH * player->R;
+        if (d.x * d.x + d.y * d.y >= reach * reach || absorbHit(player)) continue;
+        player->takeDamage();
+        playSound(&Audio::explosionSoundPlayer);
+        spawnEffect(clipExplosionPlayer, player->pos);
+        if (!player->life && player->lives > 0) startRespawnDelay();
+    }
 }
 
 // --- Collision Detection ---
+// Asteroids and meteors bounce off each other before anything else collides this tick. Bodies go
+// in list order (asteroids, then meteors), which is the same on every run of a session. A field
+// with more rock than fits on the screen (a Swarm ramping up) cannot be pulled apart, only jammed,
+// so contacts are skipped while it lasts.
+void Game::resolveRockContacts() {
+    rockSolver.clear();
+    rockBodies.clear();
+    float rockArea = 0.f;
+    for (Entity::Type type : { Entity::Type::Asteroid, Entity::Type::HazardMeteor }) {
+        for (EntityHandle handle : registry.handles(type)) {
+            const Entity* e = entities.get(handle)->get();
+            if (!e->life || e->R <= 0) continue;
+            float mass = type == Entity::Type::Asteroid ? static_cast<const Asteroid*>(e)->getMass() : METEOR_MASS;
+            rockSolver.add(e->pos, e->velocity, e->R, mass);
+            rockBodies.push_back(handle);
+            rockArea += 3.14159f * e->R * e->R;
+            if (rockArea > ROCK_MAX_COVER * WINDOW_WIDTH * WINDOW_HEIGHT) {
+                ++rockSkipped;
+                return;
+            }
+        }
+    }
+    if (rockBodies.size() < 2) return;
+
+    auto start = std::chrono::steady_clock::now();
+    rockSolver.solve();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    rockSolveSeconds += seconds;
+    rockSolveMax = std::max(rockSolveMax, seconds);
+    ++rockSolves;
+    rockContactsMax = std::max(rockContactsMax, rockSolver.stats().contacts);
+    if (rockSolver.stats().contacts == 0) return;
+
+    for (std::uint32_t i = 0; i < rockBodies.size(); ++i) {
+        Entity* e = entities.get(rockBodies[i])->get();
+        e->pos = rockSolver.body(i).pos;
+        e->velocity = rockSolver.body(i).vel;
+    }
+}
+
 void Game::checkCollisions() {
-    // Use iterators for safe removal if needed (though cleanupEntities is preferred)
-    for (auto i = entities.begin(); i != entities.end(); ++i) {
-        Entity* entityA = i->get();
-        // Skip checks if entity is dead or has no collision radius
-        if (!entityA->life || entityA->R <= 0) continue;
-
-        for (auto j = std::next(i); j != entities.end(); ++j) {
-            Entity* entityB = j->get();
-            // Skip checks if second entity is dead or has no collision radius
-            if (!entityB->life || entityB->R <= 0) continue;
-
-            // Check distance
-            if (isCollide(entityA, entityB)) {
-                // Make pointers 'a' and 'b' point to the collided entities
-                Entity* a = entityA;
-                Entity* b = entityB;
-                Entity::Type typeA = a->type;
-                Entity::Type typeB = b->type;
-
-                // Ensure typeA <= typeB for easier checking
-                if (typeA > typeB) {
-                    std::swap(a, b);
-                    std::swap(typeA, typeB);
-                }
+    Player* player = getPlayer(); // Only cleanupEntities removes entities, so this stays valid for the pass
+    resolveRockContacts();
+
+    // Broadphase: bin everything the player or a bullet can hit. Only those two ever start a
+    // collision this pass handles (rock-rock contacts were solved above; rock-item ones are
+    // ignored), so they query the grid rather than being binned themselves.
+    collisionGrid.clear();
+    float targetStepSq = 0.f; // Longest move any binned entity made this tick (widens the bullet sweeps)
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        const Entity* e = entities[i].get();
+        if (!e->life || e->R <= 0) continue;
+        if (e->type == Entity::Type::Player || e->type == Entity::Type::Bullet || e->type == Entity::Type::Effect) continue;
+        collisionGrid.add(static_cast<std::uint32_t>(i), e->pos, e->hitRadius());
+        sf::Vector2f moved = e->step(TICK_DT);
+        targetStepSq = std::max(targetStepSq, moved.x * moved.x + moved.y * moved.y);
+    }
+    collisionGrid.build();
+    float targetStep = std::sqrt(targetStepSq);
+
+    // Laser beams fired this tick, in firing order. Rocks they destroy are skipped below.
+    for (const BeamShot& shot : pendingBeams) fireBeam(shot, player);
+    pendingBeams.clear();
+
+    collisionPairs.clear();
+    pairTests = 0;
+    auto queryFrom = [this](std::size_t i) {
+        Entity* entity = entities[i].get();
+        if (!entity->life || entity->R <= 0) return;
+        collisionGrid.query(entity->pos, entity->hitRadius(), [&](std::uint32_t j) {
+            ++pairTests;
+            if (!isCollide(entity, entities[j].get())) return;
+            std::uint64_t lo = std::min<std::uint64_t>(i, j), hi = std::max<std::uint64_t>(i, j);
+            collisionPairs.push_back(lo << 32 | hi);
+        });
+    };
+    // Bullets are swept: the path each one flew this tick against every target's own motion over
+    // the same tick, keeping only the earliest contact. However far a shot moves per tick, it
+    // cannot skip over a small rock. The circles give the first possible moment; the pixels are
+    // then stepped from there to find the real one.
+    auto sweepFrom = [&](std::size_t i) {
+        const Bullet* bullet = static_cast<const Bullet*>(entities[i].get());
+        if (!bullet->life || bullet->R <= 0) return;
+        float firstTime = 2.f;
+        std::uint32_t first = 0;
+        collisionGrid.querySegment(bullet->lastPos, bullet->pos, bullet->R + targetStep, [&](std::uint32_t j) {
+            ++pairTests;
+            float time;
+            if (!sweptCollide(bullet, bullet->lastPos, entities[j].get(), TICK_DT, time)) return;
+            if (time >= firstTime && !(time == firstTime && j < first)) return; // Cannot beat the best so far
+            if (!sweptMaskTime(bullet, entities[j].get(), time)) return;
+            if (time < firstTime || (time == firstTime && j < first)) {
+                firstTime = time;
+                first = j;
+            }
+        });
+        if (firstTime > 1.f) return;
+        std::uint64_t lo = std::min<std::uint64_t>(i, first), hi = std::max<std::uint64_t>(i, first);
+        collisionPairs.push_back(lo << 32 | hi);
+    };
+    if (player) queryFrom(entities.indexOf(player->handle));
+    for (EntityHandle handle : registry.handles(Entity::Type::Bullet)) sweepFrom(entities.indexOf(handle));
+
+    // Resolve in dense order (the order the all-pairs loop used), skipping pairs an earlier hit
+    // in this pass already broke up. Splits append fragments; they are first checked next tick.
+    std::sort(collisionPairs.begin(), collisionPairs.end());
+    for (std::uint64_t pair : collisionPairs) {
+        Entity* a = entities[static_cast<std::size_t>(pair >> 32)].get();
+        Entity* b = entities[static_cast<std::size_t>(pair & 0xFFFFFFFFu)].get();
+        if (a->life && b->life) resolveCollision(a, b, player);
+    }
 
-                // --- Collision Pair Handling ---
-
-                // Player(1) <-> Asteroid(2)
-                if (typeA == Entity::Type::Player && typeB == Entity::Type::Asteroid) {
-                    if (player && player->life) { // Check player still exists and alive
-                         Asteroid* asteroid = static_cast<Asteroid*>(b);
-                         if (player->shieldActive) {
-                             player->shieldActive = false; player->shieldTimer = 0;
-                             asteroid->life = false;
-                             spawnEffect(animExplosionSmall, asteroid->pos);
-                             explosionSoundAsteroid.play();
-                         } else {
-                             player->takeDamage();
-                             explosionSoundPlayer.play();
-                             spawnEffect(animExplosionPlayer, player->pos);
-                             asteroid->life = false; // Asteroid also destroyed
-                             // Check for respawn NEED after takeDamage
-                             if (!player->life && player->lives > 0) {
-                                 playerRespawnTimer = PLAYER_RESPAWN_DELAY;
-                             }
-                         }
-                    }
-                }
-                // Player(1) <-> Bullet(3) (Assuming enemy bullets - Requires bullet flag)
-                // else if (typeA == Entity::Type::Player && typeB == Entity::Type::Bullet) {
-                //     Bullet* bullet = static_cast<Bullet*>(b);
-                //     if (bullet->isEnemy && player && player->life) { /* Handle damage/respawn */ }
-                // }
-
-                // Player(1) <-> PowerUp(4) / PowerDown(5)
-                else if (typeA == Entity::Type::Player && (typeB == Entity::Type::PowerUp || typeB == Entity::Type::PowerDown)) {
-                     if (player && player->life) {
-                         // PowerUp class handles distinguishing between Up/Down
-                         player->applyPowerUp(static_cast<PowerUp*>(b));
-                         b->life = false; // Consume item
-                         powerupSound.play(); // Assuming sound is for good powerups only
-                     }
-                }
-                 // Player(1) <-> Boss(7)
-                else if (typeA == Entity::Type::Player && typeB == Entity::Type::Boss) {
-                     if (player && player->life) {
-                         if (player->shieldActive) {
-                              player->shieldActive = false; player->shieldTimer = 0;
-                              // static_cast<Boss*>(b)->takeDamage(2); // Minor damage to boss?
-                         } else {
-                             player->takeDamage(); // Player takes damage
-                             explosionSoundPlayer.play();
-                             spawnEffect(animExplosionPlayer, player->pos);
-                             // static_cast<Boss*>(b)->takeDamage(5); // Maybe boss takes ram damage?
-                             if (!player->life && player->lives > 0) {
-                                 playerRespawnTimer = PLAYER_RESPAWN_DELAY;
-                             }
-                         }
-                     }
-                }
-                // Player(1) <-> HazardMeteor(8)
-                else if (typeA == Entity::Type::Player && typeB == Entity::Type::HazardMeteor) {
-                     if (player && player->life) {
-                         HazardMeteor* meteor = static_cast<HazardMeteor*>(b);
-                         if (player->shieldActive) {
-                              player->shieldActive = false; player->shieldTimer = 0;
-                              meteor->life = false;
-                              spawnEffect(animExplosionSmall, meteor->pos);
-                              powerdownSound.play(); // Play sound even if shielded
-                         } else {
-                             player->slowTimer = 8.0f; // Apply slow effect
-                             player->speedBoostTimer = 0.f; // Cancel speed boost
-                             meteor->life = false;
-                             spawnEffect(animExplosionSmall, meteor->pos);
-                             powerdownSound.play();
-                             // Hazard meteor ALSO damages player
-                             player->takeDamage();
-                             if (!player->life && player->lives > 0) {
-                                 playerRespawnTimer = PLAYER_RESPAWN_DELAY;
-                             }
-                         }
-                     }
-                }
+    processBombQueue(player);
+    guideMissiles(); // The grid still holds this tick's positions; dead rocks are filtered out
 
-                // Asteroid(2) <-> Bullet(3)
-                else if (typeA == Entity::Type::Asteroid && typeB == Entity::Type::Bullet) {
-                     Asteroid* asteroid = static_cast<Asteroid*>(a);
-                     Bullet* bullet = static_cast<Bullet*>(b);
-                     // TODO: Ignore collision if bullet->isEnemy?
-                     asteroid->life = false;
-                     bullet->life = false;
-                     if (player) player->addScore(asteroid->scoreValue);
-                     explosionSoundAsteroid.play();
-                     spawnEffect(animExplosionAsteroid, asteroid->pos);
-                     // Spawn smaller asteroids
-                     if (asteroid->getSize() == Asteroid::Size::Large) {
-                         spawnAsteroid(Asteroid::Size::Medium, asteroid->pos);
-                         spawnAsteroid(Asteroid::Size::Medium, asteroid->pos);
-                     } else if (asteroid->getSize() == Asteroid::Size::Medium) {
-                         spawnAsteroid(Asteroid::Size::Small, asteroid->pos);
-                         spawnAsteroid(Asteroid::Size::Small, asteroid->pos);
-                     }
-                }
+    if (player && player->life) checkShotHits(player);
+    checkDroneHits(player);
+    checkWellHits(player);
+}
 
-                // Bullet(3) <-> Boss(7)
-                else if (typeA == Entity::Type::Bullet && typeB == Entity::Type::Boss) {
-                     Bullet* bullet = static_cast<Bullet*>(a);
-                     Boss* boss = static_cast<Boss*>(b);
-                     // TODO: Ignore collision if !bullet->isEnemy? (Player bullet hits boss)
-                     // if (!bullet->isEnemy) {
-                         boss->takeDamage(bullet->damage);
-                         bullet->life = false;
-                         spawnEffect(animExplosionSmall, bullet->pos); // Hit spark
-                         // bossHitSound.play();
-                         if (!boss->life) {
-                             triggerBossExplosion(boss->pos);
-                             // Score/music handled in cleanupEntities
-                         }
-                     // }
-                }
-                // Bullet(3) <-> HazardMeteor(8)
-                else if (typeA == Entity::Type::Bullet && typeB == Entity::Type::HazardMeteor) {
-                     a->life = false; // Bullet
-                     b->life = false; // Meteor
-                     spawnEffect(animExplosionSmall, b->pos);
-                     explosionSoundAsteroid.play(); // Reuse sound
-                }
+// Everything binned in the grid that the capsule around from -> from + dir * length touches,
+// nearest first (by where the capsule first reaches it). dir must be unit length.
+std::size_t Game::castRay(sf::Vector2f from, sf::Vector2f dir, float length, float radius) {
+    beamHits.clear();
+    collisionGrid.querySegment(from, from + dir * length, radius, [&](std::uint32_t i) {
+        const Entity* e = entities[i].get();
+        if (!e->life) return;
+        sf::Vector2f rel = e->pos - from;
+        float along = rel.x * dir.x + rel.y * dir.y;
+        float reach = e->hitRadius() + radius; // The circle it was binned with
+        sf::Vector2f off = rel - dir * std::max(0.f, std::min(length, along)); // From the closest point on the segment
+        if (off.x * off.x + off.y * off.y > reach * reach) return;
+        float perpSq = rel.x * rel.x + rel.y * rel.y - along * along;
+        float entry = along - std::sqrt(std::max(0.f, reach * reach - perpSq));
+        beamHits.push_back(BeamHit{std::max(0.f, entry), i});
+    });
+    std::sort(beamHits.begin(), beamHits.end(), [](const BeamHit& a, const BeamHit& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.index < b.index;
+    });
+    return beamHits.size();
+}
+
+// One laser shot: destroys up to BEAM_PIERCE rocks along the beam, nearest first, and stops at
+// the boss. Power-ups are not targets.
+void Game::fireBeam(const BeamShot& shot, Player* player) {
+    float rad = (shot.angle - 90.f) * 3.14159f / 180.f;
+    sf::Vector2f dir(std::cos(rad), std::sin(rad));
+    castRay(shot.from, dir, BEAM_LENGTH, BEAM_RADIUS);
+
+    float reached = BEAM_LENGTH;
+    int pierced = 0;
+    for (const BeamHit& hit : beamHits) {
+        Entity* e = entities[hit.index].get();
+        if (!e->life) continue; // An earlier beam this tick got it
+        bool stopped = false;
+        if (e->type == Entity::Type::Asteroid) {
+            shatterAsteroid(static_cast<Asteroid*>(e), player);
+            ++pierced;
+        } else if (e->type == Entity::Type::HazardMeteor) {
+            e->kill();
+            spawnEffect(clipExplosionSmall, e->pos);
+            playSound(&Audio::explosionSoundAsteroid);
+            ++pierced;
+        } else if (e->type == Entity::Type::Boss) {
+            Boss* boss = static_cast<Boss*>(e);
+            boss->takeDamage(BEAM_DAMAGE);
+            spawnEffect(clipExplosionSmall, shot.from + dir * hit.distance); // Hit spark
+            if (!boss->life) triggerBossExplosion(boss->pos);
+            stopped = true;
+        } else {
+            continue;
+        }
+        if (stopped || pierced >= BEAM_PIERCE) {
+            reached = hit.distance;
+            break;
+        }
+    }
+
+    // Drones do not stop the beam: it downs every one along the length it reached
+    std::size_t downed = drones.removeAlongSegment(shot.from, shot.from + dir * reached, BEAM_RADIUS);
+    if (downed > 0 && player) player->addScore(static_cast<int>(downed) * DRONE_SCORE);
+
+    beamTraces.erase(std::remove_if(beamTraces.begin(), beamTraces.end(), [this](const BeamTrace& t) {
+        return simTick - t.tick >= static_cast<std::uint64_t>(BEAM_TRACE_TICKS);
+    }), beamTraces.end());
+    if (beamTraces.size() < BEAM_RESERVE) beamTraces.push_back(BeamTrace{shot.from, shot.angle, reached, simTick});
+}
+
+// An asteroid destroyed by the player: score, explosion, and the split into two of the next size down
+void Game::shatterAsteroid(Asteroid* asteroid, Player* player) {
+    asteroid->kill();
+    if (player) player->addScore(asteroid->scoreValue);
+    playSound(&Audio::explosionSoundAsteroid);
+    spawnEffect(clipExplosionAsteroid, asteroid->pos);
+    if (asteroid->getSize() == Asteroid::Size::Large) {
+        spawnAsteroid(Asteroid::Size::Medium, asteroid->pos);
+        spawnAsteroid(Asteroid::Size::Medium, asteroid->pos);
+    } else if (asteroid->getSize() == Asteroid::Size::Medium) {
+        spawnAsteroid(Asteroid::Size::Small, asteroid->pos);
+        spawnAsteroid(Asteroid::Size::Small, asteroid->pos);
+    }
+}
 
-                // Other potential collisions (Asteroid-Asteroid, Asteroid-Hazard) ignored for now
-
-            } // End if isCollide
-        } // End inner loop (j)
-    } // End outer loop (i)
-}
-
-
-void Game::cleanupEntities() {
-    // Use std::list::remove_if for efficient removal
-    entities.remove_if([this](const std::unique_ptr<Entity>& e) {
-        // Điều kiện xóa cơ bản: life == false
-        if (!e->life) {
-            // --- XỬ LÝ ĐẶC BIỆT CHO PLAYER ---
-            if (e->type == Entity::Type::Player) {
-                // CHỈ xóa player nếu timer hồi sinh KHÔNG chạy (<= 0)
-                // Nếu life == false NHƯNG timer > 0 nghĩa là đang chờ hồi sinh -> KHÔNG XÓA
-                if (playerRespawnTimer <= 0) {
-                    player = nullptr; // Xóa con trỏ raw khi unique_ptr bị xóa
-                    std::cout << "Cleanup: Player removed (No respawn pending)." << std::endl;
-                    return true; // Đánh dấu để xóa
-                } else {
-                    // Đang chờ hồi sinh, không làm gì cả, không xóa
-                    // std::cout << "Cleanup: Player life is false, but respawn timer active. NOT removing." << std::endl; // Debug log (optional)
-                    return false; // KHÔNG xóa player
+// Homing missiles turn towards the nearest rock, meteor or boss fire point within their cone,
+// re-picked every tick. The current target's distance bounds the search, so a missile that is
+// closing in only looks at the few cells around it; one without a target searches MISSILE_RANGE.
+void Game::guideMissiles() {
+    Boss* boss = getBoss();
+    if (boss && !boss->life) boss = nullptr;
+    for (EntityHandle handle : registry.handles(Entity::Type::Bullet)) {
+        Bullet* missile = static_cast<Bullet*>(entities.get(handle)->get());
+        if (!missile->life || missile->bulletType != Bullet::BulletType::Homing) continue;
+
+        float rad = missile->angle * 3.14159f / 180.f;
+        sf::Vector2f heading(std::sin(rad), -std::cos(rad));
+        auto inCone = [&](sf::Vector2f at, float& distanceSq) {
+            sf::Vector2f d = at - missile->pos;
+            distanceSq = d.x * d.x + d.y * d.y;
+            return d.x * heading.x + d.y * heading.y >= MISSILE_CONE_COS * std::sqrt(distanceSq);
+        };
+
+        float range = MISSILE_RANGE;
+        sf::Vector2f current;
+        float currentSq = 0.f;
+        if (missileTarget(missile, current) && inCone(current, currentSq)) range = std::min(range, std::sqrt(currentSq) + 1.f);
+        collisionGrid.nearestInCone(missile->pos, heading, MISSILE_CONE_COS, range, 1, [this](std::uint32_t i) {
+            const Entity* e = entities[i].get();
+            return e->life && (e->type == Entity::Type::Asteroid || e->type == Entity::Type::HazardMeteor);
+        }, missileCandidates);
+
+        EntityHandle best;
+        int bestPoint = -1;
+        float bestSq = range * range;
+        if (!missileCandidates.empty()) {
+            best = entities.handleAt(missileCandidates.front().id);
+            bestSq = missileCandidates.front().distanceSq;
+        }
+        if (boss) {
+            for (int gun = 0; gun < 3; ++gun) {
+                float distanceSq;
+                if (inCone(boss->getGunPos(gun), distanceSq) && distanceSq < bestSq) {
+                    best = boss->handle;
+                    bestPoint = gun;
+                    bestSq = distanceSq;
                 }
             }
-            // --- KẾT THÚC XỬ LÝ PLAYER ---
-
-            // Xử lý cho Boss (như cũ)
-            else if (e->type == Entity::Type::Boss) {
-                std::cout << "Cleanup: Boss entity removed." << std::endl;
-                if (player) player->addScore(bossDefeatScoreBonus);
-                currentBoss = nullptr;
-                bossMusic.stop();
-                if (currentState == State::Playing) backgroundMusic.play();
-                return true; // Xóa Boss
-            }
-            // Các loại entity khác, nếu life == false thì xóa bình thường
-            else {
-                
-                return true; // Đánh dấu để xóa các entity khác (bullet, asteroid, effect...)
-            }
         }
-        // Nếu life == true, không xóa
-        return false;
+        missile->target = best;
+        missile->targetPoint = bestPoint;
+
+        sf::Vector2f at;
+        if (!missileTarget(missile, at)) continue; // Nothing ahead: fly straight
+        float wanted = std::atan2(at.x - missile->pos.x, missile->pos.y - at.y) * 180.f / 3.14159f;
+        float turn = std::fmod(wanted - missile->angle + 540.f, 360.f) - 180.f;
+        missile->angle += std::max(-MISSILE_TURN, std::min(MISSILE_TURN, turn));
+        rad = missile->angle * 3.14159f / 180.f;
+        missile->velocity = sf::Vector2f(std::sin(rad), -std::cos(rad)) * missile->speed;
+    }
+}
+
+bool Game::missileTarget(const Bullet* missile, sf::Vector2f& at) {
+    std::unique_ptr<Entity>* slot = entities.get(missile->target);
+    if (!slot || !(*slot)->life) return false;
+    Entity* target = slot->get();
+    at = missile->targetPoint >= 0 && target->type == Entity::Type::Boss
+       ? static_cast<Boss*>(target)->getGunPos(missile->targetPoint) : target->pos;
+    return true;
+}
+
+// A smart bomb going off: enemy shots in the blast vanish at once; rocks, meteors and the boss are
+// queued nearest first and destroyed by processBombQueue. Uses this tick's broadphase.
+void Game::detonateBomb(sf::Vector2f center) {
+    enemyShots.removeTouching(center, BOMB_RADIUS);
+    std::size_t downed = drones.removeTouching(center, BOMB_RADIUS);
+    if (downed > 0) {
+        if (Player* player = getPlayer()) player->addScore(static_cast<int>(downed) * DRONE_SCORE);
+    }
+    spawnEffect(clipExplosionPlayer, center);
+    playSound(&Audio::explosionSoundPlayer);
+
+    bombSeeds.clear();
+    collisionGrid.query(center, BOMB_RADIUS, [&](std::uint32_t i) {
+        const Entity* e = entities[i].get();
+        if (!e->life) return;
+        if (e->type != Entity::Type::Asteroid && e->type != Entity::Type::HazardMeteor && e->type != Entity::Type::Boss) return;
+        sf::Vector2f d = e->pos - center;
+        float reach = BOMB_RADIUS + e->R;
+        float distanceSq = d.x * d.x + d.y * d.y;
+        if (distanceSq <= reach * reach) bombSeeds.push_back(SpatialGrid::Neighbor{distanceSq, i});
+    });
+    std::sort(bombSeeds.begin(), bombSeeds.end(), [](const SpatialGrid::Neighbor& a, const SpatialGrid::Neighbor& b) {
+        return a.distanceSq != b.distanceSq ? a.distanceSq < b.distanceSq : a.id < b.id;
     });
+    if (bombHead == bombQueue.size()) {
+        bombDestroyed = 0;
+        bombDepth = 0;
+        bombStartTick = simTick;
+    }
+    for (const SpatialGrid::Neighbor& n : bombSeeds) queueBombTarget(BombItem{entities.handleAt(n.id), center, BOMB_RADIUS, 0});
 }
 
-bool Game::checkLevelComplete() {
-    // Level is complete if there's no active boss AND no asteroids left
-    if (currentBoss && currentBoss->life) {
-        return false; // Boss alive, not complete
+// Works through queued blast targets in order, up to BOMB_WORK_PER_TICK of them. A split rock's
+// fragments are the entities shatterAsteroid just appended; those inside the blast join the end
+// of the queue, one generation deeper. Targets already gone cost nothing.
+void Game::processBombQueue(Player* player) {
+    if (bombHead == bombQueue.size()) return;
+    int work = 0;
+    while (bombHead < bombQueue.size() && work < BOMB_WORK_PER_TICK) {
+        BombItem item = bombQueue[bombHead++];
+        std::unique_ptr<Entity>* slot = entities.get(item.target);
+        if (!slot || !(*slot)->life) continue;
+        Entity* e = slot->get();
+        ++work;
+        ++bombDestroyed;
+        bombDepth = std::max(bombDepth, item.depth);
+        if (e->type == Entity::Type::Asteroid) {
+            std::size_t first = entities.size();
+            shatterAsteroid(static_cast<Asteroid*>(e), player);
+            for (std::size_t i = first; i < entities.size(); ++i) {
+                const Entity* fragment = entities[i].get();
+                sf::Vector2f d = fragment->pos - item.center;
+                float reach = item.radius + fragment->R;
+                if (d.x * d.x + d.y * d.y <= reach * reach) {
+                    queueBombTarget(BombItem{entities.handleAt(i), item.center, item.radius, item.depth + 1});
+                }
+            }
+        } else if (e->type == Entity::Type::HazardMeteor) {
+            e->kill();
+            spawnEffect(clipExplosionSmall, e->pos);
+        } else if (e->type == Entity::Type::Boss) {
+            Boss* boss = static_cast<Boss*>(e);
+            boss->takeDamage(BOMB_BOSS_DAMAGE);
+            spawnEffect(clipExplosionSmall, boss->pos);
+            if (!boss->life) triggerBossExplosion(boss->pos);
+        }
     }
 
-    for (const auto& entity : entities) {
-        if (entity->life && entity->type == Entity::Type::Asteroid) {
-            return false; // Found a live asteroid, not complete
+    if (bombHead == bombQueue.size()) {
+        LOG_INFO(LogCategory::Game, "Smart bomb: %d destroyed over %d ticks, %d split generations",
+                 bombDestroyed, static_cast<int>(simTick - bombStartTick + 1), bombDepth);
+        clearBombQueue();
+    }
+}
+
+// Appends to the queue without growing it: the handled front is dropped first when it is full.
+// A target that still does not fit is left alone.
+void Game::queueBombTarget(const BombItem& item) {
+    if (bombQueue.size() == bombQueue.capacity() && bombHead > 0) {
+        bombQueue.erase(bombQueue.begin(), bombQueue.begin() + static_cast<std::ptrdiff_t>(bombHead));
+        bombHead = 0;
+    }
+    if (bombQueue.size() < bombQueue.capacity()) bombQueue.push_back(item);
+}
+
+void Game::clearBombQueue() {
+    bombQueue.clear();
+    bombHead = 0;
+}
+
+// Enemy shots only ever hit the player: one pass over the shot arrays, no broadphase. The shots
+// around the player are cleared with the hit, so a dense pattern costs one life at a time.
+void Game::checkShotHits(Player* player) {
+    if (enemyShots.removeTouching(player->pos, player->R * PLAYER_SHOT_HITBOX) == 0) return;
+    enemyShots.removeTouching(player->pos, SHOT_HIT_CLEAR_RADIUS);
+    if (absorbHit(player)) return;
+    player->takeDamage();
+    playSound(&Audio::explosionSoundPlayer);
+    spawnEffect(clipExplosionPlayer, player->pos);
+    if (!player->life && player->lives > 0) {
+        startRespawnDelay();
+    }
+}
+
+// Each bullet still flying downs the first drone on the path it flew this tick; a drone that
+// rams the player is destroyed and costs a life like any other hit
+void Game::checkDroneHits(Player* player) {
+    if (drones.size() == 0) return;
+    for (EntityHandle handle : registry.handles(Entity::Type::Bullet)) {
+        Bullet* bullet = static_cast<Bullet*>(entities.get(handle)->get());
+        if (!bullet->life) continue;
+        sf::Vector2f at;
+        if (!drones.removeFirstAlong(bullet->lastPos, bullet->pos, bullet->R, at)) continue;
+        bullet->kill();
+        spawnEffect(clipExplosionSmall, at);
+        playSound(&Audio::explosionSoundAsteroid);
+        if (player) player->addScore(DRONE_SCORE);
+    }
+    if (player && player->life && drones.removeTouching(player->pos, player->R) > 0 && !absorbHit(player)) {
+        player->takeDamage();
+        playSound(&Audio::explosionSoundPlayer);
+        spawnEffect(clipExplosionPlayer, player->pos);
+        if (!player->life && player->lives > 0) {
+            startRespawnDelay();
         }
     }
+    drones.compact();
+}
 
-    // No live boss and no live asteroids found
+// A hit the player's shield takes instead of the player (using up the shield). Nothing hurts
+// the player in Swarm Survival, which is a load test.
+bool Game::absorbHit(Player* player) {
+    if (currentMode == PlayMode::Swarm) return true;
+    if (!player->hasStatus(Player::Status::Shield)) return false;
+    player->endStatus(Player::Status::Shield);
     return true;
 }
 
+void Game::resolveCollision(Entity* a, Entity* b, Player* player) {
+    Entity::Type typeA = a->type;
+    Entity::Type typeB = b->type;
+
+    // Ensure typeA <= typeB for easier checking
+    if (typeA > typeB) {
+        std::swap(a, b);
+        std::swap(typeA, typeB);
+    }
+
+    // --- Collision Pair Handling ---
+
+    // Player(1) <-> Asteroid(2)
+    if (typeA == Entity::Type::Player && typeB == Entity::Type::Asteroid) {
+        if (player && player->life) { // Check player still exists and alive
+             Asteroid* asteroid = static_cast<Asteroid*>(b);
+             if (absorbHit(player)) {
+                 asteroid->kill();
+                 spawnEffect(clipExplosionSmall, asteroid->pos);
+                 playSound(&Audio::explosionSoundAsteroid);
+             } else {
+                 player->takeDamage();
+                 playSound(&Audio::explosionSoundPlayer);
+                 spawnEffect(clipExplosionPlayer, player->pos);
+                 asteroid->kill(); // Asteroid also destroyed
+                 // Check for respawn NEED after takeDamage
+                 if (!player->life && player->lives > 0) {
+                     startRespawnDelay();
+                 }
+             }
+        }
+    }
+    // Player(1) <-> Bullet(3) (Assuming enemy bullets - Requires bullet flag)
+    // else if (typeA == Entity::Type::Player && typeB == Entity::Type::Bullet) {
+    //     Bullet* bullet = static_cast<Bullet*>(b);
+    //     if (bullet->isEnemy && player && player->life) { /* Handle damage/respawn */ }
+    // }
+
+    // Player(1) <-> PowerUp(4) / PowerDown(5)
+    else if (typeA == Entity::Type::Player && (typeB == Entity::Type::PowerUp || typeB == Entity::Type::PowerDown)) {
+         if (player && player->life) {
+             // PowerUp class handles distinguishing between Up/Down
+             PowerUp* item = static_cast<PowerUp*>(b);
+             if (!item->getIsPowerDown() && item->getPowerUpType() == PowerUp::PowerUpType::SmartBomb) detonateBomb(item->pos);
+             else player->applyPowerUp(item);
+             b->kill(); // Consume item
+             playSound(&Audio::powerupSound); // Assuming sound is for good powerups only
+         }
+    }
+     // Player(1) <-> Boss(7)
+    else if (typeA == Entity::Type::Player && typeB == Entity::Type::Boss) {
+         if (player && player->life) {
+             if (absorbHit(player)) {
+                  // static_cast<Boss*>(b)->takeDamage(2); // Minor damage to boss?
+             } else {
+                 player->takeDamage(); // Player takes damage
+                 playSound(&Audio::explosionSoundPlayer);
+                 spawnEffect(clipExplosionPlayer, player->pos);
+                 // static_cast<Boss*>(b)->takeDamage(5); // Maybe boss takes ram damage?
+                 if (!player->life && player->lives > 0) {
+                     startRespawnDelay();
+                 }
+             }
+         }
+    }
+    // Player(1) <-> HazardMeteor(8)
+    else if (typeA == Entity::Type::Player && typeB == Entity::Type::HazardMeteor) {
+         if (player && player->life) {
+             HazardMeteor* meteor = static_cast<HazardMeteor*>(b);
+             if (absorbHit(player)) {
+                  meteor->kill();
+                  spawnEffect(clipExplosionSmall, meteor->pos);
+                  playSound(&Audio::powerdownSound); // Play sound even if shielded
+             } else {
+                 player->startStatus(Player::Status::Slow, 8.0f); // Apply slow effect
+                 player->endStatus(Player::Status::SpeedBoost); // Cancel speed boost
+                 meteor->kill();
+                 spawnEffect(clipExplosionSmall, meteor->pos);
+                 playSound(&Audio::powerdownSound);
+                 // Hazard meteor ALSO damages player
+                 player->takeDamage();
+                 if (!player->life && player->lives > 0) {
+                     startRespawnDelay();
+                 }
+             }
+         }
+    }
+
+    // Asteroid(2) <-> Bullet(3)
+    else if (typeA == Entity::Type::Asteroid && typeB == Entity::Type::Bullet) {
+         // TODO: Ignore collision if bullet->isEnemy?
+         b->kill(); // Bullet
+         shatterAsteroid(static_cast<Asteroid*>(a), player);
+    }
+
+    // Bullet(3) <-> Boss(7)
+    else if (typeA == Entity::Type::Bullet && typeB == Entity::Type::Boss) {
+         Bullet* bullet = static_cast<Bullet*>(a);
+         Boss* boss = static_cast<Boss*>(b);
+         // TODO: Ignore collision if !bullet->isEnemy? (Player bullet hits boss)
+         // if (!bullet->isEnemy) {
+             boss->takeDamage(bullet->damage);
+             bullet->kill();
+             spawnEffect(clipExplosionSmall, bullet->pos); // Hit spark
+             // bossHitSound.play();
+             if (!boss->life) {
+                 triggerBossExplosion(boss->pos);
+                 // Score/music handled in cleanupEntities
+             }
+         // }
+    }
+    // Bullet(3) <-> HazardMeteor(8)
+    else if (typeA == Entity::Type::Bullet && typeB == Entity::Type::HazardMeteor) {
+         a->kill(); // Bullet
+         b->kill(); // Meteor
+         spawnEffect(clipExplosionSmall, b->pos);
+         playSound(&Audio::explosionSoundAsteroid); // Reuse sound
+    }
+
+    // Asteroid-Asteroid and Asteroid-Hazard contacts are solved before this pass (resolveRockContacts)
+}
+
+
+// Returns the entities visited (the scheduler's work units)
+std::uint32_t Game::cleanupEntities() {
+    std::uint32_t visited = static_cast<std::uint32_t>(entities.size());
+    // Walk backwards so swap-removal only moves already-visited entities into the hole.
+    // Handles held to removed entities (player, boss) simply go stale.
+    for (std::size_t i = entities.size(); i-- > 0;) {
+        Entity* e = entities[i].get();
+        if (e->life) continue;
+
+        if (e->type == Entity::Type::Player) {
+            // Nếu life == false NHƯNG timer > 0 nghĩa là đang chờ hồi sinh -> KHÔNG XÓA
+            if (respawnPending()) continue;
+            LOG_DEBUG(LogCategory::Game, "Cleanup: Player removed (No respawn pending).");
+        } else if (e->type == Entity::Type::Boss) {
+            LOG_DEBUG(LogCategory::Game, "Cleanup: Boss entity removed.");
+            if (Player* player = getPlayer()) player->addScore(bossDefeatScoreBonus);
+            if (audio) {
+                audio->bossMusic.stop();
+                if (currentState == State::Playing) audio->backgroundMusic.play();
+            }
+        }
+        registry.remove(*e);
+        entities.removeAt(i);
+    }
+    return visited;
+}
+
+bool Game::checkLevelComplete() {
+    // Level is complete if there's no active boss AND no asteroids left
+    Boss* currentBoss = getBoss();
+    if (currentBoss && currentBoss->life) {
+        return false; // Boss alive, not complete
+    }
+    return registry.liveCount(Entity::Type::Asteroid) == 0;
+}
+
 void Game::nextLevel() {
     currentLevel++;
-    std::cout << "Proceeding to Level " << currentLevel << std::endl;
+    LOG_INFO(LogCategory::Game, "Proceeding to Level %d", currentLevel);
     // State transition to LevelTransition happens in updatePlaying
 }
 
@@ -1298,12 +3072,122 @@ void Game::showStory(int level) {
     }
 }
 
-bool Game::isCollide(const Entity *a, const Entity *b) {
-    // Basic circle collision check
+// Time of first contact, as a fraction of the tick, between 'mover' travelling in a straight line
+// from 'from' to its position and 'target' moving by its step(dt) over the same tick. Contact at
+// the start of the tick counts (time 0); false if they do not meet within it.
+bool Game::sweptCollide(const Entity* mover, sf::Vector2f from, const Entity* target, float dt, float& time) {
+    sf::Vector2f targetMove = target->step(dt);
+    sf::Vector2f start = from - (target->pos - targetMove); // Relative to the target, at the start
+    sf::Vector2f move = (mover->pos - from) - targetMove;
+    float reach = mover->hitRadius() + target->hitRadius();
+    float c = start.x * start.x + start.y * start.y - reach * reach;
+    if (c < 0.f) {
+        time = 0.f;
+        return true;
+    }
+    float a = move.x * move.x + move.y * move.y;
+    float b = start.x * move.x + start.y * move.y; // Half the usual b
+    if (a <= 0.f || b >= 0.f) return false;         // Not closing
+    float disc = b * b - a * c;
+    if (disc < 0.f) return false;                   // Passes wide
+    time = (-b - std::sqrt(disc)) / a;
+    return time <= 1.f;
+}
+
+// Circles around every pixel either can touch first, then the pixels themselves
+bool Game::isCollide(const Entity *a, const Entity *b) const {
     sf::Vector2f diff = b->pos - a->pos;
     float distSq = (diff.x * diff.x) + (diff.y * diff.y);
-    float radiusSum = a->R + b->R;
-    return distSq < (radiusSum * radiusSum);
+    float radiusSum = a->hitRadius() + b->hitRadius();
+    if (distSq >= radiusSum * radiusSum) return false;
+    return masksTouch(a, a->pos, b, b->pos);
+}
+
+// --- Collision Masks ---
+// One set per texture whose shape matters: rocks, meteors, the boss and the ship. Shots and items
+// are small enough for discs.
+void Game::buildCollisionMasks() {
+    // Built by the first Game and kept while any Game uses them
+    static std::mutex cacheMutex;
+    static std::weak_ptr<const MaskLibrary> cache;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    masks = cache.lock();
+    if (masks) return;
+
+    Animation shipIdle, shipThrust;
+    Player::makeShipClips(shipIdle, shipThrust);
+    struct Source { const Animation* clips[2]; int rotations; };
+    const Source sources[] = {
+        { { &animRockLarge, nullptr }, ROCK_MASK_ROTATIONS },
+        { { &animRockMedium, nullptr }, ROCK_MASK_ROTATIONS },
+        { { &animRockSmall, nullptr }, ROCK_MASK_ROTATIONS },
+        { { &animHazardMeteor, nullptr }, ROCK_MASK_ROTATIONS },
+        { { &animBoss1, nullptr }, 1 }, // Never turns
+        { { &shipIdle, &shipThrust }, SHIP_MASK_ROTATIONS },
+    };
+
+    auto library = std::make_shared<MaskLibrary>(); // Entities point into it: never changed once built
+    library->sets.reserve(sizeof(sources) / sizeof(sources[0]));
+    std::size_t bytes = 0, count = 0;
+    for (const Source& source : sources) {
+        sf::Image image = source.clips[0]->sprite.getTexture()->copyToImage();
+        library->sets.emplace_back();
+        for (const Animation* clip : source.clips) {
+            if (clip) library->sets.back().add(image, *clip, source.rotations);
+        }
+        bytes += library->sets.back().byteSize();
+        count += library->sets.back().maskCount();
+    }
+
+    for (int r = 0; r <= DISC_MASK_MAX_RADIUS; ++r) library->discs.push_back(CollisionMask::disc(static_cast<float>(r)));
+    masks = library;
+    cache = library;
+    LOG_INFO(LogCategory::Resource, "Built %zu collision masks (%zu KB).", count, bytes / 1024);
+}
+
+const CollisionMaskSet* Game::masksFor(const sf::Texture* texture) const {
+    for (const CollisionMaskSet& set : masks->sets) {
+        if (texture && set.texture() == texture) return &set;
+    }
+    return nullptr;
+}
+
+// The frame the entity shows this tick (sampled like draw does, without the quality skip) at its angle
+const CollisionMask* Game::hitMask(const Entity* e) const {
+    if (e->masks) {
+        const CollisionMask* mask = e->masks->find(e->anim.frameRect(e->anim.frameAt(simTick - e->spawnTick)), e->angle);
+        if (mask) return mask;
+    }
+    std::size_t radius = static_cast<std::size_t>(std::ceil(e->R));
+    return radius < masks->discs.size() ? &masks->discs[radius] : nullptr;
+}
+
+bool Game::masksTouch(const Entity* a, sf::Vector2f aPos, const Entity* b, sf::Vector2f bPos) const {
+    const CollisionMask* maskA = hitMask(a);
+    const CollisionMask* maskB = hitMask(b);
+    if (!maskA || !maskB) return true; // Plain circle, and the circles already overlap
+    sf::Vector2f d = bPos - aPos;
+    return maskA->overlaps(*maskB, static_cast<int>(std::lround(d.x)), static_cast<int>(std::lround(d.y)));
+}
+
+// Steps both along the tick, a pixel of relative motion at a time, from the moment the circles
+// first meet ('time' in) to the end of the tick; 'time' out is the first step the pixels touch.
+bool Game::sweptMaskTime(const Bullet* bullet, const Entity* target, float& time) const {
+    sf::Vector2f targetMove = target->step(TICK_DT);
+    sf::Vector2f targetStart = target->pos - targetMove;
+    sf::Vector2f move = bullet->pos - bullet->lastPos;
+    sf::Vector2f relative = move - targetMove;
+    float start = time;
+    float length = std::sqrt(relative.x * relative.x + relative.y * relative.y) * (1.f - start);
+    int steps = std::max(1, static_cast<int>(std::ceil(length)));
+    for (int i = 0; i <= steps; ++i) {
+        float t = i == steps ? 1.f : start + (1.f - start) * i / steps;
+        if (masksTouch(bullet, bullet->lastPos + move * t, target, targetStart + targetMove * t)) {
+            time = t;
+            return true;
+        }
+    }
+    return false;
 }
 
 // --- High Score ---
@@ -1311,13 +3195,13 @@ void Game::loadHighScore() {
     std::ifstream inputFile(HIGHSCORE_FILE);
     if (inputFile.is_open()) {
         if (!(inputFile >> highScore)) {
-            std::cerr << "Warning: Could not read high score from " << HIGHSCORE_FILE << ". Using 0." << std::endl;
+            LOG_WARN(LogCategory::Game, "Could not read high score from %s. Using 0.", HIGHSCORE_FILE);
             highScore = 0;
         }
         inputFile.close();
-        std::cout << "Loaded high score: " << highScore << std::endl;
+        LOG_INFO(LogCategory::Game, "Loaded high score: %d", highScore);
     } else {
-        std::cout << "High score file (" << HIGHSCORE_FILE << ") not found. Starting with 0." << std::endl;
+        LOG_INFO(LogCategory::Game, "High score file (%s) not found. Starting with 0.", HIGHSCORE_FILE);
         highScore = 0;
     }
 }
@@ -1327,9 +3211,9 @@ void Game::saveHighScore() {
     if (outputFile.is_open()) {
         outputFile << highScore;
         outputFile.close();
-        std::cout << "Saved new high score: " << highScore << std::endl;
+        LOG_INFO(LogCategory::Game, "Saved new high score: %d", highScore);
     } else {
-        std::cerr << "Error: Could not open " << HIGHSCORE_FILE << " for saving high score." << std::endl;
+        LOG_ERROR(LogCategory::Game, "Could not open %s for saving high score.", HIGHSCORE_FILE);
     }
 }
 
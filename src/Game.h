@@ -3,36 +3,96 @@
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
-#include <list>
 #include <memory>
+#include "CollisionMask.h"
 #include "Entity.h"
+#include "EntityRegistry.h"
 #include "Player.h"
 #include "Boss.h"
+#include "BulletPatterns.h"
+#include "DroneSwarm.h"
 #include "Asteroid.h"
+#include "ParticleSystem.h"
+#include "TimerWheel.h"
+#include "Session.h"
+#include "Snapshot.h"
+#include "RewindBuffer.h"
+#include "FramePacer.h"
+#include "GravityField.h"
+#include "InputSampler.h"
+#include "JobScheduler.h"
+#include "RockSolver.h"
+#include "SpatialGrid.h"
+#include "SpriteBatch.h"
+#include <chrono>
 #include <fstream> // For file I/O
 #include <limits> // For std::numeric_limits
+#include <string>
+#include <vector>
 
 class ResourceManager;
 // class Animation;
 // class Asteroid;
 // class Bullet;
 // class PowerUp;
-// class Effect;
 class HazardMeteor; // Forward declare
 
+// Command-line options (parsed in main.cpp)
+struct GameOptions {
+    // Where black holes appear: Campaign gravity levels only, every level and mode, or everywhere
+    // with every large asteroid pulling too
+    enum class GravityMode : std::uint8_t { Off, Levels, Wells, Rocks };
+
+    bool fixedSeed = false;
+    std::uint32_t seed = 0;  // --seed: Random seed for every run (default: time based)
+    std::string recordPath;  // --record: write a session (seed, inputs, checksums) for each run started
+    std::string replayPath;  // --replay: re-simulate a session headlessly and verify every checksum
+    std::string tracePath;   // --trace: per-tick dump of every entity, for divergence_finder
+    std::size_t rewindBudget = 4 * 1024 * 1024; // --rewind-mb: memory for the rewind history (0 = off)
+    FramePacer::Mode pacing = FramePacer::Mode::VSync; // --pacing: vsync, limit or uncapped
+    int targetHz = 60;       // --fps: limiter rate / display rate for dropped-frame counts
+    bool inputThread = true; // --no-input-thread: poll the keyboard on the game thread instead
+    std::string latencyPath; // --latency: log input-to-present latency per frame
+    int qualityLevel = -1;   // --quality: pin the cosmetic quality level 0-3 (-1 = adapt to the frame budget)
+    int swarmTarget = 20000; // --swarm: live asteroids Swarm Survival ramps up to
+    int rockThreads = -1;    // --rock-threads: workers for the rock contact solver (-1 = one per spare core, up to 3)
+    GravityMode gravity = GravityMode::Levels; // --gravity: off, levels, wells or rocks
+    float gravityTheta = 0.5f; // --gravity-theta: Barnes-Hut opening angle (0 = exact pairwise sum)
+    int gravityThreads = -1;   // --gravity-threads: workers for the gravity pass (-1 = like --rock-threads)
+    bool headless = false;     // Session server worlds: no window, audio, UI text or particles (see SessionServer)
+};
+
 class Game {
 public:
     enum class State { MainMenu, Instructions, Story, Playing, LevelTransition, Paused, GameOver }; // Added Story
-    enum class PlayMode { Campaign, Survival };
+    enum class PlayMode { Campaign, Survival, Swarm }; // Swarm: Survival scaled to tens of thousands of rocks (load test)
+    // Kinds of events in the gameplay timer wheel (TimerEvent::kind)
+    enum class GameTimer : std::uint16_t { SpawnAsteroid, SpawnPowerUp, SpawnHazardMeteor, EntityExpire, PlayerStatusEnd, BossShoot, SwarmWave, SpawnDrones };
 
-    Game();
+    explicit Game(const GameOptions& options = GameOptions());
     ~Game();
 
     void run();
+    int exitStatus() const { return exitCode; } // Non-zero if a replay diverged, or a steady frame allocated (TRACK_ALLOCATIONS)
+
+    // Headless worlds (GameOptions::headless): the owner steps the simulation one tick at a time
+    // with its own input, story and transition screens included. The Random state and the entity
+    // blocks travel with the world, so consecutive ticks may run on different threads (one at a time).
+    void startHeadless(PlayMode mode, std::uint32_t seed); // A new run from the menu's path
+    bool stepHeadless(const PlayerInput& input); // One tick; false once the run is over
+    void captureWorld(WorldSnapshot& world);     // The world as the last tick left it
+    std::uint64_t worldHash() { return worldChecksum(); }
+    std::uint64_t ticksPlayed() const { return runTicks; }
+    int score() const { return headlessScore; } // Of the run, also once the ship is gone at game over
+    // Headless TRACK_ALLOCATIONS builds: steps Survival runs for 'ticks' with a bot and returns 0 if
+    // no tick after the warm-up touched the heap, 1 if one did, 2 if this build cannot tell
+    int runAllocationCheck(std::uint64_t ticks, std::uint32_t seed);
 
 private:
     sf::RenderWindow window;
     sf::Clock clock;
+    FramePacer pacer; // Frame rate (vsync/limiter/uncapped) and frame-time statistics
+    std::chrono::steady_clock::time_point frameWorkStart; // For the quality controller's frame budget
 
     State currentState;
     PlayMode currentMode;
@@ -40,9 +100,20 @@ private:
     Player::ShipType selectedShipType; // Track selected ship
 
     ResourceManager& resourceManager;
-    std::list<std::unique_ptr<Entity>> entities;
-    Player* player;
-    Boss* currentBoss; // Pointer to the current boss
+    // Headless worlds only: the blocks of their entities, whichever thread steps them (EntityPool::Binding)
+    std::unique_ptr<EntityPool::Arena> entityArena;
+    // Dense storage with generational handles; iterate by index while spawning (inserts append)
+    SlotMap<std::unique_ptr<Entity>> entities;
+    EntityRegistry registry; // Per-type live counts and handle lists, updated as entities come and go
+    EntityHandle playerHandle;
+    EntityHandle bossHandle; // Current boss (stale when there is none)
+
+    // --- Cosmetic particles (explosions, hit sparks), kept out of the entity list ---
+    ParticleSystem particles;
+    ParticleSystem::ClipId clipExplosionAsteroid; // Type C
+    ParticleSystem::ClipId clipExplosionPlayer;   // Type B
+    ParticleSystem::ClipId clipExplosionSmall;    // Type A
+    ParticleSystem::ClipId clipExplosionBoss;
 
     // --- Animations (Load once) ---
     // Player (Placeholder - Requires updated spritesheet)
@@ -61,24 +132,156 @@ private:
     // Animation animWeaponPU;
     // Animation animSpeedPU;
     Animation animHazardMeteor; // Slow meteor anim
-    // Explosions
-    Animation animExplosionAsteroid; // Type C
-    Animation animExplosionPlayer;   // Type B
-    Animation animExplosionSmall;    // Type A
-    Animation animExplosionBoss;
     // Boss
     Animation animBoss1;
+    // Drones (the ship's thrust frame, small and tinted)
+    Animation animDrone;
     // Animation animBoss2; // If add Boss 2
 
     // --- Game variables ---
     int currentLevel;
-    float asteroidSpawnTimer;
-    float powerUpSpawnTimer;
-    float hazardMeteorSpawnTimer; // Timer for slow meteors
-    float playerRespawnTimer;
+    // Spawns, entity lifetimes, boss guns and player statuses are all one-shot timers on simTick;
+    // handlers reschedule the recurring ones. Only expirations cost anything per tick.
+    TimerWheel timers;
+    std::uint64_t playTick;    // Playing ticks, still counting while simTick is frozen for a respawn
+    std::uint64_t respawnTick; // playTick at which the dead player respawns (0 = not respawning)
     int bossDefeatScoreBonus;
     float storyDisplayTimer; // Timer for showing story text
+    float transitionTimer;   // Time left on the level complete screen
     int highScore; // Track high score
+    std::uint64_t simTick;  // Simulation ticks of entity time (animation/lifetime clock)
+    float tickAccumulator;  // Unsimulated frame time, consumed in TICK_DT steps
+
+    // --- Determinism: recorded sessions, replay verification, traces ---
+    GameOptions options;
+    std::uint32_t runSeed;             // Random seed of the current run
+    PlayerInput tickInput;             // Controls for the Playing tick being simulated
+    bool fireRequested;                // Space pressed since the last Playing tick
+    std::uint64_t fireStampNs;         // When that press was polled (latency mode)
+    std::uint64_t runTicks;            // Playing ticks since the run started (session record index)
+    bool replaying;
+    std::uint64_t replayExpected;      // Checksum the session recorded for the current tick
+    std::uint64_t replayMismatchTick;  // First run tick whose checksum differed (0 = none yet)
+    SessionWriter sessionWriter;
+    SessionTrace sessionTrace;
+    int exitCode;
+    std::uint64_t headlessRng; // Random state between stepHeadless calls
+    int headlessScore;
+
+    // --- Suspend/resume: F5 saves the world to a snapshot file, F9 loads it back ---
+    SnapshotCodec snapshotCodec;
+    WorldSnapshot snapshotWorld; // Reused between saves/loads
+
+    // --- Input: sampled on its own thread, consumed right before each tick ---
+    InputSampler inputSampler;
+    bool inputHeld[InputSampler::KEY_COUNT];
+    // Latency mode (--latency): stamps of the input consumed by this frame's ticks, timed again
+    // once the frame has been presented
+    static const int MAX_FRAME_STAMPS = 64;
+    std::uint64_t frameStamps[MAX_FRAME_STAMPS];
+    int frameStampCount;
+    Histogram inputLatency;
+    std::ofstream latencyLog;
+    unsigned long long latencyFrames;
+
+    // --- Rewind: every Playing tick goes into a bounded history that Paused can step through ---
+    RewindBuffer rewind;
+    std::size_t rewindCursor;      // Frame shown while rewound
+    bool rewound;                  // The world was restored from the history since pausing
+    double rewindCaptureSeconds;   // Capture cost, for the report on pause
+    unsigned long long rewindCaptures;
+
+    // --- Deferrable housekeeping, time-sliced with deadlines ---
+    // Tick jobs touch the simulation, so they are budgeted in work units (entity visits) and the
+    // schedule replays exactly; the HUD is presentation only and gets whatever wall time the
+    // frame has left after its ticks.
+    JobScheduler tickJobs;
+    JobScheduler frameJobs;
+    JobScheduler::JobId cleanupJob;
+    JobScheduler::JobId levelCheckJob;
+    JobScheduler::JobId hudJob;
+    bool levelComplete; // Result of the last level check (Campaign)
+
+    // --- Collision broadphase: rocks, items and the boss are binned each tick; the player and
+    // bullets query the grid. Hits are resolved in (lower, higher) dense index order. ---
+    SpatialGrid collisionGrid;
+    std::vector<std::uint64_t> collisionPairs; // Lower dense index << 32 | higher
+    unsigned long long pairTests;              // Narrow-phase tests in the last pass
+    SpriteBatch rockBatch;                     // Asteroids and meteors, one draw call per texture
+
+    // --- Narrow phase: pairs whose circles (around every opaque pixel) overlap are confirmed with
+    // pixel masks, one set per sprite texture, built at load. Entities without one use a disc.
+    // The masks only depend on the art, so every Game in the process shares them (megabytes each). ---
+    struct MaskLibrary {
+        std::vector<CollisionMaskSet> sets;
+        std::vector<CollisionMask> discs; // Indexed by radius rounded up
+    };
+    std::shared_ptr<const MaskLibrary> masks;
+
+    // --- Rock-rock contacts: asteroids and meteors bounce off each other (see RockSolver). Bodies
+    // are gathered from the registry lists every tick and written back after the solve. ---
+    RockSolver rockSolver;
+    std::vector<EntityHandle> rockBodies; // Entity of each solver body
+    double rockSolveSeconds;              // Totals for the exit report (wall time, never fed back)
+    double rockSolveMax;
+    std::uint64_t rockSolves;
+    std::uint64_t rockSkipped;            // Ticks with more rock than the screen can hold
+    std::size_t rockContactsMax;
+
+    // --- Gravity wells: black holes (and in Rocks mode every large asteroid) pull on rocks, meteors,
+    // bullets and the player through a Barnes-Hut field rebuilt every tick (see GravityField). The
+    // pull is added to velocities right before entities move; the wells follow from the mode and
+    // level, so snapshots do not store them. ---
+    std::vector<sf::Vector2f> wells;
+    GravityField gravity;
+    std::vector<EntityHandle> gravityBodies; // Entity of each probe
+    sf::CircleShape wellCore;
+    sf::CircleShape wellHalo;
+    double gravitySeconds;                   // Totals for the exit report (wall time, never fed back)
+    double gravityMax;
+    std::uint64_t gravitySolves;
+    std::size_t gravitySourcesMax;
+    std::size_t gravityProbesMax;
+
+    // --- Laser: a hitscan beam. Shots are queued when fired and cast against the broadphase once
+    // it is built for the tick; hits come back nearest first and the beam pierces a few. ---
+    struct BeamShot { sf::Vector2f from; float angle; };
+    struct BeamHit { float distance; std::uint32_t index; }; // Dense entity index
+    struct BeamTrace { sf::Vector2f from; float angle; float length; std::uint64_t tick; };
+    std::vector<BeamShot> pendingBeams;
+    std::vector<BeamHit> beamHits;     // Last castRay result
+    std::vector<BeamTrace> beamTraces; // Beams still on screen (cosmetic)
+
+    // --- Homing missiles: each re-picks the nearest target ahead of it every tick from the
+    // broadphase, bounded by how far its current target is ---
+    std::vector<SpatialGrid::Neighbor> missileCandidates;
+
+    // --- Smart bomb: everything in the blast is destroyed breadth first, nearest first. Fragments
+    // of a rock split by the blast that land inside it queue behind the current ring. At most
+    // BOMB_WORK_PER_TICK targets are handled per tick; the rest carry over to the next. ---
+    struct BombItem { EntityHandle target; sf::Vector2f center; float radius; int depth; };
+    std::vector<BombItem> bombQueue; // FIFO from bombHead
+    std::size_t bombHead;
+    std::vector<SpatialGrid::Neighbor> bombSeeds; // Scratch for sorting a new blast
+    int bombDestroyed;       // Since the queue was last empty
+    int bombDepth;           // Deepest split generation reached
+    std::uint64_t bombStartTick;
+
+    // --- Boss bullet patterns: shots are flat arrays, not entities (see BulletPatterns) ---
+    BulletPatterns enemyShots;
+    SpriteBatch shotBatch;
+
+    // --- Hunter drones: flocking ships chasing the player, flat arrays like the shots (see DroneSwarm) ---
+    DroneSwarm drones;
+    SpriteBatch droneBatch;
+    double droneSeconds;      // Update totals for the exit report (wall time, never fed back)
+    double droneMax;
+    std::uint64_t droneUpdates;
+
+    // --- Swarm Survival overlay ---
+    sf::Text swarmText;
+    int swarmOverlayFrames; // Frames until the overlay text is rebuilt
+    double tickMs;          // Smoothed simulation time per Playing tick
 
     // --- UI Elements ---
     sf::Font uiFont;
@@ -89,27 +292,78 @@ private:
     sf::Text shipSelectionText; // Text to display selected ship
     sf::Text highScoreText; // Text to display high score
     sf::Sprite gameOverSprite; // Sprite for Game Over image
+    sf::Sprite backgroundSprite;
+    sf::RectangleShape bossBarBackground;
+    sf::RectangleShape bossBarFill;
+    sf::RectangleShape pauseOverlay;
+
+    // HUD text is only rebuilt when a shown value changes; the buffers keep their capacity between rebuilds
+    int hudScore;
+    int hudLives;
+    int hudLevel;
+    PlayMode hudMode;
+    sf::String hudBuffer;
+
+    // Allocation tracking (TRACK_ALLOCATIONS builds): steady-state Playing frames must not allocate
+    unsigned int steadyFrames;
+    unsigned long long allocFramesChecked;
+    unsigned long long allocFramesFailed;
 
-    // --- Sounds ---
-    sf::Sound shootSound;
-    sf::Sound explosionSoundAsteroid;
-    sf::Sound explosionSoundPlayer;
-    sf::Sound powerupSound;
-    sf::Sound powerdownSound; // Sound for slow meteor hit
-    sf::Sound bossHitSound; // TODO: Add sound file
-    sf::Sound bossExplodeSound; // TODO: Add sound file
-    sf::Music backgroundMusic;
-    sf::Music bossMusic;
+    // --- Sounds (none in headless worlds: every sf::Sound and sf::Music holds an audio source) ---
+    struct Audio {
+        sf::Sound shootSound;
+        sf::Sound explosionSoundAsteroid;
+        sf::Sound explosionSoundPlayer;
+        sf::Sound powerupSound;
+        sf::Sound powerdownSound; // Sound for slow meteor hit
+        sf::Sound bossHitSound; // TODO: Add sound file
+        sf::Sound bossExplodeSound; // TODO: Add sound file
+        sf::Music backgroundMusic;
+        sf::Music bossMusic;
+    };
+    std::unique_ptr<Audio> audio;
 
     // --- Methods ---
     void initialize();
     void loadResources(); // Loads textures/sounds AND creates Animation objects
     void setupUI();
     void setState(State newState);
+    void playSound(sf::Sound Audio::*sound);
+    void resumeMusic(); // The boss theme while a boss is alive, else the background music
+    void stopMusic();
 
     void handleInput();
     void update(float dt);
     void render();
+    EntityHandle addEntity(std::unique_ptr<Entity> entity);
+    TimerId scheduleTimer(GameTimer kind, float seconds, int arg = 0, EntityHandle target = EntityHandle());
+    void onTimer(const TimerEvent& event);
+    void scheduleSpawnTimers(); // Fresh spawn timers for a new level/run
+    void startRespawnDelay();
+    bool respawnPending() const { return respawnTick != 0; }
+    Player* getPlayer(); // nullptr if the player handle is stale
+    Boss* getBoss();     // nullptr if there is no live boss entity
+    void updateHud();
+    void setHudText(sf::Text& text, const char* value);
+    void checkFrameAllocations(State frameStartState);
+
+    void beginRun(); // Seeds Random and starts the session recording for a new run
+    PlayerInput sampleInput();
+    void discardInput(); // Keeps the key states current while no tick consumes them
+    void noteInputStamp(std::uint64_t stampNs);
+    void recordFrameLatency(); // After display(): latency of every input this frame consumed
+    std::uint64_t worldChecksum();
+    void finishTick(); // Checksum the tick for the session/replay/trace
+    void runReplay();
+
+    void captureSnapshot(WorldSnapshot& world);
+    void restoreSnapshot(const WorldSnapshot& world);
+    void saveSnapshot(const std::string& path);
+    void loadSnapshot(const std::string& path);
+    void recordRewindFrame();
+    void stepRewind(int ticks); // While paused: <0 goes back in the history, >0 forward (simulating past its end)
+    void updatePauseText();
+    void logFramePacing(const char* when); // Frame-time percentiles so far (F3, and on exit; with latency if measured)
 
     void loadHighScore();
     void saveHighScore();
@@ -117,6 +371,7 @@ private:
     // State updates
     void updateMainMenu(float dt);
     void updatePlaying(float dt);
+    void stepPlaying(float dt); // The simulation part of a Playing tick
     void updateLevelTransition(float dt);
     void updateGameOver(float dt);
     void updateStory(float dt);
@@ -134,21 +389,50 @@ private:
     // Game logic helpers
     void loadLevel(int levelNum);
     void startSurvival();
+    void startSwarm();
+    void spawnSwarmWave();
+    void updateSwarmOverlay();
     void resetGame(bool fullReset = false); // Add flag for partial reset (keep score/level)
     void spawnPlayer(); // Helper to create/add player
     void spawnAsteroid(Asteroid::Size size, sf::Vector2f pos = {-100, -100});
     void spawnBullet();
     void spawnPowerUp();
     void spawnHazardMeteor();
-    void spawnEffect(Animation& anim, sf::Vector2f pos);
+    void spawnEffect(ParticleSystem::ClipId clip, sf::Vector2f pos);
     void spawnBoss(int level); // Spawn boss based on level
-    void spawnBossBullet(Boss* boss, int firePointIndex); // Boss shooting logic
+    void fireBossPattern(Boss* boss, int firePointIndex); // Starts the gun's pattern for the current phase
+    void updateEnemyShots();
+    void spawnDronePack(int count);
+    void updateDrones();
     void triggerBossExplosion(sf::Vector2f bossPos); // Handle boss death effect
     void cycleShipSelection();
     void updateShipSelectionText();
 
+    void buildCollisionMasks();
+    const CollisionMaskSet* masksFor(const sf::Texture* texture) const;
+    const CollisionMask* hitMask(const Entity* e) const; // Its shape this tick (nullptr = circle only)
+    bool masksTouch(const Entity* a, sf::Vector2f aPos, const Entity* b, sf::Vector2f bPos) const;
+    bool sweptMaskTime(const Bullet* bullet, const Entity* target, float& time) const; // Refines sweptCollide's time
+
+    void placeWells(); // For the current mode and level
+    void applyGravity(float dt);
+    void checkWellHits(Player* player);
+    void resolveRockContacts();
     void checkCollisions();
-    void cleanupEntities();
+    void resolveCollision(Entity* a, Entity* b, Player* player);
+    bool absorbHit(Player* player);
+    void checkShotHits(Player* player);
+    void checkDroneHits(Player* player);
+    std::size_t castRay(sf::Vector2f from, sf::Vector2f dir, float length, float radius); // Fills beamHits
+    void fireBeam(const BeamShot& shot, Player* player);
+    void shatterAsteroid(Asteroid* asteroid, Player* player);
+    void guideMissiles();
+    void detonateBomb(sf::Vector2f center);
+    void processBombQueue(Player* player);
+    void queueBombTarget(const BombItem& item);
+    void clearBombQueue();
+    bool missileTarget(const Bullet* missile, sf::Vector2f& at); // Where its current target is, if it still exists
+    std::uint32_t cleanupEntities();
 
     bool checkLevelComplete();
     void nextLevel();
@@ -156,7 +440,8 @@ private:
     void showInstructions();
     void showStory(int level); // Show story based on level
 
-    static bool isCollide(const Entity *a, const Entity *b);
+    bool isCollide(const Entity *a, const Entity *b) const;
+    static bool sweptCollide(const Entity* mover, sf::Vector2f from, const Entity* target, float dt, float& time);
 };
 
 #endif // GAME_H
\ No newline at end of file
@@ -0,0 +1,340 @@
+#include "GravityField.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const int KEY_LEVELS = 16;                 // Bits per axis in a Morton key (tree depth limit)
+    const float KEY_CELLS = 65536.f;           // 1 << KEY_LEVELS
+    const int STACK_SIZE = 3 * KEY_LEVELS + 4; // A walk keeps at most 3 siblings per level waiting
+    const std::size_t GROUPS_PER_CHUNK = 4;
+    const std::size_t PARALLEL_MIN_GROUPS = 4 * GROUPS_PER_CHUNK; // Fewer: the caller does it all
+
+    // Bits 0-15 of v moved to the even bits
+    std::uint32_t spread(std::uint32_t v) {
+        v &= 0xFFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    }
+
+    // Sort entry for a point: its Morton key in a square from (minX, minY), 'scale' cells per px,
+    // above its index (so equal keys keep the order points were added in)
+    std::uint64_t sortEntry(float x, float y, float minX, float minY, float scale, std::size_t index) {
+        std::uint32_t qx = static_cast<std::uint32_t>(std::min(KEY_CELLS - 1.f, (x - minX) * scale));
+        std::uint32_t qy = static_cast<std::uint32_t>(std::min(KEY_CELLS - 1.f, (y - minY) * scale));
+        std::uint64_t key = spread(qx) | (spread(qy) << 1);
+        return key << 32 | static_cast<std::uint64_t>(index);
+    }
+
+    // Quadrant of a sorted entry at a tree level: bit 0 = right half, bit 1 = bottom half
+    int digit(std::uint64_t entry, int level) {
+        return static_cast<int>((entry >> (32 + 2 * (KEY_LEVELS - 1 - level))) & 3);
+    }
+}
+
+GravityField::GravityField() :
+    theta(0.5f), softeningSq(1.f), sourceCapacity(0), probeCapacity(0), lastStats(), scratch(1),
+    nextGroup(0), interactions(0) {}
+
+void GravityField::setAccuracy(float value) {
+    theta = std::max(0.f, value);
+}
+
+void GravityField::setSoftening(float length) {
+    softeningSq = std::max(length * length, 1e-6f); // Never zero: a probe on a source gets no pull, not NaN
+}
+
+void GravityField::reserve(std::size_t sources, std::size_t probes) {
+    sourceCapacity = sources;
+    probeCapacity = probes;
+    for (std::vector<float>* column : { &srcX, &srcY, &srcMass, &sortedX, &sortedY, &sortedMass }) column->reserve(sources);
+    order.reserve(sources);
+    nodes.reserve(2 * sources + 1);
+    for (std::vector<float>* column : { &probeX, &probeY, &pullX, &pullY }) column->reserve(probes);
+    probeOrder.reserve(probes);
+    groups.reserve(probes);
+    // A list holds at most every source and every node
+    for (Scratch& list : scratch) {
+        for (std::vector<float>* column : { &list.x, &list.y, &list.mass }) column->reserve(3 * sources + 1);
+    }
+}
+
+void GravityField::setWorkers(int count) {
+    if (count < 0) count = 0;
+    if (count == pool.size()) return;
+    pool.resize(0); // The workers' lists are about to move
+    scratch.resize(static_cast<std::size_t>(count) + 1);
+    reserve(sourceCapacity, probeCapacity);
+    pool.resize(count);
+}
+
+void GravityField::clear() {
+    for (std::vector<float>* column : { &srcX, &srcY, &srcMass, &probeX, &probeY, &pullX, &pullY }) column->clear();
+}
+
+void GravityField::addSource(sf::Vector2f pos, float strength) {
+    if (srcX.size() >= sourceCapacity) {
+        ++lastStats.dropped;
+        return;
+    }
+    srcX.push_back(pos.x);
+    srcY.push_back(pos.y);
+    srcMass.push_back(strength);
+}
+
+bool GravityField::addProbe(sf::Vector2f pos) {
+    if (probeX.size() >= probeCapacity) {
+        ++lastStats.dropped;
+        return false;
+    }
+    probeX.push_back(pos.x);
+    probeY.push_back(pos.y);
+    pullX.push_back(0.f);
+    pullY.push_back(0.f);
+    return true;
+}
+
+void GravityField::solve() {
+    lastStats.sources = srcX.size();
+    lastStats.probes = probeX.size();
+    lastStats.nodes = 0;
+    lastStats.groups = 0;
+    lastStats.interactions = 0;
+    if (srcX.empty() || probeX.empty()) return; // Pulls stay zero
+
+    buildTree();
+    groupProbes();
+    lastStats.nodes = nodes.size();
+    lastStats.groups = groups.size();
+
+    interactions.store(0, std::memory_order_relaxed);
+    nextGroup.store(0, std::memory_order_relaxed);
+    if (groups.size() < PARALLEL_MIN_GROUPS) {
+        runGroups(scratch[0]);
+    } else {
+        auto job = [this](std::size_t slot) { runGroups(scratch[slot]); };
+        pool.run(job);
+    }
+    lastStats.interactions = interactions.load(std::memory_order_relaxed);
+}
+
+// Keys come from the sources' bounding square
+void GravityField::buildTree() {
+    float minX = srcX[0], maxX = srcX[0], minY = srcY[0], maxY = srcY[0];
+    for (std::size_t i = 1; i < srcX.size(); ++i) {
+        minX = std::min(minX, srcX[i]);
+        maxX = std::max(maxX, srcX[i]);
+        minY = std::min(minY, srcY[i]);
+        maxY = std::max(maxY, srcY[i]);
+    }
+    float side = std::max(1.f, std::max(maxX - minX, maxY - minY));
+    float scale = KEY_CELLS / side;
+
+    order.clear();
+    for (std::size_t i = 0; i < srcX.size(); ++i) order.push_back(sortEntry(srcX[i], srcY[i], minX, minY, scale, i));
+    std::sort(order.begin(), order.end());
+
+    sortedX.clear();
+    sortedY.clear();
+    sortedMass.clear();
+    for (std::uint64_t entry : order) {
+        std::uint32_t i = static_cast<std::uint32_t>(entry);
+        sortedX.push_back(srcX[i]);
+        sortedY.push_back(srcY[i]);
+        sortedMass.push_back(srcMass[i]);
+    }
+
+    nodes.clear();
+    nodes.push_back(Node());
+    float half = side / 2.f;
+    build(0, 0, static_cast<std::uint32_t>(order.size()), 0, minX + half, minY + half, half);
+}
+
+// Fills 'node' with the sorted range [begin, end), whose keys agree above 'level'. Children of a
+// node are appended together, so they sit next to each other.
+void GravityField::build(std::uint32_t node, std::uint32_t begin, std::uint32_t end, int level, float cx, float cy, float half) {
+    for (;;) {
+        if (end - begin <= static_cast<std::uint32_t>(LEAF_SIZE) || level == KEY_LEVELS) {
+            float mass = 0.f, mx = 0.f, my = 0.f;
+            for (std::uint32_t s = begin; s < end; ++s) {
+                mass += sortedMass[s];
+                mx += sortedMass[s] * sortedX[s];
+                my += sortedMass[s] * sortedY[s];
+            }
+            bool weighed = mass > 0.f;
+            nodes[node] = Node{cx, cy, half, mass, weighed ? mx / mass : cx, weighed ? my / mass : cy, begin, end - begin, true};
+            return;
+        }
+
+        // The range is sorted, so each quadrant's entries follow the previous one's
+        std::uint32_t bounds[5] = { begin, 0, 0, 0, end };
+        for (int q = 1; q < 4; ++q) {
+            bounds[q] = static_cast<std::uint32_t>(std::partition_point(order.begin() + bounds[q - 1], order.begin() + end,
+                [&](std::uint64_t entry) { return digit(entry, level) < q; }) - order.begin());
+        }
+        int occupied = 0, only = 0;
+        for (int q = 0; q < 4; ++q) {
+            if (bounds[q + 1] == bounds[q]) continue;
+            ++occupied;
+            only = q;
+        }
+
+        float quarter = half / 2.f;
+        if (occupied == 1) { // Skip the level instead of adding a node with one child
+            cx += (only & 1) ? quarter : -quarter;
+            cy += (only & 2) ? quarter : -quarter;
+            half = quarter;
+            ++level;
+            continue;
+        }
+
+        std::uint32_t first = static_cast<std::uint32_t>(nodes.size());
+        for (int i = 0; i < occupied; ++i) nodes.push_back(Node());
+        float mass = 0.f, mx = 0.f, my = 0.f;
+        std::uint32_t child = first;
+        for (int q = 0; q < 4; ++q) {
+            if (bounds[q + 1] == bounds[q]) continue;
+            build(child, bounds[q], bounds[q + 1], level + 1, cx + ((q & 1) ? quarter : -quarter), cy + ((q & 2) ? quarter : -quarter), quarter);
+            const Node& c = nodes[child];
+            mass += c.mass;
+            mx += c.mass * c.mx;
+            my += c.mass * c.my;
+            ++child;
+        }
+        bool weighed = mass > 0.f;
+        nodes[node] = Node{cx, cy, half, mass, weighed ? mx / mass : cx, weighed ? my / mass : cy, first, static_cast<std::uint32_t>(occupied), false};
+        return;
+    }
+}
+
+// Probes in Morton order over their own bounding square, cut where the curve leaves a quadrant
+void GravityField::groupProbes() {
+    float minX = probeX[0], maxX = probeX[0], minY = probeY[0], maxY = probeY[0];
+    for (std::size_t i = 1; i < probeX.size(); ++i) {
+        minX = std::min(minX, probeX[i]);
+        maxX = std::max(maxX, probeX[i]);
+        minY = std::min(minY, probeY[i]);
+        maxY = std::max(maxY, probeY[i]);
+    }
+    float scale = KEY_CELLS / std::max(1.f, std::max(maxX - minX, maxY - minY));
+
+    probeOrder.clear();
+    for (std::size_t i = 0; i < probeX.size(); ++i) probeOrder.push_back(sortEntry(probeX[i], probeY[i], minX, minY, scale, i));
+    std::sort(probeOrder.begin(), probeOrder.end());
+
+    groups.clear();
+    split(0, static_cast<std::uint32_t>(probeOrder.size()), 0);
+}
+
+void GravityField::split(std::uint32_t begin, std::uint32_t end, int level) {
+    if (end - begin > static_cast<std::uint32_t>(GROUP_SIZE) && level < KEY_LEVELS) {
+        std::uint32_t from = begin;
+        for (int q = 0; q < 4; ++q) {
+            std::uint32_t to = q == 3 ? end : static_cast<std::uint32_t>(std::partition_point(probeOrder.begin() + from, probeOrder.begin() + end,
+                [&](std::uint64_t entry) { return digit(entry, level) <= q; }) - probeOrder.begin());
+            if (to > from) split(from, to, level + 1);
+            from = to;
+        }
+        return;
+    }
+    // A quadrant at the last level may still hold more (probes on the same spot): cut it in runs
+    for (std::uint32_t first = begin; first < end; first += GROUP_SIZE) {
+        Group group;
+        group.begin = first;
+        group.end = std::min(end, first + static_cast<std::uint32_t>(GROUP_SIZE));
+        std::uint32_t i = static_cast<std::uint32_t>(probeOrder[first]);
+        group.minX = group.maxX = probeX[i];
+        group.minY = group.maxY = probeY[i];
+        for (std::uint32_t k = first + 1; k < group.end; ++k) {
+            i = static_cast<std::uint32_t>(probeOrder[k]);
+            group.minX = std::min(group.minX, probeX[i]);
+            group.maxX = std::max(group.maxX, probeX[i]);
+            group.minY = std::min(group.minY, probeY[i]);
+            group.maxY = std::max(group.maxY, probeY[i]);
+        }
+        groups.push_back(group);
+    }
+}
+
+std::uint64_t GravityField::walk(const Group& group, Scratch& list) {
+    list.x.clear();
+    list.y.clear();
+    list.mass.clear();
+    float thetaSq = theta * theta;
+    float groupCx = (group.minX + group.maxX) / 2.f, groupCy = (group.minY + group.maxY) / 2.f;
+    float groupHalfW = (group.maxX - group.minX) / 2.f, groupHalfH = (group.maxY - group.minY) / 2.f;
+    std::uint32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    // 1. The interaction list: whole nodes far enough from every probe of the group, and the
+    //    single sources of the leaves that are not
+    while (top > 0) {
+        const Node& n = nodes[stack[--top]];
+        if (n.leaf) {
+            for (std::uint32_t s = n.first; s < n.first + n.count; ++s) {
+                list.x.push_back(sortedX[s]);
+                list.y.push_back(sortedY[s]);
+                list.mass.push_back(sortedMass[s]);
+            }
+            continue;
+        }
+        // A box touching the group's is never far from it, whatever the centre of mass says
+        bool touching = std::fabs(n.cx - groupCx) <= n.half + groupHalfW && std::fabs(n.cy - groupCy) <= n.half + groupHalfH;
+        float ex = std::max(0.f, std::max(group.minX - n.mx, n.mx - group.maxX));
+        float ey = std::max(0.f, std::max(group.minY - n.my, n.my - group.maxY));
+        float size = 2.f * n.half;
+        if (!touching && size * size < thetaSq * (ex * ex + ey * ey)) {
+            list.x.push_back(n.mx);
+            list.y.push_back(n.my);
+            list.mass.push_back(n.mass);
+            continue;
+        }
+        for (std::uint32_t c = n.count; c-- > 0;) stack[top++] = n.first + c; // First child on top
+    }
+
+    // 2. Every probe sums the list in the same order; the inner loop runs across the probes
+    int count = static_cast<int>(group.end - group.begin);
+    float px[GROUP_SIZE], py[GROUP_SIZE], ax[GROUP_SIZE], ay[GROUP_SIZE];
+    for (int k = 0; k < count; ++k) {
+        std::uint32_t i = static_cast<std::uint32_t>(probeOrder[group.begin + k]);
+        px[k] = probeX[i];
+        py[k] = probeY[i];
+        ax[k] = 0.f;
+        ay[k] = 0.f;
+    }
+    const float* lx = list.x.data();
+    const float* ly = list.y.data();
+    const float* lm = list.mass.data();
+    std::size_t terms = list.x.size();
+    for (std::size_t j = 0; j < terms; ++j) {
+        float sx = lx[j], sy = ly[j], m = lm[j];
+        for (int k = 0; k < count; ++k) {
+            float dx = sx - px[k], dy = sy - py[k];
+            float r2 = dx * dx + dy * dy + softeningSq;
+            float f = m / (r2 * std::sqrt(r2));
+            ax[k] += dx * f;
+            ay[k] += dy * f;
+        }
+    }
+    for (int k = 0; k < count; ++k) {
+        std::uint32_t i = static_cast<std::uint32_t>(probeOrder[group.begin + k]);
+        pullX[i] = ax[k];
+        pullY[i] = ay[k];
+    }
+    return static_cast<std::uint64_t>(terms) * count;
+}
+
+void GravityField::runGroups(Scratch& list) {
+    std::size_t count = groups.size();
+    for (;;) {
+        std::size_t first = nextGroup.fetch_add(GROUPS_PER_CHUNK, std::memory_order_relaxed);
+        if (first >= count) return;
+        std::size_t last = std::min(count, first + GROUPS_PER_CHUNK);
+        std::uint64_t terms = 0;
+        for (std::size_t i = first; i < last; ++i) terms += walk(groups[i], list);
+        interactions.fetch_add(terms, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef GRAVITYFIELD_H
+#define GRAVITYFIELD_H
+
+#include "WorkerPool.h"
+#include <SFML/System.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Gravity from many point sources on many probes, Barnes-Hut style. Each tick the owner adds the
+// sources (black holes, heavy rocks) and the probes (everything that is pulled), and solve()
+//   1. sorts the sources along a Morton curve over their bounding square and builds a quadtree
+//      on the sorted order: every node is a contiguous range, leaves hold up to LEAF_SIZE sources,
+//      and levels with a single occupied quadrant are skipped, so there are fewer than 2 nodes per
+//      source;
+//   2. sorts the probes the same way and cuts them into groups of up to GROUP_SIZE neighbours;
+//   3. walks the tree once per group: a node whose box is small against its distance to the
+//      group's box (size / distance < theta) counts as one mass at its centre of mass, anything
+//      closer is opened, down to single sources. Every probe of the group then sums that list in
+//      one loop across the group's probes, which the compiler vectorizes. theta = 0 is the exact
+//      pairwise sum.
+// Groups never write anything but their own probes' results and each sums its list in the order
+// the walk built it, so the pull on a probe does not depend on how many threads there are: a
+// small worker pool takes the groups in chunks with no locking, and replays match on any machine.
+//
+// Strengths are G * mass in px^3 per tick^2, pulls in px per tick^2. Nothing is allocated once
+// reserve() has sized the arrays; sources and probes past the capacity are ignored (and counted).
+class GravityField {
+public:
+    static const int LEAF_SIZE = 8;
+    static const int GROUP_SIZE = 32;
+
+    struct Stats {
+        std::size_t sources;
+        std::size_t probes;
+        std::size_t nodes;
+        std::size_t groups;
+        std::uint64_t interactions; // Source or node terms summed in the last solve (per probe)
+        std::uint64_t dropped;      // Sources and probes ignored because the arrays were full (all time)
+    };
+
+    GravityField();
+
+    GravityField(const GravityField&) = delete;
+    GravityField& operator=(const GravityField&) = delete;
+
+    void setAccuracy(float theta);     // Opening angle: 0 = exact, larger = faster and rougher
+    float accuracy() const { return theta; }
+    void setSoftening(float length);   // Pulls act as if every distance were at least about this (px)
+    void reserve(std::size_t sources, std::size_t probes);
+    void setWorkers(int count); // Threads besides the caller's (0 = solve on the caller's). Setup only
+    int workerCount() const { return pool.size(); }
+
+    void clear();
+    void addSource(sf::Vector2f pos, float strength);
+    bool addProbe(sf::Vector2f pos); // false if full (its pull is then not computed)
+    void solve();
+
+    std::size_t sourceCount() const { return srcX.size(); }
+    std::size_t probeCount() const { return probeX.size(); }
+    sf::Vector2f pull(std::uint32_t probe) const { return sf::Vector2f(pullX[probe], pullY[probe]); }
+    const Stats& stats() const { return lastStats; }
+
+private:
+    struct Node {
+        float cx, cy, half;  // Box
+        float mass, mx, my;  // Total strength and its centre
+        std::uint32_t first; // Leaf: first sorted source; inner: first child node
+        std::uint32_t count; // Leaf: sources; inner: children (2-4, contiguous)
+        bool leaf;
+    };
+
+    struct Group {
+        std::uint32_t begin, end;       // Range of probeOrder
+        float minX, minY, maxX, maxY;   // Box around its probes
+    };
+
+    // One per thread: the interaction list of the group being summed
+    struct Scratch {
+        std::vector<float> x, y, mass;
+    };
+
+    void buildTree();
+    void build(std::uint32_t node, std::uint32_t begin, std::uint32_t end, int level, float cx, float cy, float half);
+    void groupProbes();
+    void split(std::uint32_t begin, std::uint32_t end, int level);
+    std::uint64_t walk(const Group& group, Scratch& list); // Returns the terms summed
+    void runGroups(Scratch& list); // Takes chunks of groups until none are left (every thread)
+
+    float theta;
+    float softeningSq;
+    std::size_t sourceCapacity, probeCapacity;
+    Stats lastStats;
+
+    // Sources as added, then in Morton order (sorted copy, so leaves are contiguous)
+    std::vector<float> srcX, srcY, srcMass;
+    std::vector<std::uint64_t> order; // Morton key << 32 | source index
+    std::vector<float> sortedX, sortedY, sortedMass;
+    std::vector<Node> nodes;
+
+    std::vector<float> probeX, probeY, pullX, pullY;
+    std::vector<std::uint64_t> probeOrder; // Morton key << 32 | probe index
+    std::vector<Group> groups;
+    std::vector<Scratch> scratch;          // Per pool slot: [0] is the caller's, then one per worker
+
+    std::atomic<std::size_t> nextGroup;    // Every thread of the pool (the caller too) drains it
+    std::atomic<std::uint64_t> interactions;
+    WorkerPool pool;
+};
+
+#endif // GRAVITYFIELD_H
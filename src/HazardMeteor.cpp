@@ -1,8 +1,9 @@
 #include "HazardMeteor.h"
+#include "Logger.h"
 #include "ResourceManager.h"
+#include "Random.h"
 #include <cstdlib>
 #include <cmath>
-#include <iostream>
 
 HazardMeteor::HazardMeteor() {
     type = Type::HazardMeteor;
@@ -10,8 +11,8 @@ HazardMeteor::HazardMeteor() {
     R = 20.f; // Collision radius
 
     // Give it a slower, more predictable movement?
-    float angleRad = (rand() % 360) * 0.017453f;
-    float speed = static_cast<float>(rand() % 2 + 1); // Slow speed (1-2)
+    float angleRad = Random::range(360) * 0.017453f;
+    float speed = static_cast<float>(Random::range(2) + 1); // Slow speed (1-2)
     velocity.x = std::cos(angleRad) * speed;
     velocity.y = std::sin(angleRad) * speed;
 }
@@ -28,7 +29,7 @@ void HazardMeteor::settings(Animation &a, sf::Vector2f startPos, float startAngl
         actualAnim = Animation(ResourceManager::getInstance().getTexture("slow_powerdown.png"), 0, 0, frameW, frameH, 24, animSpeed, true); // Looping animation
         actualRadius = 20.f; // Set appropriate collision radius
     } catch (const std::runtime_error& e) {
-        std::cerr << "Error setting HazardMeteor animation: " << e.what() << std::endl;
+        LOG_ERROR(LogCategory::Entity, "Error setting HazardMeteor animation: %s", e.what());
         actualAnim = a; // Fallback
         actualRadius = radius;
     }
@@ -48,6 +49,4 @@ void HazardMeteor::update(float dt, const sf::Vector2u& windowSize) {
     else if (pos.x > windowSize.x + R) pos.x = -R;
     if (pos.y < -R) pos.y = windowSize.y + R;
     else if (pos.y > windowSize.y + R) pos.y = -R;
-
-    anim.update(dt); // Update animation frame
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <algorithm>
+#include <cstdint>
+
+// Fixed-size histogram of durations in milliseconds: 2500 buckets (0.1 ms wide by default, so up
+// to 250 ms) plus one overflow bucket. Sub-millisecond costs want narrower buckets, e.g. 0.001 ms
+// (up to 2.5 ms). No allocation, so it can stay on in every build.
+class Histogram {
+public:
+    explicit Histogram(double bucketWidthMs = 0.1) : bucketMs(bucketWidthMs) { reset(); }
+
+    void add(double ms) {
+        double bucketPos = ms > 0.0 ? ms / bucketMs : 0.0;
+        int bucket = bucketPos < BUCKETS ? static_cast<int>(bucketPos) : BUCKETS;
+        counts[bucket]++;
+        ++total;
+        sum += ms;
+        if (ms > maxValue) maxValue = ms;
+    }
+
+    void reset() {
+        std::fill(counts, counts + BUCKETS + 1, 0u);
+        total = 0;
+        sum = 0.0;
+        maxValue = 0.0;
+    }
+
+    void merge(const Histogram& other) { // Same bucket width
+        for (int i = 0; i <= BUCKETS; ++i) counts[i] += other.counts[i];
+        total += other.total;
+        sum += other.sum;
+        if (other.maxValue > maxValue) maxValue = other.maxValue;
+    }
+
+    std::uint64_t count() const { return total; }
+    double max() const { return maxValue; }
+    double mean() const { return total ? sum / total : 0.0; }
+
+    // Upper edge of the bucket holding the requested rank (so at most one bucket width high)
+    double percentile(double fraction) const {
+        if (total == 0) return 0.0;
+        std::uint64_t rank = static_cast<std::uint64_t>(fraction * (total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(maxValue, (i + 1) * bucketMs);
+        }
+        return maxValue;
+    }
+
+private:
+    static const int BUCKETS = 2500;
+
+    double bucketMs;
+
+    std::uint32_t counts[BUCKETS + 1];
+    std::uint64_t total;
+    double sum;
+    double maxValue;
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,64 @@
+#include "InputSampler.h"
+#include <SFML/Window.hpp>
+#include <chrono>
+
+namespace {
+    const sf::Keyboard::Key KEY_CODES[InputSampler::KEY_COUNT] = {
+        sf::Keyboard::Left, sf::Keyboard::Right, sf::Keyboard::Up, sf::Keyboard::Space
+    };
+}
+
+InputSampler::InputSampler() : stopping(false), dropped(0) {}
+
+InputSampler::~InputSampler() {
+    stop();
+}
+
+std::uint64_t InputSampler::nowNs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void InputSampler::start(int rateHz) {
+    if (running()) return;
+    stopping.store(false);
+    worker = std::thread(&InputSampler::run, this, rateHz > 0 ? rateHz : 1000);
+}
+
+void InputSampler::stop() {
+    if (!running()) return;
+    stopping.store(true);
+    worker.join();
+}
+
+// sf::Keyboard::isKeyPressed reads the global keyboard state, which is safe off the window thread
+void InputSampler::run(int rateHz) {
+    const std::chrono::nanoseconds period(1000000000LL / rateHz);
+    bool down[KEY_COUNT] = {};        // State the game has been sent
+    std::uint64_t seenNs[KEY_COUNT] = {}; // When a change not sent yet was first seen (0 = none)
+    auto next = std::chrono::steady_clock::now();
+    while (!stopping.load(std::memory_order_relaxed)) {
+        for (int k = 0; k < KEY_COUNT; ++k) {
+            bool now = sf::Keyboard::isKeyPressed(KEY_CODES[k]);
+            if (now == down[k]) {
+                seenNs[k] = 0; // Any unsent change was undone before it got through
+                continue;
+            }
+            if (seenNs[k] == 0) seenNs[k] = nowNs();
+            Event event;
+            event.key = static_cast<Key>(k);
+            event.pressed = now;
+            event.stampNs = seenNs[k];
+            // A full queue must not lose the change (a lost release leaves the key held in the
+            // game): it is sent again on the next poll
+            if (!queue.push(event)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            down[k] = now;
+            seenNs[k] = 0;
+        }
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
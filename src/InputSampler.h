@@ -0,0 +1,44 @@
+#ifndef INPUTSAMPLER_H
+#define INPUTSAMPLER_H
+
+#include "SpscQueue.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+// Polls the gameplay keys on its own thread at a high rate and queues every press/release with
+// the time it was seen. The game thread drains the queue right before each simulation tick, so a
+// tick sees input up to the moment it runs (not the moment the frame started), and taps shorter
+// than a tick are not lost.
+class InputSampler {
+public:
+    enum Key : std::uint8_t { Left, Right, Thrust, Fire, KEY_COUNT };
+
+    struct Event {
+        Key key;
+        bool pressed;
+        std::uint64_t stampNs; // steady_clock time the change was seen
+    };
+
+    InputSampler();
+    ~InputSampler();
+
+    void start(int rateHz);
+    void stop();
+    bool running() const { return worker.joinable(); }
+
+    bool poll(Event& event) { return queue.pop(event); } // Game thread only
+    std::uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); } // Pushes retried (queue full)
+
+    static std::uint64_t nowNs();
+
+private:
+    void run(int rateHz);
+
+    SpscQueue<Event, 256> queue;
+    std::thread worker;
+    std::atomic<bool> stopping;
+    std::atomic<std::uint64_t> dropped;
+};
+
+#endif // INPUTSAMPLER_H
@@ -0,0 +1,98 @@
+#include "JobScheduler.h"
+#include "Logger.h"
+#include <chrono>
+#include <utility>
+
+namespace {
+    const double ESTIMATE_WEIGHT = 0.25; // Share of the newest run in the cost estimate
+}
+
+JobScheduler::JobScheduler(Cost cost) : cost(cost) {}
+
+JobScheduler::JobId JobScheduler::add(const char* name, int maxDelay, Job job) {
+    Entry entry;
+    entry.name = name;
+    entry.maxDelay = maxDelay > 0 ? maxDelay : 0;
+    entry.job = std::move(job);
+    entry.pending = false;
+    entry.waited = 0;
+    entry.estimate = 0.0;
+    entry.stats = Stats();
+    jobs.push_back(std::move(entry));
+    return static_cast<JobId>(jobs.size() - 1);
+}
+
+void JobScheduler::request(JobId id) {
+    Entry& entry = jobs[id];
+    if (entry.pending) return;
+    entry.pending = true;
+    entry.waited = 0;
+    ++entry.stats.requests;
+}
+
+double JobScheduler::execute(Entry& entry) {
+    auto start = std::chrono::steady_clock::now();
+    entry.pending = false; // Before running: the job may request itself again
+    std::uint32_t units = entry.job();
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    Stats& s = entry.stats;
+    ++s.runs;
+    s.totalMicros += micros;
+    if (micros > s.maxMicros) s.maxMicros = micros;
+    s.totalUnits += units;
+    if (entry.waited > s.maxWaited) s.maxWaited = entry.waited;
+    entry.waited = 0;
+
+    double spent = cost == Cost::WallMicros ? micros : static_cast<double>(units);
+    entry.estimate += (spent - entry.estimate) * ESTIMATE_WEIGHT;
+    return spent;
+}
+
+void JobScheduler::runSlice(double budget) {
+    // Overdue jobs first: they run whatever the budget says
+    for (Entry& entry : jobs) {
+        if (!entry.pending || entry.waited < entry.maxDelay) continue;
+        ++entry.stats.forced;
+        budget -= execute(entry);
+    }
+    // Then the rest in registration order, as long as they are expected to fit
+    for (Entry& entry : jobs) {
+        if (!entry.pending) continue;
+        if (entry.estimate <= budget) {
+            budget -= execute(entry);
+        } else {
+            ++entry.waited;
+            ++entry.stats.deferred;
+        }
+    }
+}
+
+void JobScheduler::runPending() {
+    for (Entry& entry : jobs) {
+        if (entry.pending) execute(entry);
+    }
+}
+
+void JobScheduler::reset() {
+    for (Entry& entry : jobs) {
+        entry.pending = false;
+        entry.waited = 0;
+        entry.estimate = 0.0;
+    }
+}
+
+void JobScheduler::logReport(const char* title) const {
+    for (const Entry& entry : jobs) {
+        const Stats& s = entry.stats;
+        double mean = s.runs ? s.totalMicros / s.runs : 0.0;
+        LOG_INFO(LogCategory::Game, "%s job %s: %d runs (%d forced), %d slices deferred (max wait %d)",
+                 title, entry.name, s.runs, s.forced, s.deferred, s.maxWaited);
+        if (cost == Cost::WorkUnits) {
+            LOG_INFO(LogCategory::Game, "%s job %s cost: mean %.2f us, max %.2f us, %.2f units/run",
+                     title, entry.name, mean, s.maxMicros, s.runs ? static_cast<double>(s.totalUnits) / s.runs : 0.0);
+        } else {
+            LOG_INFO(LogCategory::Game, "%s job %s cost: mean %.2f us, max %.2f us", title, entry.name, mean, s.maxMicros);
+        }
+    }
+}
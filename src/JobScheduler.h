@@ -0,0 +1,65 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Cooperative time slicing for deferrable housekeeping. Jobs are registered once; each slice the
+// owner requests the ones that have work and calls runSlice with what is left of its budget. A
+// pending job runs when its cost estimate fits the remaining budget; one that has already waited
+// maxDelay slices runs regardless, so every request is served within a bounded delay.
+//
+// Costs are either measured wall time (microseconds) or work units returned by the job itself.
+// Work units make the schedule a pure function of the game state, which is what jobs that touch
+// the simulation need: the same session then defers the same jobs on the same ticks on every
+// machine, and replays still match.
+class JobScheduler {
+public:
+    enum class Cost { WallMicros, WorkUnits };
+    typedef int JobId;
+    typedef std::function<std::uint32_t()> Job; // Returns the work done (ignored for WallMicros)
+
+    struct Stats {
+        std::uint64_t requests;
+        std::uint64_t runs;
+        std::uint64_t forced;   // Ran past the budget because the deadline came
+        std::uint64_t deferred; // Slices spent waiting
+        int maxWaited;          // Longest wait in slices
+        double totalMicros;     // Wall time, measured in both modes
+        double maxMicros;
+        std::uint64_t totalUnits; // WorkUnits mode only
+    };
+
+    explicit JobScheduler(Cost cost);
+
+    JobId add(const char* name, int maxDelay, Job job); // Setup only (allocates)
+
+    void request(JobId id);         // Repeat requests while pending coalesce into one run
+    bool pending(JobId id) const { return jobs[id].pending; }
+    void runSlice(double budget);   // Budget in microseconds or work units
+    void runPending();              // Runs everything pending now (state changes, shutdown)
+    void reset();                   // Drops pending requests and cost estimates (new run)
+
+    void logReport(const char* title) const;
+    const Stats& stats(JobId id) const { return jobs[id].stats; }
+
+private:
+    struct Entry {
+        const char* name;
+        int maxDelay;
+        Job job;
+        bool pending;
+        int waited;       // Slices since the request
+        double estimate;  // Smoothed cost of recent runs
+        Stats stats;
+    };
+
+    double execute(Entry& entry); // Returns the cost in this scheduler's units
+
+    Cost cost;
+    std::vector<Entry> jobs;
+};
+
+#endif // JOBSCHEDULER_H
@@ -0,0 +1,205 @@
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    const char* levelName(LogLevel level) {
+        switch (level) {
+            case LogLevel::Debug:   return "DEBUG";
+            case LogLevel::Info:    return "INFO";
+            case LogLevel::Warning: return "WARN";
+            case LogLevel::Error:   return "ERROR";
+        }
+        return "?";
+    }
+
+    const char* categoryName(LogCategory category) {
+        switch (category) {
+            case LogCategory::General:  return "General";
+            case LogCategory::Game:     return "Game";
+            case LogCategory::Resource: return "Resource";
+            case LogCategory::Player:   return "Player";
+            case LogCategory::Boss:     return "Boss";
+            case LogCategory::Entity:   return "Entity";
+        }
+        return "?";
+    }
+}
+
+// Initialize static instance (Singleton pattern)
+Logger& Logger::getInstance() {
+    static Logger instance;
+    return instance;
+}
+
+Logger::Logger() :
+    slots(new Slot[CAPACITY]),
+    enqueuePos(0),
+    dequeuePos(0),
+    dropped(0),
+    written(0),
+    running(true)
+{
+    for (std::size_t i = 0; i < CAPACITY; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    for (std::atomic<int>& level : minLevels) level.store(static_cast<int>(LogLevel::Debug), std::memory_order_relaxed);
+    writer = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger() {
+    running.store(false, std::memory_order_release);
+    if (writer.joinable()) writer.join();
+    if (dropped.load() > 0) {
+        std::cerr << "[WARN][General] Logger dropped " << dropped.load() << " messages (ring full)" << std::endl;
+    }
+    delete[] slots;
+}
+
+void Logger::packText(Record& r, const char* text, std::size_t length) {
+    Arg& a = r.args[r.argCount++];
+    a.kind = Arg::Kind::Text;
+    std::size_t room = TEXT_SIZE - r.textUsed;
+    if (room == 0) { // Out of text storage: point at the terminating byte of the previous string
+        a.textOffset = static_cast<std::uint16_t>(TEXT_SIZE - 1);
+        return;
+    }
+    if (length >= room) length = room - 1;
+    a.textOffset = r.textUsed;
+    std::memcpy(r.text + r.textUsed, text, length);
+    r.text[r.textUsed + length] = '\0';
+    r.textUsed = static_cast<std::uint16_t>(r.textUsed + length + 1);
+}
+
+void Logger::push(const Record& record) {
+    std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots[pos & (CAPACITY - 1)];
+        std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.record = record;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return;
+            }
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed); // Full: never block the caller
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool Logger::pop(Record& record) {
+    std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots[pos & (CAPACITY - 1)];
+        std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                record = slot.record;
+                slot.sequence.store(pos + CAPACITY, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // Empty
+        } else {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::flush() {
+    std::uint64_t target = enqueuePos.load(std::memory_order_acquire);
+    while (written.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+void Logger::writerLoop() {
+    Record record;
+    for (;;) {
+        bool any = false;
+        while (pop(record)) {
+            write(record);
+            written.fetch_add(1, std::memory_order_release);
+            any = true;
+        }
+        if (any) {
+            std::cout.flush();
+            std::cerr.flush();
+        }
+        if (!running.load(std::memory_order_acquire)) {
+            if (!pop(record)) break; // Drained, exit
+            write(record);
+            written.fetch_add(1, std::memory_order_release);
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    std::cout.flush();
+    std::cerr.flush();
+}
+
+// Formats one record on the writer thread. Each '%' conversion consumes the next argument;
+// the length modifier is chosen from the stored argument kind, so "%d" works for any integer.
+void Logger::write(const Record& record) {
+    char line[512];
+    std::size_t len = static_cast<std::size_t>(std::snprintf(line, sizeof(line), "[%s][%s] ", levelName(record.level), categoryName(record.category)));
+    std::size_t argIndex = 0;
+
+    for (const char* f = record.format; *f && len < sizeof(line) - 1; ++f) {
+        if (*f != '%') { line[len++] = *f; continue; }
+        if (f[1] == '%') { line[len++] = '%'; ++f; continue; }
+
+        // Collect flags/width/precision, skipping any length modifiers written by the caller
+        char spec[16];
+        std::size_t s = 0;
+        spec[s++] = '%';
+        const char* c = f + 1;
+        while (*c && std::strchr("-+ #0123456789.", *c) && s < sizeof(spec) - 4) spec[s++] = *c++;
+        while (*c && std::strchr("hlLzjt", *c)) ++c;
+        if (!*c) break;
+        char conv = *c;
+        f = c;
+
+        int n = 0;
+        std::size_t room = sizeof(line) - len;
+        if (argIndex >= record.argCount) {
+            n = std::snprintf(line + len, room, "<missing>");
+        } else {
+            const Arg& a = record.args[argIndex++];
+            switch (a.kind) {
+                case Arg::Kind::Int:
+                    if (conv == 'f' || conv == 'g' || conv == 'e') {
+                        spec[s++] = conv; spec[s] = '\0';
+                        n = std::snprintf(line + len, room, spec, static_cast<double>(a.i));
+                    } else {
+                        if (conv == 's' || conv == 'c') conv = 'd';
+                        spec[s++] = 'l'; spec[s++] = 'l'; spec[s++] = conv; spec[s] = '\0';
+                        n = std::snprintf(line + len, room, spec, a.i);
+                    }
+                    break;
+                case Arg::Kind::Float:
+                    if (conv != 'f' && conv != 'g' && conv != 'e') conv = 'g';
+                    spec[s++] = conv; spec[s] = '\0';
+                    n = std::snprintf(line + len, room, spec, a.f);
+                    break;
+                case Arg::Kind::Text:
+                    spec[s++] = 's'; spec[s] = '\0';
+                    n = std::snprintf(line + len, room, spec, record.text + a.textOffset);
+                    break;
+            }
+        }
+        if (n > 0) len += std::min(static_cast<std::size_t>(n), room - 1);
+    }
+    line[std::min(len, sizeof(line) - 1)] = '\0';
+
+    std::ostream& out = (record.level >= LogLevel::Warning) ? std::cerr : std::cout;
+    out << line << '\n';
+}
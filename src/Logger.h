@@ -0,0 +1,143 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+// Asynchronous leveled logger.
+// Callers only copy a printf-style format pointer and its arguments into a lock-free ring;
+// a background thread does the formatting and the (flushed) console writes.
+// If the ring is full the message is dropped and counted, never waited on.
+
+enum class LogLevel { Debug, Info, Warning, Error };
+enum class LogCategory { General, Game, Resource, Player, Boss, Entity };
+
+// Compile-time level filter. Release builds (NDEBUG) strip LOG_DEBUG entirely.
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL 1
+#else
+#define LOG_MIN_LEVEL 0
+#endif
+#endif
+
+class Logger {
+public:
+    static const std::size_t MAX_ARGS = 6;
+    static const std::size_t TEXT_SIZE = 128; // Storage for copied string arguments
+
+    static Logger& getInstance(); // Singleton access, starts the writer thread on first use
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // 'format' must outlive the call (string literal). Supported arguments: integers, floats,
+    // enums, const char* and std::string (both copied into the record).
+    template <typename... Args>
+    void log(LogLevel level, LogCategory category, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "Too many log arguments");
+        if (static_cast<int>(level) < minLevels[static_cast<int>(category)].load(std::memory_order_relaxed)) return;
+        Record record;
+        record.level = level;
+        record.category = category;
+        record.format = format;
+        record.argCount = 0;
+        record.textUsed = 0;
+        int expand[] = { 0, (pack(record, args), 0)... };
+        (void)expand;
+        push(record);
+    }
+
+    void flush(); // Blocks until everything queued so far has been written
+    // Drops a category's records below 'level' (every level passes by default)
+    void setMinLevel(LogCategory category, LogLevel level) {
+        minLevels[static_cast<int>(category)].store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+    std::uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Arg {
+        enum class Kind : std::uint8_t { Int, Float, Text } kind;
+        union {
+            long long i;
+            double f;
+            std::uint16_t textOffset;
+        };
+    };
+
+    struct Record {
+        LogLevel level;
+        LogCategory category;
+        const char* format;
+        std::uint8_t argCount;
+        std::uint16_t textUsed;
+        Arg args[MAX_ARGS];
+        char text[TEXT_SIZE];
+    };
+
+    static const int CATEGORY_COUNT = static_cast<int>(LogCategory::Entity) + 1;
+    std::atomic<int> minLevels[CATEGORY_COUNT];
+
+    // Bounded MPMC ring (sequence-numbered slots), capacity must be a power of two
+    static const std::size_t CAPACITY = 1024;
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        Record record;
+    };
+
+    Logger();
+    ~Logger();
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+    packValue(Record& r, const T& value) {
+        Arg& a = r.args[r.argCount++];
+        a.kind = Arg::Kind::Int;
+        a.i = static_cast<long long>(value);
+    }
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type
+    packValue(Record& r, const T& value) {
+        Arg& a = r.args[r.argCount++];
+        a.kind = Arg::Kind::Float;
+        a.f = static_cast<double>(value);
+    }
+    void packText(Record& r, const char* text, std::size_t length);
+
+    template <typename T> void pack(Record& r, const T& value) { packValue(r, value); }
+    void pack(Record& r, const char* value) { packText(r, value ? value : "(null)", value ? std::strlen(value) : 6); }
+    void pack(Record& r, char* value) { pack(r, static_cast<const char*>(value)); }
+    void pack(Record& r, const std::string& value) { packText(r, value.data(), value.size()); }
+
+    void push(const Record& record);
+    bool pop(Record& record);
+    void writerLoop();
+    void write(const Record& record);
+
+    Slot* slots;
+    alignas(64) std::atomic<std::size_t> enqueuePos;
+    alignas(64) std::atomic<std::size_t> dequeuePos;
+    std::atomic<std::uint64_t> dropped;
+    std::atomic<std::uint64_t> written;
+    std::atomic<bool> running;
+    std::thread writer;
+};
+
+#if LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG(category, ...) Logger::getInstance().log(LogLevel::Debug, category, __VA_ARGS__)
+#else
+#define LOG_DEBUG(category, ...) ((void)0)
+#endif
+#if LOG_MIN_LEVEL <= 1
+#define LOG_INFO(category, ...) Logger::getInstance().log(LogLevel::Info, category, __VA_ARGS__)
+#else
+#define LOG_INFO(category, ...) ((void)0)
+#endif
+#define LOG_WARN(category, ...) Logger::getInstance().log(LogLevel::Warning, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) Logger::getInstance().log(LogLevel::Error, category, __VA_ARGS__)
+
+#endif // LOGGER_H
@@ -0,0 +1,106 @@
+#include "ParticleSystem.h"
+#include "QualityController.h"
+
+const std::size_t PARTICLE_RESERVE = 1024;
+
+ParticleSystem::ParticleSystem() : time(0.f) {
+    positions.reserve(PARTICLE_RESERVE);
+    startTimes.reserve(PARTICLE_RESERVE);
+    clipIds.reserve(PARTICLE_RESERVE);
+}
+
+ParticleSystem::ClipId ParticleSystem::addClip(const sf::Texture& texture, int x, int y, int w, int h, int count, float speed) {
+    Clip clip;
+    clip.texture = &texture;
+    clip.x = x; clip.y = y; clip.w = w; clip.h = h;
+    clip.count = count;
+    clip.speed = speed;
+    clip.duration = (speed > 0.f) ? static_cast<float>(count) / (speed * 60.f) : 0.f;
+    clip.vertices.reserve(PARTICLE_RESERVE * 6);
+    clips.push_back(std::move(clip));
+    return static_cast<ClipId>(clips.size() - 1);
+}
+
+const float COALESCE_WINDOW = 0.1f; // Seconds a particle counts as "fresh" for coalescing
+
+void ParticleSystem::spawn(ClipId clip, sf::Vector2f pos) {
+    if (clip >= clips.size()) return;
+
+    // Under load the quality level caps live particles and merges bursts at one spot
+    QualityController& quality = QualityController::getInstance();
+    const QualityController::Settings& limits = quality.settings();
+    if (startTimes.size() >= limits.maxParticles) {
+        quality.noteShed();
+        return;
+    }
+    if (limits.coalesceRadius > 0.f) {
+        float r2 = limits.coalesceRadius * limits.coalesceRadius;
+        for (std::size_t i = 0; i < startTimes.size(); ++i) {
+            if (clipIds[i] != clip || time - startTimes[i] > COALESCE_WINDOW) continue;
+            sf::Vector2f d = positions[i] - pos;
+            if (d.x * d.x + d.y * d.y < r2) {
+                quality.noteShed();
+                return;
+            }
+        }
+    }
+    positions.push_back(pos);
+    startTimes.push_back(time);
+    clipIds.push_back(clip);
+}
+
+void ParticleSystem::update(float dt) {
+    time += dt;
+
+    // Swap-remove finished particles; order inside the arrays does not matter
+    std::size_t i = 0;
+    while (i < startTimes.size()) {
+        if (time - startTimes[i] >= clips[clipIds[i]].duration) {
+            positions[i] = positions.back(); positions.pop_back();
+            startTimes[i] = startTimes.back(); startTimes.pop_back();
+            clipIds[i] = clipIds.back(); clipIds.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void ParticleSystem::draw(sf::RenderTarget& target) {
+    for (auto& clip : clips) clip.vertices.clear();
+    int frameStep = QualityController::getInstance().settings().animationStep;
+
+    for (std::size_t i = 0; i < startTimes.size(); ++i) {
+        Clip& clip = clips[clipIds[i]];
+        int frame = static_cast<int>((time - startTimes[i]) * clip.speed * 60.f);
+        if (frame >= clip.count) frame = clip.count - 1;
+        if (frameStep > 1) frame -= frame % frameStep;
+
+        float halfW = clip.w / 2.f;
+        float halfH = clip.h / 2.f;
+        const sf::Vector2f& p = positions[i];
+        float u0 = static_cast<float>(clip.x + frame * clip.w);
+        float u1 = u0 + clip.w;
+        float v0 = static_cast<float>(clip.y);
+        float v1 = v0 + clip.h;
+
+        sf::Vertex tl(sf::Vector2f(p.x - halfW, p.y - halfH), sf::Vector2f(u0, v0));
+        sf::Vertex tr(sf::Vector2f(p.x + halfW, p.y - halfH), sf::Vector2f(u1, v0));
+        sf::Vertex br(sf::Vector2f(p.x + halfW, p.y + halfH), sf::Vector2f(u1, v1));
+        sf::Vertex bl(sf::Vector2f(p.x - halfW, p.y + halfH), sf::Vector2f(u0, v1));
+        clip.vertices.push_back(tl); clip.vertices.push_back(tr); clip.vertices.push_back(br);
+        clip.vertices.push_back(tl); clip.vertices.push_back(br); clip.vertices.push_back(bl);
+    }
+
+    // One batched draw per clip texture
+    for (const auto& clip : clips) {
+        if (clip.vertices.empty()) continue;
+        sf::RenderStates states(clip.texture);
+        target.draw(clip.vertices.data(), clip.vertices.size(), sf::Triangles, states);
+    }
+}
+
+void ParticleSystem::clear() {
+    positions.clear();
+    startTimes.clear();
+    clipIds.clear();
+}
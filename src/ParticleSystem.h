@@ -0,0 +1,45 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+// Cosmetic flipbook particles (explosions, hit sparks).
+// Lives outside the entity list: no collision radius, no virtual update, no per-particle Animation.
+class ParticleSystem {
+public:
+    typedef std::uint16_t ClipId;
+
+    ParticleSystem();
+
+    // Registers a horizontal sprite-strip flipbook (same layout as Animation). Returns its id.
+    ClipId addClip(const sf::Texture& texture, int x, int y, int w, int h, int count, float speed);
+
+    void spawn(ClipId clip, sf::Vector2f pos);
+    void update(float dt);          // Advances time and drops particles whose flipbook finished
+    void draw(sf::RenderTarget& target);
+    void clear();
+
+    std::size_t size() const { return startTimes.size(); }
+
+private:
+    struct Clip {
+        const sf::Texture* texture;
+        int x, y, w, h, count;
+        float speed;    // Frames per 1/60 s, same unit as Animation::speed
+        float duration; // Seconds until the last frame has been shown
+        std::vector<sf::Vertex> vertices; // Rebuilt each draw, capacity kept between frames
+    };
+
+    std::vector<Clip> clips;
+
+    // Flat particle arrays, one entry per live particle
+    std::vector<sf::Vector2f> positions;
+    std::vector<float> startTimes;
+    std::vector<ClipId> clipIds;
+
+    float time;
+};
+
+#endif // PARTICLESYSTEM_H
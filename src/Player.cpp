@@ -1,7 +1,8 @@
 #include "Player.h"
+#include "Logger.h"
+#include "QualityController.h"
 #include "ResourceManager.h"
 #include <cmath>
-#include <iostream>
 
 const float PLAYER_DEGTORAD = 0.017453f;
 
@@ -17,55 +18,50 @@ Player::Player() :
     lives(3),
     currentShipType(ShipType::Standard),
     currentWeaponType(Bullet::BulletType::Standard), // Start with standard bullets
-    shieldActive(false),
-    shieldTimer(0.f),
-    speedBoostTimer(0.f),
-    slowTimer(0.f),
-    reverseControlsActive(false),
-    reverseControlsTimer(0.f),
-    weaponPowerUpActive(false),
-    weaponPowerUpTimer(0.f),
     shieldTexturePtr(nullptr), // Initialize texture pointers
     weaponEffectTexturePtr(nullptr),
-    speedEffectTexturePtr(nullptr)
+    speedEffectTexturePtr(nullptr),
+    timers(nullptr),
+    statusEndKind(0)
 {
+    for (int i = 0; i < STATUS_COUNT; ++i) statusActive[i] = false;
     type = Type::Player;
     name = "player";
 }
 
-// Override settings để load đúng 2 trạng thái từ spaceship.png
-void Player::settings(Animation &a, sf::Vector2f startPos, float startAngle, float radius) {
-    // Không dùng animation 'a' được truyền vào nữa, vì chúng ta tự định nghĩa anim từ spaceship.png
-    try {
-        sf::Texture& playerTexture = ResourceManager::getInstance().getTexture("spaceship.png");
-        int textureWidth = playerTexture.getSize().x; // ~250
-        int textureHeight = playerTexture.getSize().y; // ~500
-        int frameWidth = textureWidth; // Toàn bộ chiều rộng là 1 frame
-        int frameHeight = textureHeight / 2; // Chia đôi chiều cao cho 2 trạng thái (~250)
+void Player::makeShipClips(Animation& idle, Animation& thrust) {
+    sf::Texture& playerTexture = ResourceManager::getInstance().getTexture("spaceship.png");
+    int textureWidth = playerTexture.getSize().x; // ~250
+    int textureHeight = playerTexture.getSize().y; // ~500
+    int frameWidth = textureWidth; // Toàn bộ chiều rộng là 1 frame
+    int frameHeight = textureHeight / 2; // Chia đôi chiều cao cho 2 trạng thái (~250)
 
-        std::cout << "Setting up player animations from spaceship.png ("
-                  << textureWidth << "x" << textureHeight << ", Frame H: " << frameHeight << ")" << std::endl;
+    LOG_DEBUG(LogCategory::Player, "Setting up player animations from spaceship.png (%dx%d, Frame H: %d)",
+              textureWidth, textureHeight, frameHeight);
 
-        // Khởi tạo anim_idle (phần trên của texture)
-        // Animation(texture, x, y, w, h, count, speed, loop)
-        anim_idle = Animation(playerTexture, 0, 0, frameWidth, frameHeight, 1, 0.f, false);
+    // Khởi tạo idle (phần trên của texture)
+    // Animation(texture, x, y, w, h, count, speed, loop)
+    idle = Animation(playerTexture, 0, 0, frameWidth, frameHeight, 1, 0.f, false);
 
-        // Khởi tạo anim_thrust (phần dưới của texture)
-        anim_thrust = Animation(playerTexture, 0, frameHeight, frameWidth, frameHeight, 1, 0.f, false);
+    // Khởi tạo thrust (phần dưới của texture)
+    thrust = Animation(playerTexture, 0, frameHeight, frameWidth, frameHeight, 1, 0.f, false);
 
-        // Đặt animation ban đầu là idle
-        this->anim = anim_idle; // Quan trọng: gán anim hiện tại cho Entity base class
+    // *** THÊM SCALING Ở ĐÂY ***
+    float targetVisualHeight = 60.0f; // Đặt chiều cao mong muốn (ví dụ: 60 pixels)
+    float scaleFactor = targetVisualHeight / static_cast<float>(frameHeight);
+    LOG_DEBUG(LogCategory::Player, "Player Scale Factor: %f", scaleFactor);
 
-        // *** THÊM SCALING Ở ĐÂY ***
-        float targetVisualHeight = 60.0f; // Đặt chiều cao mong muốn (ví dụ: 60 pixels)
-        float scaleFactor = targetVisualHeight / static_cast<float>(frameHeight);
-        std::cout << "Player Scale Factor: " << scaleFactor << std::endl;
+    // Scale cả hai sprite animation
+    idle.sprite.setScale(scaleFactor, scaleFactor);
+    thrust.sprite.setScale(scaleFactor, scaleFactor);
+}
 
-        // Scale cả hai sprite animation
-        anim_idle.sprite.setScale(scaleFactor, scaleFactor);
-        anim_thrust.sprite.setScale(scaleFactor, scaleFactor);
-        // Gán lại anim hiện tại để đảm bảo sprite trong Entity base cũng được scale
-        this->anim = anim_idle;
+// Override settings để load đúng 2 trạng thái từ spaceship.png
+void Player::settings(Animation &a, sf::Vector2f startPos, float startAngle, float radius) {
+    // Không dùng animation 'a' được truyền vào nữa, vì chúng ta tự định nghĩa anim từ spaceship.png
+    try {
+        makeShipClips(anim_idle, anim_thrust);
+        this->anim = anim_idle; // Quan trọng: gán anim hiện tại cho Entity base class
 
         // Load textures cho hiệu ứng power-up (giữ nguyên logic này)
         shieldTexturePtr = &ResourceManager::getInstance().getTexture("shield_powerup.png");
@@ -98,7 +94,7 @@ void Player::settings(Animation &a, sf::Vector2f startPos, float startAngle, flo
 
 
     } catch (const std::runtime_error& e) {
-        std::cerr << "Error setting player animations/effects: " << e.what() << std::endl;
+        LOG_ERROR(LogCategory::Player, "Error setting player animations/effects: %s", e.what());
         // Fallback nếu có lỗi (dùng 'a' nếu cần, nhưng lý tưởng là báo lỗi và thoát)
         this->anim = a; // Dùng animation mặc định nếu lỗi
     }
@@ -116,7 +112,6 @@ void Player::update(float dt, const sf::Vector2u& windowSize) {
     if (!life) return;
 
     handleInput(dt);
-    updateEffects(dt);
     applyMovement(dt, windowSize);
 
     // *** Logic chuyển đổi Animation cốt lõi ***
@@ -124,7 +119,7 @@ void Player::update(float dt, const sf::Vector2u& windowSize) {
     // cho biến 'anim' của lớp Entity base.
     anim = thrust ? anim_thrust : anim_idle;
 
-    // Không cần gọi anim.update() vì speed = 0 và count = 1, frame sẽ không thay đổi.
+    // Không cần cập nhật anim: khung hình được lấy mẫu theo tick khi vẽ.
     // Tuy nhiên, gọi cũng không sao.
     // anim.update(dt); // Có thể bỏ dòng này
 
@@ -134,11 +129,11 @@ void Player::update(float dt, const sf::Vector2u& windowSize) {
 }
 
 void Player::handleInput(float dt) {
-    float actualTurnSpeed = turnSpeed * (slowTimer > 0 ? 0.5f : 1.0f); // Slow effect on turning
-    bool leftPressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Left);
-    bool rightPressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Right);
+    float actualTurnSpeed = turnSpeed * (hasStatus(Status::Slow) ? 0.5f : 1.0f); // Slow effect on turning
+    bool leftPressed = input.left;
+    bool rightPressed = input.right;
 
-    if (reverseControlsActive) {
+    if (hasStatus(Status::ReverseControls)) {
         std::swap(leftPressed, rightPressed); // Swap input effect
     }
 
@@ -149,9 +144,9 @@ void Player::handleInput(float dt) {
         angle += actualTurnSpeed * dt;
     }
 
-    thrust = sf::Keyboard::isKeyPressed(sf::Keyboard::Up);
+    thrust = input.thrust;
 
-    // Shooting input check (actual spawning happens in Game::spawnBullet called from Game::handleInput)
+    // Shooting input check (actual spawning happens in Game::spawnBullet, driven by input.fire in Game::updatePlaying)
     // Just checking readiness here
     // if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space) && shootTimer <= 0) {
     //     shoot(); // Signal intent to shoot
@@ -164,13 +159,14 @@ void Player::shoot() {
          //shootTimer = shootCooldown; // Reset cooldown internally
          // Game class will now call spawnBullet
      //}
-     std::cout << "Player::shoot() called (intent signal)." << std::endl; // DEBUG
+     LOG_DEBUG(LogCategory::Player, "Player::shoot() called (intent signal).");
 }
 
 
 void Player::applyMovement(float dt, const sf::Vector2u& windowSize) {
-     float currentMaxSpeed = maxSpeed * (speedBoostTimer > 0 ? 1.5f : 1.0f) * (slowTimer > 0 ? 0.5f : 1.0f);
-     float currentAcceleration = acceleration * (slowTimer > 0 ? 0.5f : 1.0f);
+     bool slowed = hasStatus(Status::Slow);
+     float currentMaxSpeed = maxSpeed * (hasStatus(Status::SpeedBoost) ? 1.5f : 1.0f) * (slowed ? 0.5f : 1.0f);
+     float currentAcceleration = acceleration * (slowed ? 0.5f : 1.0f);
 
     if (thrust) {
         velocity.x += std::cos((angle - 90) * PLAYER_DEGTORAD) * currentAcceleration * 60.f * dt;
@@ -191,40 +187,41 @@ void Player::applyMovement(float dt, const sf::Vector2u& windowSize) {
     if (pos.y > windowSize.y + R) pos.y = -R; else if (pos.y < -R) pos.y = windowSize.y + R;
 }
 
-void Player::updateEffects(float dt) {
-     if (shieldActive) {
-        shieldTimer -= dt;
-        if (shieldTimer <= 0) shieldActive = false;
-     }
-     if (speedBoostTimer > 0) {
-         speedBoostTimer -= dt;
-     }
-      if (slowTimer > 0) {
-         slowTimer -= dt;
-     }
-     if (reverseControlsActive) {
-         reverseControlsTimer -= dt;
-         if (reverseControlsTimer <= 0) reverseControlsActive = false;
-     }
-      if (weaponPowerUpActive) {
-         weaponPowerUpTimer -= dt;
-         if (weaponPowerUpTimer <= 0) weaponPowerUpActive = false;
-     }
+void Player::attachTimers(TimerWheel* wheel, std::uint16_t kind) {
+    timers = wheel;
+    statusEndKind = kind;
+}
+
+void Player::startStatus(Status status, float seconds) {
+    startStatusTicks(status, secondsToTicks(seconds));
+}
+
+void Player::startStatusTicks(Status status, std::uint64_t ticks) {
+    int i = static_cast<int>(status);
+    if (timers) {
+        timers->cancel(statusTimers[i]);
+        TimerEvent event;
+        event.kind = statusEndKind;
+        event.arg = i;
+        event.target = handle;
+        statusTimers[i] = timers->schedule(ticks, event);
+    }
+    statusActive[i] = true;
+}
+
+void Player::endStatus(Status status) {
+    int i = static_cast<int>(status);
+    if (timers) timers->cancel(statusTimers[i]); // No-op if this is the expiry itself
+    statusTimers[i] = TimerId();
+    statusActive[i] = false;
 }
 
 
 void Player::reset() {
     // Don't reset position/angle here, Game::loadLevel or respawn logic handles it
     velocity = sf::Vector2f(0.f, 0.f);
-    life = true; // Should be alive after reset
-    shieldActive = false;
-    shieldTimer = 0.f;
-    speedBoostTimer = 0.f;
-    slowTimer = 0.f;
-    reverseControlsActive = false;
-    reverseControlsTimer = 0.f;
-    weaponPowerUpActive = false;
-    weaponPowerUpTimer = 0.f;
+    revive(); // Should be alive after reset
+    for (int i = 0; i < STATUS_COUNT; ++i) endStatus(static_cast<Status>(i));
     currentWeaponType = Bullet::BulletType::Standard; // Reset weapon
     shootCooldown = 0.25f; // Reset shoot speed
     shootTimer = 0.f;
@@ -233,18 +230,18 @@ void Player::reset() {
 
 void Player::takeDamage() {
     if (!life) return; // Tránh gọi nhiều lần
-    if (shieldActive) { /* ... shield logic ... */ return; }
+    if (hasStatus(Status::Shield)) { /* ... shield logic ... */ return; }
 
     lives--;
-    std::cout << "Player took damage. Lives remaining: " << lives << std::endl; // DEBUG
+    LOG_DEBUG(LogCategory::Player, "Player took damage. Lives remaining: %d", lives);
     if (lives <= 0) {
-        life = false; // Chỉ thực sự "chết" (cần cleanup) khi hết mạng
-        std::cout << "Player has no lives left. Setting life = false." << std::endl; // DEBUG
+        kill(); // Chỉ thực sự "chết" (cần cleanup) khi hết mạng
+        LOG_DEBUG(LogCategory::Player, "Player has no lives left. Setting life = false.");
     } else {
         // Vẫn còn mạng, chỉ cần reset vị trí và trạng thái, không set life = false
         // Logic reset vị trí và trạng thái sẽ nằm trong Game::updatePlaying khi timer hết
-        life = false; // *** Vẫn cần set life=false để dừng hoạt động tạm thời ***
-         std::cout << "Player has lives left, setting life = false temporarily for respawn." << std::endl; // DEBUG
+        kill(); // *** Vẫn cần set life=false để dừng hoạt động tạm thời ***
+         LOG_DEBUG(LogCategory::Player, "Player has lives left, setting life = false temporarily for respawn.");
     }
 }
 
@@ -259,8 +256,7 @@ void Player::applyPowerUp(PowerUp* item) {
          // Apply Power-Up
          switch (item->getPowerUpType()) {
             case PowerUp::PowerUpType::Shield:
-                shieldActive = true;
-                shieldTimer = item->duration; // Use duration from item
+                startStatus(Status::Shield, item->duration); // Use duration from item
                 break;
             case PowerUp::PowerUpType::Weapon:
                  // TODO: Cycle through weapon types or specific upgrade logic
@@ -268,30 +264,30 @@ void Player::applyPowerUp(PowerUp* item) {
                      currentWeaponType = Bullet::BulletType::Laser; // Example upgrade
                      shootCooldown = 0.15f; // Laser might shoot faster
                  } else if (currentWeaponType == Bullet::BulletType::Laser) {
-                      // currentWeaponType = Bullet::BulletType::Spread;
-                      // shootCooldown = 0.4f; // Spread might be slower
+                      currentWeaponType = Bullet::BulletType::Homing; // Missiles find their own targets
+                      shootCooldown = 0.3f;
                  }
-                 weaponPowerUpActive = true;
-                 weaponPowerUpTimer = item->duration;
+                 startStatus(Status::WeaponBoost, item->duration);
                  break;
             case PowerUp::PowerUpType::Speed:
-                 speedBoostTimer = item->duration;
+                 startStatus(Status::SpeedBoost, item->duration);
                  break;
              case PowerUp::PowerUpType::ExtraLife:
                   lives++;
                   break;
+             case PowerUp::PowerUpType::SmartBomb:
+                  break; // Game detonates it (the blast works on the world, not the player)
          }
      } else {
          // Apply Power-Down
          switch (item->getPowerDownType()) {
              case PowerUp::PowerDownType::Slow:
-                 slowTimer = item->duration;
+                 startStatus(Status::Slow, item->duration);
                  // Reset speed boost if active
-                 speedBoostTimer = 0.f;
+                 endStatus(Status::SpeedBoost);
                  break;
              case PowerUp::PowerDownType::ReverseControls:
-                 reverseControlsActive = true;
-                 reverseControlsTimer = item->duration;
+                 startStatus(Status::ReverseControls, item->duration);
                  break;
              case PowerUp::PowerDownType::WeakerWeapon:
                   // TODO: Implement logic to downgrade weapon or reduce damage
@@ -313,32 +309,39 @@ void Player::setShipType(ShipType type) {
 }
 
 // Override draw to add effects
-void Player::draw(sf::RenderTarget &target) {
+void Player::draw(sf::RenderTarget &target, std::uint64_t tick) {
     if (!life) return;
 
     // Draw base ship
-    Entity::draw(target); // Calls base draw which draws anim.sprite
+    Entity::draw(target, tick); // Calls base draw which draws anim.sprite
+
+    // Lower quality levels drop the purely decorative overlays; the shield stays (it tells the player something)
+    const QualityController::Settings& quality = QualityController::getInstance().settings();
 
     // Draw Shield Effect
-    if (shieldActive && shieldTexturePtr) {
+    if (hasStatus(Status::Shield) && shieldTexturePtr) {
         shieldEffectSprite.setPosition(pos);
-        // Optional: Add pulsing/rotating effect
-        shieldEffectSprite.rotate(1.f); // Slow rotation
-        float scaleFactor = 1.0f + 0.05f * std::sin(shieldTimer * 5.f); // Simple pulse
+        float scaleFactor = 1.0f;
+        if (quality.shieldAnimation) {
+            // Optional: Add pulsing/rotating effect
+            shieldEffectSprite.rotate(1.f); // Slow rotation
+            float shieldLeft = timers ? timers->remainingTicks(statusTimers[static_cast<int>(Status::Shield)]) / static_cast<float>(TICK_RATE) : 0.f;
+            scaleFactor = 1.0f + 0.05f * std::sin(shieldLeft * 5.f); // Simple pulse
+        }
         shieldEffectSprite.setScale(scaleFactor * (R + 5.f) / (shieldTexturePtr->getSize().x / 2.f), // Scale based on player R
                                    scaleFactor * (R + 5.f) / (shieldTexturePtr->getSize().y / 2.f));
         target.draw(shieldEffectSprite);
     }
 
     // Draw Weapon Power-up Indicator
-    if (weaponPowerUpActive && weaponEffectTexturePtr) {
+    if (hasStatus(Status::WeaponBoost) && weaponEffectTexturePtr && quality.overlayEffects) {
          weaponEffectSprite.setPosition(pos); // Center on player
          weaponEffectSprite.setRotation(angle + 90.f); // Rotate with player
          target.draw(weaponEffectSprite);
     }
 
      // Draw Speed Boost Effect (at the back) - More complex positioning
-     if (speedBoostTimer > 0 && speedEffectTexturePtr && thrust) { // Only show when thrusting with boost
+     if (hasStatus(Status::SpeedBoost) && speedEffectTexturePtr && thrust && quality.overlayEffects) { // Only show when thrusting with boost
          float backOffset = -R * 0.8f; // Position behind the center
          float angleRad = (angle - 90) * PLAYER_DEGTORAD;
          sf::Vector2f offsetVec(std::cos(angleRad) * backOffset, std::sin(angleRad) * backOffset);
@@ -347,4 +350,19 @@ void Player::draw(sf::RenderTarget &target) {
          // Optional: Animate sprite or color based on timer
          target.draw(speedEffectSprite);
      }
-}
\ No newline at end of file
+}
+
+void Player::hashState(WorldChecksum& sum) const {
+    Entity::hashState(sum);
+    sum.add(thrust);
+    sum.add(score);
+    sum.add(lives);
+    sum.add(shootTimer);
+    sum.add(shootCooldown);
+    sum.add(static_cast<std::int32_t>(currentShipType));
+    sum.add(static_cast<std::int32_t>(currentWeaponType));
+    for (int i = 0; i < STATUS_COUNT; ++i) {
+        sum.add(statusActive[i]);
+        sum.add(timers ? timers->remainingTicks(statusTimers[i]) : std::uint64_t(0));
+    }
+}
@@ -4,10 +4,33 @@
 #include "Entity.h"
 #include "Bullet.h" // Include Bullet for weapon type
 #include "PowerUp.h" // Include PowerUp for power-down type
+#include "TimerWheel.h"
+
+// One tick of player controls. Game samples it (or reads it back from a recorded session)
+// and hands it to the player, so the simulation never reads the keyboard itself.
+struct PlayerInput {
+    bool left = false;
+    bool right = false;
+    bool thrust = false;
+    bool fire = false;
+
+    std::uint8_t toBits() const { return static_cast<std::uint8_t>(left | (right << 1) | (thrust << 2) | (fire << 3)); }
+    static PlayerInput fromBits(std::uint8_t bits) {
+        PlayerInput in;
+        in.left = (bits & 1) != 0;
+        in.right = (bits & 2) != 0;
+        in.thrust = (bits & 4) != 0;
+        in.fire = (bits & 8) != 0;
+        return in;
+    }
+};
 
 class Player : public Entity {
 public:
     enum class ShipType { Standard, Fast, Heavy };
+    // Timed power-up/down states. A running status owns one timer in Game's wheel; when it fires
+    // Game calls endStatus, so nothing counts these down per tick.
+    enum class Status { Shield, SpeedBoost, Slow, ReverseControls, WeaponBoost, Count };
 
     bool thrust;
     float maxSpeed;
@@ -21,18 +44,11 @@ public:
     ShipType currentShipType;
     Bullet::BulletType currentWeaponType; // Track current weapon
 
-    // Power-up/down states
-    bool shieldActive;
-    float shieldTimer;
-    float speedBoostTimer;
-    float slowTimer; // Timer for slow effect
-    bool reverseControlsActive; // Flag for reversed controls
-    float reverseControlsTimer;
-    bool weaponPowerUpActive; // Flag for weapon powerup visual
-    float weaponPowerUpTimer;
-
     Player();
 
+    // The ship's idle and thrust clips from spaceship.png, scaled to their on-screen size (throws if it is missing)
+    static void makeShipClips(Animation& idle, Animation& thrust);
+
     void settings(Animation &a, sf::Vector2f startPos, float startAngle = 0.f, float radius = 20.f) override;
     void update(float dt, const sf::Vector2u& windowSize) override;
     void reset();
@@ -41,15 +57,24 @@ public:
     void addScore(int points);
     void applyPowerUp(PowerUp* item); // Handles both up and down
     void shoot(); // Moved shoot logic trigger here
+    void setInput(const PlayerInput& in) { input = in; } // Controls for the next update
+
+    void attachTimers(TimerWheel* wheel, std::uint16_t statusEndKind); // Wheel + event kind for status expiry
+    void startStatus(Status status, float seconds); // (Re)starts a status, replacing its running timer
+    void startStatusTicks(Status status, std::uint64_t ticks);
+    void endStatus(Status status);                  // Ends it now (also what the expiry event does)
+    bool hasStatus(Status status) const { return statusActive[static_cast<int>(status)]; }
 
     void setShipType(ShipType type);
     // Override draw to handle power-up visuals
-    void draw(sf::RenderTarget &target) override;
+    void draw(sf::RenderTarget &target, std::uint64_t tick) override;
+    void hashState(WorldChecksum& sum) const override;
 
 private:
     void handleInput(float dt);
     void applyMovement(float dt, const sf::Vector2u& windowSize);
-    void updateEffects(float dt); // Renamed from updatePowerUps
+
+    PlayerInput input;
 
     // Animations
     Animation anim_idle;
@@ -62,6 +87,12 @@ private:
     sf::Sprite shieldEffectSprite;
     sf::Sprite weaponEffectSprite;
     sf::Sprite speedEffectSprite;
+
+    static const int STATUS_COUNT = static_cast<int>(Status::Count);
+    TimerWheel* timers;
+    std::uint16_t statusEndKind;
+    bool statusActive[STATUS_COUNT];
+    TimerId statusTimers[STATUS_COUNT];
 };
 
 #endif // PLAYER_H
\ No newline at end of file
@@ -1,33 +1,34 @@
 #include "PowerUp.h"
+#include "Logger.h"
 #include "ResourceManager.h"
-#include <iostream>
 #include <cmath>
 
 PowerUp::PowerUp(PowerUpType type) : /* constructor logic same as before */
-    isPowerDown(false), duration(5.0f), existenceTimer(10.0f) {
-    this->type = Entity::Type::PowerUp; itemType.upType = type; name = "powerup_";
+    isPowerDown(false), duration(5.0f), lifetime(10.0f), age(0.f) {
+    this->type = Entity::Type::PowerUp; itemType.upType = type;
     switch (type) { /* name setting same as before */
-        case PowerUpType::Shield:  name += "shield"; duration=8.0f; break; // Shield lasts longer
-        case PowerUpType::Weapon:  name += "weapon"; duration=10.0f; break; // Weapon upgrade lasts longer
-        case PowerUpType::Speed:   name += "speed"; duration=7.0f; break;
-        case PowerUpType::ExtraLife: name += "extralife"; duration = 0; break;
+        case PowerUpType::Shield:  name = "powerup_shield"; duration=8.0f; break; // Shield lasts longer
+        case PowerUpType::Weapon:  name = "powerup_weapon"; duration=10.0f; break; // Weapon upgrade lasts longer
+        case PowerUpType::Speed:   name = "powerup_speed"; duration=7.0f; break;
+        case PowerUpType::ExtraLife: name = "powerup_extralife"; duration = 0; break;
+        case PowerUpType::SmartBomb: name = "powerup_smartbomb"; duration = 0; break; // Detonates on pickup
     }
 }
 
 PowerUp::PowerUp(PowerDownType type) : /* constructor logic same as before */
-    isPowerDown(true), duration(8.0f), existenceTimer(10.0f) {
-    this->type = Entity::Type::PowerDown; itemType.downType = type; name = "powerdown_";
+    isPowerDown(true), duration(8.0f), lifetime(10.0f), age(0.f) {
+    this->type = Entity::Type::PowerDown; itemType.downType = type;
     switch (type) { /* name setting same as before */
-        case PowerDownType::Slow: name += "slow"; break;
-        case PowerDownType::ReverseControls: name += "reverse"; break;
-        case PowerDownType::WeakerWeapon: name += "weaker"; break;
+        case PowerDownType::Slow: name = "powerdown_slow"; break;
+        case PowerDownType::ReverseControls: name = "powerdown_reverse"; break;
+        case PowerDownType::WeakerWeapon: name = "powerdown_weaker"; break;
     }
 }
 
 void PowerUp::settings(Animation &a, sf::Vector2f startPos, float startAngle, float radius) {
     Animation actualAnim = a;
     float actualRadius = radius;
-    std::string textureName = "";
+    const char* textureName = nullptr;
     int frameW = 32, frameH = 32, frameCount = 1; // Default for single frame powerups
     float animSpeed = 0.f;
     bool loopAnim = true; // Most powerups might pulsate or rotate
@@ -51,6 +52,11 @@ void PowerUp::settings(Animation &a, sf::Vector2f startPos, float startAngle, fl
                      frameW = 233; frameH = 134; frameCount = 1;
                      actualRadius = 12.f;
                      break;
+                case PowerUpType::SmartBomb:
+                     textureName = "weapon_powerup.png"; // No art of its own yet: tinted below
+                     frameW = 256; frameH = 256; frameCount = 1;
+                     actualRadius = 14.f;
+                     break;
                  // case PowerUpType::ExtraLife: textureName = "extralife_powerup.png"; break; // Add texture
             }
         } else {
@@ -59,46 +65,52 @@ void PowerUp::settings(Animation &a, sf::Vector2f startPos, float startAngle, fl
              // switch (itemType.downType) {
              //    case PowerDownType::Slow: textureName = "some_slow_icon.png"; break;
              //}
-             std::cerr << "Warning: Trying to create collectible PowerDown - currently handled by HazardMeteor." << std::endl;
-             life = false; // Don't create this entity for now
+             LOG_WARN(LogCategory::Entity, "Trying to create collectible PowerDown - currently handled by HazardMeteor.");
+             kill(); // Don't create this entity for now
              return;
         }
 
-        if (!textureName.empty()) {
+        if (textureName) {
             actualAnim = Animation(ResourceManager::getInstance().getTexture(textureName), 0, 0, frameW, frameH, frameCount, animSpeed, loopAnim);
             // Adjust scale if needed for visual size vs collision radius
             float visualScale = actualRadius * 2.0f / std::max(frameW, frameH); // Scale to roughly match radius visually
             actualAnim.sprite.setScale(visualScale, visualScale);
+            if (!isPowerDown && itemType.upType == PowerUpType::SmartBomb) actualAnim.sprite.setColor(sf::Color(255, 90, 60));
         } else if (!isPowerDown && itemType.upType == PowerUpType::ExtraLife) {
             // Handle case where ExtraLife texture might be missing, use fallback
-             std::cerr << "Warning: Extra life texture missing, using fallback." << std::endl;
+             LOG_WARN(LogCategory::Entity, "Extra life texture missing, using fallback.");
         }
 
     } catch (const std::runtime_error& e) {
-         std::cerr << "Error setting powerup animation (" << name << "): " << e.what() << std::endl;
+         LOG_ERROR(LogCategory::Entity, "Error setting powerup animation (%s): %s", name, e.what());
          actualAnim = a; // Keep fallback
          actualRadius = radius;
     }
 
     Entity::settings(actualAnim, startPos, startAngle, actualRadius);
-    existenceTimer = 10.0f;
-    life = true;
+    age = 0.f;
+    revive();
     this->type = isPowerDown ? Entity::Type::PowerDown : Entity::Type::PowerUp;
 }
 
 void PowerUp::update(float dt, const sf::Vector2u& windowSize) {
     if (!life) return;
-    existenceTimer -= dt;
-    if (existenceTimer <= 0) { life = false; return; }
+    age += dt;
 
     // Optional: Add rotation or bobbing effect
     angle += 30.f * dt; // Simple rotation
-    pos.y += std::sin(existenceTimer * 2.0f) * 0.5f; // Gentle bobbing
-
-    anim.update(dt); // Update animation (might just be static or rotating)
+    pos.y += std::sin((lifetime - age) * 2.0f) * 0.5f; // Gentle bobbing
 }
 
 // Getters same as before
 bool PowerUp::getIsPowerDown() const { return isPowerDown; }
 PowerUp::PowerUpType PowerUp::getPowerUpType() const { /* ... */ return isPowerDown ? PowerUpType::Shield : itemType.upType; }
-PowerUp::PowerDownType PowerUp::getPowerDownType() const { /* ... */ return !isPowerDown ? PowerDownType::Slow : itemType.downType; }
\ No newline at end of file
+PowerUp::PowerDownType PowerUp::getPowerDownType() const { /* ... */ return !isPowerDown ? PowerDownType::Slow : itemType.downType; }
+
+void PowerUp::hashState(WorldChecksum& sum) const {
+    Entity::hashState(sum);
+    sum.add(isPowerDown);
+    sum.add(isPowerDown ? static_cast<std::int32_t>(itemType.downType) : static_cast<std::int32_t>(itemType.upType));
+    sum.add(duration);
+    sum.add(age);
+}
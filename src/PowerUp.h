@@ -5,7 +5,7 @@
 
 class PowerUp : public Entity {
 public:
-    enum class PowerUpType { Shield, Weapon, Speed, ExtraLife /* Add more */ };
+    enum class PowerUpType { Shield, Weapon, Speed, ExtraLife, SmartBomb /* Add more */ };
     enum class PowerDownType { Slow, ReverseControls, WeakerWeapon /* Add more */ };
 
     bool isPowerDown; // Flag to indicate if it's a negative effect
@@ -15,13 +15,16 @@ public:
     } itemType;
 
     float duration; // How long the effect lasts (if applicable)
-    float existenceTimer; // How long the power-up stays on screen
+    float lifetime; // How long the power-up stays on screen (expired by a timer)
+    float age;      // Seconds since spawn, drives the bobbing motion
 
     PowerUp(PowerUpType type); // Constructor for PowerUps
     PowerUp(PowerDownType type); // Constructor for PowerDowns
 
     void settings(Animation &a, sf::Vector2f startPos, float startAngle = 0.f, float radius = 12.f) override;
     void update(float dt, const sf::Vector2u& windowSize) override;
+    std::uint64_t lifetimeTicks() const override { return secondsToTicks(lifetime); }
+    void hashState(WorldChecksum& sum) const override;
 
     // Getters for type checking
     bool getIsPowerDown() const;
@@ -0,0 +1,62 @@
+#include "QualityController.h"
+#include "Logger.h"
+
+namespace {
+    const QualityController::Settings LEVELS[QualityController::LEVEL_COUNT] = {
+        // maxParticles, coalesceRadius, animationStep, overlayEffects, shieldAnimation
+        { 1024, 0.f,  1, true,  true  },
+        { 256,  16.f, 1, true,  true  },
+        { 96,   32.f, 2, false, true  },
+        { 32,   48.f, 4, false, false },
+    };
+
+    const double DEGRADE_AT = 0.90;   // Fraction of the frame budget
+    const double RESTORE_AT = 0.50;
+    const int DEGRADE_FRAMES = 3;     // Shed load quickly...
+    const int RESTORE_FRAMES = 180;   // ...restore it only after ~3 s of headroom
+    const int HOLD_FRAMES = 30;
+}
+
+QualityController& QualityController::getInstance() {
+    static QualityController instance;
+    return instance;
+}
+
+QualityController::QualityController() :
+    current(LEVELS[0]), currentLevel(0), autoLevel(true), budget(1.0 / 60.0),
+    overFrames(0), underFrames(0), holdFrames(0), shed(0) {}
+
+void QualityController::configure(int fixedLevel, double frameBudgetSeconds) {
+    budget = frameBudgetSeconds > 0.0 ? frameBudgetSeconds : 1.0 / 60.0;
+    autoLevel = fixedLevel < 0;
+    setLevel(autoLevel ? 0 : fixedLevel);
+}
+
+void QualityController::setLevel(int level) {
+    if (level < 0) level = 0;
+    if (level >= LEVEL_COUNT) level = LEVEL_COUNT - 1;
+    current = LEVELS[level];
+    currentLevel = level;
+    overFrames = 0;
+    underFrames = 0;
+    holdFrames = HOLD_FRAMES;
+}
+
+void QualityController::frameWorked(double seconds) {
+    if (!autoLevel) return;
+    if (holdFrames > 0) {
+        --holdFrames;
+        return;
+    }
+
+    overFrames = seconds > budget * DEGRADE_AT ? overFrames + 1 : 0;
+    underFrames = seconds < budget * RESTORE_AT ? underFrames + 1 : 0;
+    if (overFrames >= DEGRADE_FRAMES && currentLevel + 1 < LEVEL_COUNT) {
+        setLevel(currentLevel + 1);
+        LOG_INFO(LogCategory::Game, "Quality lowered to level %d (frame work %.2f ms, budget %.2f ms)",
+                 currentLevel, seconds * 1000.0, budget * 1000.0);
+    } else if (underFrames >= RESTORE_FRAMES && currentLevel > 0) {
+        setLevel(currentLevel - 1);
+        LOG_INFO(LogCategory::Game, "Quality raised to level %d", currentLevel);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef QUALITYCONTROLLER_H
+#define QUALITYCONTROLLER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Frame-budget driven cosmetic quality. Game reports how long each frame's work took (before
+// presenting); the controller steps down a level after a run of frames over budget and back up
+// after a long run with headroom. Only drawing and particles read the settings: nothing that
+// feeds the simulation (or its random numbers) depends on the quality level.
+class QualityController {
+public:
+    static const int LEVEL_COUNT = 4; // 0 = full quality
+
+    struct Settings {
+        std::size_t maxParticles;  // Live explosion/spark particles; spawns beyond are dropped
+        float coalesceRadius;      // A spawn this close to a fresh particle of the same clip is dropped (0 = off)
+        int animationStep;         // Flipbooks advance in steps of this many frames
+        bool overlayEffects;       // Player weapon/speed overlays (the shield is always shown)
+        bool shieldAnimation;      // Shield pulse and spin
+    };
+
+    static QualityController& getInstance(); // Singleton access
+
+    QualityController(const QualityController&) = delete;
+    QualityController& operator=(const QualityController&) = delete;
+
+    // level < 0: automatic; otherwise the level is pinned
+    void configure(int fixedLevel, double frameBudgetSeconds);
+    void frameWorked(double seconds); // Once per frame: update + render time, excluding the present/wait
+
+    const Settings& settings() const { return current; }
+    int level() const { return currentLevel; }
+    bool automatic() const { return autoLevel; }
+
+    void noteShed() { ++shed; } // A cosmetic item was skipped because of the quality level
+    std::uint64_t shedCount() const { return shed; }
+
+private:
+    QualityController();
+    void setLevel(int level);
+
+    Settings current;
+    int currentLevel;
+    bool autoLevel;
+    double budget;
+    int overFrames;   // Consecutive frames over the degrade threshold
+    int underFrames;  // Consecutive frames under the restore threshold
+    int holdFrames;   // No further change until this runs out (lets a change take effect)
+    std::uint64_t shed;
+};
+
+#endif // QUALITYCONTROLLER_H
@@ -0,0 +1,18 @@
+#include "Random.h"
+
+thread_local std::uint64_t Random::rngState = 0x853c49e6748fea9bull;
+
+void Random::seed(std::uint64_t seedValue) {
+    rngState = 0;
+    next();
+    rngState += seedValue;
+    next();
+}
+
+std::uint32_t Random::next() {
+    std::uint64_t old = rngState;
+    rngState = old * 6364136223846793005ull + 1442695040888963407ull;
+    std::uint32_t xorshifted = static_cast<std::uint32_t>(((old >> 18u) ^ old) >> 27u);
+    std::uint32_t rot = static_cast<std::uint32_t>(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+}
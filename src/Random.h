@@ -0,0 +1,23 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Gameplay random numbers (PCG32). Unlike std::rand the state is a plain value that snapshots can
+// save and restore, so a resumed run continues the exact same random sequence.
+// The state is per thread: a simulation only ever draws from the thread that runs it.
+class Random {
+public:
+    static void seed(std::uint64_t seedValue);
+    static std::uint32_t next();                        // Uniform 32-bit value
+    static int range(int bound) { return bound > 0 ? static_cast<int>(next() % static_cast<std::uint32_t>(bound)) : 0; } // [0, bound)
+    static float unit() { return static_cast<float>(next() >> 8) * (1.f / 16777216.f); }                                    // [0, 1)
+
+    static std::uint64_t state() { return rngState; }
+    static void setState(std::uint64_t s) { rngState = s; }
+
+private:
+    static thread_local std::uint64_t rngState;
+};
+
+#endif // RANDOM_H
@@ -1,5 +1,5 @@
 #include "ResourceManager.h"
-#include <iostream> // For error messages
+#include "Logger.h"
 
 // Initialize static instance (Singleton pattern)
 ResourceManager& ResourceManager::getInstance() {
@@ -7,7 +7,7 @@ ResourceManager& ResourceManager::getInstance() {
     return instance;
 }
 
-sf::Texture& ResourceManager::getTexture(const std::string& filename) {
+sf::Texture& ResourceManager::getTexture(std::string_view filename) {
     // Check if texture is already loaded
     auto it = textures.find(filename);
     if (it != textures.end()) {
@@ -16,33 +16,35 @@ sf::Texture& ResourceManager::getTexture(const std::string& filename) {
 
     // Load texture if not found
     auto texture = std::make_unique<sf::Texture>();
-    std::string fullPath = basePath + filename; // Assuming textures are in 'images/' relative to exe
+    std::string fullPath = basePath + std::string(filename); // Assuming textures are in 'images/' relative to exe
     if (!texture->loadFromFile(fullPath)) {
         throw std::runtime_error("Failed to load texture: " + fullPath);
     }
-    std::cout << "Loaded texture: " << fullPath << std::endl;
+    LOG_INFO(LogCategory::Resource, "Loaded texture: %s", fullPath);
     // texture->setSmooth(true); // Optional smoothing
-    textures[filename] = std::move(texture);
-    return *textures[filename];
+    sf::Texture& result = *texture;
+    textures.emplace(std::string(filename), std::move(texture));
+    return result;
 }
 
-sf::SoundBuffer& ResourceManager::getSoundBuffer(const std::string& filename) {
+sf::SoundBuffer& ResourceManager::getSoundBuffer(std::string_view filename) {
     auto it = soundBuffers.find(filename);
     if (it != soundBuffers.end()) {
         return *it->second;
     }
 
     auto buffer = std::make_unique<sf::SoundBuffer>();
-    std::string fullPath = soundPath + filename; // Assuming sounds are in 'sounds/'
+    std::string fullPath = soundPath + std::string(filename); // Assuming sounds are in 'sounds/'
     if (!buffer->loadFromFile(fullPath)) {
         throw std::runtime_error("Failed to load sound buffer: " + fullPath);
     }
-     std::cout << "Loaded sound buffer: " << fullPath << std::endl;
-    soundBuffers[filename] = std::move(buffer);
-    return *soundBuffers[filename];
+     LOG_INFO(LogCategory::Resource, "Loaded sound buffer: %s", fullPath);
+    sf::SoundBuffer& result = *buffer;
+    soundBuffers.emplace(std::string(filename), std::move(buffer));
+    return result;
 }
 
-sf::Font& ResourceManager::getFont(const std::string& filename) {
+sf::Font& ResourceManager::getFont(std::string_view filename) {
     auto it = fonts.find(filename);
     if (it != fonts.end()) {
         return *it->second;
@@ -50,11 +52,12 @@ sf::Font& ResourceManager::getFont(const std::string& filename) {
 
     auto font = std::make_unique<sf::Font>();
     // std::string fullPath = fontPath + filename; // Assuming fonts are in 'fonts/'
-    std::string fullPath = filename; // Or adjust path as needed
+    std::string fullPath(filename); // Or adjust path as needed
     if (!font->loadFromFile(fullPath)) {
          throw std::runtime_error("Failed to load font: " + fullPath);
     }
-     std::cout << "Loaded font: " << fullPath << std::endl;
-    fonts[filename] = std::move(font);
-    return *fonts[filename];
+     LOG_INFO(LogCategory::Resource, "Loaded font: %s", fullPath);
+    sf::Font& result = *font;
+    fonts.emplace(std::string(filename), std::move(font));
+    return result;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <string>
+#include <string_view>
 #include <map>
 #include <memory>
 #include <stdexcept>
@@ -18,14 +19,16 @@ public:
 
     static ResourceManager& getInstance(); // Singleton access
 
-    sf::Texture& getTexture(const std::string& filename);
-    sf::SoundBuffer& getSoundBuffer(const std::string& filename);
-    sf::Font& getFont(const std::string& filename);
+    // Lookups take string_view so cache hits with a literal never build a temporary std::string
+    sf::Texture& getTexture(std::string_view filename);
+    sf::SoundBuffer& getSoundBuffer(std::string_view filename);
+    sf::Font& getFont(std::string_view filename);
 
 private:
-    std::map<std::string, std::unique_ptr<sf::Texture>> textures;
-    std::map<std::string, std::unique_ptr<sf::SoundBuffer>> soundBuffers;
-    std::map<std::string, std::unique_ptr<sf::Font>> fonts;
+    // std::less<> enables heterogeneous (string_view) lookup
+    std::map<std::string, std::unique_ptr<sf::Texture>, std::less<>> textures;
+    std::map<std::string, std::unique_ptr<sf::SoundBuffer>, std::less<>> soundBuffers;
+    std::map<std::string, std::unique_ptr<sf::Font>, std::less<>> fonts;
 
     // Base path for assets (adjust if needed)
     std::string basePath = "images/"; // Default for textures
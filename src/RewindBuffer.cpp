@@ -0,0 +1,124 @@
+#include "RewindBuffer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    const std::size_t EMITTER_RESERVE = 16; // Pattern emitters run at once (a few per boss gun)
+}
+
+RewindBuffer::RewindBuffer() :
+    first(0), count(0), writePos(0), used(0), keyframeInterval(30), sinceKeyframe(0), forceKeyframe(true) {}
+
+void RewindBuffer::configure(std::size_t budgetBytes, std::size_t maxFrames, int interval) {
+    if (budgetBytes == 0 || maxFrames == 0) {
+        std::vector<std::uint8_t>().swap(storage);
+        std::vector<FrameInfo>().swap(frames);
+    } else {
+        storage.assign(budgetBytes, 0);
+        frames.assign(maxFrames, FrameInfo{0, 0, false});
+    }
+    keyframeInterval = interval > 0 ? interval : 1;
+    clear();
+}
+
+void RewindBuffer::reserve(std::size_t entities, std::size_t timers, std::size_t shots, std::size_t drones) {
+    for (WorldSnapshot* world : {&current, &previous, &decoded[0], &decoded[1]}) {
+        world->entities.reserve(entities);
+        world->timers.reserve(timers);
+        world->shots.reserve(shots);
+        world->emitters.reserve(EMITTER_RESERVE);
+        world->drones.reserve(drones);
+    }
+    codec.reserve(entities);
+    scratch.reserve(64 + entities * 32 + (shots + drones) * 16); // A full record is about 20 bytes, a shot or drone 12
+}
+
+void RewindBuffer::clear() {
+    first = 0;
+    count = 0;
+    writePos = 0;
+    used = 0;
+    sinceKeyframe = 0;
+    forceKeyframe = true;
+}
+
+void RewindBuffer::evictOldestGroup() {
+    // A delta is useless without the frames before it, so the keyframe goes with all its deltas
+    do {
+        used -= slot(0).size;
+        first = (first + 1) % frames.size();
+        --count;
+    } while (count > 0 && !slot(0).keyframe);
+}
+
+void RewindBuffer::commitFrame() {
+    if (!enabled()) return;
+
+    bool keyframe = forceKeyframe || sinceKeyframe >= keyframeInterval;
+    scratch.clear();
+    codec.encode(current, keyframe ? nullptr : &previous, scratch);
+    std::swap(current, previous);
+    std::size_t size = scratch.size();
+    if (size > storage.size()) { // One frame larger than the whole budget: keep nothing rather than a broken chain
+        LOG_WARN(LogCategory::Game, "Rewind frame of %d bytes exceeds the %d byte budget", size, storage.size());
+        clear();
+        return;
+    }
+
+    if (count == frames.size()) evictOldestGroup();
+    if (writePos + size > storage.size()) {
+        // Wrap: frames left in the tail are the oldest ones, drop them before reusing the front
+        std::size_t tail = writePos;
+        while (count > 0 && slot(0).offset >= tail) evictOldestGroup();
+        writePos = 0;
+    }
+    while (count > 0 && slot(0).offset < writePos + size && writePos < slot(0).offset + slot(0).size) {
+        evictOldestGroup();
+    }
+    if (count == 0 && !keyframe) { // Everything before it was evicted: restart the chain next tick
+        forceKeyframe = true;
+        return;
+    }
+
+    std::copy(scratch.begin(), scratch.end(), storage.begin() + writePos);
+    FrameInfo& info = frames[(first + count) % frames.size()];
+    info.offset = writePos;
+    info.size = size;
+    info.keyframe = keyframe;
+    ++count;
+    writePos += size;
+    used += size;
+    sinceKeyframe = keyframe ? 1 : sinceKeyframe + 1;
+    forceKeyframe = false;
+}
+
+const WorldSnapshot& RewindBuffer::frame(std::size_t index) {
+    if (index >= count) throw std::runtime_error("Rewind: no such frame");
+    std::size_t key = index;
+    while (!slot(key).keyframe) {
+        if (key == 0) throw std::runtime_error("Rewind: frame has no keyframe");
+        --key;
+    }
+
+    int cur = 0;
+    const FrameInfo& keyInfo = slot(key);
+    codec.decode(storage.data() + keyInfo.offset, keyInfo.size, nullptr, decoded[cur]);
+    for (std::size_t i = key + 1; i <= index; ++i) {
+        const FrameInfo& info = slot(i);
+        codec.decode(storage.data() + info.offset, info.size, &decoded[cur], decoded[1 - cur]);
+        cur = 1 - cur;
+    }
+    return decoded[cur];
+}
+
+void RewindBuffer::truncateAfter(std::size_t index) {
+    if (index + 1 >= count) return;
+    count = index + 1;
+    const FrameInfo& last = slot(index);
+    writePos = last.offset + last.size;
+    used = 0;
+    for (std::size_t i = 0; i < count; ++i) used += slot(i).size;
+    forceKeyframe = true; // 'previous' no longer holds the newest frame
+}
@@ -0,0 +1,66 @@
+#ifndef REWINDBUFFER_H
+#define REWINDBUFFER_H
+
+#include "Snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bounded history of recent world states for rewinding while paused. Every tick's snapshot is
+// encoded into one preallocated byte ring: a full keyframe every 'keyframeInterval' frames and a
+// delta against the previous frame otherwise. When the byte budget or the frame limit is reached,
+// the oldest keyframe and its deltas are dropped together. Recording never allocates once warm.
+class RewindBuffer {
+public:
+    RewindBuffer();
+
+    // Allocates the ring; budgetBytes == 0 or maxFrames == 0 disables recording
+    void configure(std::size_t budgetBytes, std::size_t maxFrames, int keyframeInterval);
+    bool enabled() const { return !storage.empty(); }
+    // Sizes the scratch worlds so recording stays allocation-free up to these counts
+    void reserve(std::size_t entities, std::size_t timers, std::size_t shots, std::size_t drones);
+
+    // Recording: fill the world returned by beginFrame, then commitFrame encodes and stores it
+    WorldSnapshot& beginFrame() { return current; }
+    void commitFrame();
+
+    // Frames are numbered 0 (oldest) .. frameCount() - 1 (newest)
+    std::size_t frameCount() const { return count; }
+    // Decodes a frame (its keyframe, then the deltas up to it). The result is valid until the
+    // next call. Throws std::runtime_error if the stored data does not decode.
+    const WorldSnapshot& frame(std::size_t index);
+    // Drops every frame newer than 'index' (resuming from a rewound state); the next frame is a keyframe
+    void truncateAfter(std::size_t index);
+    void clear();
+
+    std::size_t bytesUsed() const { return used; }
+    std::size_t budget() const { return storage.size(); }
+
+private:
+    struct FrameInfo {
+        std::size_t offset;
+        std::size_t size;
+        bool keyframe;
+    };
+
+    FrameInfo& slot(std::size_t index) { return frames[(first + index) % frames.size()]; }
+    void evictOldestGroup();
+
+    std::vector<std::uint8_t> storage; // Byte ring holding the encoded frames
+    std::vector<FrameInfo> frames;     // Frame index ring, oldest at 'first'
+    std::size_t first;
+    std::size_t count;
+    std::size_t writePos;
+    std::size_t used;
+    int keyframeInterval;
+    int sinceKeyframe;
+    bool forceKeyframe;
+
+    SnapshotCodec codec;
+    WorldSnapshot current;  // Being recorded
+    WorldSnapshot previous; // Last recorded (the delta base)
+    std::vector<std::uint8_t> scratch;
+    WorldSnapshot decoded[2]; // Ping-pong buffers for decoding delta chains
+};
+
+#endif // REWINDBUFFER_H
@@ -0,0 +1,187 @@
+#include "RockSolver.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const int VELOCITY_PASSES = 4;
+    const float RESTITUTION = 1.f;      // Elastic
+    const float REST_SPEED = 0.05f;     // Closing slower than this (px/tick) does not bounce
+    const float SLOP = 0.5f;            // Overlap left alone (px), so touching pairs do not jitter
+    const float CORRECTION = 0.6f;      // Share of the remaining overlap removed per tick
+    const std::size_t ISLANDS_PER_CHUNK = 32;
+    const std::size_t PARALLEL_MIN_ISLANDS = 2 * ISLANDS_PER_CHUNK; // Fewer: the caller does it all
+
+    float dot(sf::Vector2f a, sf::Vector2f b) { return a.x * b.x + a.y * b.y; }
+}
+
+RockSolver::RockSolver() :
+    contactCapacity(0), lastStats(), nextIsland(0) {}
+
+void RockSolver::configure(float width, float height, float cellSize) {
+    grid.configure(width, height, cellSize);
+}
+
+void RockSolver::reserve(std::size_t bodyCount, std::size_t contactCount) {
+    grid.reserve(bodyCount);
+    bodies.reserve(bodyCount);
+    parent.reserve(bodyCount);
+    islandOf.reserve(bodyCount);
+    islandStart.reserve(std::max(bodyCount, contactCount) + 1);
+    found.reserve(contactCount);
+    contacts.reserve(contactCount);
+    contactCapacity = contactCount;
+}
+
+void RockSolver::setWorkers(int count) {
+    pool.resize(count);
+}
+
+void RockSolver::clear() {
+    bodies.clear();
+}
+
+std::uint32_t RockSolver::add(sf::Vector2f pos, sf::Vector2f vel, float radius, float mass) {
+    bodies.push_back(Body{pos, vel, radius, mass > 0.f ? 1.f / mass : 0.f});
+    return static_cast<std::uint32_t>(bodies.size() - 1);
+}
+
+void RockSolver::solve() {
+    lastStats.bodies = bodies.size();
+    findContacts();
+    buildIslands();
+    std::size_t islands = islandStart.empty() ? 0 : islandStart.size() - 1;
+    lastStats.contacts = contacts.size();
+    lastStats.islands = islands;
+    lastStats.largestIsland = 0;
+    for (std::size_t i = 0; i < islands; ++i) {
+        lastStats.largestIsland = std::max<std::size_t>(lastStats.largestIsland, islandStart[i + 1] - islandStart[i]);
+    }
+    if (islands == 0) return;
+
+    nextIsland.store(0, std::memory_order_relaxed);
+    if (islands < PARALLEL_MIN_ISLANDS) {
+        runIslands();
+        return;
+    }
+    auto job = [this](std::size_t) { runIslands(); };
+    pool.run(job);
+}
+
+// Every overlapping pair once (a < b), in the order the grid reports them for ascending a. The
+// normal and the speed to bounce back at are taken from the state before anything is solved.
+void RockSolver::findContacts() {
+    grid.clear();
+    for (std::size_t i = 0; i < bodies.size(); ++i) grid.add(static_cast<std::uint32_t>(i), bodies[i].pos, bodies[i].radius);
+    grid.build();
+
+    found.clear();
+    for (std::uint32_t a = 0; a < bodies.size(); ++a) {
+        const Body& A = bodies[a];
+        grid.query(A.pos, A.radius, [&](std::uint32_t b) {
+            if (b <= a) return;
+            const Body& B = bodies[b];
+            if (A.invMass + B.invMass <= 0.f) return;
+            sf::Vector2f d = B.pos - A.pos;
+            float reach = A.radius + B.radius;
+            float distanceSq = dot(d, d);
+            if (distanceSq >= reach * reach) return;
+            if (found.size() >= contactCapacity) {
+                ++lastStats.dropped;
+                return;
+            }
+            float distance = std::sqrt(distanceSq);
+            sf::Vector2f normal = distance > 1e-4f ? d / distance : sf::Vector2f(1.f, 0.f); // Same spot: split sideways
+            float closing = dot(B.vel - A.vel, normal);
+            found.push_back(Contact{a, b, normal, closing < -REST_SPEED ? -RESTITUTION * closing : 0.f, 0.f});
+        });
+    }
+}
+
+// Union-find over the contacts, then a counting sort of the contacts by island. Islands are
+// numbered in the order their first contact was found.
+void RockSolver::buildIslands() {
+    contacts.clear();
+    islandStart.clear();
+    if (found.empty()) return;
+
+    parent.resize(bodies.size());
+    for (std::uint32_t i = 0; i < parent.size(); ++i) parent[i] = i;
+    for (const Contact& c : found) {
+        std::uint32_t ra = findRoot(c.a), rb = findRoot(c.b);
+        if (ra != rb) parent[std::max(ra, rb)] = std::min(ra, rb);
+    }
+
+    islandOf.assign(bodies.size(), 0);
+    for (const Contact& c : found) {
+        std::uint32_t root = findRoot(c.a);
+        if (islandOf[root] == 0) {
+            islandStart.push_back(0);
+            islandOf[root] = static_cast<std::uint32_t>(islandStart.size());
+        }
+        ++islandStart[islandOf[root] - 1];
+    }
+    std::uint32_t offset = 0;
+    for (std::uint32_t& start : islandStart) {
+        std::uint32_t count = start;
+        start = offset;
+        offset += count;
+    }
+    islandStart.push_back(offset);
+
+    contacts.resize(found.size());
+    for (const Contact& c : found) {
+        std::uint32_t island = islandOf[findRoot(c.a)] - 1;
+        contacts[islandStart[island]++] = c;
+    }
+    // The placement loop advanced each start to the next island's; shift them back
+    for (std::size_t i = islandStart.size() - 1; i > 0; --i) islandStart[i] = islandStart[i - 1];
+    islandStart[0] = 0;
+}
+
+std::uint32_t RockSolver::findRoot(std::uint32_t body) {
+    while (parent[body] != body) {
+        parent[body] = parent[parent[body]]; // Path halving
+        body = parent[body];
+    }
+    return body;
+}
+
+void RockSolver::runIslands() {
+    std::size_t islands = islandStart.size() - 1;
+    for (;;) {
+        std::size_t first = nextIsland.fetch_add(ISLANDS_PER_CHUNK, std::memory_order_relaxed);
+        if (first >= islands) return;
+        std::size_t last = std::min(islands, first + ISLANDS_PER_CHUNK);
+        for (std::size_t i = first; i < last; ++i) solveIsland(i);
+    }
+}
+
+void RockSolver::solveIsland(std::size_t island) {
+    Contact* begin = contacts.data() + islandStart[island];
+    Contact* end = contacts.data() + islandStart[island + 1];
+
+    for (int pass = 0; pass < VELOCITY_PASSES; ++pass) {
+        for (Contact* c = begin; c != end; ++c) {
+            Body& A = bodies[c->a];
+            Body& B = bodies[c->b];
+            float closing = dot(B.vel - A.vel, c->normal);
+            float change = (c->bounce - closing) / (A.invMass + B.invMass);
+            float total = std::max(0.f, c->impulse + change); // Contacts push, never pull
+            change = total - c->impulse;
+            c->impulse = total;
+            A.vel -= c->normal * (change * A.invMass);
+            B.vel += c->normal * (change * B.invMass);
+        }
+    }
+
+    for (Contact* c = begin; c != end; ++c) {
+        Body& A = bodies[c->a];
+        Body& B = bodies[c->b];
+        sf::Vector2f d = B.pos - A.pos;
+        float overlap = A.radius + B.radius - dot(d, c->normal);
+        if (overlap <= SLOP) continue;
+        float push = (overlap - SLOP) * CORRECTION / (A.invMass + B.invMass);
+        A.pos -= c->normal * (push * A.invMass);
+        B.pos += c->normal * (push * B.invMass);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef ROCKSOLVER_H
+#define ROCKSOLVER_H
+
+#include "SpatialGrid.h"
+#include "WorkerPool.h"
+#include <SFML/System.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Elastic circle-circle contacts between rocks. Each tick the owner adds every body, solve() finds
+// the overlapping pairs on a uniform grid, groups them into islands (bodies linked by contacts) and
+// solves each island on its own: a few sequential-impulse passes towards the bounce velocity,
+// then one pass pushing overlaps apart. Islands share no bodies, so a small worker pool takes
+// them in chunks with no locking. Within an island contacts are always handled in the order they
+// were found, so the result does not depend on how many threads there are or which one ran what:
+// replays match on any machine.
+//
+// Velocities are in px per tick. Nothing is allocated once reserve() has sized the arrays;
+// contacts past the reserved capacity are ignored (and counted).
+class RockSolver {
+public:
+    struct Body {
+        sf::Vector2f pos;
+        sf::Vector2f vel;
+        float radius;
+        float invMass; // 0 = immovable
+    };
+
+    struct Stats {
+        std::size_t bodies;
+        std::size_t contacts;
+        std::size_t islands;
+        std::size_t largestIsland; // Contacts in the biggest island
+        std::uint64_t dropped;     // Contacts ignored because the arrays were full (all time)
+    };
+
+    RockSolver();
+
+    RockSolver(const RockSolver&) = delete;
+    RockSolver& operator=(const RockSolver&) = delete;
+
+    void configure(float width, float height, float cellSize); // The area bodies move in
+    void reserve(std::size_t bodies, std::size_t contacts);
+    void setWorkers(int count); // Threads besides the caller's (0 = solve on the caller's). Setup only
+    int workerCount() const { return pool.size(); }
+
+    void clear();
+    std::uint32_t add(sf::Vector2f pos, sf::Vector2f vel, float radius, float mass);
+    void solve();
+
+    std::size_t size() const { return bodies.size(); }
+    const Body& body(std::uint32_t i) const { return bodies[i]; }
+    const Stats& stats() const { return lastStats; }
+
+private:
+    struct Contact {
+        std::uint32_t a, b;
+        sf::Vector2f normal; // From a to b
+        float bounce;        // Normal speed the pair should separate at
+        float impulse;       // Accumulated this tick (never negative)
+    };
+
+    void findContacts();
+    void buildIslands();
+    std::uint32_t findRoot(std::uint32_t body);
+    void runIslands();  // Takes chunks of islands until none are left (every thread)
+    void solveIsland(std::size_t island);
+
+    SpatialGrid grid;
+    std::vector<Body> bodies;
+    std::vector<Contact> found;       // In the order the grid reported them
+    std::vector<Contact> contacts;    // Grouped by island, in found order within each
+    std::vector<std::uint32_t> parent;       // Union-find over bodies
+    std::vector<std::uint32_t> islandOf;     // Per root body: island index + 1 (0 = none yet)
+    std::vector<std::uint32_t> islandStart;  // Per island: first contact; one extra at the end
+    std::size_t contactCapacity;
+    Stats lastStats;
+
+    std::atomic<std::size_t> nextIsland; // Every thread of the pool (the caller too) drains it
+    WorkerPool pool;
+};
+
+#endif // ROCKSOLVER_H
@@ -0,0 +1,58 @@
+#ifndef SERVERPACKET_H
+#define SERVERPACKET_H
+
+#include "BitStream.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Datagrams between the session server and its clients (see SessionServer). Each one starts with
+// this fixed 16-byte header.
+//   Snapshot (server -> client): followed by a SnapshotCodec encoding of the session's world, either
+//     a keyframe (baseTick == tick) or a delta against the keyframe sent at baseTick. Keyframes come
+//     regularly, so a client that lost one only waits for the next.
+//   Input (client -> server): the controls the client wants from now on (PlayerInput bits). The first
+//     one takes the session over from the server's bot and subscribes the sender to its snapshots.
+//   Watch (client -> server): subscribes the sender to the session's snapshots without playing it.
+// The server sends each session's snapshots to the last address it heard from about that session.
+struct ServerPacket {
+    enum class Kind : std::uint8_t { Snapshot = 1, Input = 2, Watch = 3 };
+    static const std::uint32_t MAGIC = 0x56525341; // "ASRV"
+    static const std::size_t HEADER_SIZE = 16;
+
+    Kind kind = Kind::Snapshot;
+    std::uint16_t session = 0;
+    std::uint8_t input = 0;     // Input: PlayerInput::toBits()
+    std::uint32_t tick = 0;     // Snapshot: server tick of the world. Input: last tick the client saw
+    std::uint32_t baseTick = 0; // Snapshot: tick of the keyframe a delta applies to
+
+    bool keyframe() const { return baseTick == tick; }
+
+    // Appends the header to 'out' (the payload, if any, goes right after it)
+    void write(std::vector<std::uint8_t>& out) const {
+        BitWriter w(out);
+        w.write(MAGIC, 32);
+        w.write(static_cast<std::uint8_t>(kind), 8);
+        w.write(input, 8);
+        w.write(session, 16);
+        w.write(tick, 32);
+        w.write(baseTick, 32);
+    }
+
+    // False for anything too short or not from this protocol
+    bool read(const std::uint8_t* data, std::size_t size) {
+        if (size < HEADER_SIZE) return false;
+        BitReader r(data, HEADER_SIZE);
+        if (r.read(32) != MAGIC) return false;
+        std::uint64_t k = r.read(8);
+        if (k < static_cast<std::uint8_t>(Kind::Snapshot) || k > static_cast<std::uint8_t>(Kind::Watch)) return false;
+        kind = static_cast<Kind>(k);
+        input = static_cast<std::uint8_t>(r.read(8));
+        session = static_cast<std::uint16_t>(r.read(16));
+        tick = static_cast<std::uint32_t>(r.read(32));
+        baseTick = static_cast<std::uint32_t>(r.read(32));
+        return r.ok();
+    }
+};
+
+#endif // SERVERPACKET_H
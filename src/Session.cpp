@@ -0,0 +1,109 @@
+#include "Session.h"
+#include "Entity.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+    // The last two characters are the format version: 01 had no swarm target, 02 no gravity settings
+    const char SESSION_MAGIC[8] = { 'A', 'S', 'T', 'S', 'E', 'S', '0', '3' };
+    const std::size_t MAGIC_PREFIX = 6;
+
+    // Fixed little-endian layout so sessions move between machines and builds
+    template <typename T>
+    void writeLE(std::ofstream& out, T value) {
+        char bytes[sizeof(T)];
+        for (std::size_t i = 0; i < sizeof(T); ++i) bytes[i] = static_cast<char>((static_cast<std::uint64_t>(value) >> (8 * i)) & 0xFF);
+        out.write(bytes, sizeof(T));
+    }
+
+    template <typename T>
+    bool readLE(std::ifstream& in, T& value) {
+        unsigned char bytes[sizeof(T)];
+        if (!in.read(reinterpret_cast<char*>(bytes), sizeof(T))) return false;
+        std::uint64_t v = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) v |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+        value = static_cast<T>(v);
+        return true;
+    }
+}
+
+// --- SessionWriter ---
+void SessionWriter::open(const std::string& path, const SessionHeader& header) {
+    close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create session file: " + path);
+    }
+    file.write(SESSION_MAGIC, sizeof(SESSION_MAGIC));
+    writeLE(file, header.seed);
+    writeLE(file, header.mode);
+    writeLE(file, header.ship);
+    writeLE(file, header.swarmTarget);
+    writeLE(file, header.gravity);
+    writeLE(file, header.gravityTheta);
+}
+
+void SessionWriter::write(const SessionTick& tick) {
+    if (!file.is_open()) return;
+    writeLE(file, tick.input);
+    writeLE(file, tick.checksum);
+}
+
+void SessionWriter::close() {
+    if (file.is_open()) file.close();
+}
+
+// --- SessionReader ---
+SessionReader::SessionReader(const std::string& path) : file(path, std::ios::binary) {
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open session file: " + path);
+    }
+    char magic[sizeof(SESSION_MAGIC)];
+    if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + MAGIC_PREFIX, SESSION_MAGIC) ||
+        magic[6] != '0' || magic[7] < '1' || magic[7] > '3' ||
+        !readLE(file, head.seed) || !readLE(file, head.mode) || !readLE(file, head.ship) ||
+        (magic[7] >= '2' && !readLE(file, head.swarmTarget)) ||
+        (magic[7] >= '3' && (!readLE(file, head.gravity) || !readLE(file, head.gravityTheta)))) {
+        throw std::runtime_error("Not a session file: " + path);
+    }
+}
+
+bool SessionReader::next(SessionTick& tick) {
+    return readLE(file, tick.input) && readLE(file, tick.checksum);
+}
+
+// --- SessionTrace ---
+void SessionTrace::open(const std::string& path) {
+    file.open(path, std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create trace file: " + path);
+    }
+}
+
+void SessionTrace::beginTick(std::uint64_t tick) {
+    int n = std::snprintf(line, sizeof(line), "tick %llu\n", static_cast<unsigned long long>(tick));
+    file.write(line, n);
+}
+
+void SessionTrace::endTick(std::uint64_t checksum) {
+    int n = std::snprintf(line, sizeof(line), "  checksum %016llx\n", static_cast<unsigned long long>(checksum));
+    file.write(line, n);
+}
+
+void SessionTrace::globals(std::uint64_t simTick, std::uint64_t playTick, std::uint64_t respawnTick, int level, std::size_t timers) {
+    int n = std::snprintf(line, sizeof(line), "  world simTick=%llu playTick=%llu respawnTick=%llu level=%d timers=%zu\n",
+                          static_cast<unsigned long long>(simTick), static_cast<unsigned long long>(playTick),
+                          static_cast<unsigned long long>(respawnTick), level, timers);
+    file.write(line, n);
+}
+
+// Floats are printed with enough digits to round-trip, so a diff shows the real difference
+void SessionTrace::entity(std::size_t index, SlotHandle handle, const Entity& e, std::uint64_t hash) {
+    int n = std::snprintf(line, sizeof(line),
+                          "  entity %zu handle=%u:%u type=%s hash=%016llx life=%d pos=%.9g,%.9g vel=%.9g,%.9g R=%.9g angle=%.9g\n",
+                          index, handle.index, handle.generation, e.name, static_cast<unsigned long long>(hash), e.life ? 1 : 0,
+                          e.pos.x, e.pos.y, e.velocity.x, e.velocity.y, e.R, e.angle);
+    if (n > static_cast<int>(sizeof(line)) - 1) n = static_cast<int>(sizeof(line)) - 1;
+    file.write(line, n);
+}
@@ -0,0 +1,69 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "SlotMap.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+class Entity;
+
+// A recorded run: the seed and start settings, then one record per Playing tick holding the
+// player input used for that tick and the world checksum after it. Replaying the inputs on the
+// same seed must reproduce every checksum, so the first mismatch is where two builds diverge.
+struct SessionHeader {
+    std::uint32_t seed = 0;
+    std::uint8_t mode = 0; // Game::PlayMode
+    std::uint8_t ship = 0; // Player::ShipType
+    std::uint32_t swarmTarget = 0; // Swarm Survival asteroid target (version 2; 0 in older sessions)
+    std::uint8_t gravity = 0;        // GameOptions::GravityMode (version 3; older sessions had none: Off)
+    std::uint16_t gravityTheta = 0;  // Barnes-Hut opening angle in thousandths (version 3)
+};
+
+struct SessionTick {
+    std::uint8_t input = 0;     // PlayerInput bits
+    std::uint64_t checksum = 0;
+};
+
+class SessionWriter {
+public:
+    void open(const std::string& path, const SessionHeader& header); // Throws if the file can't be created
+    void write(const SessionTick& tick);
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+private:
+    std::ofstream file;
+};
+
+class SessionReader {
+public:
+    explicit SessionReader(const std::string& path); // Throws if missing or not a session file
+
+    const SessionHeader& header() const { return head; }
+    bool next(SessionTick& tick); // false at end of file
+
+private:
+    std::ifstream file;
+    SessionHeader head;
+};
+
+// Human-readable per-tick dump of the world (one line per entity with its own hash and raw fields).
+// Two traces of the same session are compared by the divergence_finder tool to name the first
+// tick and entity that differ.
+class SessionTrace {
+public:
+    void open(const std::string& path); // Throws if the file can't be created
+    bool isOpen() const { return file.is_open(); }
+
+    void beginTick(std::uint64_t tick);
+    void globals(std::uint64_t simTick, std::uint64_t playTick, std::uint64_t respawnTick, int level, std::size_t timers);
+    void entity(std::size_t index, SlotHandle handle, const Entity& e, std::uint64_t hash);
+    void endTick(std::uint64_t checksum);
+
+private:
+    std::ofstream file;
+    char line[512];
+};
+
+#endif // SESSION_H
@@ -0,0 +1,407 @@
+#include "SessionServer.h"
+#include "Logger.h"
+#include "ServerPacket.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <stdexcept>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+const int SessionServer::TICK_RATE;
+const int SessionServer::MAX_CATCH_UP;
+const int SessionServer::KEYFRAME_INTERVAL;
+const int SessionServer::MAX_SESSIONS;
+
+namespace {
+    const double REPORT_INTERVAL = 5.0;   // Seconds between progress lines
+    const double WARM_SECONDS = 5.0;      // Memory is sampled again once the worlds have filled up
+    const std::size_t INPUT_BUFFER = 64;  // Client datagrams are a header and nothing else
+    const std::size_t WORLD_RESERVE = 1024; // Entity records per capture, like the game's entity reserve
+
+    double millis(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+}
+
+SessionServer::SessionServer(const ServerOptions& serverOptions) :
+    options(serverOptions),
+    period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / TICK_RATE))),
+    stopping(false),
+    finishedCount(0),
+    ticksDone(0),
+    missedDone(0),
+    bytesSent(0),
+    inputsReceived(0),
+    inputsRejected(0),
+    lastTicks(0),
+    lastBytes(0),
+    memoryBefore(0),
+    memoryShared(0),
+    memoryLoaded(0),
+    memoryWarm(0)
+{
+    options.sessions = std::max(1, std::min(MAX_SESSIONS, options.sessions));
+    options.snapshotInterval = std::max(1, options.snapshotInterval);
+    if (options.workers < 0) options.workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    options.workers = std::max(1, options.workers);
+    if (options.mode == Game::PlayMode::Swarm) throw std::runtime_error("Swarm worlds are too large to host as sessions");
+
+    // Worlds run on the pool, one tick at a time: no threads, files or history of their own
+    GameOptions& game = options.game;
+    game.headless = true;
+    game.rockThreads = 0;
+    game.gravityThreads = 0;
+    game.rewindBudget = 0;
+    game.inputThread = false;
+    game.recordPath.clear();
+    game.replayPath.clear();
+    game.tracePath.clear();
+    game.latencyPath.clear();
+    if (!game.fixedSeed) game.seed = static_cast<std::uint32_t>(std::time(nullptr));
+
+    if (inputSocket.bind(options.port) != sf::Socket::Done) {
+        throw std::runtime_error("Could not bind UDP port " + std::to_string(options.port));
+    }
+    inputSocket.setBlocking(false);
+}
+
+SessionServer::~SessionServer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::unique_ptr<Worker>& worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+// Worlds are built on this thread, one after the other: loading shares the resource cache
+void SessionServer::createSessions() {
+    memoryBefore = residentBytes();
+    sessions.reserve(static_cast<std::size_t>(options.sessions));
+    for (int i = 0; i < options.sessions; ++i) {
+        std::unique_ptr<Session> session(new Session());
+        session->id = static_cast<std::uint16_t>(i);
+        session->seed = options.game.seed + static_cast<std::uint32_t>(i);
+        session->ticks = 0;
+        session->client.store(0, std::memory_order_relaxed);
+        session->controlled.store(false, std::memory_order_relaxed);
+        session->input.store(0, std::memory_order_relaxed);
+        session->keyframeTick = 0;
+        session->keyframeClient = 0;
+        session->snapshotsSinceKeyframe = KEYFRAME_INTERVAL; // The first snapshot is a keyframe
+        session->finished = false;
+        session->game.reset(new Game(options.game));
+        session->game->startHeadless(options.mode, session->seed);
+        sessions.push_back(std::move(session));
+        if (i == 0) {
+            memoryShared = residentBytes();
+            // Every world logs its loading and levels like the game does; one is enough to read
+            for (LogCategory category : { LogCategory::Game, LogCategory::Resource, LogCategory::Player,
+                                          LogCategory::Boss, LogCategory::Entity }) {
+                Logger::getInstance().setMinLevel(category, LogLevel::Warning);
+            }
+        }
+    }
+    memoryLoaded = residentBytes();
+}
+
+int SessionServer::run() {
+    LOG_INFO(LogCategory::General, "Server: creating %d %s sessions (UDP port %d)...", options.sessions,
+             options.mode == Game::PlayMode::Campaign ? "campaign" : "survival", options.port);
+    createSessions();
+
+    workers.reserve(static_cast<std::size_t>(options.workers));
+    for (int i = 0; i < options.workers; ++i) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->world.entities.reserve(WORLD_RESERVE);
+        worker->codec.reserve(WORLD_RESERVE);
+        worker->packet.reserve(sf::UdpSocket::MaxDatagramSize);
+        workers.push_back(std::move(worker));
+    }
+
+    // First releases spread evenly over one period
+    Clock::time_point start = Clock::now();
+    ready.reserve(sessions.size());
+    for (std::size_t i = 0; i < sessions.size(); ++i) {
+        sessions[i]->release = start + period * static_cast<Clock::rep>(i) / static_cast<Clock::rep>(sessions.size());
+        ready.push_back(Ready{ sessions[i]->release, static_cast<std::uint32_t>(i) });
+    }
+    std::make_heap(ready.begin(), ready.end(), std::greater<Ready>());
+    for (std::unique_ptr<Worker>& worker : workers) {
+        worker->thread = std::thread(&SessionServer::workerLoop, this, std::ref(*worker));
+    }
+    LOG_INFO(LogCategory::General, "Server: %d sessions on %d workers, %d ticks per second, a snapshot every %d ticks",
+             options.sessions, options.workers, TICK_RATE, options.snapshotInterval);
+
+    double elapsed = 0.0;
+    double nextReport = REPORT_INTERVAL;
+    for (;;) {
+        pollInput();
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (memoryWarm == 0 && elapsed >= WARM_SECONDS) memoryWarm = residentBytes();
+        if (elapsed >= nextReport) {
+            logProgress(elapsed);
+            nextReport += REPORT_INTERVAL;
+        }
+        if (options.ticks > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (finishedCount == sessions.size()) break;
+        } else if (elapsed >= options.seconds) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::unique_ptr<Worker>& worker : workers) worker->thread.join();
+    logReport(elapsed);
+    return 0;
+}
+
+// Earliest release first. A worker sleeps until the front of the heap is due; whoever pushes a new
+// front wakes one sleeper, since they may be waiting for a later release.
+void SessionServer::workerLoop(Worker& worker) {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        if (stopping) return;
+        if (ready.empty()) {
+            wake.wait(lock);
+            continue;
+        }
+        Clock::time_point release = ready.front().release;
+        if (Clock::now() < release) {
+            wake.wait_until(lock, release);
+            continue;
+        }
+        std::pop_heap(ready.begin(), ready.end(), std::greater<Ready>());
+        Session& session = *sessions[ready.back().session];
+        ready.pop_back();
+        lock.unlock();
+
+        runSession(session, worker);
+
+        lock.lock();
+        if (session.finished) {
+            ++finishedCount;
+            continue;
+        }
+        ready.push_back(Ready{ session.release, session.id });
+        std::push_heap(ready.begin(), ready.end(), std::greater<Ready>());
+        if (ready.front().session == session.id) wake.notify_one();
+    }
+}
+
+void SessionServer::runSession(Session& session, Worker& worker) {
+    WorkerStats& stats = worker.stats;
+    Clock::time_point now = Clock::now();
+    stats.lagMs.add(millis(now - session.release));
+
+    // This tick, and every later one whose release passed while the session waited
+    long long owed = 1 + static_cast<long long>((now - session.release) / period);
+    if (owed > MAX_CATCH_UP) {
+        stats.dropped += static_cast<std::uint64_t>(owed - MAX_CATCH_UP);
+        session.release += period * (owed - MAX_CATCH_UP);
+        owed = MAX_CATCH_UP;
+    }
+
+    std::uint64_t stepped = 0, missed = 0;
+    for (long long i = 0; i < owed && !session.finished; ++i) {
+        Clock::time_point tickStart = Clock::now();
+        PlayerInput input = session.controlled.load(std::memory_order_relaxed)
+            ? PlayerInput::fromBits(session.input.load(std::memory_order_relaxed))
+            : botInput(session);
+        if (!session.game->stepHeadless(input)) {
+            // Game over: the session plays on with a new run (and a new seed)
+            ++stats.runs;
+            stats.scoreSum += static_cast<std::uint64_t>(std::max(0, session.game->score()));
+            session.seed += static_cast<std::uint32_t>(options.sessions);
+            session.game->startHeadless(options.mode, session.seed);
+            session.snapshotsSinceKeyframe = KEYFRAME_INTERVAL; // Nothing of the old world is worth a delta
+        }
+        ++session.ticks;
+        if (session.ticks % static_cast<std::uint64_t>(options.snapshotInterval) == 0) sendSnapshot(session, worker);
+
+        Clock::time_point tickEnd = Clock::now();
+        session.release += period; // The next tick's release is this one's deadline
+        stats.tickMs.add(millis(tickEnd - tickStart));
+        stats.busySeconds += std::chrono::duration<double>(tickEnd - tickStart).count();
+        if (tickEnd > session.release) ++missed;
+        ++stepped;
+        if (options.ticks > 0 && session.ticks >= options.ticks) session.finished = true;
+    }
+    stats.ticks += stepped;
+    stats.missed += missed;
+    ticksDone.fetch_add(stepped, std::memory_order_relaxed);
+    missedDone.fetch_add(missed, std::memory_order_relaxed);
+}
+
+void SessionServer::sendSnapshot(Session& session, Worker& worker) {
+    WorkerStats& stats = worker.stats;
+    session.game->captureWorld(worker.world);
+    worker.world.rngState = 0; // Clients must not be able to predict spawns and drops
+
+    ServerPacket header;
+    header.kind = ServerPacket::Kind::Snapshot;
+    header.session = session.id;
+    header.tick = static_cast<std::uint32_t>(session.ticks);
+    // A new subscriber gets a keyframe right away instead of deltas it cannot decode yet
+    std::uint64_t client = session.client.load(std::memory_order_relaxed);
+    bool keyframe = session.snapshotsSinceKeyframe >= KEYFRAME_INTERVAL || client != session.keyframeClient;
+    session.keyframeClient = client;
+    header.baseTick = keyframe ? header.tick : session.keyframeTick;
+    worker.packet.clear();
+    header.write(worker.packet);
+    worker.codec.encode(worker.world, keyframe ? nullptr : &session.keyframe, worker.packet);
+
+    ++stats.snapshots;
+    if (keyframe) {
+        ++stats.keyframes;
+        stats.keyframeBytes += worker.packet.size();
+        std::swap(session.keyframe, worker.world); // The capture becomes the base; its old storage the scratch
+        session.keyframeTick = header.tick;
+        session.snapshotsSinceKeyframe = 1;
+    } else {
+        stats.deltaBytes += worker.packet.size();
+        ++session.snapshotsSinceKeyframe;
+    }
+
+    if (worker.packet.size() > sf::UdpSocket::MaxDatagramSize) {
+        ++stats.oversize;
+        return;
+    }
+    // Sessions nobody subscribed to are still captured and encoded: that is part of their cost
+    if (client == 0) return;
+    sf::IpAddress address(static_cast<sf::Uint32>(client >> 16));
+    unsigned short port = static_cast<unsigned short>(client & 0xFFFF);
+    if (worker.socket.send(worker.packet.data(), worker.packet.size(), address, port) != sf::Socket::Done) {
+        ++stats.sendErrors;
+        return;
+    }
+    bytesSent.fetch_add(worker.packet.size(), std::memory_order_relaxed);
+}
+
+// Stand-in for a player on sessions no client controls: sweeps its aim back and forth, thrusts in
+// short bursts and keeps firing, so the world stays as busy as a played one (shots, splits,
+// pickups, deaths). Derived from the tick only, so it never touches the world's Random state.
+PlayerInput SessionServer::botInput(const Session& session) const {
+    std::uint64_t t = session.ticks + session.id * 37u; // Sessions out of step with each other
+    PlayerInput in;
+    in.left = (t / 45) % 4 == 0;
+    in.right = (t / 45) % 4 == 2;
+    in.thrust = t % 150 < 12;
+    in.fire = t % 6 == 0;
+    return in;
+}
+
+void SessionServer::pollInput() {
+    std::uint8_t buffer[INPUT_BUFFER];
+    std::size_t received = 0;
+    sf::IpAddress address;
+    unsigned short port = 0;
+    while (inputSocket.receive(buffer, sizeof(buffer), received, address, port) == sf::Socket::Done) {
+        ServerPacket packet;
+        if (!packet.read(buffer, received) || packet.kind == ServerPacket::Kind::Snapshot || packet.session >= sessions.size()) {
+            ++inputsRejected;
+            continue;
+        }
+        ++inputsReceived;
+        Session& session = *sessions[packet.session];
+        session.client.store(static_cast<std::uint64_t>(address.toInteger()) << 16 | port, std::memory_order_relaxed);
+        if (packet.kind == ServerPacket::Kind::Input) {
+            session.input.store(packet.input, std::memory_order_relaxed);
+            session.controlled.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+void SessionServer::logProgress(double elapsed) {
+    std::uint64_t ticks = ticksDone.load(std::memory_order_relaxed);
+    std::uint64_t bytes = bytesSent.load(std::memory_order_relaxed);
+    LOG_INFO(LogCategory::General, "Server: %.0f s, %d ticks/s (%d expected), %d deadlines missed so far, %d KB/s sent, %d KB resident",
+             elapsed, static_cast<std::uint64_t>((ticks - lastTicks) / REPORT_INTERVAL), options.sessions * TICK_RATE,
+             missedDone.load(std::memory_order_relaxed), static_cast<std::uint64_t>((bytes - lastBytes) / 1024 / REPORT_INTERVAL),
+             residentBytes() / 1024);
+    lastTicks = ticks;
+    lastBytes = bytes;
+}
+
+void SessionServer::logReport(double elapsed) {
+    WorkerStats total;
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        const WorkerStats& s = worker->stats;
+        total.tickMs.merge(s.tickMs);
+        total.lagMs.merge(s.lagMs);
+        total.ticks += s.ticks;
+        total.missed += s.missed;
+        total.dropped += s.dropped;
+        total.runs += s.runs;
+        total.scoreSum += s.scoreSum;
+        total.snapshots += s.snapshots;
+        total.keyframes += s.keyframes;
+        total.keyframeBytes += s.keyframeBytes;
+        total.deltaBytes += s.deltaBytes;
+        total.oversize += s.oversize;
+        total.sendErrors += s.sendErrors;
+        total.busySeconds += s.busySeconds;
+    }
+    std::uint64_t digest = 0; // Same seed and tick budget, same digest: on any number of workers
+    std::size_t controlled = 0, watched = 0;
+    for (const std::unique_ptr<Session>& session : sessions) {
+        digest = digest * 1099511628211ull ^ session->game->worldHash();
+        if (session->controlled.load(std::memory_order_relaxed)) ++controlled;
+        else if (session->client.load(std::memory_order_relaxed) != 0) ++watched;
+    }
+
+    LOG_INFO(LogCategory::General, "Server: %d sessions on %d workers for %.1f s: %d ticks, %d runs ended (mean score %d)",
+             sessions.size(), workers.size(), elapsed, total.ticks, total.runs,
+             total.runs ? total.scoreSum / total.runs : 0);
+    LOG_INFO(LogCategory::General, "Tick cost (step and snapshot): mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.2f ms",
+             total.tickMs.mean(), total.tickMs.percentile(0.50), total.tickMs.percentile(0.99), total.tickMs.max());
+    LOG_INFO(LogCategory::General, "Deadlines: %d missed (%.2f%%), start lag p50 %.2f ms, p99 %.2f ms, %d ticks dropped behind real time",
+             total.missed, total.ticks ? 100.0 * total.missed / total.ticks : 0.0,
+             total.lagMs.percentile(0.50), total.lagMs.percentile(0.99), total.dropped);
+    double perCoreMean = total.tickMs.mean() > 0.0 ? 1000.0 / (TICK_RATE * total.tickMs.mean()) : 0.0;
+    double perCoreP99 = total.tickMs.percentile(0.99) > 0.0 ? 1000.0 / (TICK_RATE * total.tickMs.percentile(0.99)) : 0.0;
+    double busy = elapsed > 0.0 ? 100.0 * total.busySeconds / (elapsed * workers.size()) : 0.0;
+    LOG_INFO(LogCategory::General, "Capacity: %.0f sessions per core at %d Hz (mean cost), %.0f at the p99 cost; this run %.1f per worker, %.0f%% busy",
+             perCoreMean, TICK_RATE, perCoreP99, static_cast<double>(sessions.size()) / workers.size(), busy);
+    LOG_INFO(LogCategory::General, "Snapshots: %d (%d keyframes), keyframe %d B mean, delta %d B mean, %d KB sent",
+             total.snapshots, total.keyframes, total.keyframes ? total.keyframeBytes / total.keyframes : 0,
+             total.snapshots > total.keyframes ? total.deltaBytes / (total.snapshots - total.keyframes) : 0,
+             bytesSent.load() / 1024);
+    LOG_INFO(LogCategory::General, "Clients: %d sessions played, %d watched, %d datagrams in (%d rejected), %d oversize snapshots, %d send errors",
+             controlled, watched, inputsReceived, inputsRejected, total.oversize, total.sendErrors);
+    std::size_t memoryEnd = residentBytes();
+    if (memoryEnd > 0 && sessions.size() > 1) {
+        LOG_INFO(LogCategory::General, "Memory: %d KB before, %d KB for the first world (shared resources), %d KB per further world",
+                 memoryBefore / 1024, (memoryShared - memoryBefore) / 1024, (memoryLoaded - memoryShared) / 1024 / (sessions.size() - 1));
+        long long growth = memoryWarm > 0 ? static_cast<long long>(memoryEnd) - static_cast<long long>(memoryWarm) : 0;
+        LOG_INFO(LogCategory::General, "Memory: %d KB resident at the end, %d KB per session, %d KB of growth since warm-up",
+                 memoryEnd / 1024, (memoryEnd - memoryBefore) / 1024 / sessions.size(), growth / 1024);
+    }
+    LOG_INFO(LogCategory::General, "World digest %016x", digest);
+    Logger::getInstance().flush();
+}
+
+// Resident set size, from /proc on Linux
+std::size_t SessionServer::residentBytes() {
+#ifdef __linux__
+    std::FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    unsigned long pages = 0, resident = 0;
+    int fields = std::fscanf(file, "%lu %lu", &pages, &resident);
+    std::fclose(file);
+    return fields == 2 ? static_cast<std::size_t>(resident) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
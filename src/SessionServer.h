@@ -0,0 +1,151 @@
+#ifndef SESSIONSERVER_H
+#define SESSIONSERVER_H
+
+#include "Game.h"
+#include "Histogram.h"
+#include "Snapshot.h"
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Command-line options of server mode (parsed in main.cpp)
+struct ServerOptions {
+    int sessions = 0;          // --server N: headless worlds hosted by this process (0 = play normally)
+    int workers = -1;          // --server-workers: threads stepping them (-1 = one per core)
+    Game::PlayMode mode = Game::PlayMode::Survival; // --server-mode: survival or campaign
+    double seconds = 30.0;     // --server-seconds: how long to serve before the report
+    std::uint64_t ticks = 0;   // --server-ticks: stop every session after this many ticks instead
+    unsigned short port = 47000;  // --server-port: UDP port clients send their input to
+    int snapshotInterval = 2;  // --snapshot-every: ticks between snapshots (2 = 30 per second)
+    GameOptions game;          // Seed and gravity settings shared by every world
+};
+
+// Hosts many independent headless Game worlds in one process, for tournaments and bot leagues.
+//
+// Every session owes one tick per 1/60 s. Its ticks are released on a fixed schedule (staggered
+// across the period so the sessions do not all wake at once) and each must be done before the next
+// is released: that is its deadline. A worker pool steps the sessions earliest release first; a
+// session found late steps the ticks it owes back to back, up to MAX_CATCH_UP, and past that the
+// schedule slips (those ticks are counted as dropped: the world runs slower than real time, it never
+// skips simulation). A session runs on one worker at a time, and its Random state and entity
+// blocks (an EntityPool::Arena per world) travel with it.
+//
+// Snapshots stream over UDP to the client that last sent input for the session, or asked to watch
+// it (see ServerPacket): every snapshotInterval ticks, a delta against the session's last keyframe,
+// a keyframe every KEYFRAME_INTERVAL snapshots and whenever the subscriber changes. Sessions nobody
+// plays are played by a bot.
+//
+// Memory per session is bounded: the worlds keep their entity caps and reserved arrays (no rewind,
+// audio, UI or particles), a session keeps only its last keyframe, and the capture/encode scratch
+// belongs to the workers. The report measures it, with the deadline statistics and the tick cost
+// that give the sessions one core can carry at 60 Hz.
+class SessionServer {
+public:
+    static const int TICK_RATE = 60;         // Like the game's fixed step
+    static const int MAX_CATCH_UP = 4;       // Ticks a late session may step in one turn
+    static const int KEYFRAME_INTERVAL = 30; // Snapshots between keyframes
+    static const int MAX_SESSIONS = 65535;   // Session ids are 16-bit on the wire
+
+    explicit SessionServer(const ServerOptions& options);
+    ~SessionServer();
+
+    int run(); // Serves until the time or tick budget runs out, then logs the report
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Session {
+        std::unique_ptr<Game> game;
+        std::uint16_t id;
+        std::uint32_t seed;
+        std::uint64_t ticks;          // Ticks stepped, story and transition screens included
+        Clock::time_point release;    // When the next tick is due (its deadline is one period later)
+        std::atomic<std::uint64_t> client;  // IPv4 << 16 | port snapshots go to (0 = nobody)
+        std::atomic<bool> controlled;       // A client sends the input (else the bot plays)
+        std::atomic<std::uint8_t> input;    // Its latest controls
+        WorldSnapshot keyframe;       // Base of the deltas
+        std::uint32_t keyframeTick;
+        std::uint64_t keyframeClient; // Subscriber when it was sent (a new one gets a keyframe at once)
+        int snapshotsSinceKeyframe;
+        bool finished;                // Reached options.ticks
+    };
+
+    // What a worker measured; merged for the report, so workers never share counters
+    struct WorkerStats {
+        Histogram tickMs{0.001};      // Step + snapshot time per tick (tens of us: 1 us buckets)
+        Histogram lagMs{0.01};        // How long after its release a tick started (10 us buckets)
+        std::uint64_t ticks = 0;
+        std::uint64_t missed = 0;     // Ticks finished after their deadline
+        std::uint64_t dropped = 0;    // Ticks the schedule slipped by (see MAX_CATCH_UP)
+        std::uint64_t runs = 0;       // Runs that ended (game over) and were restarted
+        std::uint64_t scoreSum = 0;
+        std::uint64_t snapshots = 0;
+        std::uint64_t keyframes = 0;
+        std::uint64_t keyframeBytes = 0;
+        std::uint64_t deltaBytes = 0;
+        std::uint64_t oversize = 0;   // Snapshots too large for one datagram (not sent)
+        std::uint64_t sendErrors = 0;
+        double busySeconds = 0.0;
+    };
+
+    struct Worker {
+        std::thread thread;
+        WorkerStats stats;
+        WorldSnapshot world;          // Capture scratch
+        SnapshotCodec codec;
+        std::vector<std::uint8_t> packet;
+        sf::UdpSocket socket;
+    };
+
+    // Release-ordered heap entry
+    struct Ready {
+        Clock::time_point release;
+        std::uint32_t session;
+        bool operator>(const Ready& other) const { return release > other.release; }
+    };
+
+    void createSessions();
+    void workerLoop(Worker& worker);
+    void runSession(Session& session, Worker& worker); // The ticks it owes, then back in the heap
+    void sendSnapshot(Session& session, Worker& worker);
+    PlayerInput botInput(const Session& session) const;
+    void pollInput();
+    void logProgress(double elapsed);
+    void logReport(double elapsed);
+    static std::size_t residentBytes(); // 0 where the platform does not say
+
+    ServerOptions options;
+    Clock::duration period;
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::vector<std::unique_ptr<Worker>> workers;
+    sf::UdpSocket inputSocket;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Ready> ready; // Min-heap on release
+    bool stopping;
+    std::size_t finishedCount;
+
+    std::atomic<std::uint64_t> ticksDone;   // Progress lines only; the report uses WorkerStats
+    std::atomic<std::uint64_t> missedDone;
+    std::atomic<std::uint64_t> bytesSent;
+    std::uint64_t inputsReceived;
+    std::uint64_t inputsRejected;
+    std::uint64_t lastTicks;   // At the last progress line
+    std::uint64_t lastBytes;
+
+    std::size_t memoryBefore;  // Before any world existed
+    std::size_t memoryShared;  // After the first (the resource cache is loaded once)
+    std::size_t memoryLoaded;  // After all of them
+    std::size_t memoryWarm;    // Once every session has played a while
+};
+
+#endif // SESSIONSERVER_H
@@ -0,0 +1,131 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Generational handle into a SlotMap. A handle stays comparable after its element is removed,
+// but lookups through it fail (the slot's generation has moved on) instead of dangling.
+struct SlotHandle {
+    static const std::uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    std::uint32_t index = INVALID_INDEX;
+    std::uint32_t generation = 0;
+
+    bool isNull() const { return index == INVALID_INDEX; }
+    bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+// Slot map: elements live densely packed (cache-friendly iteration by index or range-for),
+// an indirection table maps stable handles to dense positions.
+// insert/remove/get are O(1); remove swaps the last element into the hole, so dense order is not stable.
+template <typename T>
+class SlotMap {
+public:
+    typedef SlotHandle Handle;
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    void reserve(std::size_t count) {
+        dense.reserve(count);
+        denseToSlot.reserve(count);
+        slots.reserve(count);
+    }
+
+    Handle insert(T value) {
+        std::uint32_t slotIndex;
+        if (freeHead != SlotHandle::INVALID_INDEX) {
+            slotIndex = freeHead;
+            freeHead = slots[slotIndex].link;
+        } else {
+            slotIndex = static_cast<std::uint32_t>(slots.size());
+            slots.push_back(Slot{0, 1});
+        }
+        slots[slotIndex].link = static_cast<std::uint32_t>(dense.size());
+        dense.push_back(std::move(value));
+        denseToSlot.push_back(slotIndex);
+
+        Handle handle;
+        handle.index = slotIndex;
+        handle.generation = slots[slotIndex].generation;
+        return handle;
+    }
+
+    bool contains(Handle handle) const {
+        return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+    }
+
+    T* get(Handle handle) { return contains(handle) ? &dense[slots[handle.index].link] : nullptr; }
+    const T* get(Handle handle) const { return contains(handle) ? &dense[slots[handle.index].link] : nullptr; }
+
+    bool remove(Handle handle) {
+        if (!contains(handle)) return false;
+        removeAt(slots[handle.index].link);
+        return true;
+    }
+
+    // Removes the element at a dense position; the last element moves into its place
+    void removeAt(std::size_t denseIndex) {
+        std::uint32_t slotIndex = denseToSlot[denseIndex];
+        std::size_t last = dense.size() - 1;
+        if (denseIndex != last) {
+            dense[denseIndex] = std::move(dense[last]);
+            denseToSlot[denseIndex] = denseToSlot[last];
+            slots[denseToSlot[denseIndex]].link = static_cast<std::uint32_t>(denseIndex);
+        }
+        dense.pop_back();
+        denseToSlot.pop_back();
+        releaseSlot(slotIndex);
+    }
+
+    // Dense position of a live handle's element (only valid until the next removal)
+    std::size_t indexOf(Handle handle) const { return slots[handle.index].link; }
+
+    // Handle of the element currently at a dense position
+    Handle handleAt(std::size_t denseIndex) const {
+        Handle handle;
+        handle.index = denseToSlot[denseIndex];
+        handle.generation = slots[handle.index].generation;
+        return handle;
+    }
+
+    // Removes everything; all outstanding handles become stale. Capacity is kept.
+    void clear() {
+        for (std::uint32_t slotIndex : denseToSlot) releaseSlot(slotIndex);
+        dense.clear();
+        denseToSlot.clear();
+    }
+
+    std::size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+    T& operator[](std::size_t denseIndex) { return dense[denseIndex]; }
+    const T& operator[](std::size_t denseIndex) const { return dense[denseIndex]; }
+
+    iterator begin() { return dense.begin(); }
+    iterator end() { return dense.end(); }
+    const_iterator begin() const { return dense.begin(); }
+    const_iterator end() const { return dense.end(); }
+
+private:
+    struct Slot {
+        std::uint32_t link;       // Dense index while occupied, next free slot while free
+        std::uint32_t generation; // Bumped on every removal
+    };
+
+    void releaseSlot(std::uint32_t slotIndex) {
+        Slot& slot = slots[slotIndex];
+        ++slot.generation;
+        slot.link = freeHead;
+        freeHead = slotIndex;
+    }
+
+    std::vector<T> dense;
+    std::vector<std::uint32_t> denseToSlot;
+    std::vector<Slot> slots;
+    std::uint32_t freeHead = SlotHandle::INVALID_INDEX;
+};
+
+#endif // SLOTMAP_H
@@ -0,0 +1,386 @@
+#include "Snapshot.h"
+#include "BitStream.h"
+#include <stdexcept>
+#include <string>
+
+namespace {
+    const std::uint32_t SNAPSHOT_MAGIC = 0x50414E53; // "SNAP"
+    const std::uint8_t FLAG_DELTA = 1;
+
+    // Change mask bits for entities delta coded against the base
+    enum ChangeBit {
+        CHANGED_LIFE, CHANGED_VARIANT, CHANGED_X, CHANGED_Y, CHANGED_VX, CHANGED_VY,
+        CHANGED_ANGLE, CHANGED_RADIUS, CHANGED_AGE, CHANGED_EXTRA, CHANGE_BITS
+    };
+
+    void writeFixed(BitWriter& out, std::int64_t value, int bits) {
+        const std::int64_t lo = -(std::int64_t(1) << (bits - 1));
+        const std::int64_t hi = (std::int64_t(1) << (bits - 1)) - 1;
+        if (value < lo) value = lo; // Clamp instead of wrapping far-off entities around
+        if (value > hi) value = hi;
+        out.write(static_cast<std::uint64_t>(value), bits);
+    }
+
+    std::int32_t readFixed(BitReader& in, int bits) {
+        std::uint64_t raw = in.read(bits);
+        std::uint64_t sign = std::uint64_t(1) << (bits - 1);
+        return static_cast<std::int32_t>(static_cast<std::int64_t>(raw ^ sign) - static_cast<std::int64_t>(sign));
+    }
+
+    // Entity ids index the codec's base lookup, so a corrupt one must not size it
+    std::uint32_t readId(BitReader& in) {
+        std::uint64_t id = in.readVar();
+        if (id > SnapshotCodec::MAX_ENTITY_ID) throw std::runtime_error("Snapshot: entity id out of range");
+        return static_cast<std::uint32_t>(id);
+    }
+
+    void writeFull(BitWriter& out, const EntityRecord& e) {
+        out.write(e.type, 4);
+        out.write(e.variant, 4);
+        out.writeBool(e.life);
+        writeFixed(out, e.x, SnapshotCodec::POS_BITS);
+        writeFixed(out, e.y, SnapshotCodec::POS_BITS);
+        writeFixed(out, e.vx, SnapshotCodec::VEL_BITS);
+        writeFixed(out, e.vy, SnapshotCodec::VEL_BITS);
+        out.write(e.angle, SnapshotCodec::ANGLE_BITS);
+        out.writeVar(e.radius);
+        out.writeVar(e.age);
+        out.write(e.extraCount, 3);
+        for (int i = 0; i < e.extraCount; ++i) out.writeSigned(e.extra[i]);
+    }
+
+    void readFull(BitReader& in, EntityRecord& e) {
+        e.type = static_cast<std::uint8_t>(in.read(4));
+        e.variant = static_cast<std::uint8_t>(in.read(4));
+        e.life = in.readBool();
+        e.x = readFixed(in, SnapshotCodec::POS_BITS);
+        e.y = readFixed(in, SnapshotCodec::POS_BITS);
+        e.vx = readFixed(in, SnapshotCodec::VEL_BITS);
+        e.vy = readFixed(in, SnapshotCodec::VEL_BITS);
+        e.angle = static_cast<std::uint16_t>(in.read(SnapshotCodec::ANGLE_BITS));
+        e.radius = static_cast<std::uint16_t>(in.readVar());
+        e.age = static_cast<std::uint32_t>(in.readVar());
+        e.extraCount = static_cast<std::uint8_t>(in.read(3));
+        if (e.extraCount > EntityRecord::MAX_EXTRA) throw std::runtime_error("Snapshot: bad entity field count");
+        for (int i = 0; i < e.extraCount; ++i) e.extra[i] = static_cast<std::int32_t>(in.readSigned());
+    }
+
+    void writeShot(BitWriter& out, const ShotRecord& s) {
+        writeFixed(out, s.x, SnapshotCodec::POS_BITS);
+        writeFixed(out, s.y, SnapshotCodec::POS_BITS);
+        writeFixed(out, s.vx, SnapshotCodec::VEL_BITS);
+        writeFixed(out, s.vy, SnapshotCodec::VEL_BITS);
+        out.writeVar(s.age);
+    }
+
+    void readShot(BitReader& in, ShotRecord& s) {
+        s.x = readFixed(in, SnapshotCodec::POS_BITS);
+        s.y = readFixed(in, SnapshotCodec::POS_BITS);
+        s.vx = readFixed(in, SnapshotCodec::VEL_BITS);
+        s.vy = readFixed(in, SnapshotCodec::VEL_BITS);
+        s.age = static_cast<std::uint32_t>(in.readVar());
+    }
+
+    void writeDrone(BitWriter& out, const DroneRecord& d) {
+        writeFixed(out, d.x, SnapshotCodec::POS_BITS);
+        writeFixed(out, d.y, SnapshotCodec::POS_BITS);
+        writeFixed(out, d.vx, SnapshotCodec::VEL_BITS);
+        writeFixed(out, d.vy, SnapshotCodec::VEL_BITS);
+        out.writeVar(d.age);
+    }
+
+    void readDrone(BitReader& in, DroneRecord& d) {
+        d.x = readFixed(in, SnapshotCodec::POS_BITS);
+        d.y = readFixed(in, SnapshotCodec::POS_BITS);
+        d.vx = readFixed(in, SnapshotCodec::VEL_BITS);
+        d.vy = readFixed(in, SnapshotCodec::VEL_BITS);
+        d.age = static_cast<std::uint32_t>(in.readVar());
+    }
+
+    // A shot carried over from the base: same flight, 'elapsed' ticks older
+    bool sameShot(const ShotRecord& s, const ShotRecord& b, std::uint64_t elapsed) {
+        return s.x == b.x && s.y == b.y && s.vx == b.vx && s.vy == b.vy && s.age == b.age + elapsed;
+    }
+
+    bool extrasEqual(const EntityRecord& a, const EntityRecord& b) {
+        if (a.extraCount != b.extraCount) return false;
+        for (int i = 0; i < a.extraCount; ++i) if (a.extra[i] != b.extra[i]) return false;
+        return true;
+    }
+}
+
+std::uint16_t SnapshotCodec::quantizeAngle(float degrees) {
+    float turns = degrees / 360.f;
+    turns -= std::floor(turns); // Angles wrap, so only the position within a turn matters
+    return static_cast<std::uint16_t>(static_cast<std::uint32_t>(std::lround(turns * (1 << ANGLE_BITS))) & ((1u << ANGLE_BITS) - 1));
+}
+
+float SnapshotCodec::dequantizeAngle(std::uint16_t angle) {
+    return angle * (360.f / (1 << ANGLE_BITS));
+}
+
+void SnapshotCodec::indexBase(const WorldSnapshot& base) {
+    baseById.clear();
+    for (std::size_t i = 0; i < base.entities.size(); ++i) {
+        std::uint32_t id = base.entities[i].id;
+        if (id > MAX_ENTITY_ID) throw std::runtime_error("Snapshot: entity id out of range");
+        if (id >= baseById.size()) baseById.resize(id + 1, -1);
+        baseById[id] = static_cast<std::int32_t>(i);
+    }
+}
+
+int SnapshotCodec::findInBase(const WorldSnapshot& base, std::uint32_t id, std::uint32_t generation) const {
+    if (id >= baseById.size() || baseById[id] < 0) return -1;
+    int index = baseById[id];
+    return base.entities[index].generation == generation ? index : -1;
+}
+
+void SnapshotCodec::encode(const WorldSnapshot& world, const WorldSnapshot* base, std::vector<std::uint8_t>& out) {
+    BitWriter w(out);
+    w.write(SNAPSHOT_MAGIC, 32);
+    w.write(VERSION, 16);
+    w.write(base ? FLAG_DELTA : 0, 8);
+    if (base) {
+        w.writeVar(base->simTick);
+        indexBase(*base);
+    }
+
+    w.write(world.mode, 4);
+    w.writeSigned(world.level);
+    w.writeVar(world.simTick);
+    w.writeVar(world.playTick);
+    w.writeVar(world.respawnTick);
+    w.write(world.rngState, 64);
+    w.writeSigned(world.player);
+    w.writeSigned(world.boss);
+
+    w.writeVar(world.entities.size());
+    std::uint64_t elapsed = base ? world.simTick - base->simTick : 0;
+    for (std::size_t i = 0; i < world.entities.size(); ++i) {
+        const EntityRecord& e = world.entities[i];
+        if (!base) {
+            w.writeVar(e.id);
+            w.writeVar(e.generation);
+            writeFull(w, e);
+            continue;
+        }
+
+        // Common case first: the base has this entity at the same index
+        int match;
+        bool sameIndex = i < base->entities.size() && base->entities[i].id == e.id && base->entities[i].generation == e.generation;
+        w.writeBool(sameIndex);
+        if (sameIndex) {
+            match = static_cast<int>(i);
+        } else {
+            w.writeVar(e.id);
+            w.writeVar(e.generation);
+            match = findInBase(*base, e.id, e.generation);
+        }
+        bool matched = match >= 0 && base->entities[match].type == e.type;
+        w.writeBool(matched);
+        if (!matched) { // New since the base: full record
+            writeFull(w, e);
+            continue;
+        }
+
+        const EntityRecord& b = base->entities[match];
+        std::uint32_t predictedAge = static_cast<std::uint32_t>(b.age + elapsed);
+        std::uint32_t mask = 0;
+        if (e.life != b.life) mask |= 1u << CHANGED_LIFE;
+        if (e.variant != b.variant) mask |= 1u << CHANGED_VARIANT;
+        if (e.x != b.x) mask |= 1u << CHANGED_X;
+        if (e.y != b.y) mask |= 1u << CHANGED_Y;
+        if (e.vx != b.vx) mask |= 1u << CHANGED_VX;
+        if (e.vy != b.vy) mask |= 1u << CHANGED_VY;
+        if (e.angle != b.angle) mask |= 1u << CHANGED_ANGLE;
+        if (e.radius != b.radius) mask |= 1u << CHANGED_RADIUS;
+        if (e.age != predictedAge) mask |= 1u << CHANGED_AGE;
+        if (!extrasEqual(e, b)) mask |= 1u << CHANGED_EXTRA;
+
+        w.write(mask, CHANGE_BITS);
+        if (mask & (1u << CHANGED_LIFE)) w.writeBool(e.life);
+        if (mask & (1u << CHANGED_VARIANT)) w.write(e.variant, 4);
+        if (mask & (1u << CHANGED_X)) w.writeSigned(static_cast<std::int64_t>(e.x) - b.x);
+        if (mask & (1u << CHANGED_Y)) w.writeSigned(static_cast<std::int64_t>(e.y) - b.y);
+        if (mask & (1u << CHANGED_VX)) w.writeSigned(static_cast<std::int64_t>(e.vx) - b.vx);
+        if (mask & (1u << CHANGED_VY)) w.writeSigned(static_cast<std::int64_t>(e.vy) - b.vy);
+        if (mask & (1u << CHANGED_ANGLE)) w.write(e.angle, ANGLE_BITS);
+        if (mask & (1u << CHANGED_RADIUS)) w.writeVar(e.radius);
+        if (mask & (1u << CHANGED_AGE)) w.writeVar(e.age);
+        if (mask & (1u << CHANGED_EXTRA)) {
+            w.write(e.extraCount, 3);
+            for (int k = 0; k < e.extraCount; ++k) {
+                std::int64_t before = k < b.extraCount ? b.extra[k] : 0;
+                w.writeSigned(static_cast<std::int64_t>(e.extra[k]) - before);
+            }
+        }
+    }
+
+    w.writeVar(world.timers.size());
+    for (const TimerRecord& t : world.timers) {
+        w.writeVar(t.kind);
+        w.writeSigned(t.arg);
+        w.writeSigned(t.target);
+        w.writeVar(t.remaining);
+    }
+
+    // Shots keep their order, so against a base each base shot costs one bit (still flying or
+    // not) and only the shots fired since are written out
+    std::size_t carried = 0;
+    if (base) {
+        for (const ShotRecord& b : base->shots) {
+            bool kept = carried < world.shots.size() && sameShot(world.shots[carried], b, elapsed);
+            w.writeBool(kept);
+            if (kept) ++carried;
+        }
+    }
+    w.writeVar(world.shots.size() - carried);
+    for (std::size_t i = carried; i < world.shots.size(); ++i) writeShot(w, world.shots[i]);
+
+    w.writeVar(world.emitters.size());
+    for (const EmitterRecord& e : world.emitters) {
+        w.write(e.pattern, 8);
+        w.writeSigned(e.source);
+        w.write(e.gun, 8);
+        w.write(e.volleysLeft, 8);
+        w.write(e.wait, 8);
+        w.write(e.aim, ANGLE_BITS);
+    }
+
+    w.writeVar(world.drones.size());
+    for (const DroneRecord& d : world.drones) writeDrone(w, d);
+    w.flush();
+}
+
+void SnapshotCodec::decode(const std::uint8_t* data, std::size_t size, const WorldSnapshot* base, WorldSnapshot& world) {
+    BitReader r(data, size);
+    if (r.read(32) != SNAPSHOT_MAGIC) throw std::runtime_error("Snapshot: not a snapshot");
+    std::uint64_t version = r.read(16);
+    if (version < 1 || version > VERSION) throw std::runtime_error("Snapshot: unsupported version " + std::to_string(version));
+    bool delta = (r.read(8) & FLAG_DELTA) != 0;
+    if (delta) {
+        std::uint64_t baseTick = r.readVar();
+        if (!base || base->simTick != baseTick) throw std::runtime_error("Snapshot: delta needs the base snapshot of tick " + std::to_string(baseTick));
+        indexBase(*base);
+    } else {
+        base = nullptr;
+    }
+
+    world.mode = static_cast<std::uint8_t>(r.read(4));
+    world.level = static_cast<std::int32_t>(r.readSigned());
+    world.simTick = r.readVar();
+    world.playTick = r.readVar();
+    world.respawnTick = r.readVar();
+    world.rngState = r.read(64);
+    world.player = static_cast<std::int32_t>(r.readSigned());
+    world.boss = static_cast<std::int32_t>(r.readSigned());
+
+    std::uint64_t count = r.readVar();
+    if (!r.ok() || count > size * 8) throw std::runtime_error("Snapshot: truncated header");
+    world.entities.resize(static_cast<std::size_t>(count));
+    std::uint64_t elapsed = base ? world.simTick - base->simTick : 0;
+    for (std::size_t i = 0; i < world.entities.size(); ++i) {
+        EntityRecord& e = world.entities[i];
+        if (!base) {
+            e.id = readId(r);
+            e.generation = static_cast<std::uint32_t>(r.readVar());
+            readFull(r, e);
+            continue;
+        }
+
+        int match = -1;
+        bool sameIndex = r.readBool();
+        bool matched;
+        if (sameIndex) {
+            if (i >= base->entities.size()) throw std::runtime_error("Snapshot: delta refers past the base");
+            e.id = base->entities[i].id;
+            e.generation = base->entities[i].generation;
+            matched = r.readBool();
+            match = static_cast<int>(i);
+        } else {
+            e.id = readId(r);
+            e.generation = static_cast<std::uint32_t>(r.readVar());
+            matched = r.readBool();
+            if (matched) {
+                match = findInBase(*base, e.id, e.generation);
+                if (match < 0) throw std::runtime_error("Snapshot: delta entity missing from the base");
+            }
+        }
+        if (!matched) {
+            readFull(r, e);
+            continue;
+        }
+
+        const EntityRecord& b = base->entities[match];
+        e = b;
+        e.age = static_cast<std::uint32_t>(b.age + elapsed);
+        std::uint32_t mask = static_cast<std::uint32_t>(r.read(CHANGE_BITS));
+        if (mask & (1u << CHANGED_LIFE)) e.life = r.readBool();
+        if (mask & (1u << CHANGED_VARIANT)) e.variant = static_cast<std::uint8_t>(r.read(4));
+        if (mask & (1u << CHANGED_X)) e.x = static_cast<std::int32_t>(b.x + r.readSigned());
+        if (mask & (1u << CHANGED_Y)) e.y = static_cast<std::int32_t>(b.y + r.readSigned());
+        if (mask & (1u << CHANGED_VX)) e.vx = static_cast<std::int32_t>(b.vx + r.readSigned());
+        if (mask & (1u << CHANGED_VY)) e.vy = static_cast<std::int32_t>(b.vy + r.readSigned());
+        if (mask & (1u << CHANGED_ANGLE)) e.angle = static_cast<std::uint16_t>(r.read(ANGLE_BITS));
+        if (mask & (1u << CHANGED_RADIUS)) e.radius = static_cast<std::uint16_t>(r.readVar());
+        if (mask & (1u << CHANGED_AGE)) e.age = static_cast<std::uint32_t>(r.readVar());
+        if (mask & (1u << CHANGED_EXTRA)) {
+            e.extraCount = static_cast<std::uint8_t>(r.read(3));
+            if (e.extraCount > EntityRecord::MAX_EXTRA) throw std::runtime_error("Snapshot: bad entity field count");
+            for (int k = 0; k < e.extraCount; ++k) {
+                std::int64_t before = k < b.extraCount ? b.extra[k] : 0;
+                e.extra[k] = static_cast<std::int32_t>(before + r.readSigned());
+            }
+        }
+        if (!r.ok()) break;
+    }
+
+    std::uint64_t timerCount = r.readVar();
+    if (!r.ok() || timerCount > size * 8) throw std::runtime_error("Snapshot: truncated entity data");
+    world.timers.resize(static_cast<std::size_t>(timerCount));
+    for (TimerRecord& t : world.timers) {
+        t.kind = static_cast<std::uint16_t>(r.readVar());
+        t.arg = static_cast<std::int32_t>(r.readSigned());
+        t.target = static_cast<std::int32_t>(r.readSigned());
+        t.remaining = static_cast<std::uint32_t>(r.readVar());
+    }
+    if (!r.ok()) throw std::runtime_error("Snapshot: truncated timer data");
+
+    world.shots.clear();
+    world.emitters.clear();
+    world.drones.clear();
+    if (version < 2) return; // No enemy shots yet
+
+    if (base) {
+        for (const ShotRecord& b : base->shots) {
+            if (!r.readBool()) continue;
+            world.shots.push_back(b);
+            world.shots.back().age = static_cast<std::uint32_t>(b.age + elapsed);
+        }
+    }
+    std::uint64_t fired = r.readVar();
+    if (!r.ok() || fired > size * 8) throw std::runtime_error("Snapshot: truncated shot data");
+    std::size_t carried = world.shots.size();
+    world.shots.resize(carried + static_cast<std::size_t>(fired));
+    for (std::size_t i = carried; i < world.shots.size(); ++i) readShot(r, world.shots[i]);
+
+    std::uint64_t emitterCount = r.readVar();
+    if (!r.ok() || emitterCount > size * 8) throw std::runtime_error("Snapshot: truncated shot data");
+    world.emitters.resize(static_cast<std::size_t>(emitterCount));
+    for (EmitterRecord& e : world.emitters) {
+        e.pattern = static_cast<std::uint8_t>(r.read(8));
+        e.source = static_cast<std::int32_t>(r.readSigned());
+        e.gun = static_cast<std::uint8_t>(r.read(8));
+        e.volleysLeft = static_cast<std::uint8_t>(r.read(8));
+        e.wait = static_cast<std::uint8_t>(r.read(8));
+        e.aim = static_cast<std::uint16_t>(r.read(ANGLE_BITS));
+    }
+    if (!r.ok()) throw std::runtime_error("Snapshot: truncated emitter data");
+    if (version < 3) return; // No drones yet
+
+    std::uint64_t droneCount = r.readVar();
+    if (!r.ok() || droneCount > size * 8) throw std::runtime_error("Snapshot: truncated drone data");
+    world.drones.resize(static_cast<std::size_t>(droneCount));
+    for (DroneRecord& d : world.drones) readDrone(r, d);
+    if (!r.ok()) throw std::runtime_error("Snapshot: truncated drone data");
+}
@@ -0,0 +1,111 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Quantized world state, independent of the entity classes: Game fills it (captureSnapshot) and
+// rebuilds the world from it (restoreSnapshot); SnapshotCodec turns it into compact bytes.
+struct EntityRecord {
+    static const int MAX_EXTRA = 6;
+
+    std::uint32_t id = 0;          // Slot handle when saved; the key for delta matching
+    std::uint32_t generation = 0;
+    std::uint8_t type = 0;         // Entity::Type
+    std::uint8_t variant = 0;      // Asteroid size, bullet type, power-up kind, ship type
+    bool life = true;
+    std::int32_t x = 0, y = 0;     // Position in 1/POS_SCALE px
+    std::int32_t vx = 0, vy = 0;   // Velocity in 1/VEL_SCALE px per step
+    std::uint16_t angle = 0;       // 1/ANGLE_STEPS of a turn
+    std::uint16_t radius = 0;      // 1/RADIUS_SCALE px
+    std::uint32_t age = 0;         // Ticks since spawn (animation phase)
+    std::uint8_t extraCount = 0;
+    std::int32_t extra[MAX_EXTRA] = {}; // Type-specific fields (see Game::captureSnapshot)
+};
+
+struct TimerRecord {
+    std::uint16_t kind = 0;
+    std::int32_t arg = 0;
+    std::int32_t target = -1;      // Index into WorldSnapshot::entities, -1 = none
+    std::uint32_t remaining = 0;   // Ticks until it fires
+};
+
+// Enemy shots fly in straight lines, so a shot is its launch point, velocity and age. Shots
+// keep their order between ticks (new ones are appended), which is what the delta coding relies on.
+struct ShotRecord {
+    std::int32_t x = 0, y = 0;     // Origin in 1/POS_SCALE px
+    std::int32_t vx = 0, vy = 0;   // 1/VEL_SCALE px per step
+    std::uint32_t age = 0;         // Ticks since it was fired
+};
+
+struct EmitterRecord {
+    std::uint8_t pattern = 0;      // BulletPatterns::PatternId
+    std::int32_t source = -1;      // Index into WorldSnapshot::entities
+    std::uint8_t gun = 0;
+    std::uint8_t volleysLeft = 0;
+    std::uint8_t wait = 0;
+    std::uint16_t aim = 0;         // 1/ANGLE_STEPS of a turn
+};
+
+// Hunter drones steer every tick, so each one is stored in full
+struct DroneRecord {
+    std::int32_t x = 0, y = 0;     // 1/POS_SCALE px
+    std::int32_t vx = 0, vy = 0;   // 1/VEL_SCALE px per step
+    std::uint32_t age = 0;         // Ticks since it spawned
+};
+
+struct WorldSnapshot {
+    std::uint8_t mode = 0;         // Game::PlayMode
+    std::int32_t level = 0;
+    std::uint64_t simTick = 0;
+    std::uint64_t playTick = 0;
+    std::uint64_t respawnTick = 0;
+    std::uint64_t rngState = 0;
+    std::int32_t player = -1;      // Entity indices of the player and boss, -1 = none
+    std::int32_t boss = -1;
+    std::vector<EntityRecord> entities;
+    std::vector<TimerRecord> timers;
+    std::vector<ShotRecord> shots;       // Version 2
+    std::vector<EmitterRecord> emitters;
+    std::vector<DroneRecord> drones;     // Version 3
+};
+
+// Versioned, bit-packed encoding of a WorldSnapshot. Positions and velocities are fixed-point,
+// angles 12-bit, everything else length-prefixed. With a base snapshot, entities that existed in
+// the base store only a change mask and the differences of the fields that changed, and shots
+// carried over from the base only a bit each. Version 1 snapshots (no shots) and version 2 ones
+// (no drones) still decode.
+// Holds scratch buffers, so keep one codec around instead of creating one per call.
+class SnapshotCodec {
+public:
+    static const std::uint16_t VERSION = 3;
+    static const int POS_SCALE = 64;       // 1/64 px
+    static const int POS_BITS = 22;        // Signed: +-32768 px
+    static const int VEL_SCALE = 256;
+    static const int VEL_BITS = 18;        // Signed: +-512 px per step
+    static const int ANGLE_BITS = 12;
+    static const int RADIUS_SCALE = 16;
+    static const std::uint32_t MAX_ENTITY_ID = 1u << 20; // Slot ids decode accepts (Swarm peaks near 50000); bounds baseById
+
+    static std::int32_t quantize(float value, int scale) { return static_cast<std::int32_t>(std::lround(value * scale)); }
+    static float dequantize(std::int32_t value, int scale) { return static_cast<float>(value) / scale; }
+    static std::uint16_t quantizeAngle(float degrees);
+    static float dequantizeAngle(std::uint16_t angle);
+
+    void reserve(std::size_t entities) { baseById.reserve(entities); }
+
+    // Appends the encoding of 'world' to 'out'; 'base' (optional) enables delta encoding
+    void encode(const WorldSnapshot& world, const WorldSnapshot* base, std::vector<std::uint8_t>& out);
+    // Throws std::runtime_error for a malformed or unsupported snapshot, or a delta without its base
+    void decode(const std::uint8_t* data, std::size_t size, const WorldSnapshot* base, WorldSnapshot& world);
+
+private:
+    void indexBase(const WorldSnapshot& base);
+    int findInBase(const WorldSnapshot& base, std::uint32_t id, std::uint32_t generation) const;
+
+    std::vector<std::int32_t> baseById; // Slot id -> index in the base snapshot's entities
+};
+
+#endif // SNAPSHOT_H
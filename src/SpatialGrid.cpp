@@ -0,0 +1,55 @@
+#include "SpatialGrid.h"
+
+SpatialGrid::SpatialGrid() : columns(1), rows(1), cellSize(1.f), inverseCell(1.f), largestRadius(0.f) {}
+
+void SpatialGrid::configure(float width, float height, float cell) {
+    cellSize = cell > 0.f ? cell : 1.f;
+    columns = std::max(1, static_cast<int>(width / cellSize) + 1);
+    rows = std::max(1, static_cast<int>(height / cellSize) + 1);
+    inverseCell = 1.f / cellSize;
+    cellStart.assign(static_cast<std::size_t>(columns) * rows + 1, 0);
+    clear();
+}
+
+void SpatialGrid::reserve(std::size_t items) {
+    ids.reserve(items);
+    cells.reserve(items);
+    points.reserve(items);
+    sortedIds.reserve(items);
+    sortedPoints.reserve(items);
+}
+
+void SpatialGrid::clear() {
+    ids.clear();
+    cells.clear();
+    points.clear();
+    sortedIds.clear();
+    sortedPoints.clear();
+    std::fill(cellStart.begin(), cellStart.end(), 0u);
+    largestRadius = 0.f;
+}
+
+void SpatialGrid::add(std::uint32_t id, sf::Vector2f pos, float radius) {
+    ids.push_back(id);
+    points.push_back(pos);
+    cells.push_back(static_cast<std::uint32_t>(cellY(pos.y) * columns + cellX(pos.x)));
+    if (radius > largestRadius) largestRadius = radius;
+}
+
+void SpatialGrid::build() {
+    // Count per cell, turn the counts into start offsets, then place each item (stable: items
+    // keep their staging order within a cell)
+    std::fill(cellStart.begin(), cellStart.end(), 0u);
+    for (std::uint32_t cell : cells) ++cellStart[cell + 1];
+    for (std::size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+    sortedIds.resize(ids.size());
+    sortedPoints.resize(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        std::uint32_t slot = cellStart[cells[i]]++;
+        sortedIds[slot] = ids[i];
+        sortedPoints[slot] = points[i];
+    }
+    // Placing advanced every start to the next cell's start: shift back by one
+    for (std::size_t c = cellStart.size() - 1; c > 0; --c) cellStart[c] = cellStart[c - 1];
+    cellStart[0] = 0;
+}
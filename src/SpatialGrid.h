@@ -0,0 +1,180 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <SFML/System.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Uniform-grid broadphase over the play area, rebuilt from scratch each tick. Items are staged
+// with add() and then counting-sorted into cells by their centre, so a cell's items are one
+// contiguous run and a query only walks the cells its circle (grown by the largest item radius)
+// overlaps. Positions outside the area fall into the border cells. Arrays keep their capacity:
+// rebuilding does not allocate once warm.
+class SpatialGrid {
+public:
+    struct Neighbor {
+        float distanceSq; // From the query centre to where the item was added
+        std::uint32_t id;
+    };
+
+    SpatialGrid();
+
+    void configure(float width, float height, float cellSize);
+    void reserve(std::size_t items);
+
+    void clear();
+    void add(std::uint32_t id, sf::Vector2f pos, float radius);
+    void build();
+
+    std::size_t size() const { return ids.size(); }
+    float maxRadius() const { return largestRadius; }
+
+    // Calls fn(id) for every item that could touch the circle (cell-level test, no distance check)
+    template <typename Fn>
+    void query(sf::Vector2f center, float radius, Fn&& fn) const {
+        if (ids.empty()) return;
+        float reach = radius + largestRadius;
+        int x0 = cellX(center.x - reach), x1 = cellX(center.x + reach);
+        int y0 = cellY(center.y - reach), y1 = cellY(center.y + reach);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                int cell = y * columns + x;
+                for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) fn(sortedIds[i]);
+            }
+        }
+    }
+
+    // Same, but stops as soon as fn(id) returns false (for callers that only need the first few)
+    template <typename Fn>
+    void queryWhile(sf::Vector2f center, float radius, Fn&& fn) const {
+        if (ids.empty()) return;
+        float reach = radius + largestRadius;
+        int x0 = cellX(center.x - reach), x1 = cellX(center.x + reach);
+        int y0 = cellY(center.y - reach), y1 = cellY(center.y + reach);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                int cell = y * columns + x;
+                for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                    if (!fn(sortedIds[i])) return;
+                }
+            }
+        }
+    }
+
+    // Calls fn(id) for every item that could touch the capsule around the segment from-to (a ray
+    // with thickness). Row by row, only the cells the capsule crosses are walked, each once.
+    template <typename Fn>
+    void querySegment(sf::Vector2f from, sf::Vector2f to, float radius, Fn&& fn) const {
+        if (ids.empty()) return;
+        const float far = std::numeric_limits<float>::infinity();
+        float reach = radius + largestRadius;
+        sf::Vector2f d = to - from;
+        int y0 = cellY(std::min(from.y, to.y) - reach), y1 = cellY(std::max(from.y, to.y) + reach);
+        for (int y = y0; y <= y1; ++y) {
+            // The stretch of the segment within reach of this row (border rows extend outwards,
+            // as they hold the items beyond the area)
+            float top = y == 0 ? -far : y * cellSize - reach;
+            float bottom = y == rows - 1 ? far : (y + 1) * cellSize + reach;
+            float t0 = 0.f, t1 = 1.f;
+            if (d.y != 0.f) {
+                float ta = (top - from.y) / d.y, tb = (bottom - from.y) / d.y;
+                t0 = std::max(0.f, std::min(ta, tb));
+                t1 = std::min(1.f, std::max(ta, tb));
+                if (t0 > t1) continue;
+            } else if (from.y < top || from.y > bottom) {
+                continue;
+            }
+            float xa = from.x + d.x * t0, xb = from.x + d.x * t1;
+            int x0 = cellX(std::min(xa, xb) - reach), x1 = cellX(std::max(xa, xb) + reach);
+            for (int x = x0; x <= x1; ++x) {
+                int cell = y * columns + x;
+                for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) fn(sortedIds[i]);
+            }
+        }
+    }
+
+    // The k items nearest to 'center' within maxRadius that accept(id) takes, nearest first (ties
+    // by id), measured to the positions they were added at. Cells are searched in square rings
+    // outwards; the search stops as soon as no cell left can hold anything nearer.
+    template <typename AcceptFn>
+    void nearest(sf::Vector2f center, float maxRadius, std::size_t k, AcceptFn&& accept, std::vector<Neighbor>& out) const {
+        search(center, maxRadius, k, out, [&](std::uint32_t id, sf::Vector2f, float) { return accept(id); });
+    }
+
+    // Same, counting only items within the cone around the unit vector 'dir' whose half angle has
+    // the cosine cosHalfAngle
+    template <typename AcceptFn>
+    void nearestInCone(sf::Vector2f center, sf::Vector2f dir, float cosHalfAngle, float maxRadius, std::size_t k,
+                       AcceptFn&& accept, std::vector<Neighbor>& out) const {
+        search(center, maxRadius, k, out, [&](std::uint32_t id, sf::Vector2f offset, float distanceSq) {
+            float along = offset.x * dir.x + offset.y * dir.y;
+            if (along < cosHalfAngle * std::sqrt(distanceSq)) return false;
+            return accept(id);
+        });
+    }
+
+private:
+    template <typename TestFn>
+    void search(sf::Vector2f center, float maxRadius, std::size_t k, std::vector<Neighbor>& out, TestFn&& test) const {
+        out.clear();
+        if (ids.empty() || k == 0) return;
+        float maxSq = maxRadius * maxRadius;
+        int cx = cellX(center.x), cy = cellY(center.y);
+        int lastRing = std::max(std::max(cx, columns - 1 - cx), std::max(cy, rows - 1 - cy));
+        for (int ring = 0; ring <= lastRing; ++ring) {
+            // Everything in this ring is at least ring - 1 whole cells away
+            if (ring > 1) {
+                float bound = (ring - 1) * cellSize;
+                if (bound * bound > maxSq) break;
+                if (out.size() == k && bound * bound >= out.back().distanceSq) break;
+            }
+            for (int y = cy - ring; y <= cy + ring; ++y) {
+                if (y < 0 || y >= rows) continue;
+                bool edgeRow = y == cy - ring || y == cy + ring;
+                for (int x = cx - ring; x <= cx + ring; x += edgeRow ? 1 : 2 * ring) {
+                    if (x >= 0 && x < columns) visitCell(y * columns + x, center, maxSq, k, out, test);
+                    if (ring == 0) break;
+                }
+            }
+        }
+    }
+
+    template <typename TestFn>
+    void visitCell(int cell, sf::Vector2f center, float maxSq, std::size_t k, std::vector<Neighbor>& out, TestFn& test) const {
+        for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+            sf::Vector2f offset = sortedPoints[i] - center;
+            float distanceSq = offset.x * offset.x + offset.y * offset.y;
+            if (distanceSq > maxSq) continue;
+            Neighbor n = { distanceSq, sortedIds[i] };
+            if (out.size() == k && !closer(n, out.back())) continue;
+            if (!test(n.id, offset, distanceSq)) continue;
+            if (out.size() == k) out.pop_back();
+            out.push_back(n);
+            for (std::size_t j = out.size() - 1; j > 0 && closer(out[j], out[j - 1]); --j) std::swap(out[j], out[j - 1]);
+        }
+    }
+
+    static bool closer(const Neighbor& a, const Neighbor& b) {
+        return a.distanceSq != b.distanceSq ? a.distanceSq < b.distanceSq : a.id < b.id;
+    }
+
+    int cellX(float x) const { return std::min(columns - 1, std::max(0, static_cast<int>(x * inverseCell))); }
+    int cellY(float y) const { return std::min(rows - 1, std::max(0, static_cast<int>(y * inverseCell))); }
+
+    int columns, rows;
+    float cellSize;
+    float inverseCell;
+    float largestRadius;
+
+    std::vector<std::uint32_t> ids;       // Staged items
+    std::vector<std::uint32_t> cells;     // Cell of each staged item
+    std::vector<sf::Vector2f> points;     // Position of each staged item
+    std::vector<std::uint32_t> cellStart; // Prefix sums: cell c holds sortedIds[cellStart[c], cellStart[c + 1])
+    std::vector<std::uint32_t> sortedIds;
+    std::vector<sf::Vector2f> sortedPoints; // Positions in sortedIds order (for nearest queries)
+};
+
+#endif // SPATIALGRID_H
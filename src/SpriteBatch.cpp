@@ -0,0 +1,76 @@
+#include "SpriteBatch.h"
+#include <cmath>
+
+namespace {
+    const float DEG_TO_RAD = 0.017453293f;
+    const std::size_t VERTICES_PER_QUAD = 6; // Two triangles
+}
+
+SpriteBatch::SpriteBatch() : reserveQuads(0) {}
+
+void SpriteBatch::reserve(std::size_t quads) {
+    reserveQuads = quads;
+    for (Layer& layer : layers) layer.vertices.reserve(quads * VERTICES_PER_QUAD);
+}
+
+void SpriteBatch::addLayer(const sf::Texture& texture) {
+    for (const Layer& layer : layers) {
+        if (layer.texture == &texture) return;
+    }
+    layers.push_back(Layer());
+    layers.back().texture = &texture;
+    layers.back().vertices.reserve(reserveQuads * VERTICES_PER_QUAD);
+}
+
+void SpriteBatch::add(const sf::Sprite& sprite, sf::Vector2f pos, float angleDegrees) {
+    const sf::Texture* texture = sprite.getTexture();
+    if (!texture) return;
+
+    Layer* layer = nullptr;
+    for (Layer& candidate : layers) {
+        if (candidate.texture == texture) { layer = &candidate; break; }
+    }
+    if (!layer) {
+        addLayer(*texture);
+        layer = &layers.back();
+    }
+
+    const sf::IntRect& rect = sprite.getTextureRect();
+    const sf::Vector2f& origin = sprite.getOrigin();
+    const sf::Vector2f& scale = sprite.getScale();
+    sf::Color color = sprite.getColor();
+
+    // Same transform as the sprite's: scale about the origin, rotate, then translate
+    float c = std::cos(angleDegrees * DEG_TO_RAD);
+    float s = std::sin(angleDegrees * DEG_TO_RAD);
+    float left = -origin.x * scale.x, right = (rect.width - origin.x) * scale.x;
+    float top = -origin.y * scale.y, bottom = (rect.height - origin.y) * scale.y;
+    auto corner = [&](float x, float y, float u, float v) {
+        return sf::Vertex(sf::Vector2f(pos.x + x * c - y * s, pos.y + x * s + y * c), color, sf::Vector2f(u, v));
+    };
+    float u0 = static_cast<float>(rect.left), u1 = static_cast<float>(rect.left + rect.width);
+    float v0 = static_cast<float>(rect.top), v1 = static_cast<float>(rect.top + rect.height);
+    sf::Vertex tl = corner(left, top, u0, v0);
+    sf::Vertex tr = corner(right, top, u1, v0);
+    sf::Vertex br = corner(right, bottom, u1, v1);
+    sf::Vertex bl = corner(left, bottom, u0, v1);
+
+    std::vector<sf::Vertex>& v = layer->vertices;
+    v.push_back(tl); v.push_back(tr); v.push_back(br);
+    v.push_back(tl); v.push_back(br); v.push_back(bl);
+}
+
+void SpriteBatch::draw(sf::RenderTarget& target) {
+    for (Layer& layer : layers) {
+        if (layer.vertices.empty()) continue;
+        sf::RenderStates states(layer.texture);
+        target.draw(layer.vertices.data(), layer.vertices.size(), sf::Triangles, states);
+        layer.vertices.clear();
+    }
+}
+
+std::size_t SpriteBatch::quadCount() const {
+    std::size_t vertices = 0;
+    for (const Layer& layer : layers) vertices += layer.vertices.size();
+    return vertices / VERTICES_PER_QUAD;
+}
@@ -0,0 +1,33 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+
+// Collects many sprites as textured quads and draws them with one call per texture, instead of
+// one draw call per sprite. Takes the sprite's texture rect, origin, scale and colour; position
+// and rotation are passed in (entities keep those outside the sprite).
+class SpriteBatch {
+public:
+    SpriteBatch();
+
+    void reserve(std::size_t quads); // Per texture, for layers that exist now or are added later
+    void addLayer(const sf::Texture& texture); // Up front, so the first sprite with this texture does not allocate
+
+    void add(const sf::Sprite& sprite, sf::Vector2f pos, float angleDegrees);
+    void draw(sf::RenderTarget& target); // Draws everything added since the last draw, then empties the batch
+
+    std::size_t quadCount() const;
+
+private:
+    struct Layer {
+        const sf::Texture* texture;
+        std::vector<sf::Vertex> vertices; // Capacity kept between frames
+    };
+
+    std::vector<Layer> layers; // A handful of textures: linear lookup
+    std::size_t reserveQuads;
+};
+
+#endif // SPRITEBATCH_H
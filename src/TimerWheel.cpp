@@ -0,0 +1,112 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel() : freeHead(NIL), current(0), count(0) {
+    for (int l = 0; l < LEVELS; ++l)
+        for (std::uint32_t s = 0; s < SLOTS; ++s) buckets[l][s] = NIL;
+}
+
+void TimerWheel::reserve(std::size_t n) {
+    nodes.reserve(n);
+}
+
+TimerId TimerWheel::schedule(std::uint64_t delayTicks, const TimerEvent& event) {
+    std::uint32_t index;
+    if (freeHead != NIL) {
+        index = freeHead;
+        freeHead = nodes[index].next;
+    } else {
+        index = static_cast<std::uint32_t>(nodes.size());
+        Node fresh = {};
+        fresh.generation = 1;
+        nodes.push_back(fresh);
+    }
+
+    // Clamp to the wheel's range; the outermost level keeps cascading it down
+    const std::uint64_t maxDelay = (std::uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+    if (delayTicks == 0) delayTicks = 1;
+    if (delayTicks > maxDelay) delayTicks = maxDelay;
+
+    Node& node = nodes[index];
+    node.event = event;
+    node.due = current + delayTicks;
+    node.active = true;
+    link(index);
+    ++count;
+
+    TimerId id;
+    id.index = index;
+    id.generation = node.generation;
+    return id;
+}
+
+bool TimerWheel::isPending(TimerId id) const {
+    return id.index < nodes.size() && nodes[id.index].active && nodes[id.index].generation == id.generation;
+}
+
+std::uint64_t TimerWheel::remainingTicks(TimerId id) const {
+    return isPending(id) ? nodes[id.index].due - current : 0;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (!isPending(id)) return false;
+    release(id.index);
+    return true;
+}
+
+void TimerWheel::clear(std::uint64_t tick) {
+    for (std::uint32_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].active) release(i);
+    }
+    current = tick;
+}
+
+// Level = how far the deadline is from the current tick; slot = the deadline's digit at that level.
+// Measuring from 'current' (not current + 1) keeps a new level-0 timer out of the slot being drained.
+void TimerWheel::link(std::uint32_t index) {
+    Node& node = nodes[index];
+    std::uint64_t delta = node.due - current; // due >= current: scheduling adds >= 1, cascades only move due timers closer
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (std::uint64_t(1) << (SLOT_BITS * (level + 1)))) ++level;
+    std::uint32_t slot = static_cast<std::uint32_t>((node.due >> (SLOT_BITS * level)) & SLOT_MASK);
+
+    node.level = static_cast<std::uint8_t>(level);
+    node.slot = static_cast<std::uint8_t>(slot);
+    node.prev = NIL;
+    node.next = buckets[level][slot];
+    if (node.next != NIL) nodes[node.next].prev = index;
+    buckets[level][slot] = index;
+}
+
+void TimerWheel::unlink(std::uint32_t index) {
+    Node& node = nodes[index];
+    if (node.prev != NIL) nodes[node.prev].next = node.next;
+    else buckets[node.level][node.slot] = node.next;
+    if (node.next != NIL) nodes[node.next].prev = node.prev;
+}
+
+void TimerWheel::release(std::uint32_t index) {
+    unlink(index);
+    Node& node = nodes[index];
+    node.active = false;
+    ++node.generation;
+    node.next = freeHead;
+    freeHead = index;
+    --count;
+}
+
+// Called while processing tick 'current' when level 'level-1' wraps: re-files the matching
+// higher-level slot into lower levels. The next level up is cascaded first when this one wraps too.
+void TimerWheel::cascadeFrom(int level) {
+    if (level >= LEVELS) return;
+    std::uint32_t slot = static_cast<std::uint32_t>((current >> (SLOT_BITS * level)) & SLOT_MASK);
+    if (slot == 0) cascadeFrom(level + 1);
+
+    std::uint32_t index = buckets[level][slot];
+    buckets[level][slot] = NIL;
+    while (index != NIL) {
+        std::uint32_t next = nodes[index].next;
+        link(index);
+        index = next;
+    }
+}
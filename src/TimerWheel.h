@@ -0,0 +1,92 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include "SlotMap.h"
+#include <cstdint>
+#include <vector>
+
+// What a timer delivers when it expires: a caller-defined kind, an optional entity and an argument
+struct TimerEvent {
+    std::uint16_t kind = 0;
+    std::int32_t arg = 0;
+    SlotHandle target;
+};
+
+typedef SlotHandle TimerId; // Generational, so cancelling an already fired timer is harmless
+
+// Hierarchical timing wheel over simulation ticks (4 levels x 64 slots, ~16.7M ticks of range).
+// Timers are registered once; advancing a tick only touches the slot that comes due (plus an
+// occasional cascade of a higher-level slot), so the per-tick cost follows the number of
+// expirations, not the number of pending timers. Nodes are pooled: no allocation once warm.
+class TimerWheel {
+public:
+    TimerWheel();
+
+    void reserve(std::size_t count);
+
+    // Fires 'delayTicks' after the last processed tick (at least one tick later)
+    TimerId schedule(std::uint64_t delayTicks, const TimerEvent& event);
+    bool cancel(TimerId id);
+    bool isPending(TimerId id) const;
+    std::uint64_t remainingTicks(TimerId id) const; // 0 if not pending
+
+    // Processes every tick up to and including 'tick', calling handler(const TimerEvent&) for each
+    // expiration in due order. The handler may schedule or cancel timers.
+    template <typename Handler>
+    void advance(std::uint64_t tick, Handler&& handler) {
+        while (current < tick) {
+            ++current;
+            std::uint32_t slot = static_cast<std::uint32_t>(current & SLOT_MASK);
+            if (slot == 0) cascadeFrom(1);
+            while (buckets[0][slot] != NIL) {
+                std::uint32_t index = buckets[0][slot];
+                TimerEvent event = nodes[index].event;
+                release(index);
+                handler(event);
+            }
+        }
+    }
+
+    // Calls fn(const TimerEvent&, remainingTicks) for every pending timer (snapshots), in pool order
+    template <typename Fn>
+    void forEachPending(Fn&& fn) const {
+        for (const Node& node : nodes) {
+            if (node.active) fn(node.event, node.due - current);
+        }
+    }
+
+    // Drops all pending timers (their ids become stale) and restarts counting at 'tick'
+    void clear(std::uint64_t tick);
+
+    std::uint64_t now() const { return current; }
+    std::size_t pending() const { return count; }
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const std::uint32_t SLOTS = 1u << SLOT_BITS;
+    static const std::uint64_t SLOT_MASK = SLOTS - 1;
+    static const std::uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Node {
+        TimerEvent event;
+        std::uint64_t due;
+        std::uint32_t prev, next;  // Bucket list links (next doubles as the free-list link)
+        std::uint32_t generation;
+        std::uint8_t level, slot;
+        bool active;
+    };
+
+    void link(std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    void cascadeFrom(int level);
+
+    std::vector<Node> nodes;
+    std::uint32_t freeHead;
+    std::uint32_t buckets[LEVELS][SLOTS];
+    std::uint64_t current; // Last processed tick
+    std::size_t count;
+};
+
+#endif // TIMERWHEEL_H
@@ -0,0 +1,61 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool() :
+    generation(0), busy(0), stopping(false), entry(nullptr), job(nullptr) {}
+
+WorkerPool::~WorkerPool() {
+    resize(0);
+}
+
+void WorkerPool::resize(int count) {
+    if (count < 0) count = 0;
+    if (static_cast<std::size_t>(count) == workers.size()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+    workers.clear();
+    stopping = false;
+    for (int i = 0; i < count; ++i) workers.emplace_back(&WorkerPool::workerLoop, this, generation, static_cast<std::size_t>(i) + 1);
+}
+
+void WorkerPool::dispatch(Entry jobEntry, void* jobData) {
+    if (workers.empty()) {
+        jobEntry(jobData, 0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entry = jobEntry;
+        job = jobData;
+        busy = static_cast<int>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+    jobEntry(jobData, 0);
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return busy == 0; });
+}
+
+// 'seen' is the generation when the worker was started (only run() changes it, on the owner's thread)
+void WorkerPool::workerLoop(std::uint64_t seen, std::size_t slot) {
+    for (;;) {
+        Entry current;
+        void* data;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            current = entry;
+            data = job;
+        }
+        current(data, slot);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) idle.notify_one();
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A few threads that help the owner's thread through one job at a time. run(job) calls job(slot)
+// on every worker (slots 1..size()) and job(0) on the caller, and returns once they have all
+// finished. The job divides the work itself (the solvers drain an atomic chunk counter), so the
+// result can only depend on the thread count if the job lets it. run() does not allocate.
+class WorkerPool {
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void resize(int count); // Threads besides the caller's (0 = run() does it all on the caller's)
+    int size() const { return static_cast<int>(workers.size()); }
+
+    template <typename Job>
+    void run(Job& job) { dispatch(&invoke<Job>, &job); }
+
+private:
+    typedef void (*Entry)(void* job, std::size_t slot);
+
+    template <typename Job>
+    static void invoke(void* job, std::size_t slot) { (*static_cast<Job*>(job))(slot); }
+
+    void dispatch(Entry entry, void* job);
+    void workerLoop(std::uint64_t seen, std::size_t slot);
+
+    // run() publishes the job and bumps the generation, then waits until the workers are idle again
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::uint64_t generation;
+    int busy;
+    bool stopping;
+    Entry entry;
+    void* job;
+};
+
+#endif // WORKERPOOL_H
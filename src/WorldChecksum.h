@@ -0,0 +1,36 @@
+#ifndef WORLDCHECKSUM_H
+#define WORLDCHECKSUM_H
+
+#include <cstdint>
+#include <cstring>
+
+// Running 64-bit hash (FNV-1a over 32-bit words) of gameplay state, fed field by field.
+// Order matters, and floats are hashed by bit pattern: any difference at all is a divergence.
+class WorldChecksum {
+public:
+    WorldChecksum() : hash(OFFSET) {}
+
+    void reset() { hash = OFFSET; }
+
+    void add(std::uint32_t v) { hash = (hash ^ v) * PRIME; }
+    void add(std::int32_t v) { add(static_cast<std::uint32_t>(v)); }
+    void add(std::uint64_t v) {
+        add(static_cast<std::uint32_t>(v));
+        add(static_cast<std::uint32_t>(v >> 32));
+    }
+    void add(bool v) { add(static_cast<std::uint32_t>(v ? 1u : 0u)); }
+    void add(float v) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        add(bits);
+    }
+
+    std::uint64_t value() const { return hash; }
+
+private:
+    static const std::uint64_t OFFSET = 14695981039346656037ull;
+    static const std::uint64_t PRIME = 1099511628211ull;
+    std::uint64_t hash;
+};
+
+#endif // WORLDCHECKSUM_H
@@ -1,10 +1,127 @@
 #include "Game.h"
+#include "SessionServer.h"
+#include <cstdlib>
 #include <iostream>
+#include <string>
+
+static void printUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " [--seed N] [--record FILE] [--replay FILE] [--trace FILE] [--rewind-mb N]\n"
+              << "       [--pacing vsync|limit|uncapped] [--fps N] [--no-input-thread] [--latency FILE]\n"
+              << "       [--quality auto|0-3] [--swarm N] [--rock-threads N]\n"
+              << "       [--gravity off|levels|wells|rocks] [--gravity-theta T] [--gravity-threads N]\n"
+              << "       [--server N [--server-workers N] [--server-mode survival|campaign] [--server-seconds S]\n"
+              << "        [--server-ticks T] [--server-port P] [--snapshot-every N]]\n"
+              << "  --seed N       Seed every run with N instead of the clock\n"
+              << "  --record FILE  Record each run (seed, inputs, per-tick checksums) to FILE\n"
+              << "  --replay FILE  Re-simulate a recorded run without rendering; exit code 1 if it diverges\n"
+              << "  --trace FILE   Write a per-tick dump of every entity to FILE (see divergence_finder)\n"
+              << "  --rewind-mb N  Memory for the rewind history shown while paused (default 4, 0 = off)\n"
+              << "  --pacing MODE  vsync (default), limit (sleep/spin limiter at --fps) or uncapped\n"
+              << "  --fps N        Limiter rate (default 60). With vsync, dropped frames are judged against the measured refresh\n"
+              << "  --no-input-thread  Poll the keyboard once per tick on the game thread\n"
+              << "  --latency FILE Log input-to-present latency per frame to FILE (summary on exit/F3)\n"
+              << "  --quality Q    Cosmetic quality: auto (default, follows the frame budget) or a fixed level 0-3\n"
+              << "  --swarm N      Asteroids Swarm Survival ramps up to (default 20000, 1000-50000)\n"
+              << "  --rock-threads N  Worker threads for rock-rock collisions (default: one per spare core, up to 3;\n"
+              << "                 0 = game thread only). Results are the same for any N\n"
+              << "  --gravity MODE Black holes: levels (default, the Campaign level before each boss), wells (every\n"
+              << "                 level and mode), rocks (wells, and every large asteroid pulls too) or off\n"
+              << "  --gravity-theta T  Barnes-Hut accuracy, 0-1.5 (default 0.5; 0 = exact, larger = faster)\n"
+              << "  --gravity-threads N  Worker threads for the gravity pass (default: as many as --rock-threads)\n"
+              << "  --server N     Host N headless sessions (no window) stepped at 60 Hz by a worker pool, streaming\n"
+              << "                 snapshots over UDP to clients, then log deadline, capacity and memory metrics.\n"
+              << "                 --seed, --gravity and --gravity-theta apply to every session\n"
+              << "  --server-workers N  Threads stepping the sessions (default: one per core)\n"
+              << "  --server-mode M     survival (default) or campaign\n"
+              << "  --server-seconds S  Serve for S seconds (default 30)\n"
+              << "  --server-ticks T    Instead, stop each session after T ticks (with --seed: same digest on any workers)\n"
+              << "  --server-port P     UDP port for client input and watch requests (default 47000)\n"
+              << "  --snapshot-every N  Ticks between snapshots (default 2)\n";
+}
+
+int main(int argc, char* argv[]) {
+    GameOptions options;
+    ServerOptions server;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seed" && hasValue) {
+            options.fixedSeed = true;
+            options.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--record" && hasValue) {
+            options.recordPath = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            options.replayPath = argv[++i];
+        } else if (arg == "--trace" && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--rewind-mb" && hasValue) {
+            options.rewindBudget = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10)) * 1024 * 1024;
+        } else if (arg == "--pacing" && hasValue) {
+            std::string mode = argv[++i];
+            if (mode == "vsync") options.pacing = FramePacer::Mode::VSync;
+            else if (mode == "limit") options.pacing = FramePacer::Mode::Limiter;
+            else if (mode == "uncapped") options.pacing = FramePacer::Mode::Uncapped;
+            else { printUsage(argv[0]); return EXIT_FAILURE; }
+        } else if (arg == "--no-input-thread") {
+            options.inputThread = false;
+        } else if (arg == "--latency" && hasValue) {
+            options.latencyPath = argv[++i];
+        } else if (arg == "--quality" && hasValue) {
+            std::string level = argv[++i];
+            options.qualityLevel = level == "auto" ? -1 : static_cast<int>(std::strtol(level.c_str(), nullptr, 10));
+        } else if (arg == "--swarm" && hasValue) {
+            options.swarmTarget = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+        } else if (arg == "--rock-threads" && hasValue) {
+            options.rockThreads = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            if (options.rockThreads < 0) { printUsage(argv[0]); return EXIT_FAILURE; }
+        } else if (arg == "--gravity" && hasValue) {
+            std::string mode = argv[++i];
+            if (mode == "off") options.gravity = GameOptions::GravityMode::Off;
+            else if (mode == "levels") options.gravity = GameOptions::GravityMode::Levels;
+            else if (mode == "wells") options.gravity = GameOptions::GravityMode::Wells;
+            else if (mode == "rocks") options.gravity = GameOptions::GravityMode::Rocks;
+            else { printUsage(argv[0]); return EXIT_FAILURE; }
+        } else if (arg == "--gravity-theta" && hasValue) {
+            options.gravityTheta = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--gravity-threads" && hasValue) {
+            options.gravityThreads = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            if (options.gravityThreads < 0) { printUsage(argv[0]); return EXIT_FAILURE; }
+        } else if (arg == "--server" && hasValue) {
+            server.sessions = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            if (server.sessions <= 0) { printUsage(argv[0]); return EXIT_FAILURE; }
+        } else if (arg == "--server-workers" && hasValue) {
+            server.workers = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            if (server.workers <= 0) { printUsage(argv[0]); return EXIT_FAILURE; }
+        } else if (arg == "--server-mode" && hasValue) {
+            std::string mode = argv[++i];
+            if (mode == "survival") server.mode = Game::PlayMode::Survival;
+            else if (mode == "campaign") server.mode = Game::PlayMode::Campaign;
+            else { printUsage(argv[0]); return EXIT_FAILURE; }
+        } else if (arg == "--server-seconds" && hasValue) {
+            server.seconds = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--server-ticks" && hasValue) {
+            server.ticks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--server-port" && hasValue) {
+            server.port = static_cast<unsigned short>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--snapshot-every" && hasValue) {
+            server.snapshotInterval = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+        } else if (arg == "--fps" && hasValue) {
+            options.targetHz = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+        } else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
 
-int main() {
     try {
-        Game game;
+        if (server.sessions > 0) {
+            server.game = options;
+            SessionServer sessionServer(server);
+            return sessionServer.run();
+        }
+        Game game(options);
         game.run();
+        return game.exitStatus();
     } catch (const std::exception& e) {
         std::cerr << "An unexpected error occurred: " << e.what() << std::endl;
         return EXIT_FAILURE;
@@ -12,6 +129,4 @@ int main() {
          std::cerr << "An unknown error occurred." << std::endl;
          return EXIT_FAILURE;
     }
-
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,41 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Shared by the *_bench tools: the field generator and the per-tick timing summary they print.
+namespace bench {
+    const double TICK_BUDGET_MS = 1000.0 / 60.0;
+
+    // Small deterministic generator so every run measures the same field
+    inline std::uint32_t lcg(std::uint32_t& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    struct TickSummary {
+        double mean, p99, max; // ms
+
+        bool inBudget() const { return p99 < TICK_BUDGET_MS; }
+        const char* verdict() const { return inBudget() ? "ok" : "OVER"; }
+
+        // "mean .. p99 .. max .. (..% of a tick)", no newline: the caller appends its own columns
+        void print() const {
+            std::printf("mean %6.3f ms  p99 %6.3f ms  max %6.3f ms  (%4.1f%% of a tick)", mean, p99, max, 100.0 * p99 / TICK_BUDGET_MS);
+        }
+    };
+
+    // 'times' holds one run's ms per tick (at least one); it is left sorted
+    inline TickSummary summarize(std::vector<double>& times) {
+        double mean = 0.0;
+        for (double t : times) mean += t;
+        mean /= times.size();
+        std::sort(times.begin(), times.end());
+        return TickSummary{mean, times[times.size() * 99 / 100], times.back()};
+    }
+}
+
+#endif // BENCH_COMMON_H
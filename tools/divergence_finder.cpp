@@ -0,0 +1,130 @@
+// divergence_finder: replays one recorded session on two game builds and reports the first tick
+// and entity at which their simulations differ.
+//
+//   divergence_finder <gameA> <gameB> <session>     run both builds with --replay/--trace, compare
+//   divergence_finder --traces <traceA> <traceB>    compare two existing traces
+//
+// Exit code: 0 identical, 1 diverged, 2 usage or I/O error.
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Runs one build from its own directory (it loads images/ and sounds/ relative to the working dir)
+static bool runReplay(const fs::path& exe, const fs::path& session, const fs::path& trace, const fs::path& log) {
+    fs::path dir = exe.parent_path();
+    std::string command =
+#ifdef _WIN32
+        "cd /d \"" + dir.string() + "\" && \"" + exe.string() + "\"";
+#else
+        "cd \"" + dir.string() + "\" && \"" + exe.string() + "\"";
+#endif
+    command += " --replay \"" + session.string() + "\" --trace \"" + trace.string() + "\" > \"" + log.string() + "\" 2>&1";
+    int status = std::system(command.c_str());
+    std::cout << exe.string() << ": replay " << (status == 0 ? "matched the session" : "did NOT match the session")
+              << " (log: " << log.string() << ")\n";
+    return fs::exists(trace);
+}
+
+static std::vector<std::string> split(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::istringstream in(line);
+    std::string token;
+    while (in >> token) tokens.push_back(token);
+    return tokens;
+}
+
+// Names the key=value fields that differ between two lines describing the same thing
+static void reportFields(const std::string& a, const std::string& b) {
+    std::vector<std::string> ta = split(a), tb = split(b);
+    for (std::size_t i = 0; i < ta.size() && i < tb.size(); ++i) {
+        if (ta[i] == tb[i]) continue;
+        std::size_t eq = ta[i].find('=');
+        std::string key = eq == std::string::npos ? "field " + std::to_string(i) : ta[i].substr(0, eq);
+        std::cout << "    " << key << ": A " << ta[i].substr(eq == std::string::npos ? 0 : eq + 1)
+                  << "  B " << tb[i].substr(eq == std::string::npos ? 0 : tb[i].find('=') + 1) << "\n";
+    }
+    if (ta.size() != tb.size()) std::cout << "    (different number of fields)\n";
+}
+
+static int compareTraces(const fs::path& pathA, const fs::path& pathB) {
+    std::ifstream a(pathA), b(pathB);
+    if (!a || !b) {
+        std::cerr << "Cannot open " << (!a ? pathA : pathB).string() << "\n";
+        return 2;
+    }
+
+    std::string lineA, lineB, tick = "(before the first tick)";
+    unsigned long long lineNo = 0;
+    while (true) {
+        bool hasA = static_cast<bool>(std::getline(a, lineA));
+        bool hasB = static_cast<bool>(std::getline(b, lineB));
+        ++lineNo;
+        if (!hasA && !hasB) {
+            std::cout << "Traces are identical (" << lineNo - 1 << " lines, last " << tick << ")\n";
+            return 0;
+        }
+        if (hasA && hasB && lineA == lineB) {
+            if (lineA.compare(0, 5, "tick ") == 0) tick = lineA;
+            continue;
+        }
+
+        std::cout << "First divergence at " << tick << " (line " << lineNo << ")\n";
+        if (!hasA || !hasB) {
+            std::cout << "  trace " << (hasA ? "B" : "A") << " ends here: that build stopped playing earlier\n";
+            return 1;
+        }
+        std::cout << "  A:" << lineA << "\n  B:" << lineB << "\n";
+        std::vector<std::string> ta = split(lineA), tb = split(lineB);
+        if (!ta.empty() && !tb.empty() && ta[0] == "entity" && tb[0] == "entity" && ta[1] == tb[1]) {
+            std::cout << "  entity " << ta[1] << " (" << ta[2] << ", " << ta[3] << ") differs in:\n";
+            reportFields(lineA, lineB);
+        } else if (!ta.empty() && !tb.empty() && ta[0] == tb[0]) {
+            reportFields(lineA, lineB);
+        } else {
+            std::cout << "  (the entity lists differ: an entity was spawned or removed in one build only)\n";
+        }
+        return 1;
+    }
+}
+
+static void printUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " <gameA> <gameB> <session>\n"
+              << "       " << exe << " --traces <traceA> <traceB>\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 4 && std::string(argv[1]) == "--traces") {
+        return compareTraces(argv[2], argv[3]);
+    }
+    if (argc != 4) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    try {
+        fs::path exeA = fs::absolute(argv[1]);
+        fs::path exeB = fs::absolute(argv[2]);
+        fs::path session = fs::absolute(argv[3]);
+        fs::path work = fs::temp_directory_path() / "divergence_finder";
+        fs::create_directories(work);
+
+        fs::path traceA = work / "traceA.txt", traceB = work / "traceB.txt";
+        fs::remove(traceA);
+        fs::remove(traceB);
+        if (!runReplay(exeA, session, traceA, work / "replayA.log") || !runReplay(exeB, session, traceB, work / "replayB.log")) {
+            std::cerr << "A build produced no trace (see the logs in " << work.string() << ")\n";
+            return 2;
+        }
+        return compareTraces(traceA, traceB);
+    } catch (const std::exception& e) {
+        std::cerr << "divergence_finder: " << e.what() << "\n";
+        return 2;
+    }
+}
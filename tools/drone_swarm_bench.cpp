@@ -0,0 +1,94 @@
+// drone_swarm_bench: steps the hunter drone swarm on a 1200x800 field (the game window) and reports the time per
+// tick against the 60 Hz budget.
+//
+//   drone_swarm_bench [--expect CHECKSUM] [droneCount ...]      default: 500 1000 2000 4000
+//
+// Drones start spread over the field and chase a target circling the centre, the way they chase
+// the player. Each count runs 600 ticks; the checksum of the final state must not change between
+// runs or machines, so --expect (hex, as printed; give one count) checks it against a recorded one.
+// Exit code: 0 ok, 1 a checksum differs from the expected one or a p99 is over the budget, 2 usage
+// error.
+
+#include "DroneSwarm.h"
+#include "WorldChecksum.h"
+#include "bench_common.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+    const int TICKS = 600;
+    const float WIDTH = 1200.f, HEIGHT = 800.f;
+
+    using bench::lcg;
+
+    // Returns the final state's checksum
+    std::uint64_t run(std::size_t count, bool& inBudget) {
+        DroneSwarm swarm;
+        swarm.configure(WIDTH, HEIGHT);
+        swarm.reserve(count);
+        std::uint32_t rng = 12345;
+        for (std::size_t i = 0; i < count; ++i) {
+            sf::Vector2f pos(static_cast<float>(lcg(rng) % 10000) / 10000.f * WIDTH, static_cast<float>(lcg(rng) % 10000) / 10000.f * HEIGHT);
+            swarm.spawn(pos, sf::Vector2f(0.f, 0.f), 0);
+        }
+
+        std::vector<double> times;
+        times.reserve(TICKS);
+        double tests = 0.0;
+        for (int tick = 0; tick < TICKS; ++tick) {
+            float phase = tick * 0.01f;
+            sf::Vector2f target(WIDTH / 2.f + 400.f * std::cos(phase), HEIGHT / 2.f + 300.f * std::sin(phase));
+            auto start = std::chrono::steady_clock::now();
+            swarm.update(target, true);
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            tests += static_cast<double>(swarm.stats().neighborTests);
+        }
+
+        WorldChecksum sum;
+        swarm.hashState(sum);
+        bench::TickSummary timing = bench::summarize(times);
+        std::printf("%5zu drones  ", count);
+        timing.print();
+        std::printf("  %8.0f neighbour tests  %s  checksum %016llx\n",
+                    tests / TICKS, timing.verdict(), static_cast<unsigned long long>(sum.value()));
+        inBudget = timing.inBudget();
+        return sum.value();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    bool check = false;
+    std::uint64_t expected = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--expect") == 0 && i + 1 < argc) {
+            expected = std::strtoull(argv[++i], nullptr, 16);
+            check = true;
+            continue;
+        }
+        long value = std::strtol(argv[i], nullptr, 10);
+        if (value <= 0) {
+            std::fprintf(stderr, "Usage: %s [--expect CHECKSUM] [droneCount ...]\n", argv[0]);
+            return 2;
+        }
+        sizes.push_back(static_cast<std::size_t>(value));
+    }
+    if (sizes.empty()) sizes = {500, 1000, 2000, 4000};
+
+    bool failed = false;
+    for (std::size_t count : sizes) {
+        bool inBudget = true;
+        std::uint64_t checksum = run(count, inBudget);
+        failed |= !inBudget;
+        if (check && checksum != expected) {
+            std::printf("  MISMATCH: expected checksum %016llx\n", static_cast<unsigned long long>(expected));
+            failed = true;
+        }
+    }
+    return failed ? 1 : 0;
+}
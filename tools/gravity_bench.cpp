@@ -0,0 +1,178 @@
+// gravity_bench: steps a self-gravitating rock field with the Barnes-Hut solver and reports the
+// time per tick against the 60 Hz budget, and how far the approximation is from the exact sum.
+//
+//   gravity_bench [--threads N] [--theta T ...] [bodyCount ...]      default: 1000 2000 4000 8000
+//
+// Every body is both a source and a probe (a third of them heavy, like large rocks), plus two
+// black holes, in a wrapping 1200x800 field. For each count and theta (default 0.3 0.5 0.8) the
+// field runs 600 ticks on the calling thread alone and with N workers (default 3), and prints a
+// checksum of the final state for both: they must match. The error column compares the first
+// tick's pulls with theta = 0 (the exact pairwise sum). Exit code: 0 ok, 1 the checksums differ or
+// the error is over the tolerance for its theta, 2 usage error.
+
+#include "GravityField.h"
+#include "WorldChecksum.h"
+#include "bench_common.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+    const int TICKS = 600;
+    const float WIDTH = 1200.f, HEIGHT = 800.f;
+    const float HOLE_STRENGTH = 600.f;  // Game's black holes
+    const float HEAVY_STRENGTH = 27.f;  // A large rock
+    const float LIGHT_STRENGTH = 3.f;
+    const float SOFTENING = 10.f;
+    const float MAX_PULL = 0.6f;        // px per tick^2
+    // Allowed mean error per theta^2: a centre-of-mass walk misses terms of order theta^2, and the
+    // ratio creeps up with density (about 6 at 8000 bodies), so this leaves room for bigger fields
+    const double ERROR_PER_THETA_SQ = 0.1;
+
+    using bench::lcg;
+
+    struct Body {
+        sf::Vector2f pos, vel;
+        float strength;
+    };
+
+    void makeField(std::size_t count, std::vector<Body>& bodies) {
+        std::uint32_t rng = 12345;
+        bodies.resize(count);
+        for (Body& b : bodies) {
+            b.pos = sf::Vector2f(static_cast<float>(lcg(rng) % 10000) / 10000.f * WIDTH, static_cast<float>(lcg(rng) % 10000) / 10000.f * HEIGHT);
+            float angle = static_cast<float>(lcg(rng) % 360) * 0.017453f;
+            float speed = 0.5f + static_cast<float>(lcg(rng) % 3);
+            b.vel = sf::Vector2f(std::cos(angle) * speed, std::sin(angle) * speed);
+            b.strength = lcg(rng) % 3 == 0 ? HEAVY_STRENGTH : LIGHT_STRENGTH;
+        }
+    }
+
+    void fill(GravityField& field, const std::vector<Body>& bodies) {
+        field.clear();
+        field.addSource(sf::Vector2f(WIDTH * 0.3f, HEIGHT * 0.35f), HOLE_STRENGTH);
+        field.addSource(sf::Vector2f(WIDTH * 0.7f, HEIGHT * 0.65f), HOLE_STRENGTH);
+        for (const Body& b : bodies) field.addSource(b.pos, b.strength);
+        for (const Body& b : bodies) field.addProbe(b.pos);
+    }
+
+    // Mean of |approximate - exact| / |exact| over the probes, on the starting field
+    double firstTickError(const std::vector<Body>& bodies, float theta) {
+        GravityField exact, approximate;
+        for (GravityField* field : { &exact, &approximate }) {
+            field->setSoftening(SOFTENING);
+            field->reserve(bodies.size() + 2, bodies.size());
+            fill(*field, bodies);
+        }
+        exact.setAccuracy(0.f);
+        approximate.setAccuracy(theta);
+        exact.solve();
+        approximate.solve();
+        double error = 0.0;
+        for (std::uint32_t i = 0; i < bodies.size(); ++i) {
+            sf::Vector2f a = exact.pull(i), b = approximate.pull(i);
+            double magnitude = std::sqrt(a.x * a.x + a.y * a.y);
+            if (magnitude > 0.0) error += std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y)) / magnitude;
+        }
+        return error / bodies.size();
+    }
+
+    // Returns the final state's checksum
+    std::uint64_t run(std::size_t count, float theta, int workers) {
+        std::vector<Body> bodies;
+        makeField(count, bodies);
+        GravityField field;
+        field.setAccuracy(theta);
+        field.setSoftening(SOFTENING);
+        field.reserve(count + 2, count);
+        field.setWorkers(workers);
+
+        std::vector<double> times;
+        times.reserve(TICKS);
+        double terms = 0.0, nodes = 0.0;
+        for (int tick = 0; tick < TICKS; ++tick) {
+            auto start = std::chrono::steady_clock::now();
+            fill(field, bodies);
+            field.solve();
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            terms += static_cast<double>(field.stats().interactions);
+            nodes += static_cast<double>(field.stats().nodes);
+
+            for (std::uint32_t i = 0; i < bodies.size(); ++i) { // Game::applyGravity, then Asteroid::update
+                Body& b = bodies[i];
+                sf::Vector2f pull = field.pull(i);
+                float magnitude = std::sqrt(pull.x * pull.x + pull.y * pull.y);
+                if (magnitude > MAX_PULL) pull *= MAX_PULL / magnitude;
+                b.vel += pull;
+                b.pos += b.vel;
+                if (b.pos.x < 0.f) b.pos.x += WIDTH;
+                else if (b.pos.x >= WIDTH) b.pos.x -= WIDTH;
+                if (b.pos.y < 0.f) b.pos.y += HEIGHT;
+                else if (b.pos.y >= HEIGHT) b.pos.y -= HEIGHT;
+            }
+        }
+
+        WorldChecksum sum;
+        for (const Body& b : bodies) {
+            sum.add(b.pos.x);
+            sum.add(b.pos.y);
+            sum.add(b.vel.x);
+            sum.add(b.vel.y);
+        }
+        bench::TickSummary timing = bench::summarize(times);
+        std::printf("  theta %.2f  %d workers  ", theta, workers);
+        timing.print();
+        std::printf("  %6.0f terms/body  %6.0f nodes  %s  checksum %016llx\n",
+                    terms / TICKS / count, nodes / TICKS, timing.verdict(), static_cast<unsigned long long>(sum.value()));
+        return sum.value();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int workers = 3;
+    std::vector<float> thetas;
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            workers = std::max(0, static_cast<int>(std::strtol(argv[++i], nullptr, 10)));
+            continue;
+        }
+        if (std::strcmp(argv[i], "--theta") == 0 && hasValue) {
+            thetas.push_back(std::max(0.f, std::strtof(argv[++i], nullptr)));
+            continue;
+        }
+        long value = std::strtol(argv[i], nullptr, 10);
+        if (value <= 0) {
+            std::fprintf(stderr, "Usage: %s [--threads N] [--theta T ...] [bodyCount ...]\n", argv[0]);
+            return 2;
+        }
+        sizes.push_back(static_cast<std::size_t>(value));
+    }
+    if (sizes.empty()) sizes = {1000, 2000, 4000, 8000};
+    if (thetas.empty()) thetas = {0.3f, 0.5f, 0.8f};
+
+    bool failed = false;
+    for (std::size_t count : sizes) {
+        std::printf("%zu bodies + 2 black holes, %d ticks\n", count, TICKS);
+        for (float theta : thetas) {
+            std::vector<Body> bodies;
+            makeField(count, bodies);
+            double error = firstTickError(bodies, theta), tolerance = ERROR_PER_THETA_SQ * theta * theta;
+            std::printf("  theta %.2f  error %.4f%% against the exact sum (%.4f%% allowed)  %s\n",
+                        theta, 100.0 * error, 100.0 * tolerance, error <= tolerance ? "ok" : "OVER");
+            failed |= error > tolerance;
+            std::uint64_t serial = run(count, theta, 0);
+            if (workers > 0 && run(count, theta, workers) != serial) {
+                std::printf("  MISMATCH: %d workers changed the result\n", workers);
+                failed = true;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
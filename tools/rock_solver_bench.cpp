@@ -0,0 +1,151 @@
+// rock_solver_bench: steps the rock contact solver on synthetic fields and reports the time per
+// tick against the 60 Hz budget.
+//
+//   rock_solver_bench [--threads N] [--cover F] [bodyCount ...]      default: 1000 2000 4000 8000
+//
+// Rocks get the game's three sizes and masses and speeds of 2-4 px per tick, in a wrapping square
+// sized so that they cover the fraction F of it (default 0.25, a busy Campaign screen). Each count
+// runs 600 ticks (move, wrap, solve) on the calling thread alone and with N workers (default 3),
+// and prints a checksum of the final state for both. Exit code: 0 ok, 1 the checksums differ or a
+// p99 is over the budget, 2 usage error.
+
+#include "RockSolver.h"
+#include "WorldChecksum.h"
+#include "bench_common.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+    const int TICKS = 600;
+    const float RADII[3] = { 25.f, 15.f, 8.f };  // Large, medium, small (Asteroid)
+    const float MASSES[3] = { 9.f, 3.5f, 1.f };  // Asteroid::getMass
+
+    using bench::lcg;
+
+    struct Rock {
+        sf::Vector2f pos, vel;
+        float radius, mass;
+    };
+
+    float makeField(std::size_t count, double cover, std::vector<Rock>& rocks) {
+        std::uint32_t rng = 12345;
+        rocks.resize(count);
+        double area = 0.0;
+        for (Rock& r : rocks) {
+            int size = static_cast<int>(lcg(rng) % 3);
+            r.radius = RADII[size];
+            r.mass = MASSES[size];
+            area += 3.14159 * r.radius * r.radius;
+        }
+        float side = static_cast<float>(std::sqrt(area / cover));
+        for (Rock& r : rocks) {
+            r.pos = sf::Vector2f(static_cast<float>(lcg(rng) % 10000) / 10000.f * side, static_cast<float>(lcg(rng) % 10000) / 10000.f * side);
+            float angle = static_cast<float>(lcg(rng) % 360) * 0.017453f;
+            float speed = 2.f + static_cast<float>(lcg(rng) % 3);
+            r.vel = sf::Vector2f(std::cos(angle) * speed, std::sin(angle) * speed);
+        }
+        return side;
+    }
+
+    struct Result {
+        std::uint64_t checksum;
+        bool inBudget;
+    };
+
+    Result run(std::size_t count, double cover, int workers) {
+        std::vector<Rock> rocks;
+        float side = makeField(count, cover, rocks);
+        RockSolver solver;
+        solver.configure(side, side, 2.f * RADII[0]);
+        solver.reserve(count, count * 4);
+        solver.setWorkers(workers);
+
+        std::vector<double> times;
+        times.reserve(TICKS);
+        double contacts = 0.0, islands = 0.0;
+        std::size_t largest = 0;
+        for (int tick = 0; tick < TICKS; ++tick) {
+            for (Rock& r : rocks) { // Asteroid::update
+                r.pos += r.vel;
+                if (r.pos.x < -r.radius) r.pos.x = side + r.radius;
+                else if (r.pos.x > side + r.radius) r.pos.x = -r.radius;
+                if (r.pos.y < -r.radius) r.pos.y = side + r.radius;
+                else if (r.pos.y > side + r.radius) r.pos.y = -r.radius;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            solver.clear();
+            for (const Rock& r : rocks) solver.add(r.pos, r.vel, r.radius, r.mass);
+            solver.solve();
+            for (std::uint32_t i = 0; i < rocks.size(); ++i) {
+                rocks[i].pos = solver.body(i).pos;
+                rocks[i].vel = solver.body(i).vel;
+            }
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+            contacts += static_cast<double>(solver.stats().contacts);
+            islands += static_cast<double>(solver.stats().islands);
+            largest = std::max(largest, solver.stats().largestIsland);
+        }
+
+        WorldChecksum sum;
+        for (const Rock& r : rocks) {
+            sum.add(r.pos.x);
+            sum.add(r.pos.y);
+            sum.add(r.vel.x);
+            sum.add(r.vel.y);
+        }
+        bench::TickSummary timing = bench::summarize(times);
+        std::printf("  %d workers  ", workers);
+        timing.print();
+        std::printf("  %7.0f contacts  %7.0f islands  largest %5zu  %s  checksum %016llx\n",
+                    contacts / TICKS, islands / TICKS, largest, timing.verdict(), static_cast<unsigned long long>(sum.value()));
+        return Result{sum.value(), timing.inBudget()};
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int workers = 3;
+    double cover = 0.25;
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            workers = std::max(0, static_cast<int>(std::strtol(argv[++i], nullptr, 10)));
+            continue;
+        }
+        if (std::strcmp(argv[i], "--cover") == 0 && hasValue) {
+            cover = std::strtod(argv[++i], nullptr);
+            continue;
+        }
+        long value = std::strtol(argv[i], nullptr, 10);
+        if (value <= 0 || cover <= 0.0 || cover > 1.0) {
+            std::fprintf(stderr, "Usage: %s [--threads N] [--cover F] [bodyCount ...]\n", argv[0]);
+            return 2;
+        }
+        sizes.push_back(static_cast<std::size_t>(value));
+    }
+    if (sizes.empty()) sizes = {1000, 2000, 4000, 8000};
+
+    bool failed = false;
+    for (std::size_t count : sizes) {
+        std::printf("%zu rocks, %.0f%% cover, %d ticks\n", count, cover * 100.0, TICKS);
+        Result serial = run(count, cover, 0);
+        failed |= !serial.inBudget;
+        if (workers > 0) {
+            Result parallel = run(count, cover, workers);
+            failed |= !parallel.inBudget;
+            if (parallel.checksum != serial.checksum) {
+                std::printf("  MISMATCH: %d workers changed the result\n", workers);
+                failed = true;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+// session_client: watches (or plays) sessions of a running session server (--server) over UDP and
+// checks the snapshot stream it gets back.
+//
+//   session_client [--host H] [--port P] [--seconds S] [--play] [firstSession [count]]
+//                                     default: 127.0.0.1 47000 10 s, watch session 0
+//
+// It subscribes to each session (Watch, or Input with --play: a steady turn-and-fire), renews that
+// once a second, and decodes every snapshot: keyframes on their own, deltas against the keyframe
+// they name. The report gives snapshots per second and per session, bytes, decode failures and
+// deltas that arrived without their keyframe (lost or reordered datagrams).
+
+#include "ServerPacket.h"
+#include "Snapshot.h"
+#include <SFML/Network.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Watched {
+        WorldSnapshot keyframe;
+        std::uint32_t keyframeTick = 0;
+        bool haveKeyframe = false;
+        std::uint32_t lastTick = 0;
+        std::uint64_t snapshots = 0;
+        std::uint64_t keyframes = 0;
+        std::uint64_t bytes = 0;
+        std::size_t entities = 0;
+    };
+
+    void subscribe(sf::UdpSocket& socket, const sf::IpAddress& host, unsigned short port,
+                   std::uint16_t session, std::uint32_t lastTick, bool play) {
+        ServerPacket packet;
+        packet.kind = play ? ServerPacket::Kind::Input : ServerPacket::Kind::Watch;
+        packet.session = session;
+        packet.tick = lastTick;
+        if (play) packet.input = 1 | 8; // PlayerInput bits left and fire (Player.h needs the whole game)
+        std::vector<std::uint8_t> out;
+        packet.write(out);
+        socket.send(out.data(), out.size(), host, port);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string host = "127.0.0.1";
+    unsigned short port = 47000;
+    double seconds = 10.0;
+    bool play = false;
+    long first = 0, count = 1;
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--host") == 0 && hasValue) { host = argv[++i]; continue; }
+        if (std::strcmp(argv[i], "--port") == 0 && hasValue) { port = static_cast<unsigned short>(std::strtol(argv[++i], nullptr, 10)); continue; }
+        if (std::strcmp(argv[i], "--seconds") == 0 && hasValue) { seconds = std::strtod(argv[++i], nullptr); continue; }
+        if (std::strcmp(argv[i], "--play") == 0) { play = true; continue; }
+        long value = std::strtol(argv[i], nullptr, 10);
+        if (positional < 2 && value >= 0 && value <= 65535) {
+            (positional++ == 0 ? first : count) = value;
+            continue;
+        }
+        std::fprintf(stderr, "Usage: %s [--host H] [--port P] [--seconds S] [--play] [firstSession [count]]\n", argv[0]);
+        return 1;
+    }
+    if (count < 1 || first + count > 65536) {
+        std::fprintf(stderr, "Sessions %ld..%ld are out of range\n", first, first + count - 1);
+        return 1;
+    }
+
+    sf::IpAddress server(host);
+    sf::UdpSocket socket;
+    if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Done) {
+        std::fprintf(stderr, "Could not bind a UDP socket\n");
+        return 1;
+    }
+    socket.setBlocking(false);
+
+    std::vector<Watched> watched(static_cast<std::size_t>(count));
+    SnapshotCodec codec;
+    WorldSnapshot world;
+    std::vector<std::uint8_t> buffer(sf::UdpSocket::MaxDatagramSize);
+    std::uint64_t foreign = 0, failures = 0, orphans = 0;
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now(), end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    Clock::time_point renew = start;
+    while (Clock::now() < end) {
+        if (Clock::now() >= renew) { // The server only remembers the last address it heard from
+            for (long i = 0; i < count; ++i) {
+                subscribe(socket, server, port, static_cast<std::uint16_t>(first + i), watched[i].lastTick, play);
+            }
+            renew += std::chrono::seconds(1);
+        }
+
+        std::size_t received = 0;
+        sf::IpAddress from;
+        unsigned short fromPort = 0;
+        bool any = false;
+        while (socket.receive(buffer.data(), buffer.size(), received, from, fromPort) == sf::Socket::Done) {
+            any = true;
+            ServerPacket packet;
+            if (!packet.read(buffer.data(), received) || packet.kind != ServerPacket::Kind::Snapshot ||
+                packet.session < first || packet.session >= first + count) {
+                ++foreign;
+                continue;
+            }
+            Watched& w = watched[packet.session - first];
+            w.bytes += received;
+            const std::uint8_t* payload = buffer.data() + ServerPacket::HEADER_SIZE;
+            std::size_t size = received - ServerPacket::HEADER_SIZE;
+            try {
+                if (packet.keyframe()) {
+                    codec.decode(payload, size, nullptr, w.keyframe);
+                    w.keyframeTick = packet.tick;
+                    w.haveKeyframe = true;
+                    w.entities = w.keyframe.entities.size();
+                    ++w.keyframes;
+                } else if (w.haveKeyframe && w.keyframeTick == packet.baseTick) {
+                    codec.decode(payload, size, &w.keyframe, world);
+                    w.entities = world.entities.size();
+                } else {
+                    ++orphans;
+                    continue;
+                }
+            } catch (const std::exception& e) { // runtime_error for bad data; bad_alloc and the like count too
+                if (failures++ == 0) std::fprintf(stderr, "Session %u tick %u: %s\n", packet.session, packet.tick, e.what());
+                continue;
+            }
+            ++w.snapshots;
+            w.lastTick = packet.tick;
+        }
+        if (!any) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::uint64_t snapshots = 0, keyframes = 0, bytes = 0;
+    std::size_t silent = 0;
+    for (long i = 0; i < count; ++i) {
+        const Watched& w = watched[i];
+        snapshots += w.snapshots;
+        keyframes += w.keyframes;
+        bytes += w.bytes;
+        if (w.snapshots == 0) ++silent;
+        if (count <= 8) {
+            std::printf("session %5ld: %7llu snapshots (%llu keyframes), last tick %u, %zu entities\n",
+                        first + i, static_cast<unsigned long long>(w.snapshots), static_cast<unsigned long long>(w.keyframes),
+                        w.lastTick, w.entities);
+        }
+    }
+    std::printf("%s %ld sessions for %.1f s: %.1f snapshots/s per session, %.1f KB/s in total, %.0f B per snapshot\n",
+                play ? "Played" : "Watched", count, elapsed, snapshots / elapsed / count, bytes / elapsed / 1024.0,
+                snapshots ? static_cast<double>(bytes) / snapshots : 0.0);
+    std::printf("%llu keyframes, %llu decode failures, %llu deltas without their keyframe, %llu foreign datagrams, %zu silent sessions\n",
+                static_cast<unsigned long long>(keyframes), static_cast<unsigned long long>(failures),
+                static_cast<unsigned long long>(orphans), static_cast<unsigned long long>(foreign), silent);
+    return (failures == 0 && silent == 0) ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// snapshot_bench: measures the world snapshot codec on synthetic worlds shaped like real play
+// (mostly asteroids and bullets, one player, a few power-ups and timers).
+//
+//   snapshot_bench [entityCount ...]      default: 100 1000 10000
+//
+// For each size it reports the size per entity and encode/decode throughput of a full snapshot,
+// and of a delta against the previous tick's snapshot (every entity moved one step).
+
+#include "Snapshot.h"
+#include "bench_common.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    using bench::lcg;
+
+    void makeWorld(std::size_t count, WorldSnapshot& world) {
+        std::uint32_t rng = 12345;
+        world = WorldSnapshot();
+        world.mode = 1;
+        world.level = 3;
+        world.simTick = 5000;
+        world.playTick = 5200;
+        world.rngState = 0x853C49E6748FEA9Bull;
+        world.player = 0;
+        world.entities.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            EntityRecord& e = world.entities[i];
+            e.id = static_cast<std::uint32_t>(i);
+            e.generation = 1 + lcg(rng) % 4;
+            std::uint32_t roll = lcg(rng) % 100;
+            e.type = i == 0 ? 1 : (roll < 60 ? 2 : (roll < 95 ? 3 : 4)); // Player, asteroid, bullet, power-up
+            e.variant = static_cast<std::uint8_t>(lcg(rng) % 3);
+            e.x = static_cast<std::int32_t>(lcg(rng) % (1200 * SnapshotCodec::POS_SCALE));
+            e.y = static_cast<std::int32_t>(lcg(rng) % (800 * SnapshotCodec::POS_SCALE));
+            e.vx = static_cast<std::int32_t>(lcg(rng) % (10 * SnapshotCodec::VEL_SCALE)) - 5 * SnapshotCodec::VEL_SCALE;
+            e.vy = static_cast<std::int32_t>(lcg(rng) % (10 * SnapshotCodec::VEL_SCALE)) - 5 * SnapshotCodec::VEL_SCALE;
+            e.angle = static_cast<std::uint16_t>(lcg(rng) % 4096);
+            e.radius = static_cast<std::uint16_t>((8 + lcg(rng) % 18) * SnapshotCodec::RADIUS_SCALE);
+            e.age = lcg(rng) % 2000;
+            e.extraCount = 1;
+            e.extra[0] = e.type == 2 ? 20 : 1;
+        }
+        for (int i = 0; i < 8; ++i) {
+            TimerRecord t;
+            t.kind = static_cast<std::uint16_t>(i % 4);
+            t.target = i % 2 ? static_cast<std::int32_t>(lcg(rng) % count) : -1;
+            t.remaining = 1 + lcg(rng) % 900;
+            world.timers.push_back(t);
+        }
+    }
+
+    // One tick later: positions advance by velocity, ages by one
+    void stepWorld(const WorldSnapshot& from, WorldSnapshot& to) {
+        to = from;
+        ++to.simTick;
+        ++to.playTick;
+        for (EntityRecord& e : to.entities) {
+            e.x += e.vx * SnapshotCodec::POS_SCALE / SnapshotCodec::VEL_SCALE;
+            e.y += e.vy * SnapshotCodec::POS_SCALE / SnapshotCodec::VEL_SCALE;
+            ++e.age;
+        }
+        for (TimerRecord& t : to.timers) if (t.remaining > 1) --t.remaining;
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Encodes/decodes 'world' repeatedly for about a fifth of a second each way
+    void measure(const char* label, const WorldSnapshot& world, const WorldSnapshot* base) {
+        SnapshotCodec codec;
+        std::vector<std::uint8_t> bytes;
+        codec.encode(world, base, bytes);
+        std::size_t size = bytes.size();
+
+        int encodes = 0;
+        auto start = std::chrono::steady_clock::now();
+        double encodeTime;
+        do {
+            bytes.clear();
+            codec.encode(world, base, bytes);
+            ++encodes;
+        } while ((encodeTime = secondsSince(start)) < 0.2);
+
+        WorldSnapshot decoded;
+        int decodes = 0;
+        start = std::chrono::steady_clock::now();
+        double decodeTime;
+        do {
+            codec.decode(bytes.data(), bytes.size(), base, decoded);
+            ++decodes;
+        } while ((decodeTime = secondsSince(start)) < 0.2);
+        if (decoded.entities.size() != world.entities.size() || decoded.simTick != world.simTick) {
+            throw std::runtime_error("decoded world does not match the encoded one");
+        }
+
+        double entitiesPerSec = static_cast<double>(world.entities.size());
+        std::printf("  %-6s %9zu bytes  %6.2f bytes/entity  encode %8.1f MB/s %7.2f Mentities/s  decode %8.1f MB/s %7.2f Mentities/s\n",
+                    label, size, static_cast<double>(size) / world.entities.size(),
+                    size * encodes / encodeTime / 1e6, entitiesPerSec * encodes / encodeTime / 1e6,
+                    size * decodes / decodeTime / 1e6, entitiesPerSec * decodes / decodeTime / 1e6);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        long value = std::strtol(argv[i], nullptr, 10);
+        if (value <= 0) {
+            std::fprintf(stderr, "Usage: %s [entityCount ...]\n", argv[0]);
+            return 2;
+        }
+        sizes.push_back(static_cast<std::size_t>(value));
+    }
+    if (sizes.empty()) sizes = {100, 1000, 10000};
+
+    try {
+        for (std::size_t count : sizes) {
+            WorldSnapshot base, world;
+            makeWorld(count, base);
+            stepWorld(base, world);
+            std::printf("%zu entities (unquantized: %zu bytes/entity in memory)\n", count, sizeof(EntityRecord));
+            measure("full", world, nullptr);
+            measure("delta", world, &base);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "snapshot_bench: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
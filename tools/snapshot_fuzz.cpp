@@ -0,0 +1,198 @@
+// snapshot_fuzz: feeds SnapshotCodec::decode damaged copies of real snapshots, the way a lossy or
+// hostile network would, and checks it copes: every input must either decode or throw
+// std::runtime_error, which is what the session client counts as a decode failure. Any other
+// exception fails the run, and a crash or abort fails it by itself.
+//
+//   snapshot_fuzz [rounds] [--seed N]      default: 20000 rounds, seed 1
+//
+// The inputs are a keyframe and a delta against it (entities, timers, enemy shots, emitters and
+// drones), first cut short at every length, then for each round three copies of either: one with
+// random bytes overwritten, one with random bits flipped, and one cut at a random point and
+// continued with random bytes. Exit code: 0 ok, 1 an input was mishandled, 2 usage error.
+
+#include "Snapshot.h"
+#include "bench_common.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    using bench::lcg;
+
+    struct Tally {
+        std::uint64_t decoded = 0, rejected = 0, failures = 0;
+    };
+
+    void makeWorld(WorldSnapshot& world) {
+        std::uint32_t rng = 777;
+        world = WorldSnapshot();
+        world.mode = 2;
+        world.level = 4;
+        world.simTick = 9000;
+        world.playTick = 9100;
+        world.rngState = 0x853C49E6748FEA9Bull;
+        world.player = 0;
+        world.boss = 1;
+        world.entities.resize(200);
+        for (std::size_t i = 0; i < world.entities.size(); ++i) {
+            EntityRecord& e = world.entities[i];
+            e.id = static_cast<std::uint32_t>(i * 3);
+            e.generation = 1 + lcg(rng) % 4;
+            e.type = static_cast<std::uint8_t>(1 + lcg(rng) % 6);
+            e.variant = static_cast<std::uint8_t>(lcg(rng) % 3);
+            e.x = static_cast<std::int32_t>(lcg(rng) % (1200 * SnapshotCodec::POS_SCALE));
+            e.y = static_cast<std::int32_t>(lcg(rng) % (800 * SnapshotCodec::POS_SCALE));
+            e.vx = static_cast<std::int32_t>(lcg(rng) % (10 * SnapshotCodec::VEL_SCALE)) - 5 * SnapshotCodec::VEL_SCALE;
+            e.vy = static_cast<std::int32_t>(lcg(rng) % (10 * SnapshotCodec::VEL_SCALE)) - 5 * SnapshotCodec::VEL_SCALE;
+            e.angle = static_cast<std::uint16_t>(lcg(rng) % 4096);
+            e.radius = static_cast<std::uint16_t>((8 + lcg(rng) % 18) * SnapshotCodec::RADIUS_SCALE);
+            e.age = lcg(rng) % 2000;
+            e.extraCount = static_cast<std::uint8_t>(lcg(rng) % (EntityRecord::MAX_EXTRA + 1));
+            for (int k = 0; k < e.extraCount; ++k) e.extra[k] = static_cast<std::int32_t>(lcg(rng) % 200) - 100;
+        }
+        for (int i = 0; i < 8; ++i) {
+            TimerRecord t;
+            t.kind = static_cast<std::uint16_t>(i % 4);
+            t.target = i % 2 ? static_cast<std::int32_t>(lcg(rng) % world.entities.size()) : -1;
+            t.remaining = 1 + lcg(rng) % 900;
+            world.timers.push_back(t);
+        }
+        for (int i = 0; i < 20; ++i) {
+            ShotRecord s;
+            s.x = static_cast<std::int32_t>(lcg(rng) % (1200 * SnapshotCodec::POS_SCALE));
+            s.y = static_cast<std::int32_t>(lcg(rng) % (800 * SnapshotCodec::POS_SCALE));
+            s.vx = static_cast<std::int32_t>(lcg(rng) % (6 * SnapshotCodec::VEL_SCALE)) - 3 * SnapshotCodec::VEL_SCALE;
+            s.vy = static_cast<std::int32_t>(lcg(rng) % (6 * SnapshotCodec::VEL_SCALE)) - 3 * SnapshotCodec::VEL_SCALE;
+            s.age = lcg(rng) % 300;
+            world.shots.push_back(s);
+        }
+        for (int i = 0; i < 3; ++i) {
+            EmitterRecord e;
+            e.pattern = static_cast<std::uint8_t>(i);
+            e.source = 1;
+            e.gun = static_cast<std::uint8_t>(i);
+            e.volleysLeft = static_cast<std::uint8_t>(1 + lcg(rng) % 5);
+            e.wait = static_cast<std::uint8_t>(lcg(rng) % 30);
+            e.aim = static_cast<std::uint16_t>(lcg(rng) % 4096);
+            world.emitters.push_back(e);
+        }
+        for (int i = 0; i < 30; ++i) {
+            DroneRecord d;
+            d.x = static_cast<std::int32_t>(lcg(rng) % (1200 * SnapshotCodec::POS_SCALE));
+            d.y = static_cast<std::int32_t>(lcg(rng) % (800 * SnapshotCodec::POS_SCALE));
+            d.age = lcg(rng) % 600;
+            world.drones.push_back(d);
+        }
+    }
+
+    // A few ticks later: everything moved, some entities and shots gone, new ones appended
+    void stepWorld(const WorldSnapshot& from, WorldSnapshot& to) {
+        to = from;
+        to.simTick += 3;
+        to.playTick += 3;
+        for (EntityRecord& e : to.entities) {
+            e.x += 3 * e.vx * SnapshotCodec::POS_SCALE / SnapshotCodec::VEL_SCALE;
+            e.y += 3 * e.vy * SnapshotCodec::POS_SCALE / SnapshotCodec::VEL_SCALE;
+            e.age += 3;
+        }
+        to.entities.erase(to.entities.begin() + 40, to.entities.begin() + 50);
+        for (std::uint32_t i = 0; i < 10; ++i) {
+            EntityRecord e = from.entities[i];
+            e.id = 1000 + i;
+            to.entities.push_back(e);
+        }
+        to.shots.erase(to.shots.begin(), to.shots.begin() + 5);
+        to.shots.push_back(from.shots[0]);
+        for (DroneRecord& d : to.drones) d.x += 3 * SnapshotCodec::POS_SCALE;
+    }
+
+    void feed(SnapshotCodec& codec, const std::vector<std::uint8_t>& bytes, const WorldSnapshot* base,
+              WorldSnapshot& out, Tally& tally, const char* what) {
+        try {
+            codec.decode(bytes.data(), bytes.size(), base, out);
+            ++tally.decoded;
+        } catch (const std::runtime_error&) {
+            ++tally.rejected;
+        } catch (const std::exception& e) {
+            if (tally.failures++ < 10) std::printf("  FAIL: %s (%zu bytes) threw something else: %s\n", what, bytes.size(), e.what());
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::uint64_t rounds = 20000;
+    std::uint32_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(argv[i], &end, 10);
+        if (end && *end == '\0' && value > 0) {
+            rounds = value;
+            continue;
+        }
+        std::fprintf(stderr, "Usage: %s [rounds] [--seed N]\n", argv[0]);
+        return 2;
+    }
+
+    WorldSnapshot keyframe, next, out;
+    makeWorld(keyframe);
+    stepWorld(keyframe, next);
+    SnapshotCodec codec;
+    std::vector<std::uint8_t> full, delta;
+    codec.encode(keyframe, nullptr, full);
+    codec.encode(next, &keyframe, delta);
+
+    Tally tally;
+    feed(codec, full, nullptr, out, tally, "intact keyframe");
+    feed(codec, delta, &keyframe, out, tally, "intact delta");
+    if (tally.decoded != 2) {
+        std::printf("The intact snapshots did not decode: nothing to damage\n");
+        return 1;
+    }
+
+    std::vector<std::uint8_t> damaged;
+    for (std::size_t length = 0; length < full.size(); ++length) {
+        damaged.assign(full.begin(), full.begin() + length);
+        feed(codec, damaged, nullptr, out, tally, "truncated keyframe");
+    }
+    for (std::size_t length = 0; length < delta.size(); ++length) {
+        damaged.assign(delta.begin(), delta.begin() + length);
+        feed(codec, damaged, &keyframe, out, tally, "truncated delta");
+    }
+
+    std::uint32_t rng = seed;
+    for (std::uint64_t round = 0; round < rounds; ++round) {
+        bool isDelta = lcg(rng) % 2 != 0;
+        const std::vector<std::uint8_t>& source = isDelta ? delta : full;
+        const WorldSnapshot* base = isDelta ? &keyframe : nullptr;
+
+        damaged = source;
+        int hits = 1 + static_cast<int>(lcg(rng) % 4);
+        for (int k = 0; k < hits; ++k) damaged[lcg(rng) % damaged.size()] = static_cast<std::uint8_t>(lcg(rng));
+        feed(codec, damaged, base, out, tally, "overwritten bytes");
+
+        damaged = source;
+        hits = 1 + static_cast<int>(lcg(rng) % 8);
+        for (int k = 0; k < hits; ++k) damaged[lcg(rng) % damaged.size()] ^= static_cast<std::uint8_t>(1u << (lcg(rng) % 8));
+        feed(codec, damaged, base, out, tally, "flipped bits");
+
+        std::size_t cut = lcg(rng) % source.size();
+        damaged.assign(source.begin(), source.begin() + cut);
+        std::size_t length = lcg(rng) % (2 * source.size());
+        for (std::size_t k = 0; k < length; ++k) damaged.push_back(static_cast<std::uint8_t>(lcg(rng)));
+        feed(codec, damaged, base, out, tally, "noise after a valid start");
+    }
+
+    std::printf("%llu inputs: %llu decoded, %llu rejected, %llu mishandled\n",
+                static_cast<unsigned long long>(tally.decoded + tally.rejected + tally.failures),
+                static_cast<unsigned long long>(tally.decoded), static_cast<unsigned long long>(tally.rejected),
+                static_cast<unsigned long long>(tally.failures));
+    return tally.failures == 0 ? 0 : 1;
+}